@@ -6,10 +6,169 @@
 
 namespace FWK_CS {
 
-ColaEvento::ColaEvento() {
+ColaEvento::ColaEvento(size_t capacidadControl, size_t capacidadDatos,
+		size_t pesoControl) {
+	size_t capacidades[Evento::CANTIDAD_PRIORIDADES];
+	capacidades[Evento::PRIORIDAD_CONTROL] = capacidadControl;
+	capacidades[Evento::PRIORIDAD_DATOS] = capacidadDatos;
+	for (size_t i = 0; i < Evento::CANTIDAD_PRIORIDADES; ++i) {
+		Carril &carril = carriles[i];
+		carril.capacidad = (capacidades[i] > 0) ? capacidades[i] : 1;
+		carril.eventos = new Evento*[carril.capacidad];
+		carril.inicio = 0;
+		carril.cantidad = 0;
+		carril.peso = 1;
+	}
+	carriles[Evento::PRIORIDAD_CONTROL].peso =
+			(pesoControl > 0) ? pesoControl : 1;
+	total = 0;
+	turno = Evento::PRIORIDAD_CONTROL;
+	entregados = 0;
+	cerrada = false;
+}
+
+bool ColaEvento::intentarInsertar(Evento *evento) {
+	{
+		PThread::Mutex::Lock lock(mutex);
+		Carril &carril = carriles[evento->getPrioridad()];
+		if (cerrada || carril.cantidad == carril.capacidad) {
+			return false;
+		}
+		carril.eventos[(carril.inicio + carril.cantidad) % carril.capacidad] =
+				evento;
+		++carril.cantidad;
+		++total;
+	}
+	datos.notificarUno();
+	return true;
+}
+
+bool ColaEvento::insertar(Evento *evento) {
+	{
+		PThread::Mutex::Lock lock(mutex);
+		Carril &carril = carriles[evento->getPrioridad()];
+		while (!cerrada && carril.cantidad == carril.capacidad) {
+			carril.espacio.esperar(mutex);
+		}
+		if (cerrada) {
+			return false;
+		}
+		carril.eventos[(carril.inicio + carril.cantidad) % carril.capacidad] =
+				evento;
+		++carril.cantidad;
+		++total;
+	}
+	datos.notificarUno();
+	return true;
+}
+
+bool ColaEvento::intentarExtraer(Evento *&evento) {
+	Evento::t_prioridad prioridad;
+	{
+		PThread::Mutex::Lock lock(mutex);
+		if (total == 0) {
+			return false;
+		}
+		evento = quitarSiguiente();
+		prioridad = evento->getPrioridad();
+	}
+	carriles[prioridad].espacio.notificarUno();
+	return true;
+}
+
+Evento* ColaEvento::extraer() {
+	Evento *evento = NULL;
+	esperarEvento(NULL, evento);
+	return evento;
+}
+
+Evento* ColaEvento::extraer(long milisegundos) {
+	timespec limite = PThread::Condicion::limiteEn(milisegundos);
+	Evento *evento = NULL;
+	esperarEvento(&limite, evento);
+	return evento;
+}
+
+void ColaEvento::cerrar() {
+	{
+		PThread::Mutex::Lock lock(mutex);
+		cerrada = true;
+	}
+	datos.notificarTodos();
+	for (size_t i = 0; i < Evento::CANTIDAD_PRIORIDADES; ++i) {
+		carriles[i].espacio.notificarTodos();
+	}
+}
+
+bool ColaEvento::estaCerrada() const {
+	PThread::Mutex::Lock lock(mutex);
+	return cerrada;
+}
+
+size_t ColaEvento::getTamanio(Evento::t_prioridad prioridad) const {
+	PThread::Mutex::Lock lock(mutex);
+	return carriles[prioridad].cantidad;
+}
+
+size_t ColaEvento::getTamanio() const {
+	PThread::Mutex::Lock lock(mutex);
+	return total;
+}
+
+size_t ColaEvento::getCapacidad(Evento::t_prioridad prioridad) const {
+	return carriles[prioridad].capacidad;
 }
 
 ColaEvento::~ColaEvento() {
+	for (size_t i = 0; i < Evento::CANTIDAD_PRIORIDADES; ++i) {
+		delete[] carriles[i].eventos;
+	}
+}
+
+bool ColaEvento::esperarEvento(const timespec *limite, Evento *&evento) {
+	Evento::t_prioridad prioridad;
+	{
+		PThread::Mutex::Lock lock(mutex);
+		while (total == 0 && !cerrada) {
+			if (limite == NULL) {
+				datos.esperar(mutex);
+			}
+			else if (!datos.esperarHasta(mutex, *limite) && total == 0) {
+				return false;
+			}
+		}
+		if (total == 0) {
+			return false;
+		}
+		evento = quitarSiguiente();
+		prioridad = evento->getPrioridad();
+	}
+	carriles[prioridad].espacio.notificarUno();
+	return true;
+}
+
+Evento* ColaEvento::quitarSiguiente() {
+	/* Turno ponderado: el carril en turno sigue mientras tenga eventos y no
+	 * haya agotado su peso. Si agota su peso, el turno pasa al siguiente
+	 * carril con eventos; si se vacia, vuelve al de mayor prioridad */
+	if (carriles[turno].cantidad == 0 || entregados >= carriles[turno].peso) {
+		size_t siguiente = (entregados >= carriles[turno].peso) ? turno + 1 : 0;
+		for (size_t i = 0; i < Evento::CANTIDAD_PRIORIDADES; ++i) {
+			size_t candidato = (siguiente + i) % Evento::CANTIDAD_PRIORIDADES;
+			if (carriles[candidato].cantidad > 0) {
+				turno = candidato;
+				break;
+			}
+		}
+		entregados = 0;
+	}
+	Carril &carril = carriles[turno];
+	Evento *evento = carril.eventos[carril.inicio];
+	carril.inicio = (carril.inicio + 1) % carril.capacidad;
+	--carril.cantidad;
+	--total;
+	++entregados;
+	return evento;
 }
 
 }
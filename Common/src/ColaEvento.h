@@ -6,12 +6,145 @@
 #ifndef COLAEVENTO_H_
 #define COLAEVENTO_H_
 
+#include <cstddef>
+#include "Condicion.h"
+#include "Evento.h"
+#include "Mutex.h"
+
 namespace FWK_CS {
 
+/**
+ * @brief Cola acotada de eventos con un carril por prioridad, para múltiples
+ * productores y múltiples consumidores
+ * @details Cada carril tiene su propia capacidad, por lo que un carril de
+ * datos lleno no bloquea a los productores de eventos de control
+ * @details La extracción recorre los carriles por turno ponderado: el carril
+ * en turno entrega hasta su peso en eventos consecutivos y luego cede el
+ * turno al siguiente carril con eventos. Con un peso de control alto, los
+ * eventos de control esperan a lo sumo un evento de datos, y el carril de
+ * datos nunca queda sin servicio
+ * @details La cola no es dueña de los eventos
+ */
+
 class ColaEvento {
 public:
-	ColaEvento();
+
+	/**
+	 * @brief Construye una cola vacía
+	 * @param capacidadControl Capacidad del carril de control
+	 * @param capacidadDatos Capacidad del carril de datos
+	 * @param pesoControl Eventos de control consecutivos que se extraen antes
+	 * de ceder el turno a un evento de datos (el peso de datos es 1)
+	 */
+	explicit ColaEvento(size_t capacidadControl = 256,
+			size_t capacidadDatos = 4096, size_t pesoControl = 8);
+
+	/**
+	 * @brief Método para insertar un evento en el carril de su prioridad,
+	 * sin esperar
+	 * @param evento Evento a insertar
+	 * @return <tt>true</tt> si se insertó
+	 * @return <tt>false</tt> si el carril está lleno o la cola está cerrada
+	 */
+	bool intentarInsertar(Evento *evento);
+
+	/**
+	 * @brief Método para insertar un evento en el carril de su prioridad,
+	 * esperando si el carril está lleno
+	 * @param evento Evento a insertar
+	 * @return <tt>true</tt> si se insertó
+	 * @return <tt>false</tt> si la cola está cerrada
+	 */
+	bool insertar(Evento *evento);
+
+	/**
+	 * @brief Método para extraer el próximo evento sin esperar
+	 * @param evento Donde se guarda el evento extraído
+	 * @return <tt>true</tt> si se extrajo un evento
+	 * @return <tt>false</tt> si la cola está vacía
+	 */
+	bool intentarExtraer(Evento *&evento);
+
+	/**
+	 * @brief Método para extraer el próximo evento, esperando si la cola está
+	 * vacía
+	 * @return El evento extraído, o <tt>NULL</tt> si la cola está vacía y
+	 * cerrada
+	 */
+	Evento* extraer();
+
+	/**
+	 * @brief Igual a ColaEvento::extraer, con un tiempo límite
+	 * @param milisegundos Tiempo máximo de espera
+	 * @return El evento extraído, o <tt>NULL</tt> si se alcanzó el límite o
+	 * la cola está vacía y cerrada
+	 */
+	Evento* extraer(long milisegundos);
+
+	/**
+	 * @brief Método que cierra la cola: no se admiten nuevas inserciones y se
+	 * despierta a todos los hilos en espera. Los eventos ya insertados
+	 * pueden seguir extrayéndose
+	 */
+	void cerrar();
+
+	/**
+	 * @brief Método para consultar si la cola fue cerrada
+	 * @return <tt>true</tt> si fue cerrada
+	 */
+	bool estaCerrada() const;
+
+	/**
+	 * @brief Método para obtener la cantidad de eventos en un carril
+	 * @param prioridad Prioridad del carril
+	 * @return La cantidad de eventos
+	 */
+	size_t getTamanio(Evento::t_prioridad prioridad) const;
+
+	/**
+	 * @brief Método para obtener la cantidad de eventos en la cola
+	 * @return La cantidad de eventos
+	 */
+	size_t getTamanio() const;
+
+	/**
+	 * @brief Método para obtener la capacidad de un carril
+	 * @param prioridad Prioridad del carril
+	 * @return La capacidad
+	 */
+	size_t getCapacidad(Evento::t_prioridad prioridad) const;
+
+	/**
+	 * @brief Destructor
+	 */
 	virtual ~ColaEvento();
+
+private:
+
+	/* Anillo acotado de eventos de una prioridad */
+	struct Carril {
+		Evento **eventos;
+		size_t capacidad;
+		size_t inicio;
+		size_t cantidad;
+		size_t peso;
+		PThread::Condicion espacio;
+	};
+
+	mutable PThread::Mutex mutex;
+	PThread::Condicion datos;
+	Carril carriles[Evento::CANTIDAD_PRIORIDADES];
+	size_t total;
+	/* Carril en turno y eventos que entrego en el turno actual */
+	size_t turno;
+	size_t entregados;
+	bool cerrada;
+
+	bool esperarEvento(const timespec *limite, Evento *&evento);
+	Evento* quitarSiguiente();
+
+	ColaEvento(const ColaEvento&);
+	ColaEvento& operator=(const ColaEvento&);
 };
 
 }
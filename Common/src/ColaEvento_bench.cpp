@@ -0,0 +1,128 @@
+/******************************
+ *  Archivo: ColaEvento_bench.cpp
+ *	Autor:   Martín Lucero
+ *****************************/
+#include "ColaEvento.h"
+#include "Bench.h"
+#include <algorithm>
+#include <cstdio>
+#include <pthread.h>
+#include <time.h>
+#include <vector>
+
+/* Latencia de los latidos mientras un productor mantiene llena la cola con
+ * datos: con los latidos en el carril de control, o encolados como datos
+ * detrás de la transferencia */
+
+#define LATIDOS 2000
+#define MICROSEGUNDOS_ENTRE_LATIDOS 500
+/* Trabajo simulado del consumidor por cada evento de datos */
+#define GIROS_POR_DATO 300
+
+namespace FWK_CS {
+
+class EventoBench: public Evento {
+public:
+	EventoBench(t_prioridad prioridad, bool latido) :
+			Evento(prioridad), latido(latido), enviado(0) {
+	}
+	bool latido;
+	long long enviado;
+};
+
+struct Carga {
+	ColaEvento *cola;
+	Evento::t_prioridad prioridadLatidos;
+	std::vector<long long> latencias;
+	size_t datos;
+	bool terminado;
+};
+
+static void* producirDatos(void *parametro) {
+	Carga *carga = static_cast<Carga*>(parametro);
+	EventoBench dato(Evento::PRIORIDAD_DATOS, false);
+	while (!__atomic_load_n(&carga->terminado, __ATOMIC_ACQUIRE)) {
+		carga->cola->insertar(&dato);
+	}
+	return NULL;
+}
+
+static void* producirLatidos(void *parametro) {
+	Carga *carga = static_cast<Carga*>(parametro);
+	std::vector<EventoBench*> latidos;
+	for (int i = 0; i < LATIDOS; ++i) {
+		latidos.push_back(new EventoBench(carga->prioridadLatidos, true));
+	}
+	struct timespec pausa = { 0, MICROSEGUNDOS_ENTRE_LATIDOS * 1000L };
+	for (int i = 0; i < LATIDOS; ++i) {
+		nanosleep(&pausa, NULL);
+		latidos[i]->enviado = PThread::nanosegundosAhora();
+		carga->cola->insertar(latidos[i]);
+	}
+	/* El consumidor libera los latidos a medida que los procesa */
+	return NULL;
+}
+
+static void* consumir(void *parametro) {
+	Carga *carga = static_cast<Carga*>(parametro);
+	Evento *evento;
+	while ((evento = carga->cola->extraer()) != NULL) {
+		EventoBench *bench = static_cast<EventoBench*>(evento);
+		if (bench->latido) {
+			carga->latencias.push_back(
+					PThread::nanosegundosAhora() - bench->enviado);
+			delete bench;
+			continue;
+		}
+		++carga->datos;
+		for (volatile int giro = 0; giro < GIROS_POR_DATO; ++giro) {
+		}
+	}
+	return NULL;
+}
+
+static void medir(const char *prueba, Evento::t_prioridad prioridadLatidos) {
+	ColaEvento cola;
+	Carga carga;
+	carga.cola = &cola;
+	carga.prioridadLatidos = prioridadLatidos;
+	carga.datos = 0;
+	carga.terminado = false;
+
+	pthread_t consumidor, datos, latidos;
+	pthread_create(&consumidor, NULL, consumir, &carga);
+	pthread_create(&datos, NULL, producirDatos, &carga);
+	pthread_create(&latidos, NULL, producirLatidos, &carga);
+	pthread_join(latidos, NULL);
+	__atomic_store_n(&carga.terminado, true, __ATOMIC_RELEASE);
+	pthread_join(datos, NULL);
+	cola.cerrar();
+	pthread_join(consumidor, NULL);
+
+	std::vector<long long> &latencias = carga.latencias;
+	std::sort(latencias.begin(), latencias.end());
+	printf("%-22s p50 %8.1f us  p99 %8.1f us  max %8.1f us  %lu datos\n",
+			prueba, PThread::percentil(latencias, 50) / 1e3,
+			PThread::percentil(latencias, 99) / 1e3,
+			latencias.back() / 1e3, (unsigned long) carga.datos);
+}
+
+void benchLatidosConCarriles() {
+	medir("carril de control", Evento::PRIORIDAD_CONTROL);
+}
+
+void benchLatidosDetrasDeDatos() {
+	medir("carril de datos", Evento::PRIORIDAD_DATOS);
+}
+
+}
+
+#ifdef COLAEVENTO_BENCH
+int main() {
+	printf("%d latidos cada %d us con la cola de datos llena\n", LATIDOS,
+			MICROSEGUNDOS_ENTRE_LATIDOS);
+	FWK_CS::benchLatidosConCarriles();
+	FWK_CS::benchLatidosDetrasDeDatos();
+	return 0;
+}
+#endif
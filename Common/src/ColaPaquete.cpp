@@ -3,13 +3,305 @@
  *	Autor:   Martín Lucero
  *****************************/
 #include "ColaPaquete.h"
+#include "Futex.h"
+#include <climits>
+#include <stdint.h>
+
+/* Iteraciones de espera activa antes de dormir al hilo */
+#define GIROS_ANTES_DE_DORMIR 128
 
 namespace FWK_CS {
 
-ColaPaquete::ColaPaquete() {
+using PThread::futexEsperar;
+using PThread::futexDespertar;
+using PThread::pausaCPU;
+
+ColaPaquete::ColaPaquete(size_t capacidad) {
+	size_t tamanio = 2;
+	while (tamanio < capacidad) {
+		tamanio <<= 1;
+	}
+	celdas = new Celda[tamanio];
+	for (size_t i = 0; i < tamanio; ++i) {
+		celdas[i].secuencia = i;
+		celdas[i].paquete = NULL;
+	}
+	mascara = tamanio - 1;
+	posInsercion = 0;
+	posExtraccion = 0;
+	senialDatos = 0;
+	consumidoresDormidos = 0;
+	consumidoresAvisados = false;
+	senialEspacio = 0;
+	productoresDormidos = 0;
+	productoresAvisados = false;
+	cerrada = false;
+}
+
+bool ColaPaquete::intentarInsertar(Paquete *paquete) {
+	if (__atomic_load_n(&cerrada, __ATOMIC_RELAXED)) {
+		return false;
+	}
+	size_t pos = __atomic_load_n(&posInsercion, __ATOMIC_RELAXED);
+	Celda *celda;
+	while (true) {
+		celda = &celdas[pos & mascara];
+		size_t secuencia = __atomic_load_n(&celda->secuencia, __ATOMIC_ACQUIRE);
+		intptr_t diferencia = (intptr_t) secuencia - (intptr_t) pos;
+		if (diferencia == 0) {
+			if (__atomic_compare_exchange_n(&posInsercion, &pos, pos + 1, true,
+					__ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+				break;
+			}
+		}
+		else if (diferencia < 0) {
+			/* La celda todavia tiene el paquete de la vuelta anterior */
+			return false;
+		}
+		else {
+			pos = __atomic_load_n(&posInsercion, __ATOMIC_RELAXED);
+		}
+	}
+	celda->paquete = paquete;
+	__atomic_store_n(&celda->secuencia, pos + 1, __ATOMIC_RELEASE);
+	despertar(senialDatos, consumidoresDormidos, consumidoresAvisados, 1);
+	return true;
+}
+
+bool ColaPaquete::insertar(Paquete *paquete) {
+	while (true) {
+		for (int giro = 0; giro < GIROS_ANTES_DE_DORMIR; ++giro) {
+			if (intentarInsertar(paquete)) {
+				return true;
+			}
+			if (estaCerrada()) {
+				return false;
+			}
+			pausaCPU();
+		}
+		dormir(senialEspacio, productoresDormidos, productoresAvisados,
+				false);
+	}
+}
+
+size_t ColaPaquete::intentarInsertarLote(Paquete **origen, size_t cantidad) {
+	if (cantidad == 0 || __atomic_load_n(&cerrada, __ATOMIC_RELAXED)) {
+		return 0;
+	}
+	if (cantidad > mascara + 1) {
+		cantidad = mascara + 1;
+	}
+	size_t pos = __atomic_load_n(&posInsercion, __ATOMIC_RELAXED);
+	size_t libres;
+	while (true) {
+		/* Cuento cuantas celdas consecutivas estan libres para esta vuelta */
+		libres = 0;
+		intptr_t diferencia = 0;
+		while (libres < cantidad) {
+			size_t secuencia = __atomic_load_n(
+					&celdas[(pos + libres) & mascara].secuencia,
+					__ATOMIC_ACQUIRE);
+			diferencia = (intptr_t) secuencia - (intptr_t) (pos + libres);
+			if (diferencia != 0) {
+				break;
+			}
+			++libres;
+		}
+		if (libres == 0) {
+			if (diferencia < 0) {
+				return 0;
+			}
+			/* Otro productor ya tomo la celda */
+			pos = __atomic_load_n(&posInsercion, __ATOMIC_RELAXED);
+			continue;
+		}
+		if (__atomic_compare_exchange_n(&posInsercion, &pos, pos + libres,
+				true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+			break;
+		}
+	}
+	for (size_t i = 0; i < libres; ++i) {
+		Celda *celda = &celdas[(pos + i) & mascara];
+		celda->paquete = origen[i];
+		__atomic_store_n(&celda->secuencia, pos + i + 1, __ATOMIC_RELEASE);
+	}
+	despertar(senialDatos, consumidoresDormidos, consumidoresAvisados,
+			(int) libres);
+	return libres;
+}
+
+size_t ColaPaquete::insertarLote(Paquete **origen, size_t cantidad) {
+	size_t insertados = 0;
+	while (insertados < cantidad) {
+		size_t parcial = 0;
+		for (int giro = 0; giro < GIROS_ANTES_DE_DORMIR; ++giro) {
+			parcial = intentarInsertarLote(origen + insertados,
+					cantidad - insertados);
+			if (parcial > 0 || estaCerrada()) {
+				break;
+			}
+			pausaCPU();
+		}
+		if (parcial > 0) {
+			insertados += parcial;
+		}
+		else if (estaCerrada()) {
+			break;
+		}
+		else {
+			dormir(senialEspacio, productoresDormidos, productoresAvisados,
+				false);
+		}
+	}
+	return insertados;
+}
+
+bool ColaPaquete::intentarExtraer(Paquete *&paquete) {
+	return (intentarExtraerLote(&paquete, 1) == 1);
+}
+
+Paquete* ColaPaquete::extraer() {
+	Paquete *paquete = NULL;
+	extraerLote(&paquete, 1);
+	return paquete;
+}
+
+size_t ColaPaquete::intentarExtraerLote(Paquete **destino, size_t maximo) {
+	if (maximo == 0) {
+		return 0;
+	}
+	if (maximo > mascara + 1) {
+		maximo = mascara + 1;
+	}
+	size_t pos = __atomic_load_n(&posExtraccion, __ATOMIC_RELAXED);
+	size_t cantidad;
+	while (true) {
+		/* Cuento cuantas celdas consecutivas ya tienen su paquete publicado */
+		cantidad = 0;
+		intptr_t diferencia = 0;
+		while (cantidad < maximo) {
+			size_t secuencia = __atomic_load_n(
+					&celdas[(pos + cantidad) & mascara].secuencia,
+					__ATOMIC_ACQUIRE);
+			diferencia = (intptr_t) secuencia - (intptr_t) (pos + cantidad + 1);
+			if (diferencia != 0) {
+				break;
+			}
+			++cantidad;
+		}
+		if (cantidad == 0) {
+			if (diferencia < 0) {
+				return 0;
+			}
+			/* Otro consumidor ya tomo la celda */
+			pos = __atomic_load_n(&posExtraccion, __ATOMIC_RELAXED);
+			continue;
+		}
+		if (__atomic_compare_exchange_n(&posExtraccion, &pos, pos + cantidad,
+				true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+			break;
+		}
+	}
+	for (size_t i = 0; i < cantidad; ++i) {
+		Celda *celda = &celdas[(pos + i) & mascara];
+		destino[i] = celda->paquete;
+		__atomic_store_n(&celda->secuencia, pos + i + mascara + 1,
+				__ATOMIC_RELEASE);
+	}
+	despertar(senialEspacio, productoresDormidos, productoresAvisados,
+			(int) cantidad);
+	return cantidad;
+}
+
+size_t ColaPaquete::extraerLote(Paquete **destino, size_t maximo) {
+	while (true) {
+		for (int giro = 0; giro < GIROS_ANTES_DE_DORMIR; ++giro) {
+			size_t cantidad = intentarExtraerLote(destino, maximo);
+			if (cantidad > 0) {
+				return cantidad;
+			}
+			if (estaCerrada() && !hayDatos()) {
+				return 0;
+			}
+			pausaCPU();
+		}
+		dormir(senialDatos, consumidoresDormidos, consumidoresAvisados,
+				true);
+	}
+}
+
+void ColaPaquete::cerrar() {
+	__atomic_store_n(&cerrada, true, __ATOMIC_SEQ_CST);
+	__atomic_add_fetch(&senialDatos, 1, __ATOMIC_SEQ_CST);
+	futexDespertar(&senialDatos, INT_MAX);
+	__atomic_add_fetch(&senialEspacio, 1, __ATOMIC_SEQ_CST);
+	futexDespertar(&senialEspacio, INT_MAX);
+}
+
+bool ColaPaquete::estaCerrada() const {
+	return __atomic_load_n(&cerrada, __ATOMIC_ACQUIRE);
+}
+
+size_t ColaPaquete::getTamanio() const {
+	size_t extraccion = __atomic_load_n(&posExtraccion, __ATOMIC_ACQUIRE);
+	size_t insercion = __atomic_load_n(&posInsercion, __ATOMIC_ACQUIRE);
+	return (insercion > extraccion) ? insercion - extraccion : 0;
+}
+
+size_t ColaPaquete::getCapacidad() const {
+	return mascara + 1;
 }
 
 ColaPaquete::~ColaPaquete() {
+	delete[] celdas;
+}
+
+bool ColaPaquete::hayDatos() const {
+	size_t pos = __atomic_load_n(&posExtraccion, __ATOMIC_RELAXED);
+	size_t secuencia = __atomic_load_n(&celdas[pos & mascara].secuencia,
+			__ATOMIC_ACQUIRE);
+	return (secuencia == pos + 1);
+}
+
+bool ColaPaquete::hayEspacio() const {
+	size_t pos = __atomic_load_n(&posInsercion, __ATOMIC_RELAXED);
+	size_t secuencia = __atomic_load_n(&celdas[pos & mascara].secuencia,
+			__ATOMIC_ACQUIRE);
+	return (secuencia == pos);
+}
+
+void ColaPaquete::despertar(int &senial, int &dormidos, bool &avisados,
+		int cantidad) {
+	/* Junto con el incremento de dormidos en dormir(), garantiza que o bien
+	 * el hilo que se va a dormir ve el cambio, o bien aca se lo ve dormido */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&dormidos, __ATOMIC_RELAXED) == 0) {
+		return;
+	}
+	/* Un hilo despertado sigue contado como dormido hasta que vuelve a
+	 * ejecutarse. Mientras tanto no se repite el llamado al sistema: ese
+	 * hilo, ya despierto, vera tambien lo que se publique ahora */
+	if (!__atomic_exchange_n(&avisados, true, __ATOMIC_ACQ_REL)) {
+		__atomic_add_fetch(&senial, 1, __ATOMIC_RELEASE);
+		futexDespertar(&senial, cantidad);
+	}
+}
+
+void ColaPaquete::dormir(int &senial, int &dormidos, bool &avisados,
+		bool esperandoDatos) {
+	__atomic_add_fetch(&dormidos, 1, __ATOMIC_SEQ_CST);
+	/* Un aviso que no llego a despertar a nadie no debe impedir que se
+	 * despierte a este hilo */
+	__atomic_store_n(&avisados, false, __ATOMIC_SEQ_CST);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	int valor = __atomic_load_n(&senial, __ATOMIC_ACQUIRE);
+	bool listo = estaCerrada() || (esperandoDatos ? hayDatos() : hayEspacio());
+	if (!listo) {
+		futexEsperar(&senial, valor);
+	}
+	/* Despierto: los proximos cambios pueden despertar a otro hilo */
+	__atomic_store_n(&avisados, false, __ATOMIC_RELEASE);
+	__atomic_sub_fetch(&dormidos, 1, __ATOMIC_SEQ_CST);
 }
 
 }
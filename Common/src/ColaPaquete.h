@@ -6,12 +6,171 @@
 #ifndef COLAPAQUETE_H_
 #define COLAPAQUETE_H_
 
+#include <cstddef>
+
 namespace FWK_CS {
 
+class Paquete;
+
+/**
+ * @brief Cola acotada de paquetes, sin locks, para múltiples productores y
+ * múltiples consumidores
+ * @details Es un anillo de celdas donde cada celda tiene un número de
+ * secuencia que indica si está libre o tiene un paquete para la vuelta
+ * actual, por lo que productores y consumidores solo compiten mediante un
+ * CAS sobre su propio índice. Los índices están en líneas de caché distintas
+ * @details Las operaciones bloqueantes esperan activamente un tiempo acotado
+ * y luego se duermen sobre un futex. Si nadie está dormido, no se realizan
+ * llamadas al sistema
+ * @details La cola no es dueña de los paquetes
+ */
+
 class ColaPaquete {
 public:
-	ColaPaquete();
+
+	/**
+	 * @brief Construye una cola vacía
+	 * @param capacidad Cantidad máxima de paquetes. Se redondea a la potencia
+	 * de 2 siguiente
+	 */
+	explicit ColaPaquete(size_t capacidad = 1024);
+
+	/**
+	 * @brief Método para insertar un paquete sin esperar
+	 * @param paquete Paquete a insertar
+	 * @return <tt>true</tt> si se insertó
+	 * @return <tt>false</tt> si la cola está llena o cerrada
+	 */
+	bool intentarInsertar(Paquete *paquete);
+
+	/**
+	 * @brief Método para insertar un paquete, esperando si la cola está llena
+	 * @param paquete Paquete a insertar
+	 * @return <tt>true</tt> si se insertó
+	 * @return <tt>false</tt> si la cola está cerrada
+	 */
+	bool insertar(Paquete *paquete);
+
+	/**
+	 * @brief Método para insertar varios paquetes consecutivos sin esperar,
+	 * reservando las celdas con una sola operación atómica y despertando a
+	 * los consumidores una sola vez
+	 * @param origen Arreglo con los paquetes a insertar, en orden
+	 * @param cantidad Cantidad de paquetes del arreglo
+	 * @return La cantidad de paquetes insertados (los primeros del arreglo),
+	 * 0 si la cola está llena o cerrada
+	 */
+	size_t intentarInsertarLote(Paquete **origen, size_t cantidad);
+
+	/**
+	 * @brief Igual a ColaPaquete::intentarInsertarLote, pero espera hasta
+	 * insertar todos los paquetes
+	 * @param origen Arreglo con los paquetes a insertar, en orden
+	 * @param cantidad Cantidad de paquetes del arreglo
+	 * @return La cantidad de paquetes insertados. Es menor a @a cantidad solo
+	 * si la cola se cerró
+	 */
+	size_t insertarLote(Paquete **origen, size_t cantidad);
+
+	/**
+	 * @brief Método para extraer un paquete sin esperar
+	 * @param paquete Donde se guarda el paquete extraído
+	 * @return <tt>true</tt> si se extrajo un paquete
+	 * @return <tt>false</tt> si la cola está vacía
+	 */
+	bool intentarExtraer(Paquete *&paquete);
+
+	/**
+	 * @brief Método para extraer un paquete, esperando si la cola está vacía
+	 * @return El paquete extraído, o <tt>NULL</tt> si la cola está vacía y
+	 * cerrada
+	 */
+	Paquete* extraer();
+
+	/**
+	 * @brief Método para extraer varios paquetes consecutivos sin esperar,
+	 * reservándolos con una sola operación atómica
+	 * @param destino Arreglo donde se guardan los paquetes extraídos
+	 * @param maximo Cantidad máxima de paquetes a extraer
+	 * @return La cantidad de paquetes extraídos, 0 si la cola está vacía
+	 */
+	size_t intentarExtraerLote(Paquete **destino, size_t maximo);
+
+	/**
+	 * @brief Igual a ColaPaquete::intentarExtraerLote, pero espera a que
+	 * haya al menos un paquete
+	 * @param destino Arreglo donde se guardan los paquetes extraídos
+	 * @param maximo Cantidad máxima de paquetes a extraer
+	 * @return La cantidad de paquetes extraídos, 0 si la cola está vacía y
+	 * cerrada
+	 */
+	size_t extraerLote(Paquete **destino, size_t maximo);
+
+	/**
+	 * @brief Método que cierra la cola: no se admiten nuevas inserciones y se
+	 * despierta a todos los hilos en espera. Los paquetes ya insertados
+	 * pueden seguir extrayéndose
+	 */
+	void cerrar();
+
+	/**
+	 * @brief Método para consultar si la cola fue cerrada
+	 * @return <tt>true</tt> si fue cerrada
+	 */
+	bool estaCerrada() const;
+
+	/**
+	 * @brief Método para obtener la cantidad de paquetes en la cola. Es
+	 * aproximada si otros hilos la están modificando
+	 * @return La cantidad de paquetes
+	 */
+	size_t getTamanio() const;
+
+	/**
+	 * @brief Método para obtener la capacidad de la cola
+	 * @return La capacidad
+	 */
+	size_t getCapacidad() const;
+
+	/**
+	 * @brief Destructor
+	 */
 	virtual ~ColaPaquete();
+
+private:
+
+	struct Celda {
+		size_t secuencia;
+		Paquete *paquete;
+	};
+
+	Celda *celdas;
+	size_t mascara;
+
+	char relleno0[64];
+	size_t posInsercion;
+	char relleno1[64 - sizeof(size_t)];
+	size_t posExtraccion;
+	char relleno2[64 - sizeof(size_t)];
+
+	/* Palabras de futex, cantidad de hilos dormidos sobre cada una y si ya
+	 * se desperto a alguno que todavia no volvio a ejecutarse */
+	int senialDatos;
+	int consumidoresDormidos;
+	bool consumidoresAvisados;
+	int senialEspacio;
+	int productoresDormidos;
+	bool productoresAvisados;
+	bool cerrada;
+
+	bool hayDatos() const;
+	bool hayEspacio() const;
+	void despertar(int &senial, int &dormidos, bool &avisados, int cantidad);
+	void dormir(int &senial, int &dormidos, bool &avisados,
+			bool esperandoDatos);
+
+	ColaPaquete(const ColaPaquete&);
+	ColaPaquete& operator=(const ColaPaquete&);
 };
 
 }
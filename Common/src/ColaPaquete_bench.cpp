@@ -0,0 +1,159 @@
+/******************************
+ *  Archivo: ColaPaquete_bench.cpp
+ *	Autor:   Martín Lucero
+ *****************************/
+#include "ColaPaquete.h"
+#include "Condicion.h"
+#include "Mutex.h"
+#include "Barrera.h"
+#include "Bench.h"
+#include <cstdio>
+#include <deque>
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+#include <vector>
+
+/* Paquetes por segundo a través de la ColaPaquete, con distintas cantidades
+ * de productores y consumidores, frente a un std::deque acotado protegido
+ * por un PThread::Mutex */
+
+#define PAQUETES 1000000
+#define CAPACIDAD 1024
+
+namespace FWK_CS {
+
+/* Cola acotada de referencia, con un mutex y dos variables de condición */
+class ColaMutex {
+public:
+	explicit ColaMutex(size_t capacidad) :
+			capacidad(capacidad), cerrada(false) {
+	}
+	bool insertar(Paquete *paquete) {
+		mutex.bloquear();
+		while (paquetes.size() == capacidad && !cerrada) {
+			hayEspacio.esperar(mutex);
+		}
+		bool insertado = !cerrada;
+		if (insertado) {
+			paquetes.push_back(paquete);
+			hayDatos.notificarUno();
+		}
+		mutex.desbloquear();
+		return insertado;
+	}
+	Paquete* extraer() {
+		mutex.bloquear();
+		while (paquetes.empty() && !cerrada) {
+			hayDatos.esperar(mutex);
+		}
+		Paquete *paquete = NULL;
+		if (!paquetes.empty()) {
+			paquete = paquetes.front();
+			paquetes.pop_front();
+			hayEspacio.notificarUno();
+		}
+		mutex.desbloquear();
+		return paquete;
+	}
+	void cerrar() {
+		mutex.bloquear();
+		cerrada = true;
+		hayDatos.notificarTodos();
+		hayEspacio.notificarTodos();
+		mutex.desbloquear();
+	}
+private:
+	PThread::Mutex mutex;
+	PThread::Condicion hayDatos;
+	PThread::Condicion hayEspacio;
+	std::deque<Paquete*> paquetes;
+	size_t capacidad;
+	bool cerrada;
+};
+
+/* Los paquetes son punteros que nunca se desreferencian: se cuentan y se
+ * suman para verificar que llegaron todos */
+template<typename C>
+struct Traspaso {
+	C cola;
+	PThread::Barrera largada;
+	int porProductor;
+	uintptr_t suma;
+	Traspaso(int productores, int consumidores) :
+			cola(CAPACIDAD), largada(productores + consumidores + 1),
+			porProductor(PAQUETES / productores), suma(0) {
+	}
+	static void* producir(void *parametro) {
+		Traspaso *traspaso = static_cast<Traspaso*>(parametro);
+		traspaso->largada.esperar();
+		for (int i = 1; i <= traspaso->porProductor; ++i) {
+			traspaso->cola.insertar(reinterpret_cast<Paquete*>((uintptr_t) i));
+		}
+		return NULL;
+	}
+	static void* consumir(void *parametro) {
+		Traspaso *traspaso = static_cast<Traspaso*>(parametro);
+		traspaso->largada.esperar();
+		uintptr_t suma = 0;
+		Paquete *paquete;
+		while ((paquete = traspaso->cola.extraer()) != NULL) {
+			suma += reinterpret_cast<uintptr_t>(paquete);
+		}
+		__atomic_add_fetch(&traspaso->suma, suma, __ATOMIC_RELAXED);
+		return NULL;
+	}
+};
+
+template<typename C>
+static void medir(const char *prueba, int productores, int consumidores) {
+	Traspaso<C> *traspaso = new Traspaso<C>(productores, consumidores);
+	std::vector<pthread_t> hilos(productores + consumidores);
+	for (int i = 0; i < productores; ++i) {
+		pthread_create(&hilos[i], NULL, Traspaso<C>::producir, traspaso);
+	}
+	for (int i = productores; i < productores + consumidores; ++i) {
+		pthread_create(&hilos[i], NULL, Traspaso<C>::consumir, traspaso);
+	}
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	traspaso->largada.esperar();
+	for (int i = 0; i < productores; ++i) {
+		pthread_join(hilos[i], NULL);
+	}
+	traspaso->cola.cerrar();
+	for (int i = productores; i < productores + consumidores; ++i) {
+		pthread_join(hilos[i], NULL);
+	}
+	double segundos = PThread::segundosDesde(inicio);
+	uintptr_t n = (uintptr_t) traspaso->porProductor;
+	uintptr_t esperada = n * (n + 1) / 2 * productores;
+	double paquetes = (double) n * productores;
+	printf("%-12s %2d prod %2d cons  %10.0f paq/s  %7.1f ns/paq%s\n", prueba,
+			productores, consumidores, paquetes / segundos,
+			segundos * 1e9 / paquetes,
+			(traspaso->suma != esperada) ? "  ERROR" : "");
+	delete traspaso;
+}
+
+void benchColaPaquete() {
+	int configuraciones[][2] = { { 1, 1 }, { 1, 4 }, { 4, 1 }, { 2, 2 },
+			{ 4, 4 }, { 8, 8 } };
+	for (size_t i = 0; i < sizeof(configuraciones) / sizeof(configuraciones[0]);
+			++i) {
+		medir<ColaPaquete>("ColaPaquete", configuraciones[i][0],
+				configuraciones[i][1]);
+		medir<ColaMutex>("deque+mutex", configuraciones[i][0],
+				configuraciones[i][1]);
+	}
+}
+
+}
+
+#ifdef COLAPAQUETE_BENCH
+int main() {
+	printf("%d paquetes, capacidad %d\n", PAQUETES, CAPACIDAD);
+	FWK_CS::benchColaPaquete();
+	return 0;
+}
+#endif
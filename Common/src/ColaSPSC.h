@@ -0,0 +1,318 @@
+/******************************
+ *  Archivo: ColaSPSC.h
+ *	Autor:   Martín Lucero
+ *****************************/
+
+#ifndef COLASPSC_H_
+#define COLASPSC_H_
+
+#include <cstddef>
+#include <poll.h>
+#include <sched.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+#include "Futex.h"
+
+/* Iteraciones de espera activa antes de dormir o ceder el procesador */
+#define COLA_SPSC_GIROS 256
+
+namespace FWK_CS {
+
+/**
+ * @brief Cola acotada sin esperas para exactamente un productor y un
+ * consumidor, pensada para pasar datos entre un ReceptorPaquete y el hilo
+ * que los maneja
+ * @details Cada lado guarda una copia del índice del otro lado y solo la
+ * actualiza cuando la copia indica que la cola está llena (productor) o
+ * vacía (consumidor), por lo que en régimen normal cada hilo solo escribe su
+ * propia línea de caché
+ * @details Opcionalmente, el consumidor puede dormirse sobre un eventfd
+ * cuando la cola está vacía. El productor solo escribe en el eventfd si el
+ * consumidor está dormido. Para esperar el descriptor desde un epoll,
+ * el consumidor debe armar la espera con prepararEspera() antes de cada
+ * epoll_wait y cerrarla con terminarEspera() al despertar
+ * @warning Solo un hilo puede insertar y solo un hilo puede extraer
+ */
+
+template<typename T>
+class ColaSPSC {
+public:
+
+	/**
+	 * @brief Construye una cola vacía
+	 * @param capacidad Cantidad máxima de elementos. Se redondea a la
+	 * potencia de 2 siguiente
+	 * @param conEspera Si el consumidor se duerme sobre un eventfd al esperar
+	 * datos. Si no se puede crear el eventfd, se espera activamente
+	 */
+	explicit ColaSPSC(size_t capacidad = 1024, bool conEspera = false) {
+		size_t tamanio = 1;
+		while (tamanio < capacidad) {
+			tamanio <<= 1;
+		}
+		elementos = new T[tamanio];
+		mascara = tamanio - 1;
+		lectura = 0;
+		escrituraCache = 0;
+		escritura = 0;
+		lecturaCache = 0;
+		dormido = 0;
+		descriptor = conEspera ? eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC) : -1;
+	}
+
+	/**
+	 * @brief Método para insertar un elemento sin esperar
+	 * @warning Solo puede invocarlo el hilo productor
+	 * @param valor Elemento a insertar
+	 * @return <tt>true</tt> si se insertó
+	 * @return <tt>false</tt> si la cola está llena
+	 */
+	bool intentarInsertar(const T &valor) {
+		size_t pos = escritura;
+		if (pos - lecturaCache > mascara) {
+			lecturaCache = __atomic_load_n(&lectura, __ATOMIC_ACQUIRE);
+			if (pos - lecturaCache > mascara) {
+				return false;
+			}
+		}
+		elementos[pos & mascara] = valor;
+		__atomic_store_n(&escritura, pos + 1, __ATOMIC_RELEASE);
+		if (descriptor != -1) {
+			notificar();
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Método para insertar un elemento, esperando activamente si la
+	 * cola está llena
+	 * @warning Solo puede invocarlo el hilo productor
+	 * @param valor Elemento a insertar
+	 */
+	void insertar(const T &valor) {
+		for (unsigned int giro = 0; !intentarInsertar(valor); ++giro) {
+			esperarActivamente(giro);
+		}
+	}
+
+	/**
+	 * @brief Método para extraer un elemento sin esperar
+	 * @warning Solo puede invocarlo el hilo consumidor
+	 * @param valor Donde se guarda el elemento extraído
+	 * @return <tt>true</tt> si se extrajo
+	 * @return <tt>false</tt> si la cola está vacía
+	 */
+	bool intentarExtraer(T &valor) {
+		size_t pos = lectura;
+		if (pos == escrituraCache) {
+			escrituraCache = __atomic_load_n(&escritura, __ATOMIC_ACQUIRE);
+			if (pos == escrituraCache) {
+				return false;
+			}
+		}
+		valor = elementos[pos & mascara];
+		__atomic_store_n(&lectura, pos + 1, __ATOMIC_RELEASE);
+		return true;
+	}
+
+	/**
+	 * @brief Método para extraer un elemento, esperando si la cola está vacía
+	 * @warning Solo puede invocarlo el hilo consumidor
+	 * @param valor Donde se guarda el elemento extraído
+	 * @param milisegundos Tiempo máximo de espera, -1 para esperar sin límite
+	 * @return <tt>true</tt> si se extrajo
+	 * @return <tt>false</tt> si se alcanzó el tiempo límite
+	 */
+	bool extraer(T &valor, int milisegundos = -1) {
+		for (unsigned int giro = 0; giro < COLA_SPSC_GIROS; ++giro) {
+			if (intentarExtraer(valor)) {
+				return true;
+			}
+			PThread::pausaCPU();
+		}
+		/* El límite es absoluto para que los despertares no reinicien la
+		 * espera */
+		struct timespec limite;
+		if (milisegundos >= 0) {
+			clock_gettime(CLOCK_MONOTONIC, &limite);
+			limite.tv_sec += milisegundos / 1000;
+			limite.tv_nsec += (long) (milisegundos % 1000) * 1000000;
+			if (limite.tv_nsec >= 1000000000) {
+				++limite.tv_sec;
+				limite.tv_nsec -= 1000000000;
+			}
+		}
+		while (!intentarExtraer(valor)) {
+			int espera = -1;
+			if (milisegundos >= 0) {
+				espera = milisegundosRestantes(limite);
+				if (espera == 0) {
+					return intentarExtraer(valor);
+				}
+			}
+			if (descriptor == -1) {
+				sched_yield();
+			}
+			else {
+				dormir(espera);
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Método para armar la espera del consumidor sobre el descriptor
+	 * desde un epoll propio. A partir de aquí, el productor escribe en el
+	 * eventfd al insertar
+	 * @warning Solo puede invocarlo el hilo consumidor, y luego de que
+	 * devuelva <tt>true</tt> debe invocar terminarEspera() al despertar
+	 * @return <tt>true</tt> si la espera quedó armada y la cola está vacía
+	 * @return <tt>false</tt> si ya hay elementos, o si la cola no espera con
+	 * eventfd. En ese caso no hay que esperar
+	 */
+	bool prepararEspera() {
+		if (descriptor == -1) {
+			return false;
+		}
+		__atomic_store_n(&dormido, 1, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&escritura, __ATOMIC_ACQUIRE) != lectura) {
+			terminarEspera();
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Método para cerrar una espera armada con prepararEspera(),
+	 * vaciando el eventfd si el productor llegó a notificar
+	 * @warning Solo puede invocarlo el hilo consumidor
+	 * @return <tt>true</tt> si el productor notificó durante la espera
+	 */
+	bool terminarEspera() {
+		if (__atomic_exchange_n(&dormido, 0, __ATOMIC_ACQ_REL) != 0) {
+			return false;
+		}
+		/* El productor consumio la marca: escribio o va a escribir en el
+		 * eventfd, y hay que vaciarlo para que no despierte la proxima
+		 * espera */
+		struct pollfd evento;
+		evento.fd = descriptor;
+		evento.events = POLLIN;
+		uint64_t valor;
+		while (read(descriptor, &valor, sizeof(valor)) < 0) {
+			poll(&evento, 1, -1);
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Método para consultar si la cola está vacía. Es exacto solo
+	 * desde el hilo consumidor
+	 * @return <tt>true</tt> si está vacía
+	 */
+	bool estaVacia() const {
+		return (__atomic_load_n(&lectura, __ATOMIC_ACQUIRE)
+				== __atomic_load_n(&escritura, __ATOMIC_ACQUIRE));
+	}
+
+	/**
+	 * @brief Método para obtener la capacidad de la cola
+	 * @return La capacidad
+	 */
+	size_t getCapacidad() const {
+		return mascara + 1;
+	}
+
+	/**
+	 * @brief Método para obtener el eventfd sobre el que se duerme el
+	 * consumidor, para agregarlo a un epoll
+	 * @see prepararEspera()
+	 * @return El descriptor, o -1 si la cola no espera con eventfd
+	 */
+	int getDescriptor() const {
+		return descriptor;
+	}
+
+	/**
+	 * @brief Destructor
+	 */
+	~ColaSPSC() {
+		if (descriptor != -1) {
+			close(descriptor);
+		}
+		delete[] elementos;
+	}
+
+private:
+
+	T *elementos;
+	size_t mascara;
+
+	/* Linea del consumidor */
+	char relleno0[64];
+	size_t lectura;
+	size_t escrituraCache;
+	char relleno1[64 - 2 * sizeof(size_t)];
+
+	/* Linea del productor */
+	size_t escritura;
+	size_t lecturaCache;
+	char relleno2[64 - 2 * sizeof(size_t)];
+
+	/* 1 si el consumidor esta por dormirse o dormido */
+	int dormido;
+	int descriptor;
+
+	void notificar() {
+		/* Junto con la marca en prepararEspera(), garantiza que o bien el consumidor
+		 * ve el elemento nuevo, o bien aca se lo ve dormido */
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&dormido, __ATOMIC_RELAXED) != 0
+				&& __atomic_exchange_n(&dormido, 0, __ATOMIC_ACQ_REL) != 0) {
+			uint64_t uno = 1;
+			ssize_t escrito = write(descriptor, &uno, sizeof(uno));
+			(void) escrito;
+		}
+	}
+
+	void dormir(int milisegundos) {
+		if (!prepararEspera()) {
+			return;
+		}
+		struct pollfd evento;
+		evento.fd = descriptor;
+		evento.events = POLLIN;
+		poll(&evento, 1, milisegundos);
+		terminarEspera();
+	}
+
+	static int milisegundosRestantes(const struct timespec &limite) {
+		struct timespec actual;
+		clock_gettime(CLOCK_MONOTONIC, &actual);
+		long long restante = (long long) (limite.tv_sec - actual.tv_sec)
+				* 1000000000LL + (limite.tv_nsec - actual.tv_nsec);
+		if (restante <= 0) {
+			return 0;
+		}
+		/* Redondeo hacia arriba para no despertar antes del limite */
+		return (int) ((restante + 999999) / 1000000);
+	}
+
+	static void esperarActivamente(unsigned int giro) {
+		if (giro < COLA_SPSC_GIROS) {
+			PThread::pausaCPU();
+		}
+		else {
+			sched_yield();
+		}
+	}
+
+	ColaSPSC(const ColaSPSC&);
+	ColaSPSC& operator=(const ColaSPSC&);
+};
+
+}
+#endif
@@ -0,0 +1,146 @@
+/******************************
+ *  Archivo: ColaSPSC_bench.cpp
+ *	Autor:   Martín Lucero
+ *****************************/
+#include "ColaSPSC.h"
+#include "Thread.h"
+#include "Bench.h"
+#include <algorithm>
+#include <cstdio>
+#include <sched.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <vector>
+
+/* Mensajes por segundo y latencia de traspaso (mediana y percentil 99) de la
+ * ColaSPSC entre dos hilos fijados a procesadores con
+ * Thread::Atributos::setAfinidadCPU, esperando activamente o con eventfd */
+
+#define MENSAJES 5000000
+#define TRASPASOS 100000
+#define CAPACIDAD 1024
+/* Iteraciones de espera activa del productor antes de ceder el procesador,
+ * mientras espera que se consuma el mensaje anterior */
+#define GIROS_ANTES_DE_CEDER 256
+
+namespace FWK_CS {
+
+typedef ColaSPSC<uint64_t> t_cola;
+
+/* Con latencias, inserta un mensaje a la vez con el instante de envío y
+ * espera que se consuma antes del siguiente, para medir el traspaso y no el
+ * tiempo en cola */
+class Productor: public POSIX::Thread {
+public:
+	Productor(const Atributos &atributos, t_cola &cola, bool latencias) :
+			Thread(atributos), cola(cola), latencias(latencias) {
+	}
+protected:
+	void* ejecutar(void*) {
+		if (!latencias) {
+			for (uint64_t i = 1; i <= MENSAJES; ++i) {
+				cola.insertar(i);
+			}
+			return NULL;
+		}
+		for (int i = 0; i < TRASPASOS; ++i) {
+			cola.insertar((uint64_t) PThread::nanosegundosAhora());
+			for (int giro = 0; !cola.estaVacia(); ++giro) {
+				if (giro < GIROS_ANTES_DE_CEDER) {
+					PThread::pausaCPU();
+				}
+				else {
+					sched_yield();
+				}
+			}
+		}
+		return NULL;
+	}
+private:
+	t_cola &cola;
+	bool latencias;
+};
+
+class Consumidor: public POSIX::Thread {
+public:
+	Consumidor(const Atributos &atributos, t_cola &cola, bool latencias) :
+			Thread(atributos), suma(0), cola(cola), latencias(latencias) {
+	}
+	uint64_t suma;
+	std::vector<long long> traspasos;
+protected:
+	void* ejecutar(void*) {
+		uint64_t valor;
+		if (!latencias) {
+			for (int i = 0; i < MENSAJES; ++i) {
+				cola.extraer(valor);
+				suma += valor;
+			}
+			return NULL;
+		}
+		traspasos.reserve(TRASPASOS);
+		for (int i = 0; i < TRASPASOS; ++i) {
+			cola.extraer(valor);
+			traspasos.push_back(
+					PThread::nanosegundosAhora() - (long long) valor);
+		}
+		return NULL;
+	}
+private:
+	t_cola &cola;
+	bool latencias;
+};
+
+static void medir(const char *prueba, bool conEspera,
+		const POSIX::Thread::Atributos &productor,
+		const POSIX::Thread::Atributos &consumidor) {
+	void *retorno;
+	t_cola colaRendimiento(CAPACIDAD, conEspera);
+	Productor emisor(productor, colaRendimiento, false);
+	Consumidor receptor(consumidor, colaRendimiento, false);
+	long long inicio = PThread::nanosegundosAhora();
+	receptor.iniciar();
+	emisor.iniciar();
+	POSIX::Thread::esperarThread(emisor, retorno);
+	POSIX::Thread::esperarThread(receptor, retorno);
+	double segundos = (PThread::nanosegundosAhora() - inicio) / 1e9;
+	uint64_t esperada = (uint64_t) MENSAJES * (MENSAJES + 1) / 2;
+
+	t_cola colaLatencia(CAPACIDAD, conEspera);
+	Productor pinger(productor, colaLatencia, true);
+	Consumidor medidor(consumidor, colaLatencia, true);
+	medidor.iniciar();
+	pinger.iniciar();
+	POSIX::Thread::esperarThread(pinger, retorno);
+	POSIX::Thread::esperarThread(medidor, retorno);
+	std::vector<long long> &traspasos = medidor.traspasos;
+	std::sort(traspasos.begin(), traspasos.end());
+
+	printf("%-28s %10.0f msgs/s  p50 %7.2f us  p99 %7.2f us%s\n", prueba,
+			MENSAJES / segundos, PThread::percentil(traspasos, 50) / 1e3,
+			PThread::percentil(traspasos, 99) / 1e3,
+			(receptor.suma != esperada) ? "  ERROR" : "");
+}
+
+void benchColaSPSC() {
+	/* Con un solo procesador, ambos quedan fijados al 0 */
+	int otro = std::min(1, (int) sysconf(_SC_NPROCESSORS_ONLN) - 1);
+	POSIX::Thread::Atributos productor;
+	POSIX::Thread::Atributos consumidor;
+	productor.setAfinidadCPU(0);
+	consumidor.setAfinidadCPU(otro);
+	printf("productor en el procesador 0, consumidor en el %d\n", otro);
+	medir("espera activa", false, productor, consumidor);
+	medir("eventfd", true, productor, consumidor);
+}
+
+}
+
+#ifdef COLASPSC_BENCH
+int main() {
+	printf("%d mensajes, %d traspasos, capacidad %d\n", MENSAJES, TRASPASOS,
+			CAPACIDAD);
+	FWK_CS::benchColaSPSC();
+	return 0;
+}
+#endif
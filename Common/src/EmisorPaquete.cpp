@@ -3,13 +3,221 @@
  *	Autor:   Martín Lucero
  *****************************/
 #include "EmisorPaquete.h"
+#include "ExcepcionesSocket.h"
+#include "Futex.h"
+#include "Paquete.h"
+#include "VistaBuffer.h"
+#include <sched.h>
+#include <time.h>
+
+#define NANOS_POR_SEGUNDO 1000000000ULL
+#define NANOS_POR_MICRO 1000ULL
+#define NOMBRE_HILO "emisor"
+/* Iteraciones de espera activa antes de ceder el procesador mientras otro
+ * hilo envia un paquete directo */
+#define GIROS_ANTES_DE_CEDER 128
+/* Bit de EmisorPaquete::pendientes que indica un envio directo en curso. Cada
+ * paquete encolado y sin enviar suma ENCOLADO */
+#define ENVIO_DIRECTO 1
+#define ENCOLADO 2
+/* Tiempo sin envios a partir del cual no se considera que haya carga. Es
+ * menor que un llamado a sendmsg, asi que un productor que encola sin pausa
+ * nunca lo alcanza y sus paquetes se agrupan */
+#define NANOS_REPOSO 1000ULL
 
 namespace FWK_CS {
 
-EmisorPaquete::EmisorPaquete() {
+/* Instante actual del reloj monotono, en nanosegundos */
+static uint64_t nanosMonotonos() {
+	struct timespec tiempo;
+	clock_gettime(CLOCK_MONOTONIC, &tiempo);
+	return (uint64_t) tiempo.tv_sec * NANOS_POR_SEGUNDO + tiempo.tv_nsec;
+}
+
+EmisorPaquete::EmisorPaquete(Com::SocketTCP_IP &socket, size_t capacidadCola,
+		size_t maximoLote, unsigned long microsegundosLatencia) :
+		socket(socket), cola(capacidadCola), hilo(*this) {
+	this->maximoLote = (maximoLote > 0) ? maximoLote : 1;
+	nanosLatencia = (uint64_t) microsegundosLatencia * NANOS_POR_MICRO;
+	lote = new Paquete*[this->maximoLote];
+	vistas = new Com::VistaBuffer[this->maximoLote];
+	iniciado = false;
+	pendientes = 0;
+	ultimoEnvio = 0;
+	paquetesEnviados = 0;
+	lotesEnviados = 0;
+	error = false;
+}
+
+void EmisorPaquete::iniciar() {
+	hilo.setNombre(NOMBRE_HILO);
+	hilo.iniciar();
+	iniciado = true;
+}
+
+bool EmisorPaquete::enviar(Paquete *paquete) {
+	if (enviarDirecto(paquete)) {
+		return true;
+	}
+	__atomic_add_fetch(&pendientes, ENCOLADO, __ATOMIC_SEQ_CST);
+	if (!cola.insertar(paquete)) {
+		__atomic_sub_fetch(&pendientes, ENCOLADO, __ATOMIC_RELEASE);
+		return false;
+	}
+	return true;
+}
+
+bool EmisorPaquete::intentarEnviar(Paquete *paquete) {
+	if (enviarDirecto(paquete)) {
+		return true;
+	}
+	__atomic_add_fetch(&pendientes, ENCOLADO, __ATOMIC_SEQ_CST);
+	if (!cola.intentarInsertar(paquete)) {
+		__atomic_sub_fetch(&pendientes, ENCOLADO, __ATOMIC_RELEASE);
+		return false;
+	}
+	return true;
+}
+
+void EmisorPaquete::detener() {
+	cola.cerrar();
+	if (iniciado) {
+		void *retorno;
+		POSIX::Thread::esperarThread(hilo, retorno);
+		iniciado = false;
+	}
+	esperarEnvioDirecto();
+}
+
+bool EmisorPaquete::tuvoError() const {
+	return __atomic_load_n(&error, __ATOMIC_ACQUIRE);
+}
+
+size_t EmisorPaquete::getPaquetesEnviados() const {
+	return __atomic_load_n(&paquetesEnviados, __ATOMIC_RELAXED);
+}
+
+size_t EmisorPaquete::getLotesEnviados() const {
+	return __atomic_load_n(&lotesEnviados, __ATOMIC_RELAXED);
 }
 
 EmisorPaquete::~EmisorPaquete() {
+	detener();
+	/* Paquetes encolados sin iniciar el hilo */
+	Paquete *paquete;
+	while (cola.intentarExtraer(paquete)) {
+		paquete->liberar();
+	}
+	delete[] vistas;
+	delete[] lote;
+}
+
+void EmisorPaquete::ejecutar() {
+	bool conCarga = false;
+	size_t cantidad;
+	while ((cantidad = cola.extraerLote(lote, maximoLote)) > 0) {
+		if (conCarga && cantidad < maximoLote && nanosLatencia > 0) {
+			cantidad = completarLote(cantidad);
+		}
+		conCarga = (cantidad > 1);
+
+		if (!__atomic_load_n(&error, __ATOMIC_RELAXED)) {
+			for (size_t i = 0; i < cantidad; ++i) {
+				vistas[i] = lote[i]->getVista();
+			}
+			/* Un paquete directo tomado antes que estos fue encolado antes */
+			esperarEnvioDirecto();
+			transmitir(vistas, cantidad);
+		}
+		for (size_t i = 0; i < cantidad; ++i) {
+			lote[i]->liberar();
+		}
+		__atomic_sub_fetch(&pendientes, cantidad * ENCOLADO, __ATOMIC_RELEASE);
+	}
+}
+
+bool EmisorPaquete::enviarDirecto(Paquete *paquete) {
+	/* Sin paquetes encolados ni envios recientes, el hilo emisor esta
+	 * esperando: despertarlo cuesta mas que el envio. Con envios recientes hay
+	 * carga, y se encola para que el hilo agrupe los paquetes. Los paquetes
+	 * encolados durante el envio directo esperan a que termine, por lo que se
+	 * mantiene el orden */
+	if (__atomic_load_n(&pendientes, __ATOMIC_RELAXED) != 0
+			|| nanosMonotonos() - __atomic_load_n(&ultimoEnvio,
+					__ATOMIC_RELAXED) < NANOS_REPOSO) {
+		return false;
+	}
+	size_t libre = 0;
+	if (!__atomic_compare_exchange_n(&pendientes, &libre, ENVIO_DIRECTO,
+			false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+		return false;
+	}
+	if (cola.estaCerrada()) {
+		__atomic_sub_fetch(&pendientes, ENVIO_DIRECTO, __ATOMIC_RELEASE);
+		return false;
+	}
+	Com::VistaBuffer vista = paquete->getVista();
+	transmitir(&vista, 1);
+	__atomic_sub_fetch(&pendientes, ENVIO_DIRECTO, __ATOMIC_RELEASE);
+	paquete->liberar();
+	return true;
+}
+
+void EmisorPaquete::transmitir(const Com::VistaBuffer *vistas,
+		size_t cantidad) {
+	try {
+		socket.enviarVectorizado(vistas, cantidad);
+		__atomic_store_n(&ultimoEnvio, nanosMonotonos(), __ATOMIC_RELAXED);
+		__atomic_add_fetch(&paquetesEnviados, cantidad, __ATOMIC_RELAXED);
+		__atomic_add_fetch(&lotesEnviados, 1, __ATOMIC_RELAXED);
+	}
+	catch (Com::SocketExcepcion&) {
+		/* Se sigue vaciando la cola para liberar los paquetes */
+		__atomic_store_n(&error, true, __ATOMIC_RELEASE);
+		cola.cerrar();
+	}
+}
+
+void EmisorPaquete::esperarEnvioDirecto() {
+	/* Dura lo que un llamado a sendmsg, pero el hilo que envia puede haber
+	 * perdido el procesador */
+	int giros = 0;
+	while (__atomic_load_n(&pendientes, __ATOMIC_ACQUIRE) & ENVIO_DIRECTO) {
+		if (++giros < GIROS_ANTES_DE_CEDER) {
+			PThread::pausaCPU();
+		}
+		else {
+			sched_yield();
+		}
+	}
+}
+
+size_t EmisorPaquete::completarLote(size_t cantidad) {
+	/* El presupuesto es de pocos microsegundos, menos que lo que tarda en
+	 * dormirse y despertarse un hilo, por lo que se espera activamente */
+	uint64_t limite = nanosMonotonos() + nanosLatencia;
+	while (cantidad < maximoLote) {
+		size_t extraidos = cola.intentarExtraerLote(lote + cantidad,
+				maximoLote - cantidad);
+		if (extraidos > 0) {
+			cantidad += extraidos;
+			continue;
+		}
+		if (cola.estaCerrada() || nanosMonotonos() >= limite) {
+			break;
+		}
+		PThread::pausaCPU();
+	}
+	return cantidad;
+}
+
+EmisorPaquete::Hilo::Hilo(EmisorPaquete &emisor) :
+		emisor(emisor) {
+}
+
+void* EmisorPaquete::Hilo::ejecutar(void*) {
+	emisor.ejecutar();
+	return NULL;
 }
 
 }
@@ -6,12 +6,147 @@
 #ifndef EMISORPAQUETE_H_
 #define EMISORPAQUETE_H_
 
+#include <cstddef>
+#include <stdint.h>
+#include "ColaPaquete.h"
+#include "SocketTCP_IP.h"
+#include "Thread.h"
+
 namespace FWK_CS {
 
+class Paquete;
+
+/**
+ * @brief Lado de salida de una conexión: un hilo propio extrae los paquetes
+ * encolados y los envía, agrupando varios en un solo llamado a sendmsg
+ * (ver Com::SocketTCP_IP::enviarVectorizado)
+ * @details Cada lote toma los paquetes que ya están en la cola. Si el lote
+ * anterior tuvo más de un paquete (hay carga), se espera además hasta el
+ * presupuesto de latencia a que lleguen más, y se envía al llenarse el lote
+ * o al agotarse el presupuesto. Sin carga, un paquete aislado se envía sin
+ * demora
+ * @details Si no hay paquetes encolados sin enviar y el último envío
+ * terminó hace más de un microsegundo, EmisorPaquete::enviar envía el paquete
+ * directamente desde el hilo que lo invoca: despertar al hilo emisor costaba
+ * más que el envío mismo. Los paquetes que se encolan mientras tanto se
+ * envían después, manteniendo el orden
+ * @details El emisor toma posesión de los paquetes encolados y los libera
+ * (Paquete::liberar) luego de enviarlos
+ * @details Si el envío falla, la cola se cierra: los paquetes pendientes se
+ * liberan sin enviar y EmisorPaquete::enviar retorna <tt>false</tt>
+ */
+
 class EmisorPaquete {
 public:
-	EmisorPaquete();
+
+	/**
+	 * @brief Construye el emisor, sin iniciar su hilo
+	 * @param socket Socket conectado por el que enviar. Debe seguir vivo
+	 * mientras el emisor esté iniciado
+	 * @param capacidadCola Cantidad máxima de paquetes encolados
+	 * @param maximoLote Cantidad máxima de paquetes por llamado al sistema
+	 * @param microsegundosLatencia Presupuesto de latencia para completar un
+	 * lote bajo carga, 0 para no esperar nunca
+	 */
+	explicit EmisorPaquete(Com::SocketTCP_IP &socket,
+			size_t capacidadCola = 1024, size_t maximoLote = 32,
+			unsigned long microsegundosLatencia = 50);
+
+	/**
+	 * @brief Método que inicia el hilo emisor
+	 * @throw MultiHiloExcepcion Error al iniciar el hilo
+	 */
+	void iniciar() /* throw (MultiHiloExcepcion) */;
+
+	/**
+	 * @brief Método para encolar un paquete, esperando si la cola está llena.
+	 * Sin carga, lo envía en el momento
+	 * @param paquete Paquete a enviar. Pasa a ser del emisor
+	 * @return <tt>true</tt> si se encoló o se envió
+	 * @return <tt>false</tt> si el emisor fue detenido o falló el envío. El
+	 * paquete sigue siendo de quien lo encoló
+	 */
+	bool enviar(Paquete *paquete);
+
+	/**
+	 * @brief Método para encolar un paquete sin esperar a que haya lugar en
+	 * la cola. Sin carga, lo envía en el momento
+	 * @param paquete Paquete a enviar. Pasa a ser del emisor
+	 * @return <tt>true</tt> si se encoló o se envió
+	 * @return <tt>false</tt> si la cola está llena, el emisor fue detenido o
+	 * falló el envío. El paquete sigue siendo de quien lo encoló
+	 */
+	bool intentarEnviar(Paquete *paquete);
+
+	/**
+	 * @brief Método que deja de aceptar paquetes y espera a que el hilo
+	 * envíe los ya encolados y termine
+	 */
+	void detener();
+
+	/**
+	 * @brief Método para consultar si falló un envío
+	 * @return <tt>true</tt> si falló
+	 */
+	bool tuvoError() const;
+
+	/**
+	 * @brief Método para obtener la cantidad de paquetes enviados
+	 * @return La cantidad de paquetes
+	 */
+	size_t getPaquetesEnviados() const;
+
+	/**
+	 * @brief Método para obtener la cantidad de lotes enviados. El cociente
+	 * entre paquetes y lotes es la cantidad promedio de mensajes por llamado
+	 * al sistema
+	 * @return La cantidad de lotes
+	 */
+	size_t getLotesEnviados() const;
+
+	/**
+	 * @brief Destructor. Detiene el emisor si no fue detenido
+	 */
 	virtual ~EmisorPaquete();
+
+private:
+
+	class Hilo: public POSIX::Thread {
+	public:
+		explicit Hilo(EmisorPaquete &emisor);
+	protected:
+		void* ejecutar(void *parametro);
+	private:
+		EmisorPaquete &emisor;
+	};
+
+	Com::SocketTCP_IP &socket;
+	ColaPaquete cola;
+	size_t maximoLote;
+	uint64_t nanosLatencia;
+	Paquete **lote;
+	Com::VistaBuffer *vistas;
+	Hilo hilo;
+	bool iniciado;
+
+	/* Paquetes encolados sin enviar (de a ENCOLADO) y bit de envio directo
+	 * en curso */
+	size_t pendientes;
+	/* Instante en que termino el ultimo envio, en nanosegundos */
+	uint64_t ultimoEnvio;
+
+	size_t paquetesEnviados;
+	size_t lotesEnviados;
+	bool error;
+
+	void ejecutar();
+	size_t completarLote(size_t cantidad);
+	bool enviarDirecto(Paquete *paquete);
+	void transmitir(const Com::VistaBuffer *vistas, size_t cantidad);
+	void esperarEnvioDirecto();
+
+	EmisorPaquete(const EmisorPaquete&);
+	EmisorPaquete& operator=(const EmisorPaquete&);
 };
 
 }
@@ -0,0 +1,199 @@
+/******************************
+ *  Archivo: EmisorPaquete_bench.cpp
+ *	Autor:   Martín Lucero
+ *****************************/
+#include "EmisorPaquete.h"
+#include "Paquete.h"
+#include "PoolPaquetes.h"
+#include "SocketCliente.h"
+#include "SocketServidor.h"
+#include "Bench.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <time.h>
+#include <vector>
+
+/* Paquetes por llamado al sistema y rendimiento del EmisorPaquete bajo
+ * carga, y latencia de un paquete aislado sin carga, frente a un envío por
+ * paquete directo sobre el socket */
+
+#define PAQUETES 200000
+#define IDAS_Y_VUELTAS 2000
+#define TAMANIO_CARGA 32
+#define PUERTO_BENCH 40480
+
+namespace FWK_CS {
+
+static const char CARGA[TAMANIO_CARGA] = "0123456789abcdef0123456789abcde";
+
+static const size_t TAMANIO_PAQUETE = Paquete::TAMANIO_CABECERA + TAMANIO_CARGA;
+
+static void completar(Paquete &paquete, uint32_t secuencia) {
+	paquete.setTipo(1);
+	paquete.setSecuencia(secuencia);
+	paquete.asignarCarga(CARGA, sizeof(CARGA));
+}
+
+/* Lado receptor: acepta una conexión y lee los bytes de la cantidad de
+ * paquetes indicada. Con eco, responde un byte por cada paquete completo */
+class Receptor: public POSIX::Thread {
+public:
+	Receptor(Com::SocketServidor &servidor, size_t paquetes, bool eco) :
+			servidor(servidor), paquetes(paquetes), eco(eco), recibidos(0) {
+	}
+protected:
+	void* ejecutar(void*) {
+		Com::SocketCliente *conexion = servidor.aceptarClientes();
+		Com::BufferTransmision buffer(1 << 16);
+		Com::BufferTransmision respuesta(
+				(const Com::BufferTransmision::t_buffer*) "r", 1);
+		size_t esperados = paquetes * TAMANIO_PAQUETE;
+		size_t pendientesPaquete = TAMANIO_PAQUETE;
+		while (recibidos < esperados) {
+			ssize_t bytes = conexion->recibir(buffer);
+			if (bytes <= 0) {
+				break;
+			}
+			recibidos += (size_t) bytes;
+			if (eco && (pendientesPaquete -= (size_t) bytes) == 0) {
+				conexion->enviar(respuesta);
+				pendientesPaquete = TAMANIO_PAQUETE;
+			}
+		}
+		conexion->cerrar();
+		delete conexion;
+		return NULL;
+	}
+private:
+	Com::SocketServidor &servidor;
+	size_t paquetes;
+	bool eco;
+	size_t recibidos;
+};
+
+/* Envía un paquete, con el emisor o con un llamado directo al socket */
+class Envio {
+public:
+	Envio(Com::SocketCliente &cliente, EmisorPaquete *emisor) :
+			cliente(cliente), emisor(emisor) {
+	}
+	void enviar(Paquete *paquete) {
+		if (emisor != NULL) {
+			emisor->enviar(paquete);
+			return;
+		}
+		Com::VistaBuffer vista = paquete->getVista();
+		cliente.enviarVectorizado(&vista, 1);
+		paquete->liberar();
+	}
+private:
+	Com::SocketCliente &cliente;
+	EmisorPaquete *emisor;
+};
+
+static void reportarLlamados(EmisorPaquete *emisor) {
+	if (emisor != NULL) {
+		emisor->detener();
+		printf("  %6.1f paq/llamado", (double) emisor->getPaquetesEnviados()
+				/ emisor->getLotesEnviados());
+	}
+	else {
+		printf("  %6.1f paq/llamado", 1.0);
+	}
+	printf("%s\n", (emisor != NULL && emisor->tuvoError()) ? "  ERROR" : "");
+}
+
+static void medirCarga(const char *prueba, Com::SocketServidor &servidor,
+		in_port_t puerto, bool conEmisor) {
+	Receptor receptor(servidor, PAQUETES, false);
+	receptor.iniciar();
+	Com::SocketCliente cliente(puerto, "127.0.0.1");
+	cliente.crear();
+	cliente.conectar();
+	PoolPaquetes pool(4096, TAMANIO_CARGA);
+	EmisorPaquete *emisor = conEmisor ? new EmisorPaquete(cliente) : NULL;
+	if (emisor != NULL) {
+		emisor->iniciar();
+	}
+	Envio envio(cliente, emisor);
+
+	long long inicio = PThread::nanosegundosAhora();
+	for (uint32_t i = 0; i < PAQUETES; ++i) {
+		Paquete *paquete = pool.obtener();
+		completar(*paquete, i);
+		envio.enviar(paquete);
+	}
+	void *retorno;
+	POSIX::Thread::esperarThread(receptor, retorno);
+	double segundos = (PThread::nanosegundosAhora() - inicio) / 1e9;
+	printf("%-26s %10.0f paq/s", prueba, PAQUETES / segundos);
+	reportarLlamados(emisor);
+	delete emisor;
+	cliente.cerrar();
+}
+
+/* Sin carga: cada paquete se envía recién cuando llegó la respuesta del
+ * anterior, así que el emisor nunca tiene más de uno encolado */
+static void medirReposo(const char *prueba, Com::SocketServidor &servidor,
+		in_port_t puerto, bool conEmisor) {
+	Receptor receptor(servidor, IDAS_Y_VUELTAS, true);
+	receptor.iniciar();
+	Com::SocketCliente cliente(puerto, "127.0.0.1");
+	cliente.crear();
+	cliente.conectar();
+	PoolPaquetes pool(16, TAMANIO_CARGA);
+	EmisorPaquete *emisor = conEmisor ? new EmisorPaquete(cliente) : NULL;
+	if (emisor != NULL) {
+		emisor->iniciar();
+	}
+	Envio envio(cliente, emisor);
+
+	Com::BufferTransmision respuesta(1);
+	std::vector<long long> latencias;
+	for (uint32_t i = 0; i < IDAS_Y_VUELTAS; ++i) {
+		Paquete *paquete = pool.obtener();
+		completar(*paquete, i);
+		long long inicio = PThread::nanosegundosAhora();
+		envio.enviar(paquete);
+		cliente.recibir(respuesta);
+		latencias.push_back(PThread::nanosegundosAhora() - inicio);
+	}
+	void *retorno;
+	POSIX::Thread::esperarThread(receptor, retorno);
+	std::sort(latencias.begin(), latencias.end());
+	printf("%-26s p50 %7.1f us  p99 %7.1f us", prueba,
+			PThread::percentil(latencias, 50) / 1e3,
+			PThread::percentil(latencias, 99) / 1e3);
+	reportarLlamados(emisor);
+	delete emisor;
+	cliente.cerrar();
+}
+
+void benchEmisorBajoCarga(Com::SocketServidor &servidor, in_port_t puerto) {
+	medirCarga("carga: emisor", servidor, puerto, true);
+	medirCarga("carga: envio por paquete", servidor, puerto, false);
+}
+
+void benchEmisorEnReposo(Com::SocketServidor &servidor, in_port_t puerto) {
+	medirReposo("reposo: emisor", servidor, puerto, true);
+	medirReposo("reposo: envio por paquete", servidor, puerto, false);
+}
+
+}
+
+#ifdef EMISORPAQUETE_BENCH
+int main(int argc, char **argv) {
+	in_port_t puerto = (in_port_t) ((argc > 1) ? atoi(argv[1]) : PUERTO_BENCH);
+	Com::SocketServidor servidor(puerto);
+	servidor.crear();
+	servidor.enlazarServidor();
+	servidor.escucharClientes(4);
+	printf("%d paquetes de %d bytes de carga, %d idas y vueltas\n", PAQUETES,
+			TAMANIO_CARGA, IDAS_Y_VUELTAS);
+	FWK_CS::benchEmisorBajoCarga(servidor, puerto);
+	FWK_CS::benchEmisorEnReposo(servidor, puerto);
+	servidor.cerrar();
+	return 0;
+}
+#endif
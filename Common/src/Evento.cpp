@@ -6,7 +6,12 @@
 
 namespace FWK_CS {
 
-Evento::Evento() {
+Evento::Evento(t_prioridad prioridad) {
+	this->prioridad = prioridad;
+}
+
+Evento::t_prioridad Evento::getPrioridad() const {
+	return prioridad;
 }
 
 Evento::~Evento() {
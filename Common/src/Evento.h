@@ -6,12 +6,50 @@
 #ifndef EVENTO_H_
 #define EVENTO_H_
 
+#include <cstddef>
+
 namespace FWK_CS {
 
+/**
+ * @brief Clase base de los eventos que circulan por una ColaEvento
+ * @details La prioridad determina el carril de la cola: los eventos de
+ * control (latidos, cancelaciones, confirmaciones) se extraen antes que los
+ * de datos
+ */
+
 class Evento {
 public:
-	Evento();
+
+	typedef enum {
+		PRIORIDAD_CONTROL = 0,	///< Eventos cortos y urgentes
+		PRIORIDAD_DATOS			///< Transferencias de datos
+	} t_prioridad;
+
+	/**
+	 * @brief Cantidad de prioridades, y de carriles de ColaEvento
+	 */
+	static const size_t CANTIDAD_PRIORIDADES = PRIORIDAD_DATOS + 1;
+
+	/**
+	 * @brief Construye un evento
+	 * @param prioridad Prioridad del evento
+	 */
+	explicit Evento(t_prioridad prioridad = PRIORIDAD_DATOS);
+
+	/**
+	 * @brief Método para obtener la prioridad del evento
+	 * @return La prioridad
+	 */
+	t_prioridad getPrioridad() const;
+
+	/**
+	 * @brief Destructor
+	 */
 	virtual ~Evento();
+
+private:
+
+	t_prioridad prioridad;
 };
 
 }
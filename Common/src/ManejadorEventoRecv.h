@@ -6,12 +6,179 @@
 #ifndef MANEJADOREVENTORECV_H_
 #define MANEJADOREVENTORECV_H_
 
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+#include "Thread.h"
+
 namespace FWK_CS {
 
+class ColaPaquete;
+class Paquete;
+
+/**
+ * @brief Interfaz de los objetos que procesan los paquetes de un tipo de
+ * mensaje en un ManejadorEventoRecv
+ */
+
+class ManejadorPaquete {
+public:
+
+	/**
+	 * @brief Método invocado desde un hilo del despachador por cada paquete
+	 * del tipo registrado. Los paquetes de una misma conexión se reciben en
+	 * orden y desde el mismo hilo
+	 * @param paquete Paquete recibido. Se libera al retornar, por lo que no
+	 * debe conservarse
+	 * @details Si arroja una excepción, el paquete se cuenta como descartado
+	 * y el hilo sigue con los paquetes siguientes
+	 */
+	virtual void paqueteRecibido(Paquete &paquete) = 0;
+
+	/**
+	 * @brief Destructor
+	 */
+	virtual ~ManejadorPaquete() {
+	}
+};
+
+/**
+ * @brief Despachador de los paquetes recibidos: busca el manejador de cada
+ * paquete por su tipo en una tabla indexada y lo invoca desde uno de sus
+ * hilos
+ * @details Cada hilo tiene su propia ColaPaquete. Cada conexión se asigna a
+ * un hilo según un hash de su identificador (Paquete::getConexion), por lo
+ * que los paquetes de una conexión se procesan en orden mientras que los de
+ * conexiones distintas se procesan en paralelo
+ * @details Un ReceptorPaquete puede entregar directamente en la cola del
+ * hilo de su conexión (ver ManejadorEventoRecv::getCola), sin pasar por una
+ * cola intermedia y sin cerrarla al terminar
+ * @details La tabla de manejadores no se sincroniza: se completa antes de
+ * ManejadorEventoRecv::iniciar y luego solo se lee
+ */
+
 class ManejadorEventoRecv {
 public:
-	ManejadorEventoRecv();
+
+	/**
+	 * @brief Construye el despachador, sin iniciar sus hilos
+	 * @param cantidadHilos Cantidad de hilos. 0 para usar uno por procesador
+	 * @param cantidadTipos Tamaño de la tabla: los tipos válidos van de 0 a
+	 * cantidadTipos - 1
+	 * @param capacidadCola Capacidad de la cola de cada hilo
+	 */
+	explicit ManejadorEventoRecv(size_t cantidadHilos = 0,
+			size_t cantidadTipos = 256, size_t capacidadCola = 1024);
+
+	/**
+	 * @brief Método para registrar el manejador de un tipo de mensaje. Si ya
+	 * había uno, se reemplaza
+	 * @pre Los hilos no fueron iniciados
+	 * @param tipo Tipo de mensaje (ver Paquete::getTipo)
+	 * @param manejador Manejador a invocar. Debe seguir vivo mientras el
+	 * despachador esté iniciado
+	 * @return <tt>true</tt> si se registró
+	 * @return <tt>false</tt> si el tipo está fuera de la tabla
+	 */
+	bool registrar(uint16_t tipo, ManejadorPaquete *manejador);
+
+	/**
+	 * @brief Método para asignar el manejador de los paquetes cuyo tipo no
+	 * tiene manejador registrado. Sin él, esos paquetes se descartan
+	 * @pre Los hilos no fueron iniciados
+	 * @param manejador Manejador a invocar, o <tt>NULL</tt>
+	 */
+	void setManejadorPorDefecto(ManejadorPaquete *manejador);
+
+	/**
+	 * @brief Método que inicia los hilos
+	 * @throw MultiHiloExcepcion Error al iniciar un hilo
+	 */
+	void iniciar() /* throw (MultiHiloExcepcion) */;
+
+	/**
+	 * @brief Método para despachar un paquete, esperando si la cola de su
+	 * hilo está llena
+	 * @param paquete Paquete a despachar. Pasa a ser del despachador
+	 * @return <tt>true</tt> si se encoló
+	 * @return <tt>false</tt> si el despachador fue detenido. El paquete sigue
+	 * siendo de quien lo despachó
+	 */
+	bool despachar(Paquete *paquete);
+
+	/**
+	 * @brief Método para obtener la cola del hilo que procesa una conexión,
+	 * para entregar en ella los paquetes directamente
+	 * @warning La cola es compartida por todas las conexiones del hilo y
+	 * solo la cierra ManejadorEventoRecv::detener. Un ReceptorPaquete que
+	 * entregue en ella debe construirse con <tt>cerrarDestino</tt> en
+	 * <tt>false</tt>; si no, al terminar una conexión el hilo deja de
+	 * procesar las demás
+	 * @param conexion Identificador de la conexión
+	 * @return La cola. Los paquetes insertados pasan a ser del despachador
+	 */
+	ColaPaquete& getCola(size_t conexion);
+
+	/**
+	 * @brief Método que deja de aceptar paquetes y espera a que los hilos
+	 * procesen los ya encolados y terminen
+	 */
+	void detener();
+
+	/**
+	 * @brief Método para obtener la cantidad de hilos
+	 * @return La cantidad de hilos
+	 */
+	size_t getCantidadHilos() const;
+
+	/**
+	 * @brief Método para obtener la cantidad de paquetes entregados a un
+	 * manejador
+	 * @return La cantidad de paquetes
+	 */
+	size_t getProcesados() const;
+
+	/**
+	 * @brief Método para obtener la cantidad de paquetes descartados por no
+	 * tener manejador o porque su manejador arrojó una excepción
+	 * @return La cantidad de paquetes
+	 */
+	size_t getDescartados() const;
+
+	/**
+	 * @brief Destructor. Detiene el despachador si no fue detenido
+	 */
 	virtual ~ManejadorEventoRecv();
+
+private:
+
+	class Trabajador: public POSIX::Thread {
+	public:
+		Trabajador(ManejadorEventoRecv &despachador, size_t capacidadCola);
+		virtual ~Trabajador();
+		ColaPaquete *cola;
+		/* Contadores propios, en su propia linea de cache: la cola la leen
+		 * todos los hilos que despachan */
+		char relleno0[64];
+		size_t procesados;
+		size_t descartados;
+		char relleno1[64];
+	protected:
+		void* ejecutar(void *parametro);
+	private:
+		ManejadorEventoRecv &despachador;
+	};
+
+	std::vector<Trabajador*> trabajadores;
+	/* Tabla densa indexada por tipo */
+	std::vector<ManejadorPaquete*> manejadores;
+	ManejadorPaquete *porDefecto;
+	bool iniciado;
+
+	bool procesar(Paquete &paquete);
+
+	ManejadorEventoRecv(const ManejadorEventoRecv&);
+	ManejadorEventoRecv& operator=(const ManejadorEventoRecv&);
 };
 
 }
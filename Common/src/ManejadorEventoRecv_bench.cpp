@@ -0,0 +1,116 @@
+/******************************
+ *  Archivo: ManejadorEventoRecv_bench.cpp
+ *	Autor:   Martín Lucero
+ *****************************/
+#include "ManejadorEventoRecv.h"
+#include "Paquete.h"
+#include "PoolPaquetes.h"
+#include "Bench.h"
+#include <cstdio>
+#include <cstdlib>
+#include <pthread.h>
+#include <time.h>
+
+/* Rendimiento del despacho de paquetes de varias conexiones según la
+ * cantidad de hilos del ManejadorEventoRecv */
+
+#define CONEXIONES 16
+#define PAQUETES_POR_CONEXION 50000
+#define TIPOS 4
+/* Trabajo simulado del manejador por cada paquete */
+#define GIROS_POR_PAQUETE 200
+#define MAXIMO_HILOS 8
+
+namespace FWK_CS {
+
+/* Verifica que los paquetes de cada conexión lleguen en orden. Cada conexión
+ * la atiende un único hilo, por lo que su secuencia no necesita
+ * sincronización */
+class ManejadorBench: public ManejadorPaquete {
+public:
+	ManejadorBench() :
+			desordenados(0) {
+		for (int i = 0; i < CONEXIONES; ++i) {
+			ultimaSecuencia[i] = 0;
+		}
+	}
+	void paqueteRecibido(Paquete &paquete) {
+		size_t conexion = paquete.getConexion();
+		if (paquete.getSecuencia() <= ultimaSecuencia[conexion]) {
+			__atomic_add_fetch(&desordenados, 1, __ATOMIC_RELAXED);
+		}
+		ultimaSecuencia[conexion] = paquete.getSecuencia();
+		for (volatile int giro = 0; giro < GIROS_POR_PAQUETE; ++giro) {
+		}
+	}
+	size_t getDesordenados() const {
+		return desordenados;
+	}
+private:
+	uint32_t ultimaSecuencia[CONEXIONES];
+	size_t desordenados;
+};
+
+struct Conexion {
+	ManejadorEventoRecv *despachador;
+	PoolPaquetes *pool;
+	size_t identificador;
+};
+
+static void* producir(void *parametro) {
+	Conexion *conexion = static_cast<Conexion*>(parametro);
+	for (uint32_t secuencia = 1; secuencia <= PAQUETES_POR_CONEXION;
+			++secuencia) {
+		Paquete *paquete = conexion->pool->obtener();
+		paquete->setConexion(conexion->identificador);
+		paquete->setSecuencia(secuencia);
+		paquete->setTipo((uint16_t) (secuencia % TIPOS));
+		conexion->despachador->despachar(paquete);
+	}
+	return NULL;
+}
+
+void benchDespacho(size_t hilos) {
+	PoolPaquetes pool(8192, 16);
+	ManejadorBench manejador;
+	ManejadorEventoRecv despachador(hilos);
+	for (uint16_t tipo = 0; tipo < TIPOS; ++tipo) {
+		despachador.registrar(tipo, &manejador);
+	}
+	despachador.iniciar();
+
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	Conexion conexiones[CONEXIONES];
+	pthread_t productores[CONEXIONES];
+	for (size_t i = 0; i < CONEXIONES; ++i) {
+		conexiones[i].despachador = &despachador;
+		conexiones[i].pool = &pool;
+		conexiones[i].identificador = i;
+		pthread_create(&productores[i], NULL, producir, &conexiones[i]);
+	}
+	for (size_t i = 0; i < CONEXIONES; ++i) {
+		pthread_join(productores[i], NULL);
+	}
+	despachador.detener();
+	double segundos = PThread::segundosDesde(inicio);
+	printf("%2lu hilos %12.0f paq/s  %8lu procesados  %lu desordenados\n",
+			(unsigned long) despachador.getCantidadHilos(),
+			despachador.getProcesados() / segundos,
+			(unsigned long) despachador.getProcesados(),
+			(unsigned long) manejador.getDesordenados());
+}
+
+}
+
+#ifdef MANEJADOREVENTORECV_BENCH
+int main(int argc, char **argv) {
+	size_t maximoHilos = (argc > 1) ? (size_t) atol(argv[1]) : MAXIMO_HILOS;
+	printf("%d conexiones de %d paquetes, %d giros por paquete\n", CONEXIONES,
+			PAQUETES_POR_CONEXION, GIROS_POR_PAQUETE);
+	for (size_t hilos = 1; hilos <= maximoHilos; hilos *= 2) {
+		FWK_CS::benchDespacho(hilos);
+	}
+	return 0;
+}
+#endif
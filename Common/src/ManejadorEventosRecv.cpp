@@ -3,13 +3,166 @@
  *	Autor:   Martín Lucero
  *****************************/
 #include "ManejadorEventoRecv.h"
+#include "ColaPaquete.h"
+#include "Paquete.h"
+#include <cxxabi.h>
+#include <sstream>
+#include <unistd.h>
+
+#define TAMANIO_LOTE 64
+#define PREFIJO_NOMBRE "despacho-"
 
 namespace FWK_CS {
 
-ManejadorEventoRecv::ManejadorEventoRecv() {
+ManejadorEventoRecv::ManejadorEventoRecv(size_t cantidadHilos,
+		size_t cantidadTipos, size_t capacidadCola) :
+		manejadores(cantidadTipos, (ManejadorPaquete*) NULL) {
+	if (cantidadHilos == 0) {
+		long procesadores = sysconf(_SC_NPROCESSORS_ONLN);
+		cantidadHilos = (procesadores > 0) ? (size_t) procesadores : 1;
+	}
+	for (size_t i = 0; i < cantidadHilos; ++i) {
+		trabajadores.push_back(new Trabajador(*this, capacidadCola));
+	}
+	porDefecto = NULL;
+	iniciado = false;
+}
+
+bool ManejadorEventoRecv::registrar(uint16_t tipo,
+		ManejadorPaquete *manejador) {
+	if (tipo >= manejadores.size()) {
+		return false;
+	}
+	manejadores[tipo] = manejador;
+	return true;
+}
+
+void ManejadorEventoRecv::setManejadorPorDefecto(ManejadorPaquete *manejador) {
+	porDefecto = manejador;
+}
+
+void ManejadorEventoRecv::iniciar() {
+	for (size_t i = 0; i < trabajadores.size(); ++i) {
+		std::ostringstream nombre;
+		nombre << PREFIJO_NOMBRE << i;
+		trabajadores[i]->setNombre(nombre.str());
+		trabajadores[i]->iniciar();
+	}
+	iniciado = true;
+}
+
+bool ManejadorEventoRecv::despachar(Paquete *paquete) {
+	return getCola(paquete->getConexion()).insertar(paquete);
+}
+
+ColaPaquete& ManejadorEventoRecv::getCola(size_t conexion) {
+	/* Hash multiplicativo, para que identificadores consecutivos no
+	 * dependan de la cantidad de hilos al repartirse */
+	uint64_t hash = (uint64_t) conexion * 0x9E3779B97F4A7C15ULL;
+	hash ^= hash >> 32;
+	return *trabajadores[hash % trabajadores.size()]->cola;
+}
+
+void ManejadorEventoRecv::detener() {
+	for (size_t i = 0; i < trabajadores.size(); ++i) {
+		trabajadores[i]->cola->cerrar();
+	}
+	if (iniciado) {
+		for (size_t i = 0; i < trabajadores.size(); ++i) {
+			void *retorno;
+			POSIX::Thread::esperarThread(*trabajadores[i], retorno);
+		}
+		iniciado = false;
+	}
+}
+
+size_t ManejadorEventoRecv::getCantidadHilos() const {
+	return trabajadores.size();
+}
+
+size_t ManejadorEventoRecv::getProcesados() const {
+	size_t total = 0;
+	for (size_t i = 0; i < trabajadores.size(); ++i) {
+		total += __atomic_load_n(&trabajadores[i]->procesados,
+				__ATOMIC_RELAXED);
+	}
+	return total;
+}
+
+size_t ManejadorEventoRecv::getDescartados() const {
+	size_t total = 0;
+	for (size_t i = 0; i < trabajadores.size(); ++i) {
+		total += __atomic_load_n(&trabajadores[i]->descartados,
+				__ATOMIC_RELAXED);
+	}
+	return total;
 }
 
 ManejadorEventoRecv::~ManejadorEventoRecv() {
+	detener();
+	for (size_t i = 0; i < trabajadores.size(); ++i) {
+		delete trabajadores[i];
+	}
+}
+
+bool ManejadorEventoRecv::procesar(Paquete &paquete) {
+	uint16_t tipo = paquete.getTipo();
+	ManejadorPaquete *manejador =
+			(tipo < manejadores.size()) ? manejadores[tipo] : NULL;
+	if (manejador == NULL) {
+		manejador = porDefecto;
+	}
+	if (manejador == NULL) {
+		return false;
+	}
+	try {
+		manejador->paqueteRecibido(paquete);
+	}
+	catch (abi::__forced_unwind&) {
+		/* La cancelacion del hilo debe seguir desenrollando la pila */
+		throw;
+	}
+	catch (...) {
+		/* Un manejador que falla no detiene al hilo: las demas conexiones
+		 * asignadas a el seguirian sin atenderse */
+		return false;
+	}
+	return true;
+}
+
+ManejadorEventoRecv::Trabajador::Trabajador(ManejadorEventoRecv &despachador,
+		size_t capacidadCola) :
+		despachador(despachador) {
+	cola = new ColaPaquete(capacidadCola);
+	procesados = 0;
+	descartados = 0;
+}
+
+ManejadorEventoRecv::Trabajador::~Trabajador() {
+	/* Paquetes encolados sin iniciar los hilos */
+	Paquete *paquete;
+	while (cola->intentarExtraer(paquete)) {
+		paquete->liberar();
+	}
+	delete cola;
+}
+
+void* ManejadorEventoRecv::Trabajador::ejecutar(void*) {
+	Paquete *lote[TAMANIO_LOTE];
+	size_t cantidad;
+	while ((cantidad = cola->extraerLote(lote, TAMANIO_LOTE)) > 0) {
+		for (size_t i = 0; i < cantidad; ++i) {
+			if (despachador.procesar(*lote[i])) {
+				__atomic_store_n(&procesados, procesados + 1, __ATOMIC_RELAXED);
+			}
+			else {
+				__atomic_store_n(&descartados, descartados + 1,
+						__ATOMIC_RELAXED);
+			}
+			lote[i]->liberar();
+		}
+	}
+	return NULL;
 }
 
 }
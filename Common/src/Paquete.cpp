@@ -3,13 +3,152 @@
  *	Autor:   Martín Lucero
  *****************************/
 #include "Paquete.h"
+#include "PoolPaquetes.h"
+#include <arpa/inet.h>
+#include <cstring>
+#include <new>
+
+/* Alineacion del comienzo de la cabecera dentro del bloque */
+#define ALINEACION 8
 
 namespace FWK_CS {
 
-Paquete::Paquete() {
+/* Espacio que ocupa el objeto al comienzo del bloque */
+static size_t tamanioObjeto() {
+	return (sizeof(Paquete) + ALINEACION - 1) & ~((size_t) ALINEACION - 1);
+}
+
+Paquete::Paquete(size_t capacidad, PoolPaquetes *pool) :
+		capacidad(capacidad), pool(pool) {
+	char *bloque = reinterpret_cast<char*>(this);
+	cabecera = reinterpret_cast<Cabecera*>(bloque + tamanioObjeto());
+	carga = reinterpret_cast<Com::BufferTransmision::t_buffer*>(cabecera + 1);
+	reiniciar();
 }
 
 Paquete::~Paquete() {
 }
 
+size_t Paquete::tamanioBloque(size_t capacidad) {
+	size_t tamanio = tamanioObjeto() + TAMANIO_CABECERA + capacidad;
+	return (tamanio + ALINEACION - 1) & ~((size_t) ALINEACION - 1);
+}
+
+Paquete* Paquete::crear(size_t capacidad) {
+	char *bloque = new char[tamanioBloque(capacidad)];
+	return new (bloque) Paquete(capacidad, NULL);
+}
+
+void Paquete::liberar() {
+	if (pool != NULL) {
+		pool->devolver(this);
+		return;
+	}
+	char *bloque = reinterpret_cast<char*>(this);
+	this->~Paquete();
+	delete[] bloque;
+}
+
+uint16_t Paquete::getTipo() const {
+	return ntohs(cabecera->tipo);
+}
+
+void Paquete::setTipo(uint16_t tipo) {
+	cabecera->tipo = htons(tipo);
+}
+
+uint16_t Paquete::getFlags() const {
+	return ntohs(cabecera->flags);
+}
+
+void Paquete::setFlags(uint16_t flags) {
+	cabecera->flags = htons(flags);
+}
+
+uint32_t Paquete::getSecuencia() const {
+	return ntohl(cabecera->secuencia);
+}
+
+void Paquete::setSecuencia(uint32_t secuencia) {
+	cabecera->secuencia = htonl(secuencia);
+}
+
+uint32_t Paquete::getLongitud() const {
+	return ntohl(cabecera->longitud);
+}
+
+bool Paquete::setLongitud(uint32_t longitud) {
+	if (longitud > capacidad) {
+		return false;
+	}
+	cabecera->longitud = htonl(longitud);
+	return true;
+}
+
+size_t Paquete::getCapacidad() const {
+	return capacidad;
+}
+
+Com::BufferTransmision::t_buffer* Paquete::obtenerCarga() {
+	return carga;
+}
+
+const Com::BufferTransmision::t_buffer* Paquete::obtenerCarga() const {
+	return carga;
+}
+
+bool Paquete::asignarCarga(const void *datos, size_t tamanio) {
+	if (tamanio > capacidad) {
+		return false;
+	}
+	memcpy(carga, datos, tamanio);
+	cabecera->longitud = htonl((uint32_t) tamanio);
+	return true;
+}
+
+bool Paquete::agregarCarga(const void *datos, size_t tamanio) {
+	size_t longitud = getLongitud();
+	if (tamanio > capacidad - longitud) {
+		return false;
+	}
+	memcpy(carga + longitud, datos, tamanio);
+	cabecera->longitud = htonl((uint32_t) (longitud + tamanio));
+	return true;
+}
+
+Com::VistaBuffer Paquete::getVistaCarga() const {
+	return Com::VistaBuffer(carga, getLongitud());
+}
+
+Com::VistaBuffer Paquete::getVista() const {
+	return Com::VistaBuffer(
+			reinterpret_cast<const Com::BufferTransmision::t_buffer*>(
+					cabecera), TAMANIO_CABECERA + getLongitud());
+}
+
+Com::BufferTransmision::t_buffer* Paquete::obtenerCabecera() {
+	return reinterpret_cast<Com::BufferTransmision::t_buffer*>(cabecera);
+}
+
+Com::BufferTransmision::t_buffer* Paquete::prepararCarga() {
+	return (getLongitud() <= capacidad) ? carga : NULL;
+}
+
+size_t Paquete::getConexion() const {
+	return conexion;
+}
+
+void Paquete::setConexion(size_t conexion) {
+	this->conexion = conexion;
+}
+
+void Paquete::reiniciar() {
+	memset(cabecera, 0, TAMANIO_CABECERA);
+	conexion = 0;
+}
+
+PoolPaquetes* Paquete::getPool() const {
+	return pool;
+}
+
 }
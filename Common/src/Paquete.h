@@ -6,12 +6,226 @@
 #ifndef PAQUETE_H_
 #define PAQUETE_H_
 
+#include <cstddef>
+#include <stdint.h>
+#include "VistaBuffer.h"
+
 namespace FWK_CS {
 
+class PoolPaquetes;
+
+/**
+ * @brief Unidad de mensaje del framework: una cabecera binaria fija (tipo,
+ * longitud, secuencia y flags) seguida de la carga
+ * @details El objeto, la cabecera y el espacio para la carga están en un
+ * único bloque de memoria, que se obtiene de un PoolPaquetes (sin alocar) o
+ * con Paquete::crear. La cabecera se guarda en el formato de la red, por lo
+ * que cabecera y carga pueden enviarse con un solo llamado a partir de
+ * Paquete::getVista, sin copiarlas
+ * @details Para recibir, se leen Paquete::TAMANIO_CABECERA bytes del socket
+ * en Paquete::obtenerCabecera y la carga en Paquete::prepararCarga,
+ * directamente sobre el paquete
+ * @details Un paquete no puede copiarse; se pasa por puntero y se devuelve
+ * con Paquete::liberar
+ */
+
 class Paquete {
 public:
-	Paquete();
-	virtual ~Paquete();
+
+	/**
+	 * @brief Formato de la cabecera en la red. Todos los campos están en el
+	 * orden de bytes de la red
+	 */
+	struct Cabecera {
+		uint16_t tipo;
+		uint16_t flags;
+		uint32_t longitud;
+		uint32_t secuencia;
+	};
+
+	/**
+	 * @brief Tamaño de la cabecera en la red, en bytes
+	 */
+	static const size_t TAMANIO_CABECERA = sizeof(Cabecera);
+
+	/**
+	 * @brief Método para crear un paquete fuera de un pool, en un único
+	 * bloque alocado con new
+	 * @param capacidad Tamaño máximo de la carga, en bytes
+	 * @return El paquete, vacío y con la cabecera en cero
+	 */
+	static Paquete* crear(size_t capacidad);
+
+	/**
+	 * @brief Método para devolver el paquete a su pool, o destruirlo si fue
+	 * creado con Paquete::crear
+	 * @post El paquete no debe volver a usarse
+	 */
+	void liberar();
+
+	/**
+	 * @brief Método para obtener el tipo de mensaje
+	 * @return El tipo
+	 */
+	uint16_t getTipo() const;
+
+	/**
+	 * @brief Método para fijar el tipo de mensaje
+	 * @param tipo El tipo
+	 */
+	void setTipo(uint16_t tipo);
+
+	/**
+	 * @brief Método para obtener los flags del mensaje
+	 * @return Los flags
+	 */
+	uint16_t getFlags() const;
+
+	/**
+	 * @brief Método para fijar los flags del mensaje
+	 * @param flags Los flags
+	 */
+	void setFlags(uint16_t flags);
+
+	/**
+	 * @brief Método para obtener el número de secuencia del mensaje
+	 * @return El número de secuencia
+	 */
+	uint32_t getSecuencia() const;
+
+	/**
+	 * @brief Método para fijar el número de secuencia del mensaje
+	 * @param secuencia El número de secuencia
+	 */
+	void setSecuencia(uint32_t secuencia);
+
+	/**
+	 * @brief Método para obtener la longitud de la carga
+	 * @return La longitud, en bytes
+	 */
+	uint32_t getLongitud() const;
+
+	/**
+	 * @brief Método para fijar la longitud de la carga, luego de escribirla
+	 * directamente en Paquete::obtenerCarga
+	 * @param longitud La longitud, en bytes
+	 * @return <tt>true</tt> si se fijó
+	 * @return <tt>false</tt> si supera la capacidad
+	 */
+	bool setLongitud(uint32_t longitud);
+
+	/**
+	 * @brief Método para obtener la capacidad de la carga
+	 * @return La capacidad, en bytes
+	 */
+	size_t getCapacidad() const;
+
+	/**
+	 * @brief Método para obtener la carga, para leerla o escribirla en el
+	 * lugar
+	 * @return Puntero al comienzo de la carga
+	 */
+	Com::BufferTransmision::t_buffer* obtenerCarga();
+
+	/**
+	 * @brief Método para obtener la carga, solo para consulta
+	 * @return Puntero al comienzo de la carga
+	 */
+	const Com::BufferTransmision::t_buffer* obtenerCarga() const;
+
+	/**
+	 * @brief Método para reemplazar la carga por una copia de @a datos
+	 * @param datos Datos a copiar
+	 * @param tamanio Cantidad de bytes
+	 * @return <tt>true</tt> si se copió
+	 * @return <tt>false</tt> si supera la capacidad. La carga no se modifica
+	 */
+	bool asignarCarga(const void *datos, size_t tamanio);
+
+	/**
+	 * @brief Método para agregar una copia de @a datos al final de la carga
+	 * @param datos Datos a copiar
+	 * @param tamanio Cantidad de bytes
+	 * @return <tt>true</tt> si se agregó
+	 * @return <tt>false</tt> si supera la capacidad. La carga no se modifica
+	 */
+	bool agregarCarga(const void *datos, size_t tamanio);
+
+	/**
+	 * @brief Método para obtener una vista de la carga
+	 * @return La vista, válida mientras no se libere el paquete
+	 */
+	Com::VistaBuffer getVistaCarga() const;
+
+	/**
+	 * @brief Método para obtener una vista del mensaje completo (cabecera y
+	 * carga contiguas), lista para enviar
+	 * @return La vista, válida mientras no se libere el paquete
+	 */
+	Com::VistaBuffer getVista() const;
+
+	/**
+	 * @brief Método para obtener el espacio de la cabecera, donde se reciben
+	 * sus Paquete::TAMANIO_CABECERA bytes
+	 * @return Puntero al comienzo de la cabecera
+	 */
+	Com::BufferTransmision::t_buffer* obtenerCabecera();
+
+	/**
+	 * @brief Método que, con la cabecera ya recibida, valida su longitud y
+	 * retorna dónde recibir la carga
+	 * @return Puntero al comienzo de la carga, donde deben recibirse
+	 * Paquete::getLongitud bytes. <tt>NULL</tt> si la longitud supera la
+	 * capacidad
+	 */
+	Com::BufferTransmision::t_buffer* prepararCarga();
+
+	/**
+	 * @brief Método para obtener el identificador de la conexión por la que
+	 * llegó el paquete. Es local al proceso y no se envía
+	 * @return El identificador, 0 si no se asignó
+	 */
+	size_t getConexion() const;
+
+	/**
+	 * @brief Método para asignar el identificador de la conexión por la que
+	 * llegó el paquete (ver ReceptorPaquete::setConexion)
+	 * @param conexion El identificador
+	 */
+	void setConexion(size_t conexion);
+
+	/**
+	 * @brief Método que pone la cabecera y la conexión en cero y vacía la
+	 * carga
+	 */
+	void reiniciar();
+
+	/**
+	 * @brief Método para obtener el pool al que pertenece el paquete
+	 * @return El pool, o <tt>NULL</tt> si fue creado con Paquete::crear
+	 */
+	PoolPaquetes* getPool() const;
+
+private:
+
+	friend class PoolPaquetes;
+
+	Cabecera *cabecera;
+	Com::BufferTransmision::t_buffer *carga;
+	size_t capacidad;
+	PoolPaquetes *pool;
+	size_t conexion;
+
+	/* Se construye dentro de un bloque, con la cabecera y la carga a
+	 * continuacion del objeto */
+	Paquete(size_t capacidad, PoolPaquetes *pool);
+	~Paquete();
+
+	/* Tamanio del bloque de un paquete con esa capacidad */
+	static size_t tamanioBloque(size_t capacidad);
+
+	Paquete(const Paquete&);
+	Paquete& operator=(const Paquete&);
 };
 
 }
@@ -0,0 +1,128 @@
+/******************************
+ *  Archivo: Paquete_bench.cpp
+ *	Autor:   Martín Lucero
+ *****************************/
+#include "Paquete.h"
+#include "PoolPaquetes.h"
+#include "ColaPaquete.h"
+#include "Bench.h"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <pthread.h>
+#include <time.h>
+
+/* Crear, completar y reciclar paquetes: desde un PoolPaquetes, desde el heap
+ * y pasándolos de un hilo a otro */
+
+#define PAQUETES 1000000
+#define CAPACIDAD 64
+#define PAQUETES_POOL 1024
+
+namespace FWK_CS {
+
+/* Lo incrementa el operator new del programa de benchmark */
+static size_t asignacionesHeap = 0;
+
+static const char CARGA[32] = "0123456789abcdef0123456789abcde";
+
+static void reportar(const char *prueba, double segundos, size_t asignaciones) {
+	printf("%-24s %10.0f paq/s  %6.1f ns/paq  %8lu asignaciones\n", prueba,
+			PAQUETES / segundos, segundos * 1e9 / PAQUETES,
+			(unsigned long) asignaciones);
+}
+
+static void completar(Paquete &paquete, uint32_t secuencia) {
+	paquete.setTipo(1);
+	paquete.setSecuencia(secuencia);
+	paquete.asignarCarga(CARGA, sizeof(CARGA));
+}
+
+void benchPool() {
+	PoolPaquetes pool(PAQUETES_POOL, CAPACIDAD);
+	size_t previas = asignacionesHeap;
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	for (uint32_t i = 0; i < PAQUETES; ++i) {
+		Paquete *paquete = pool.obtener();
+		completar(*paquete, i);
+		paquete->liberar();
+	}
+	reportar("pool", PThread::segundosDesde(inicio), asignacionesHeap - previas);
+}
+
+void benchHeap() {
+	size_t previas = asignacionesHeap;
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	for (uint32_t i = 0; i < PAQUETES; ++i) {
+		Paquete *paquete = Paquete::crear(CAPACIDAD);
+		completar(*paquete, i);
+		paquete->liberar();
+	}
+	reportar("heap", PThread::segundosDesde(inicio), asignacionesHeap - previas);
+}
+
+static void* consumir(void *parametro) {
+	ColaPaquete *cola = static_cast<ColaPaquete*>(parametro);
+	Paquete *paquete;
+	while ((paquete = cola->extraer()) != NULL) {
+		paquete->liberar();
+	}
+	return NULL;
+}
+
+/* El productor completa los paquetes y el consumidor los libera, con lo que
+ * cada paquete se libera en un hilo distinto al que lo obtuvo */
+static void medirEntreHilos(const char *prueba, PoolPaquetes *pool) {
+	ColaPaquete cola(PAQUETES_POOL / 2);
+	size_t previas = asignacionesHeap;
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	pthread_t consumidor;
+	pthread_create(&consumidor, NULL, consumir, &cola);
+	for (uint32_t i = 0; i < PAQUETES; ++i) {
+		Paquete *paquete = (pool != NULL) ?
+				pool->obtener() : Paquete::crear(CAPACIDAD);
+		completar(*paquete, i);
+		cola.insertar(paquete);
+	}
+	cola.cerrar();
+	pthread_join(consumidor, NULL);
+	reportar(prueba, PThread::segundosDesde(inicio), asignacionesHeap - previas);
+}
+
+void benchPoolEntreHilos() {
+	PoolPaquetes pool(PAQUETES_POOL, CAPACIDAD);
+	medirEntreHilos("pool entre hilos", &pool);
+}
+
+void benchHeapEntreHilos() {
+	medirEntreHilos("heap entre hilos", NULL);
+}
+
+}
+
+#ifdef PAQUETE_BENCH
+void* operator new(size_t tamanio) throw (std::bad_alloc) {
+	__atomic_add_fetch(&FWK_CS::asignacionesHeap, 1, __ATOMIC_RELAXED);
+	void *memoria = malloc(tamanio ? tamanio : 1);
+	if (memoria == NULL) {
+		throw std::bad_alloc();
+	}
+	return memoria;
+}
+
+void operator delete(void *memoria) throw () {
+	free(memoria);
+}
+
+int main() {
+	printf("%d paquetes de %d bytes de carga\n", PAQUETES, CAPACIDAD);
+	FWK_CS::benchPool();
+	FWK_CS::benchHeap();
+	FWK_CS::benchPoolEntreHilos();
+	FWK_CS::benchHeapEntreHilos();
+	return 0;
+}
+#endif
@@ -3,7 +3,140 @@
  *	Autor:   Martín Lucero
  *****************************/
 #include "Paquete.h"
+#include "PoolPaquetes.h"
+#include <arpa/inet.h>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <pthread.h>
 
 namespace FWK_CS {
 
+/* La cabecera se guarda en el orden de bytes de la red, seguida de la carga */
+void testCabeceraEnFormatoDeRed() {
+	Paquete *paquete = Paquete::crear(16);
+	paquete->setTipo(0x0102);
+	paquete->setFlags(0x0304);
+	paquete->setSecuencia(0x05060708);
+	assert(paquete->asignarCarga("abc", 3));
+
+	Com::VistaBuffer vista = paquete->getVista();
+	assert(vista.getTamanio() == Paquete::TAMANIO_CABECERA + 3);
+	const unsigned char esperado[] = { 0x01, 0x02, 0x03, 0x04, 0, 0, 0, 3,
+			0x05, 0x06, 0x07, 0x08, 'a', 'b', 'c' };
+	assert(memcmp(vista.obtenerDatos(), esperado, sizeof(esperado)) == 0);
+	assert(paquete->getTipo() == 0x0102);
+	assert(paquete->getFlags() == 0x0304);
+	assert(paquete->getSecuencia() == 0x05060708);
+	paquete->liberar();
+}
+
+void testCargaRespetaCapacidad() {
+	Paquete *paquete = Paquete::crear(8);
+	assert(paquete->asignarCarga("12345", 5));
+	assert(paquete->agregarCarga("678", 3));
+	assert(!paquete->agregarCarga("9", 1));
+	assert(!paquete->asignarCarga("123456789", 9));
+	assert(paquete->getLongitud() == 8);
+	assert(memcmp(paquete->getVistaCarga().obtenerDatos(), "12345678", 8)
+			== 0);
+	assert(!paquete->setLongitud(9));
+	assert(paquete->setLongitud(2));
+	assert(paquete->getVistaCarga().getTamanio() == 2);
+	paquete->liberar();
+}
+
+/* Un mensaje enviado desde un paquete se recibe directamente sobre otro */
+void testRecepcionSobreElPaquete() {
+	Paquete *origen = Paquete::crear(32);
+	origen->setTipo(7);
+	origen->setSecuencia(42);
+	origen->asignarCarga("hola mundo", 10);
+	Com::VistaBuffer trama = origen->getVista();
+
+	Paquete *destino = Paquete::crear(32);
+	memcpy(destino->obtenerCabecera(), trama.obtenerDatos(),
+			Paquete::TAMANIO_CABECERA);
+	Com::BufferTransmision::t_buffer *carga = destino->prepararCarga();
+	assert(carga == destino->obtenerCarga());
+	memcpy(carga, trama.obtenerDatos() + Paquete::TAMANIO_CABECERA,
+			destino->getLongitud());
+	assert(destino->getTipo() == 7);
+	assert(destino->getSecuencia() == 42);
+	assert(memcmp(destino->obtenerCarga(), "hola mundo", 10) == 0);
+
+	/* Una longitud mayor a la capacidad se rechaza */
+	Paquete *chico = Paquete::crear(4);
+	memcpy(chico->obtenerCabecera(), trama.obtenerDatos(),
+			Paquete::TAMANIO_CABECERA);
+	assert(chico->prepararCarga() == NULL);
+
+	origen->liberar();
+	destino->liberar();
+	chico->liberar();
+}
+
+void testPoolReciclaPaquetes() {
+	PoolPaquetes pool(4, 64);
+	assert(pool.getLibres() == 4);
+	Paquete *paquetes[4];
+	for (int i = 0; i < 4; ++i) {
+		paquetes[i] = pool.intentarObtener();
+		assert(paquetes[i] != NULL);
+		assert(paquetes[i]->getPool() == &pool);
+		assert(paquetes[i]->getCapacidad() == 64);
+	}
+	assert(pool.intentarObtener() == NULL);
+
+	paquetes[0]->setTipo(3);
+	paquetes[0]->asignarCarga("xyz", 3);
+	paquetes[0]->liberar();
+	Paquete *reciclado = pool.intentarObtener();
+	assert(reciclado == paquetes[0]);
+	assert(reciclado->getTipo() == 0 && reciclado->getLongitud() == 0);
+
+	for (int i = 0; i < 4; ++i) {
+		paquetes[i]->liberar();
+	}
+	assert(pool.getLibres() == 4);
+}
+
+namespace {
+
+void* obtenerYLiberar(void *parametro) {
+	PoolPaquetes *pool = static_cast<PoolPaquetes*>(parametro);
+	for (int i = 0; i < 100000; ++i) {
+		Paquete *paquete = pool->obtener();
+		paquete->setSecuencia(i);
+		paquete->liberar();
+	}
+	return NULL;
+}
+}
+
+/* Más hilos que paquetes: obtener espera a que otro hilo libere uno */
+void testPoolConcurrente() {
+	PoolPaquetes pool(2, 16);
+	pthread_t hilos[4];
+	for (int i = 0; i < 4; ++i) {
+		pthread_create(&hilos[i], NULL, obtenerYLiberar, &pool);
+	}
+	for (int i = 0; i < 4; ++i) {
+		pthread_join(hilos[i], NULL);
+	}
+	assert(pool.getLibres() == 2);
+}
+
+}
+
+#ifdef PAQUETE_TEST
+int main() {
+	FWK_CS::testCabeceraEnFormatoDeRed();
+	FWK_CS::testCargaRespetaCapacidad();
+	FWK_CS::testRecepcionSobreElPaquete();
+	FWK_CS::testPoolReciclaPaquetes();
+	FWK_CS::testPoolConcurrente();
+	printf("Paquete_test: OK\n");
+	return 0;
 }
+#endif
@@ -0,0 +1,141 @@
+/******************************
+ *  Archivo: PoolPaquetes.cpp
+ *	Autor:   Martín Lucero
+ *****************************/
+#include "PoolPaquetes.h"
+#include "Paquete.h"
+#include "Futex.h"
+#include <new>
+#include <stdexcept>
+
+/* Iteraciones de espera activa antes de dormir al hilo */
+#define GIROS_ANTES_DE_DORMIR 128
+/* Indice que marca la pila vacia */
+#define SIN_PAQUETE 0xFFFFFFFFu
+
+namespace FWK_CS {
+
+using PThread::futexEsperar;
+using PThread::futexDespertar;
+using PThread::pausaCPU;
+
+/* Tope que apunta a @a indice, con el contador de cambios de @a anterior
+ * incrementado */
+static uint64_t nuevoTope(uint64_t anterior, uint32_t indice) {
+	return ((anterior >> 32) + 1) << 32 | indice;
+}
+
+PoolPaquetes::PoolPaquetes(size_t cantidad, size_t capacidad) :
+		cantidad(cantidad), capacidad(capacidad),
+		tamanioBloque(Paquete::tamanioBloque(capacidad)), senialLibres(0), dormidos(0) {
+	if (cantidad >= SIN_PAQUETE) {
+		throw std::invalid_argument("Demasiados paquetes para el pool");
+	}
+	bloques = new char[cantidad * tamanioBloque];
+	siguientes = new uint32_t[cantidad];
+	/* El paquete 0 queda en el tope, asi se entregan en orden de memoria */
+	for (size_t i = 0; i < cantidad; ++i) {
+		new (bloques + i * tamanioBloque) Paquete(capacidad, this);
+		siguientes[i] = (i + 1 < cantidad) ? (uint32_t) (i + 1) : SIN_PAQUETE;
+	}
+	tope = (cantidad > 0) ? 0 : SIN_PAQUETE;
+}
+
+Paquete* PoolPaquetes::intentarObtener() {
+	uint64_t actual = __atomic_load_n(&tope, __ATOMIC_ACQUIRE);
+	while (true) {
+		uint32_t primero = (uint32_t) actual;
+		if (primero == SIN_PAQUETE) {
+			return NULL;
+		}
+		/* Si otro hilo ya lo extrajo, el siguiente leido puede ser viejo, pero
+		 * el contador de cambios hace fallar el compare-and-swap */
+		uint32_t siguiente = __atomic_load_n(&siguientes[primero],
+				__ATOMIC_RELAXED);
+		if (__atomic_compare_exchange_n(&tope, &actual,
+				nuevoTope(actual, siguiente), true, __ATOMIC_ACQUIRE,
+				__ATOMIC_ACQUIRE)) {
+			return paquete(primero);
+		}
+	}
+}
+
+Paquete* PoolPaquetes::obtener() {
+	while (true) {
+		for (int giro = 0; giro < GIROS_ANTES_DE_DORMIR; ++giro) {
+			Paquete *libre = intentarObtener();
+			if (libre != NULL) {
+				return libre;
+			}
+			pausaCPU();
+		}
+		/* Junto con la barrera de devolver(), o bien aca se ve el paquete
+		 * devuelto, o bien alla se ve al hilo dormido */
+		int valor = __atomic_load_n(&senialLibres, __ATOMIC_ACQUIRE);
+		__atomic_add_fetch(&dormidos, 1, __ATOMIC_SEQ_CST);
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		if ((uint32_t) __atomic_load_n(&tope, __ATOMIC_RELAXED) == SIN_PAQUETE) {
+			futexEsperar(&senialLibres, valor);
+		}
+		__atomic_sub_fetch(&dormidos, 1, __ATOMIC_SEQ_CST);
+	}
+}
+
+size_t PoolPaquetes::getLibres() const {
+	/* Se recorre la pila en lugar de llevar la cuenta, que agregaria una
+	 * operacion atomica a cada obtener y devolver. Con otros hilos usando el
+	 * pool la pila cambia durante el recorrido, que se corta en cantidad */
+	uint32_t actual = (uint32_t) __atomic_load_n(&tope, __ATOMIC_ACQUIRE);
+	size_t contados = 0;
+	while (actual != SIN_PAQUETE && contados < cantidad) {
+		++contados;
+		actual = __atomic_load_n(&siguientes[actual], __ATOMIC_RELAXED);
+	}
+	return contados;
+}
+
+size_t PoolPaquetes::getCantidad() const {
+	return cantidad;
+}
+
+size_t PoolPaquetes::getCapacidad() const {
+	return capacidad;
+}
+
+PoolPaquetes::~PoolPaquetes() {
+	for (size_t i = 0; i < cantidad; ++i) {
+		paquete((uint32_t) i)->~Paquete();
+	}
+	delete[] siguientes;
+	delete[] bloques;
+}
+
+Paquete* PoolPaquetes::paquete(uint32_t indice) const {
+	return reinterpret_cast<Paquete*>(bloques + indice * tamanioBloque);
+}
+
+uint32_t PoolPaquetes::indice(const Paquete *paquete) const {
+	return (uint32_t) ((reinterpret_cast<const char*>(paquete) - bloques)
+			/ tamanioBloque);
+}
+
+void PoolPaquetes::devolver(Paquete *paquete) {
+	/* Se reinicia al devolverlo, asi obtener entrega el paquete limpio */
+	paquete->reiniciar();
+	uint32_t devuelto = indice(paquete);
+	uint64_t actual = __atomic_load_n(&tope, __ATOMIC_RELAXED);
+	do {
+		__atomic_store_n(&siguientes[devuelto], (uint32_t) actual,
+				__ATOMIC_RELAXED);
+	} while (!__atomic_compare_exchange_n(&tope, &actual,
+			nuevoTope(actual, devuelto), true, __ATOMIC_SEQ_CST,
+			__ATOMIC_RELAXED));
+	/* El compare-and-swap secuencialmente consistente hace de barrera frente
+	 * al incremento de dormidos en obtener() */
+	if (__atomic_load_n(&dormidos, __ATOMIC_SEQ_CST) > 0) {
+		__atomic_add_fetch(&senialLibres, 1, __ATOMIC_RELEASE);
+		futexDespertar(&senialLibres, 1);
+	}
+}
+
+}
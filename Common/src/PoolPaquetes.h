@@ -0,0 +1,107 @@
+/******************************
+ *  Archivo: PoolPaquetes.h
+ *	Autor:   Martín Lucero
+ *****************************/
+
+#ifndef POOLPAQUETES_H_
+#define POOLPAQUETES_H_
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace FWK_CS {
+
+class Paquete;
+
+/**
+ * @brief Pool de paquetes de igual capacidad, alocados juntos al construirlo
+ * @details Obtener y liberar un paquete no aloca memoria ni toma locks: los
+ * paquetes libres se guardan en una pila sin locks, que se actualiza con un
+ * único compare-and-swap y devuelve primero el último paquete liberado, que
+ * suele seguir en la caché. Puede usarse desde varios hilos a la vez; un
+ * paquete puede liberarse en un hilo distinto al que lo obtuvo. Sólo obtener
+ * duerme al hilo, cuando no quedan paquetes libres
+ */
+
+class PoolPaquetes {
+public:
+
+	/**
+	 * @brief Construye el pool con todos sus paquetes libres
+	 * @throw std::invalid_argument si la cantidad no entra en 32 bits
+	 * @param cantidad Cantidad de paquetes
+	 * @param capacidad Capacidad de la carga de cada paquete, en bytes
+	 */
+	PoolPaquetes(size_t cantidad, size_t capacidad);
+
+	/**
+	 * @brief Método para obtener un paquete libre, sin esperar
+	 * @return El paquete, vacío y con la cabecera en cero, o <tt>NULL</tt>
+	 * si no hay paquetes libres
+	 */
+	Paquete* intentarObtener();
+
+	/**
+	 * @brief Método para obtener un paquete libre, esperando a que se libere
+	 * uno si no hay
+	 * @return El paquete, vacío y con la cabecera en cero
+	 */
+	Paquete* obtener();
+
+	/**
+	 * @brief Método para obtener la cantidad de paquetes libres. Recorre los
+	 * paquetes libres, y es aproximada si otros hilos están usando el pool
+	 * @return La cantidad de paquetes libres
+	 */
+	size_t getLibres() const;
+
+	/**
+	 * @brief Método para obtener la cantidad total de paquetes
+	 * @return La cantidad de paquetes
+	 */
+	size_t getCantidad() const;
+
+	/**
+	 * @brief Método para obtener la capacidad de la carga de los paquetes
+	 * @return La capacidad, en bytes
+	 */
+	size_t getCapacidad() const;
+
+	/**
+	 * @brief Destructor
+	 * @pre Todos los paquetes fueron liberados
+	 */
+	~PoolPaquetes();
+
+private:
+
+	friend class Paquete;
+
+	char *bloques;
+	size_t cantidad;
+	size_t capacidad;
+	size_t tamanioBloque;
+
+	/* Pila de paquetes libres: el indice del tope en los 32 bits bajos y un
+	 * contador de cambios en los altos, para que un compare-and-swap no tome
+	 * por igual un tope que se extrajo y se volvio a apilar (problema ABA) */
+	uint64_t tope;
+	/* Para cada paquete apilado, el indice del que sigue debajo */
+	uint32_t *siguientes;
+
+	/* Palabra de futex y cantidad de hilos dormidos en obtener() */
+	int senialLibres;
+	int dormidos;
+
+	Paquete* paquete(uint32_t indice) const;
+	uint32_t indice(const Paquete *paquete) const;
+
+	/* Se invoca desde Paquete::liberar */
+	void devolver(Paquete *paquete);
+
+	PoolPaquetes(const PoolPaquetes&);
+	PoolPaquetes& operator=(const PoolPaquetes&);
+};
+
+}
+#endif
@@ -6,13 +6,442 @@
 #ifndef PROTOCOLO_H_
 #define PROTOCOLO_H_
 
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <stdint.h>
+#include <sys/uio.h>
+#include "VistaBuffer.h"
+
 namespace FWK_CS {
 
+/**
+ * @brief Interfaz de un protocolo de encuadre: cómo se delimita cada mensaje
+ * dentro del flujo de bytes de un socket
+ * @details Hay dos formas de usar un protocolo:
+ * @details Dinámica: a través de un puntero o referencia a Protocolo, para
+ * elegirlo en tiempo de ejecución. Cada mensaje paga una llamada virtual
+ * @details Estática: las clases ProtocoloLongitud, ProtocoloDelimitador y
+ * ProtocoloFijo tienen los mismos métodos pero no son virtuales, y se pasan
+ * como parámetro de las plantillas decodificarTramas y encuadrarTrama. El
+ * protocolo queda expandido en línea dentro del ciclo de envío o recepción.
+ * ProtocoloDinamico adapta cualquiera de ellas a la interfaz Protocolo
+ * @details Los protocolos no guardan estado entre mensajes, por lo que
+ * pueden compartirse entre hilos y conexiones
+ */
+
 class Protocolo {
 public:
+
+	/**
+	 * @brief Resultado de intentar decodificar una trama
+	 */
+	typedef enum {
+		TRAMA_COMPLETA,		///< Se decodificó una trama
+		TRAMA_INCOMPLETA,	///< Faltan bytes para completar la trama
+		TRAMA_INVALIDA		///< Los datos no respetan el protocolo
+	} t_resultado;
+
+	/**
+	 * @brief Trama decodificada. Las vistas apuntan a los datos recibidos,
+	 * sin copiarlos
+	 */
+	struct Trama {
+		/* Bytes de control previos a la carga (vacía si no hay) */
+		Com::VistaBuffer cabecera;
+		/* Datos del mensaje */
+		Com::VistaBuffer carga;
+		/* Bytes que ocupa la trama completa en el flujo, incluyendo los de
+		 * control */
+		size_t consumidos;
+	};
+
+	/**
+	 * @brief Tamaño máximo del prefijo que escribe Protocolo::escribirPrefijo
+	 */
+	static const size_t MAXIMO_PREFIJO = 64;
+
+	/**
+	 * @brief Tamaño máximo del sufijo que escribe Protocolo::escribirSufijo
+	 */
+	static const size_t MAXIMO_SUFIJO = 8;
+
+	/**
+	 * @brief Constructor
+	 */
 	Protocolo();
+
+	/**
+	 * @brief Método para decodificar la primera trama de los datos recibidos
+	 * @param datos Datos recibidos y no consumidos, comenzando por una trama
+	 * @param trama Donde se guarda la trama, si está completa
+	 * @return El resultado de la decodificación
+	 */
+	virtual t_resultado decodificar(const Com::VistaBuffer &datos,
+			Trama &trama) const = 0;
+
+	/**
+	 * @brief Método para consultar si una carga puede enviarse con el
+	 * protocolo (por ejemplo, si no contiene al delimitador)
+	 * @param carga Datos a enviar
+	 * @return <tt>true</tt> si puede enviarse
+	 */
+	virtual bool admiteCarga(const Com::VistaBuffer &carga) const = 0;
+
+	/**
+	 * @brief Método para escribir los bytes de control que van antes de la
+	 * carga
+	 * @param tamanioCarga Tamaño de la carga a enviar
+	 * @param destino Espacio de al menos Protocolo::MAXIMO_PREFIJO bytes
+	 * @return La cantidad de bytes escritos
+	 */
+	virtual size_t escribirPrefijo(size_t tamanioCarga,
+			Com::BufferTransmision::t_buffer *destino) const = 0;
+
+	/**
+	 * @brief Método para escribir los bytes de control que van después de
+	 * la carga
+	 * @param destino Espacio de al menos Protocolo::MAXIMO_SUFIJO bytes
+	 * @return La cantidad de bytes escritos
+	 */
+	virtual size_t escribirSufijo(
+			Com::BufferTransmision::t_buffer *destino) const = 0;
+
+	/**
+	 * @brief Destructor
+	 */
 	virtual ~Protocolo();
 };
 
+/**
+ * @brief Protocolo con una cabecera de tamaño fijo que incluye la longitud de
+ * la carga, como un entero de 32 bits en el orden de bytes de la red
+ * @details Con los valores por defecto, la cabecera es solo la longitud. Con
+ * <tt>ProtocoloLongitud(Paquete::TAMANIO_CABECERA,
+ * offsetof(Paquete::Cabecera, longitud))</tt> decodifica los mensajes
+ * enviados desde Paquete::getVista
+ */
+
+class ProtocoloLongitud {
+public:
+
+	/**
+	 * @brief Construye el protocolo
+	 * @param tamanioCabecera Tamaño de la cabecera, hasta
+	 * Protocolo::MAXIMO_PREFIJO bytes
+	 * @param posicionLongitud Posición de la longitud dentro de la cabecera
+	 * @param maximaCarga Longitud máxima aceptada. Una longitud mayor hace
+	 * inválida la trama, para no reservar memoria por datos corruptos
+	 * @throw std::invalid_argument La cabecera supera
+	 * Protocolo::MAXIMO_PREFIJO bytes o la longitud no entra en ella
+	 */
+	explicit ProtocoloLongitud(size_t tamanioCabecera = sizeof(uint32_t),
+			size_t posicionLongitud = 0, size_t maximaCarga = 1 << 24) :
+			tamanioCabecera(tamanioCabecera),
+			posicionLongitud(posicionLongitud), maximaCarga(maximaCarga) {
+		if (tamanioCabecera > Protocolo::MAXIMO_PREFIJO
+				|| tamanioCabecera < sizeof(uint32_t)
+				|| posicionLongitud > tamanioCabecera - sizeof(uint32_t)) {
+			throw std::invalid_argument("Cabecera de longitud invalida");
+		}
+	}
+
+	Protocolo::t_resultado decodificar(const Com::VistaBuffer &datos,
+			Protocolo::Trama &trama) const {
+		if (datos.getTamanio() < tamanioCabecera) {
+			return Protocolo::TRAMA_INCOMPLETA;
+		}
+		const Com::BufferTransmision::t_buffer *campo = datos.obtenerDatos()
+				+ posicionLongitud;
+		size_t longitud = ((size_t) (uint8_t) campo[0] << 24)
+				| ((size_t) (uint8_t) campo[1] << 16)
+				| ((size_t) (uint8_t) campo[2] << 8) | (size_t) (uint8_t) campo[3];
+		if (longitud > maximaCarga) {
+			return Protocolo::TRAMA_INVALIDA;
+		}
+		if (datos.getTamanio() - tamanioCabecera < longitud) {
+			return Protocolo::TRAMA_INCOMPLETA;
+		}
+		trama.cabecera = datos.subVista(0, tamanioCabecera);
+		trama.carga = datos.subVista(tamanioCabecera, longitud);
+		trama.consumidos = tamanioCabecera + longitud;
+		return Protocolo::TRAMA_COMPLETA;
+	}
+
+	bool admiteCarga(const Com::VistaBuffer &carga) const {
+		return (carga.getTamanio() <= maximaCarga);
+	}
+
+	size_t escribirPrefijo(size_t tamanioCarga,
+			Com::BufferTransmision::t_buffer *destino) const {
+		memset(destino, 0, tamanioCabecera);
+		Com::BufferTransmision::t_buffer *campo = destino + posicionLongitud;
+		campo[0] = (Com::BufferTransmision::t_buffer) (tamanioCarga >> 24);
+		campo[1] = (Com::BufferTransmision::t_buffer) (tamanioCarga >> 16);
+		campo[2] = (Com::BufferTransmision::t_buffer) (tamanioCarga >> 8);
+		campo[3] = (Com::BufferTransmision::t_buffer) tamanioCarga;
+		return tamanioCabecera;
+	}
+
+	size_t escribirSufijo(Com::BufferTransmision::t_buffer*) const {
+		return 0;
+	}
+
+private:
+
+	size_t tamanioCabecera;
+	size_t posicionLongitud;
+	size_t maximaCarga;
+};
+
+/**
+ * @brief Protocolo donde cada mensaje termina con una secuencia de bytes
+ * delimitadora (por ejemplo, un fin de línea). La carga no puede contener al
+ * delimitador
+ */
+
+class ProtocoloDelimitador {
+public:
+
+	/**
+	 * @brief Construye el protocolo
+	 * @param delimitador Secuencia delimitadora
+	 * @param tamanioDelimitador Tamaño del delimitador, entre 1 y
+	 * Protocolo::MAXIMO_SUFIJO bytes
+	 * @param maximaCarga Longitud máxima aceptada. Si se acumulan más datos
+	 * sin encontrar el delimitador, la trama es inválida
+	 * @throw std::invalid_argument El tamaño del delimitador está fuera de
+	 * rango
+	 */
+	explicit ProtocoloDelimitador(const char *delimitador = "\n",
+			size_t tamanioDelimitador = 1, size_t maximaCarga = 1 << 16) :
+			tamanioDelimitador(tamanioDelimitador), maximaCarga(maximaCarga) {
+		if (tamanioDelimitador == 0
+				|| tamanioDelimitador > Protocolo::MAXIMO_SUFIJO) {
+			throw std::invalid_argument("Tamanio de delimitador invalido");
+		}
+		memcpy(this->delimitador, delimitador, tamanioDelimitador);
+	}
+
+	Protocolo::t_resultado decodificar(const Com::VistaBuffer &datos,
+			Protocolo::Trama &trama) const {
+		size_t posicion = buscar(datos);
+		if (posicion == Com::VistaBuffer::NO_ENCONTRADO) {
+			return (datos.getTamanio() > maximaCarga + tamanioDelimitador) ?
+					Protocolo::TRAMA_INVALIDA : Protocolo::TRAMA_INCOMPLETA;
+		}
+		if (posicion > maximaCarga) {
+			return Protocolo::TRAMA_INVALIDA;
+		}
+		trama.cabecera = Com::VistaBuffer();
+		trama.carga = datos.subVista(0, posicion);
+		trama.consumidos = posicion + tamanioDelimitador;
+		return Protocolo::TRAMA_COMPLETA;
+	}
+
+	bool admiteCarga(const Com::VistaBuffer &carga) const {
+		return (carga.getTamanio() <= maximaCarga
+				&& buscar(carga) == Com::VistaBuffer::NO_ENCONTRADO);
+	}
+
+	size_t escribirPrefijo(size_t,
+			Com::BufferTransmision::t_buffer*) const {
+		return 0;
+	}
+
+	size_t escribirSufijo(Com::BufferTransmision::t_buffer *destino) const {
+		memcpy(destino, delimitador, tamanioDelimitador);
+		return tamanioDelimitador;
+	}
+
+private:
+
+	char delimitador[Protocolo::MAXIMO_SUFIJO];
+	size_t tamanioDelimitador;
+	size_t maximaCarga;
+
+	/* Posicion de la primera aparicion completa del delimitador */
+	size_t buscar(const Com::VistaBuffer &datos) const {
+		size_t desde = 0;
+		while ((desde = datos.buscar(delimitador[0], desde))
+				!= Com::VistaBuffer::NO_ENCONTRADO) {
+			if (datos.getTamanio() - desde < tamanioDelimitador) {
+				return Com::VistaBuffer::NO_ENCONTRADO;
+			}
+			if (memcmp(datos.obtenerDatos() + desde, delimitador,
+					tamanioDelimitador) == 0) {
+				return desde;
+			}
+			++desde;
+		}
+		return Com::VistaBuffer::NO_ENCONTRADO;
+	}
+};
+
+/**
+ * @brief Protocolo donde todos los mensajes tienen el mismo tamaño y no hay
+ * bytes de control
+ */
+
+class ProtocoloFijo {
+public:
+
+	/**
+	 * @brief Construye el protocolo
+	 * @param tamanio Tamaño de cada mensaje, mayor a cero
+	 * @throw std::invalid_argument El tamaño es cero
+	 */
+	explicit ProtocoloFijo(size_t tamanio) :
+			tamanio(tamanio) {
+		if (tamanio == 0) {
+			throw std::invalid_argument("Tamanio de mensaje nulo");
+		}
+	}
+
+	Protocolo::t_resultado decodificar(const Com::VistaBuffer &datos,
+			Protocolo::Trama &trama) const {
+		if (datos.getTamanio() < tamanio) {
+			return Protocolo::TRAMA_INCOMPLETA;
+		}
+		trama.cabecera = Com::VistaBuffer();
+		trama.carga = datos.subVista(0, tamanio);
+		trama.consumidos = tamanio;
+		return Protocolo::TRAMA_COMPLETA;
+	}
+
+	bool admiteCarga(const Com::VistaBuffer &carga) const {
+		return (carga.getTamanio() == tamanio);
+	}
+
+	size_t escribirPrefijo(size_t,
+			Com::BufferTransmision::t_buffer*) const {
+		return 0;
+	}
+
+	size_t escribirSufijo(Com::BufferTransmision::t_buffer*) const {
+		return 0;
+	}
+
+private:
+
+	size_t tamanio;
+};
+
+/**
+ * @brief Adaptador que expone un protocolo estático (ProtocoloLongitud,
+ * ProtocoloDelimitador, ProtocoloFijo u otro con los mismos métodos) a
+ * través de la interfaz Protocolo
+ */
+
+template<class Politica>
+class ProtocoloDinamico: public Protocolo {
+public:
+
+	/**
+	 * @brief Construye el adaptador
+	 * @param politica Protocolo a adaptar, que se copia
+	 */
+	explicit ProtocoloDinamico(const Politica &politica = Politica()) :
+			politica(politica) {
+	}
+
+	virtual t_resultado decodificar(const Com::VistaBuffer &datos,
+			Trama &trama) const {
+		return politica.decodificar(datos, trama);
+	}
+
+	virtual bool admiteCarga(const Com::VistaBuffer &carga) const {
+		return politica.admiteCarga(carga);
+	}
+
+	virtual size_t escribirPrefijo(size_t tamanioCarga,
+			Com::BufferTransmision::t_buffer *destino) const {
+		return politica.escribirPrefijo(tamanioCarga, destino);
+	}
+
+	virtual size_t escribirSufijo(
+			Com::BufferTransmision::t_buffer *destino) const {
+		return politica.escribirSufijo(destino);
+	}
+
+	/**
+	 * @brief Método para obtener el protocolo adaptado
+	 * @return El protocolo
+	 */
+	const Politica& getPolitica() const {
+		return politica;
+	}
+
+private:
+
+	Politica politica;
+};
+
+/**
+ * @brief Decodifica todas las tramas completas de @a datos y se las entrega
+ * a @a receptor, que debe tener el método
+ * <tt>void tramaRecibida(const Protocolo::Trama&)</tt>
+ * @details Con un protocolo estático como @a Politica, la decodificación
+ * queda expandida en línea; con Protocolo, usa la interfaz virtual
+ * @param protocolo Protocolo con el que decodificar
+ * @param datos Datos recibidos y no consumidos
+ * @param receptor Destino de las tramas
+ * @param consumidos Donde se guarda la cantidad de bytes de las tramas
+ * entregadas, que pueden descartarse
+ * @return Protocolo::TRAMA_INCOMPLETA si los datos restantes no completan
+ * una trama, o Protocolo::TRAMA_INVALIDA si no respetan el protocolo (en
+ * ese caso, la conexión debería cerrarse)
+ */
+template<class Politica, class Receptor>
+Protocolo::t_resultado decodificarTramas(const Politica &protocolo,
+		const Com::VistaBuffer &datos, Receptor &receptor, size_t &consumidos) {
+	consumidos = 0;
+	Protocolo::Trama trama;
+	Protocolo::t_resultado resultado;
+	while ((resultado = protocolo.decodificar(
+			datos.subVista(consumidos, datos.getTamanio() - consumidos), trama))
+			== Protocolo::TRAMA_COMPLETA) {
+		receptor.tramaRecibida(trama);
+		consumidos += trama.consumidos;
+	}
+	return resultado;
+}
+
+/**
+ * @brief Arma las regiones de una trama para enviarla con un solo writev o
+ * sendmsg, sin copiar la carga
+ * @param protocolo Protocolo con el que encuadrar
+ * @param carga Datos a enviar
+ * @param prefijo Espacio de Protocolo::MAXIMO_PREFIJO bytes para el prefijo
+ * @param sufijo Espacio de Protocolo::MAXIMO_SUFIJO bytes para el sufijo
+ * @param regiones Arreglo de 3 regiones donde se arma la trama
+ * @return La cantidad de regiones usadas, 0 si el protocolo no admite la
+ * carga
+ */
+template<class Politica>
+int encuadrarTrama(const Politica &protocolo, const Com::VistaBuffer &carga,
+		Com::BufferTransmision::t_buffer *prefijo,
+		Com::BufferTransmision::t_buffer *sufijo, struct iovec *regiones) {
+	if (!protocolo.admiteCarga(carga)) {
+		return 0;
+	}
+	int cantidad = 0;
+	size_t tamanio = protocolo.escribirPrefijo(carga.getTamanio(), prefijo);
+	if (tamanio > 0) {
+		regiones[cantidad].iov_base = prefijo;
+		regiones[cantidad++].iov_len = tamanio;
+	}
+	if (!carga.estaVacia()) {
+		regiones[cantidad].iov_base = (void*) carga.obtenerDatos();
+		regiones[cantidad++].iov_len = carga.getTamanio();
+	}
+	tamanio = protocolo.escribirSufijo(sufijo);
+	if (tamanio > 0) {
+		regiones[cantidad].iov_base = sufijo;
+		regiones[cantidad++].iov_len = tamanio;
+	}
+	return cantidad;
+}
+
 }
 #endif
@@ -0,0 +1,132 @@
+/******************************
+ *  Archivo: Protocolo_bench.cpp
+ *	Autor:   Martín Lucero
+ *****************************/
+#include "Protocolo.h"
+#include "Bench.h"
+#include <cstdio>
+#include <cstring>
+#include <time.h>
+#include <vector>
+
+/* Encuadrar y decodificar tramas chicas con cada protocolo, expandido en
+ * línea como política estática o a través de la interfaz virtual */
+
+#define TRAMAS 100000
+#define VUELTAS 10
+#define TAMANIO_CARGA 16
+
+namespace FWK_CS {
+
+static void reportar(const char *protocolo, const char *prueba,
+		double segundos) {
+	double tramas = (double) TRAMAS * VUELTAS;
+	printf("%-12s %-20s %12.0f tramas/s  %6.1f ns/trama\n", protocolo, prueba,
+			tramas / segundos, segundos * 1e9 / tramas);
+}
+
+struct ContadorTramas {
+	size_t tramas;
+	size_t bytes;
+	ContadorTramas() :
+			tramas(0), bytes(0) {
+	}
+	void tramaRecibida(const Protocolo::Trama &trama) {
+		++tramas;
+		bytes += trama.carga.getTamanio();
+	}
+};
+
+template<class Politica>
+static size_t medirEncuadre(const Politica &protocolo,
+		const Com::VistaBuffer &carga) {
+	Com::BufferTransmision::t_buffer prefijo[Protocolo::MAXIMO_PREFIJO];
+	Com::BufferTransmision::t_buffer sufijo[Protocolo::MAXIMO_SUFIJO];
+	struct iovec regiones[3];
+	size_t bytes = 0;
+	for (int vuelta = 0; vuelta < VUELTAS; ++vuelta) {
+		for (int i = 0; i < TRAMAS; ++i) {
+			int cantidad = encuadrarTrama(protocolo, carga, prefijo, sufijo,
+					regiones);
+			for (int r = 0; r < cantidad; ++r) {
+				bytes += regiones[r].iov_len;
+			}
+		}
+	}
+	return bytes;
+}
+
+template<class Politica>
+static size_t medirDecodificacion(const Politica &protocolo,
+		const Com::VistaBuffer &flujo) {
+	ContadorTramas contador;
+	for (int vuelta = 0; vuelta < VUELTAS; ++vuelta) {
+		size_t consumidos;
+		decodificarTramas(protocolo, flujo, contador, consumidos);
+	}
+	return contador.tramas;
+}
+
+template<class Politica>
+void benchProtocolo(const char *nombre, const Politica &politica) {
+	Com::BufferTransmision::t_buffer datos[TAMANIO_CARGA];
+	memset(datos, 'x', sizeof(datos));
+	Com::VistaBuffer carga(datos, sizeof(datos));
+
+	/* El flujo recibido: TRAMAS tramas consecutivas */
+	std::vector<Com::BufferTransmision::t_buffer> flujo;
+	Com::BufferTransmision::t_buffer prefijo[Protocolo::MAXIMO_PREFIJO];
+	Com::BufferTransmision::t_buffer sufijo[Protocolo::MAXIMO_SUFIJO];
+	struct iovec regiones[3];
+	for (int i = 0; i < TRAMAS; ++i) {
+		int cantidad = encuadrarTrama(politica, carga, prefijo, sufijo,
+				regiones);
+		for (int r = 0; r < cantidad; ++r) {
+			const Com::BufferTransmision::t_buffer *inicio =
+					(const Com::BufferTransmision::t_buffer*) regiones[r].iov_base;
+			flujo.insert(flujo.end(), inicio, inicio + regiones[r].iov_len);
+		}
+	}
+	Com::VistaBuffer vistaFlujo(&flujo[0], flujo.size());
+
+	/* El puntero volatil impide que el compilador conozca el tipo dinámico
+	 * y resuelva las llamadas virtuales en tiempo de compilación */
+	ProtocoloDinamico<Politica> adaptador(politica);
+	const Protocolo * volatile dinamico = &adaptador;
+
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	size_t conPolitica = medirEncuadre(politica, carga);
+	reportar(nombre, "encuadrar estatico", PThread::segundosDesde(inicio));
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	size_t conInterfaz = medirEncuadre(*dinamico, carga);
+	reportar(nombre, "encuadrar virtual", PThread::segundosDesde(inicio));
+	if (conPolitica != conInterfaz) {
+		printf("%s: encuadres distintos\n", nombre);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	conPolitica = medirDecodificacion(politica, vistaFlujo);
+	reportar(nombre, "decodificar estatico", PThread::segundosDesde(inicio));
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	conInterfaz = medirDecodificacion(*dinamico, vistaFlujo);
+	reportar(nombre, "decodificar virtual", PThread::segundosDesde(inicio));
+	if (conPolitica != conInterfaz
+			|| conPolitica != (size_t) TRAMAS * VUELTAS) {
+		printf("%s: decodificaciones distintas\n", nombre);
+	}
+}
+
+}
+
+#ifdef PROTOCOLO_BENCH
+int main() {
+	printf("%d tramas de %d bytes de carga, %d vueltas\n", TRAMAS,
+			TAMANIO_CARGA, VUELTAS);
+	FWK_CS::benchProtocolo("longitud", FWK_CS::ProtocoloLongitud());
+	FWK_CS::benchProtocolo("delimitador",
+			FWK_CS::ProtocoloDelimitador("\r\n", 2));
+	FWK_CS::benchProtocolo("fijo", FWK_CS::ProtocoloFijo(TAMANIO_CARGA));
+	return 0;
+}
+#endif
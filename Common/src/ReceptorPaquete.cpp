@@ -3,13 +3,201 @@
  *	Autor:   Martín Lucero
  *****************************/
 #include "ReceptorPaquete.h"
+#include "ColaPaquete.h"
+#include "ExcepcionesSocket.h"
+#include "Paquete.h"
+#include "PoolPaquetes.h"
+#include <cstddef>
+#include <cstring>
+
+#define NOMBRE_HILO "receptor"
 
 namespace FWK_CS {
 
-ReceptorPaquete::ReceptorPaquete() {
+ReceptorPaquete::ReceptorPaquete(Com::SocketTCP_IP &socket, PoolPaquetes &pool,
+		ColaPaquete &destino, const Protocolo *protocolo, size_t tamanioBuffer,
+		size_t maximoLote, bool cerrarDestino) :
+		socket(socket), pool(pool), destino(destino), protocolo(protocolo),
+		nativo(Paquete::TAMANIO_CABECERA, offsetof(Paquete::Cabecera, longitud),
+				pool.getCapacidad()), cerrarDestino(cerrarDestino),
+		buffer(tamanioBuffer, true), hilo(*this) {
+	auxiliar = buffer.estaDobleMapeado() ?
+			NULL : new Com::BufferTransmision::t_buffer[buffer.getCapacidadTotal()];
+	this->maximoLote = (maximoLote > 0) ? maximoLote : 1;
+	lote = new Paquete*[this->maximoLote];
+	enLote = 0;
+	conexion = 0;
+	tramaInvalida = false;
+	iniciado = false;
+	paquetesRecibidos = 0;
+	lotesEntregados = 0;
+	lecturas = 0;
+	error = false;
+}
+
+void ReceptorPaquete::setConexion(size_t conexion) {
+	this->conexion = conexion;
+}
+
+void ReceptorPaquete::iniciar() {
+	hilo.setNombre(NOMBRE_HILO);
+	hilo.iniciar();
+	iniciado = true;
+}
+
+void ReceptorPaquete::esperar() {
+	if (iniciado) {
+		void *retorno;
+		POSIX::Thread::esperarThread(hilo, retorno);
+		iniciado = false;
+	}
+}
+
+bool ReceptorPaquete::tuvoError() const {
+	return __atomic_load_n(&error, __ATOMIC_ACQUIRE);
+}
+
+size_t ReceptorPaquete::getPaquetesRecibidos() const {
+	return __atomic_load_n(&paquetesRecibidos, __ATOMIC_RELAXED);
+}
+
+size_t ReceptorPaquete::getLotesEntregados() const {
+	return __atomic_load_n(&lotesEntregados, __ATOMIC_RELAXED);
+}
+
+size_t ReceptorPaquete::getLecturas() const {
+	return __atomic_load_n(&lecturas, __ATOMIC_RELAXED);
 }
 
 ReceptorPaquete::~ReceptorPaquete() {
+	esperar();
+	delete[] lote;
+	delete[] auxiliar;
+}
+
+void ReceptorPaquete::ejecutar() {
+	bool conError = false;
+	try {
+		while (!tramaInvalida) {
+			socket.recibir(buffer);
+			__atomic_add_fetch(&lecturas, 1, __ATOMIC_RELAXED);
+			procesar();
+			entregarLote();
+			if (buffer.estaLleno()) {
+				/* Una trama que no entra en el buffer nunca se completa */
+				tramaInvalida = true;
+			}
+		}
+		conError = true;
+	}
+	catch (Com::RecepcionExcepcion &e) {
+		conError = (e.obtenerCodigoError()
+				!= Com::RecepcionExcepcion::usuario_desconectado);
+	}
+	catch (Com::SocketExcepcion&) {
+		conError = true;
+	}
+	entregarLote();
+	__atomic_store_n(&error, conError, __ATOMIC_RELEASE);
+	if (cerrarDestino) {
+		destino.cerrar();
+	}
+}
+
+void ReceptorPaquete::procesar() {
+	while (!tramaInvalida) {
+		Com::VistaBuffer vista = buffer.obtenerVista();
+		size_t consumidos;
+		Protocolo::t_resultado resultado =
+				(protocolo == NULL) ?
+						decodificarTramas(nativo, vista, *this, consumidos) :
+						decodificarTramas(*protocolo, vista, *this,
+								consumidos);
+		buffer.descartarDatos(consumidos);
+		if (resultado == Protocolo::TRAMA_INVALIDA) {
+			tramaInvalida = true;
+		}
+		/* Si la vista no cubre todos los datos, la trama pendiente da la
+		 * vuelta al final del buffer y puede estar completa */
+		if (tramaInvalida
+				|| vista.getTamanio() - consumidos
+						== buffer.getTamanioOcupado() || !decodificarPartida()) {
+			return;
+		}
+	}
+}
+
+bool ReceptorPaquete::decodificarPartida() {
+	size_t ocupado = buffer.getTamanioOcupado();
+	buffer.copiarDatos(auxiliar, ocupado);
+	Com::VistaBuffer vista(auxiliar, ocupado);
+	Protocolo::Trama trama;
+	Protocolo::t_resultado resultado =
+			(protocolo == NULL) ?
+					nativo.decodificar(vista, trama) :
+					protocolo->decodificar(vista, trama);
+	if (resultado == Protocolo::TRAMA_INVALIDA) {
+		tramaInvalida = true;
+	}
+	if (resultado != Protocolo::TRAMA_COMPLETA) {
+		return false;
+	}
+	tramaRecibida(trama);
+	buffer.descartarDatos(trama.consumidos);
+	return true;
+}
+
+void ReceptorPaquete::tramaRecibida(const Protocolo::Trama &trama) {
+	if (tramaInvalida) {
+		return;
+	}
+	Paquete *paquete = pool.intentarObtener();
+	if (paquete == NULL) {
+		/* Los paquetes del lote en curso no pueden volver al pool hasta ser
+		 * entregados */
+		entregarLote();
+		paquete = pool.obtener();
+	}
+	if (protocolo == NULL) {
+		memcpy(paquete->obtenerCabecera(), trama.cabecera.obtenerDatos(),
+				Paquete::TAMANIO_CABECERA);
+		memcpy(paquete->prepararCarga(), trama.carga.obtenerDatos(),
+				trama.carga.getTamanio());
+	}
+	else if (!paquete->asignarCarga(trama.carga.obtenerDatos(),
+			trama.carga.getTamanio())) {
+		paquete->liberar();
+		tramaInvalida = true;
+		return;
+	}
+	paquete->setConexion(conexion);
+	lote[enLote++] = paquete;
+	if (enLote == maximoLote) {
+		entregarLote();
+	}
+}
+
+void ReceptorPaquete::entregarLote() {
+	if (enLote == 0) {
+		return;
+	}
+	size_t entregados = destino.insertarLote(lote, enLote);
+	/* Si la cola se cerro, los paquetes restantes se descartan */
+	for (size_t i = entregados; i < enLote; ++i) {
+		lote[i]->liberar();
+	}
+	__atomic_add_fetch(&paquetesRecibidos, entregados, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&lotesEntregados, 1, __ATOMIC_RELAXED);
+	enLote = 0;
+}
+
+ReceptorPaquete::Hilo::Hilo(ReceptorPaquete &receptor) :
+		receptor(receptor) {
+}
+
+void* ReceptorPaquete::Hilo::ejecutar(void*) {
+	receptor.ejecutar();
+	return NULL;
 }
 
 }
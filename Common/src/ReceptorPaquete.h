@@ -6,12 +6,161 @@
 #ifndef RECEPTORPAQUETE_H_
 #define RECEPTORPAQUETE_H_
 
+#include <cstddef>
+#include "BufferCircular.h"
+#include "Protocolo.h"
+#include "SocketTCP_IP.h"
+#include "Thread.h"
+
 namespace FWK_CS {
 
+class ColaPaquete;
+class Paquete;
+class PoolPaquetes;
+
+/**
+ * @brief Lado de entrada de una conexión: un hilo propio lee del socket en
+ * bloques grandes sobre un Com::BufferCircular, separa las tramas con el
+ * protocolo configurado, las copia en paquetes de un PoolPaquetes y los
+ * entrega a una ColaPaquete de a lotes, de modo que cada despertar del
+ * consumidor procese muchos paquetes
+ * @details Sin protocolo, las tramas son paquetes completos en el formato de
+ * Paquete::getVista (los que envía un EmisorPaquete), y se conserva la
+ * cabecera. Con otro protocolo, cada trama es la carga de un paquete con la
+ * cabecera en cero
+ * @details Un lote se entrega al llenarse y al terminar de procesar cada
+ * lectura, por lo que un paquete no espera más que la lectura en la que
+ * llegó
+ * @details El hilo termina al cortarse la conexión, si los datos no respetan
+ * el protocolo o si se cancela el token del socket (ver
+ * Com::SocketTCP_IP::setTokenCancelacion). Al terminar, si así se indicó,
+ * cierra la cola de destino
+ */
+
 class ReceptorPaquete {
 public:
-	ReceptorPaquete();
+
+	/**
+	 * @brief Construye el receptor, sin iniciar su hilo
+	 * @param socket Socket conectado del que recibir. Debe seguir vivo
+	 * mientras el receptor esté iniciado
+	 * @param pool Pool del que se obtienen los paquetes. Una trama con una
+	 * carga mayor a la capacidad de sus paquetes es inválida
+	 * @param destino Cola donde se entregan los paquetes
+	 * @param protocolo Protocolo con el que separar las tramas, o
+	 * <tt>NULL</tt> para recibir paquetes completos. Debe seguir vivo
+	 * mientras el receptor esté iniciado
+	 * @param tamanioBuffer Capacidad del buffer de recepción. Debe ser mayor
+	 * a la trama más larga
+	 * @param maximoLote Cantidad máxima de paquetes por lote
+	 * @param cerrarDestino Si se cierra la cola de destino al terminar.
+	 * Debe ser <tt>false</tt> si la cola es compartida con otras conexiones,
+	 * como las de ManejadorEventoRecv::getCola
+	 */
+	ReceptorPaquete(Com::SocketTCP_IP &socket, PoolPaquetes &pool,
+			ColaPaquete &destino, const Protocolo *protocolo = NULL,
+			size_t tamanioBuffer = 1 << 16, size_t maximoLote = 64,
+			bool cerrarDestino = true);
+
+	/**
+	 * @brief Método para asignar el identificador de conexión que se guarda
+	 * en cada paquete recibido (ver Paquete::getConexion)
+	 * @pre El hilo no fue iniciado
+	 * @param conexion El identificador
+	 */
+	void setConexion(size_t conexion);
+
+	/**
+	 * @brief Método que inicia el hilo receptor
+	 * @throw MultiHiloExcepcion Error al iniciar el hilo
+	 */
+	void iniciar() /* throw (MultiHiloExcepcion) */;
+
+	/**
+	 * @brief Método que espera a que termine el hilo receptor
+	 */
+	void esperar();
+
+	/**
+	 * @brief Método para consultar si el hilo terminó por un error (de
+	 * recepción o de protocolo), y no por el corte de la conexión
+	 * @return <tt>true</tt> si terminó por un error
+	 */
+	bool tuvoError() const;
+
+	/**
+	 * @brief Método para obtener la cantidad de paquetes entregados
+	 * @return La cantidad de paquetes
+	 */
+	size_t getPaquetesRecibidos() const;
+
+	/**
+	 * @brief Método para obtener la cantidad de lotes entregados
+	 * @return La cantidad de lotes
+	 */
+	size_t getLotesEntregados() const;
+
+	/**
+	 * @brief Método para obtener la cantidad de lecturas del socket
+	 * @return La cantidad de lecturas
+	 */
+	size_t getLecturas() const;
+
+	/**
+	 * @brief Destructor
+	 * @pre El hilo no se está ejecutando (ver ReceptorPaquete::esperar)
+	 */
 	virtual ~ReceptorPaquete();
+
+private:
+
+	class Hilo: public POSIX::Thread {
+	public:
+		explicit Hilo(ReceptorPaquete &receptor);
+	protected:
+		void* ejecutar(void *parametro);
+	private:
+		ReceptorPaquete &receptor;
+	};
+
+	template<class Politica, class Receptor>
+	friend Protocolo::t_resultado decodificarTramas(const Politica&,
+			const Com::VistaBuffer&, Receptor&, size_t&);
+
+	Com::SocketTCP_IP &socket;
+	PoolPaquetes &pool;
+	ColaPaquete &destino;
+	const Protocolo *protocolo;
+	/* Protocolo de los paquetes completos */
+	ProtocoloLongitud nativo;
+	bool cerrarDestino;
+	size_t conexion;
+
+	Com::BufferCircular buffer;
+	/* Copia contigua de una trama que da la vuelta al final del buffer, si
+	 * no esta doblemente mapeado */
+	Com::BufferTransmision::t_buffer *auxiliar;
+	Paquete **lote;
+	size_t maximoLote;
+	size_t enLote;
+	bool tramaInvalida;
+
+	Hilo hilo;
+	bool iniciado;
+
+	size_t paquetesRecibidos;
+	size_t lotesEntregados;
+	size_t lecturas;
+	bool error;
+
+	void ejecutar();
+	void procesar();
+	bool decodificarPartida();
+	void tramaRecibida(const Protocolo::Trama &trama);
+	void entregarLote();
+
+	ReceptorPaquete(const ReceptorPaquete&);
+	ReceptorPaquete& operator=(const ReceptorPaquete&);
 };
 
 }
@@ -0,0 +1,179 @@
+/******************************
+ *  Archivo: ReceptorPaquete_bench.cpp
+ *	Autor:   Martín Lucero
+ *****************************/
+#include "ReceptorPaquete.h"
+#include "ColaPaquete.h"
+#include "Paquete.h"
+#include "PoolPaquetes.h"
+#include "SocketCliente.h"
+#include "SocketServidor.h"
+#include "Bench.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <time.h>
+#include <vector>
+
+/* Recepción de paquetes chicos: con el ReceptorPaquete, que lee en bloques
+ * grandes y entrega de a lotes, frente a un recibirConProtocolo por mensaje */
+
+#define PAQUETES 300000
+#define TAMANIO_CARGA 16
+#define PUERTO_BENCH 40490
+/* Tamaño de cada envío del flujo pregenerado */
+#define TAMANIO_ENVIO (1 << 16)
+
+namespace FWK_CS {
+
+typedef std::vector<Com::BufferTransmision::t_buffer> t_flujo;
+
+static void reportar(const char *prueba, double segundos,
+		double paquetesPorLectura, double paquetesPorDespertar) {
+	printf("%-22s %10.0f paq/s  %7.1f paq/lectura  %7.1f paq/despertar\n",
+			prueba, PAQUETES / segundos, paquetesPorLectura,
+			paquetesPorDespertar);
+}
+
+/* Envía un flujo pregenerado en bloques grandes y corta la conexión, para
+ * que el costo medido sea el del lado receptor */
+class Emisor: public POSIX::Thread {
+public:
+	Emisor(Com::SocketCliente &cliente, const t_flujo &flujo) :
+			cliente(cliente), flujo(flujo) {
+	}
+protected:
+	void* ejecutar(void*) {
+		size_t enviados = 0;
+		while (enviados < flujo.size()) {
+			size_t tamanio = std::min<size_t>(TAMANIO_ENVIO,
+					flujo.size() - enviados);
+			enviados += cliente.enviar(
+					Com::VistaBuffer(&flujo[enviados], tamanio));
+		}
+		cliente.cortarComunicacion(Com::Socket::cortar_ambos);
+		return NULL;
+	}
+private:
+	Com::SocketCliente &cliente;
+	const t_flujo &flujo;
+};
+
+static void agregar(t_flujo &flujo, const void *datos, size_t tamanio) {
+	const Com::BufferTransmision::t_buffer *inicio =
+			static_cast<const Com::BufferTransmision::t_buffer*>(datos);
+	flujo.insert(flujo.end(), inicio, inicio + tamanio);
+}
+
+/* Paquetes completos, en el formato de Paquete::getVista */
+static void generarPaquetes(t_flujo &flujo) {
+	const char carga[TAMANIO_CARGA] = "0123456789abcde";
+	Paquete *paquete = Paquete::crear(TAMANIO_CARGA);
+	paquete->setTipo(1);
+	paquete->asignarCarga(carga, sizeof(carga));
+	for (uint32_t i = 0; i < PAQUETES; ++i) {
+		paquete->setSecuencia(i);
+		Com::VistaBuffer vista = paquete->getVista();
+		agregar(flujo, vista.obtenerDatos(), vista.getTamanio());
+	}
+	paquete->liberar();
+}
+
+/* Mensajes con el prefijo de longitud de SocketTCP_IP::enviarConProtocolo */
+static void generarMensajes(t_flujo &flujo) {
+	const char carga[TAMANIO_CARGA] = "0123456789abcde";
+	size_t longitud = sizeof(carga);
+	for (int i = 0; i < PAQUETES; ++i) {
+		agregar(flujo, &longitud, sizeof(longitud));
+		agregar(flujo, carga, sizeof(carga));
+	}
+}
+
+static Com::SocketCliente* conectar(Com::SocketServidor &servidor,
+		Com::SocketCliente &cliente) {
+	cliente.crear();
+	cliente.conectar();
+	return servidor.aceptarClientes();
+}
+
+void benchReceptorPaquete(Com::SocketServidor &servidor, in_port_t puerto) {
+	t_flujo flujo;
+	generarPaquetes(flujo);
+	Com::SocketCliente cliente(puerto, "127.0.0.1");
+	Com::SocketCliente *conexion = conectar(servidor, cliente);
+	PoolPaquetes pool(2048, TAMANIO_CARGA);
+	ColaPaquete cola(1024);
+	ReceptorPaquete receptor(*conexion, pool, cola);
+	Emisor emisor(cliente, flujo);
+
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	receptor.iniciar();
+	emisor.iniciar();
+	Paquete *lote[64];
+	size_t cantidad, paquetes = 0, despertares = 0;
+	while ((cantidad = cola.extraerLote(lote, 64)) > 0) {
+		++despertares;
+		for (size_t i = 0; i < cantidad; ++i) {
+			lote[i]->liberar();
+		}
+		paquetes += cantidad;
+	}
+	double segundos = PThread::segundosDesde(inicio);
+	receptor.esperar();
+	void *retorno;
+	POSIX::Thread::esperarThread(emisor, retorno);
+	if (paquetes != PAQUETES || receptor.tuvoError()) {
+		printf("receptor: se recibieron %lu paquetes\n",
+				(unsigned long) paquetes);
+	}
+	reportar("receptor de paquetes", segundos,
+			(double) receptor.getPaquetesRecibidos() / receptor.getLecturas(),
+			(double) paquetes / despertares);
+	conexion->cerrar();
+	delete conexion;
+	cliente.cerrar();
+}
+
+void benchRecibirConProtocolo(Com::SocketServidor &servidor,
+		in_port_t puerto) {
+	t_flujo flujo;
+	generarMensajes(flujo);
+	Com::SocketCliente cliente(puerto, "127.0.0.1");
+	Com::SocketCliente *conexion = conectar(servidor, cliente);
+	Emisor emisor(cliente, flujo);
+
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	emisor.iniciar();
+	Com::BufferTransmision buffer(TAMANIO_CARGA);
+	for (int i = 0; i < PAQUETES; ++i) {
+		conexion->recibirConProtocolo(buffer);
+	}
+	double segundos = PThread::segundosDesde(inicio);
+	void *retorno;
+	POSIX::Thread::esperarThread(emisor, retorno);
+	/* Dos lecturas por mensaje, la longitud y la carga, y cada mensaje lo
+	 * procesa el mismo hilo que lo lee */
+	reportar("recibirConProtocolo", segundos, 0.5, 1.0);
+	conexion->cerrar();
+	delete conexion;
+	cliente.cerrar();
+}
+
+}
+
+#ifdef RECEPTORPAQUETE_BENCH
+int main(int argc, char **argv) {
+	in_port_t puerto = (in_port_t) ((argc > 1) ? atoi(argv[1]) : PUERTO_BENCH);
+	Com::SocketServidor servidor(puerto);
+	servidor.crear();
+	servidor.enlazarServidor();
+	servidor.escucharClientes(4);
+	printf("%d paquetes de %d bytes de carga\n", PAQUETES, TAMANIO_CARGA);
+	FWK_CS::benchReceptorPaquete(servidor, puerto);
+	FWK_CS::benchRecibirConProtocolo(servidor, puerto);
+	servidor.cerrar();
+	return 0;
+}
+#endif
@@ -0,0 +1,52 @@
+#include "Barrera.h"
+#include "Futex.h"
+#include <climits>
+
+/* Iteraciones de espera activa antes de dormir en el futex */
+#define MAX_GIROS 100
+
+namespace PThread {
+
+Barrera::Barrera(int participantes) {
+	this->participantes = (participantes > 0) ? participantes : 1;
+	restantes = this->participantes;
+	fase = 0;
+	dormidos = 0;
+}
+
+bool Barrera::esperar() {
+	/* La fase se lee antes de anotarse: no puede avanzar hasta que este hilo
+	 * llegue */
+	int actual = __atomic_load_n(&fase, __ATOMIC_ACQUIRE);
+	if (__atomic_sub_fetch(&restantes, 1, __ATOMIC_ACQ_REL) == 0) {
+		/* Se repone la cuenta antes de publicar la nueva fase, para que
+		 * quienes pasen a la siguiente la encuentren completa */
+		__atomic_store_n(&restantes, participantes, __ATOMIC_RELAXED);
+		__atomic_add_fetch(&fase, 1, __ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&dormidos, __ATOMIC_SEQ_CST) > 0) {
+			futexDespertar(&fase, INT_MAX);
+		}
+		return true;
+	}
+
+	for (int giros = 0; giros < MAX_GIROS; ++giros) {
+		if (__atomic_load_n(&fase, __ATOMIC_ACQUIRE) != actual) {
+			return false;
+		}
+		pausaCPU();
+	}
+	__atomic_add_fetch(&dormidos, 1, __ATOMIC_SEQ_CST);
+	while (__atomic_load_n(&fase, __ATOMIC_ACQUIRE) == actual) {
+		futexEsperar(&fase, actual);
+	}
+	__atomic_sub_fetch(&dormidos, 1, __ATOMIC_RELAXED);
+	return false;
+}
+
+int Barrera::getParticipantes() const {
+	return participantes;
+}
+
+Barrera::~Barrera() {
+}
+}
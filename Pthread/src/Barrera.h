@@ -0,0 +1,60 @@
+#ifndef BARRERA_H_
+#define BARRERA_H_
+
+namespace PThread {
+
+/**
+ * @brief Barrera reutilizable implementada directamente sobre un futex. Los
+ * hilos que llegan esperan hasta que llegue el último participante; entonces
+ * se liberan todos y la barrera queda lista para la fase siguiente
+ * @details Útil para pasos de división y unión (fork-join) que se repiten.
+ * La espera es activa por una cantidad acotada de iteraciones antes de
+ * dormir en el kernel
+ */
+
+class Barrera {
+public:
+
+	/**
+	 * @brief Instancia una barrera
+	 * @param participantes Cantidad de hilos que deben llegar en cada fase,
+	 * mayor a cero
+	 */
+	explicit Barrera(int participantes);
+
+	/**
+	 * @brief Método para llegar a la barrera y esperar al resto de los
+	 * participantes de la fase
+	 * @return <tt>true</tt> para el último hilo en llegar, que puede usarse
+	 * para realizar trabajo de una sola vez por fase
+	 * @return <tt>false</tt> para el resto
+	 */
+	bool esperar();
+
+	/**
+	 * @brief Método para obtener la cantidad de participantes
+	 * @return La cantidad
+	 */
+	int getParticipantes() const;
+
+	/**
+	 * @brief Destructor
+	 * @pre No hay hilos esperando
+	 */
+	~Barrera();
+
+private:
+
+	int participantes;
+	/* Participantes que faltan llegar en la fase actual */
+	int restantes;
+	/* Palabra del futex: numero de fase */
+	int fase;
+	int dormidos;
+
+	Barrera(const Barrera&);
+	Barrera& operator=(const Barrera&);
+};
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <cstddef>
+#include <time.h>
+#include <vector>
+
+/* Utilidades de medición compartidas por los programas *_bench.cpp */
+
+namespace PThread {
+
+/**
+ * @brief Instante actual del reloj monotónico, en nanosegundos
+ */
+inline long long nanosegundosAhora() {
+	struct timespec ahora;
+	clock_gettime(CLOCK_MONOTONIC, &ahora);
+	return (long long) ahora.tv_sec * 1000000000LL + ahora.tv_nsec;
+}
+
+/**
+ * @brief Segundos transcurridos desde @a inicio, tomado con
+ * clock_gettime(CLOCK_MONOTONIC)
+ */
+inline double segundosDesde(const struct timespec &inicio) {
+	struct timespec fin;
+	clock_gettime(CLOCK_MONOTONIC, &fin);
+	return (double) (fin.tv_sec - inicio.tv_sec)
+			+ (double) (fin.tv_nsec - inicio.tv_nsec) / 1e9;
+}
+
+/**
+ * @brief Milisegundos transcurridos desde @a inicio, tomado con
+ * clock_gettime(CLOCK_MONOTONIC)
+ */
+inline double milisegundosDesde(const struct timespec &inicio) {
+	return segundosDesde(inicio) * 1e3;
+}
+
+/**
+ * @brief Percentil de una serie de mediciones
+ * @pre La serie está ordenada de menor a mayor y no está vacía
+ * @param ordenadas Las mediciones
+ * @param porcentaje Percentil buscado, de 0 a 100
+ */
+inline long long percentil(const std::vector<long long> &ordenadas,
+		size_t porcentaje) {
+	size_t indice = ordenadas.size() * porcentaje / 100;
+	return ordenadas[(indice < ordenadas.size()) ? indice : ordenadas.size() - 1];
+}
+
+}
+
+#endif
@@ -0,0 +1,102 @@
+#include "ColaRobo.h"
+
+namespace POSIX {
+
+ColaRobo::ColaRobo(size_t capacidadInicial) {
+	superior = 0;
+	inferior = 0;
+	arreglo = crearArreglo(capacidadInicial);
+}
+
+void ColaRobo::insertar(Tarea *tarea) {
+	long inf = __atomic_load_n(&inferior, __ATOMIC_RELAXED);
+	long sup = __atomic_load_n(&superior, __ATOMIC_ACQUIRE);
+	Arreglo *arr = __atomic_load_n(&arreglo, __ATOMIC_RELAXED);
+	if ((size_t) (inf - sup) > arr->mascara) {
+		arr = agrandar(arr, sup, inf);
+	}
+	__atomic_store_n(&arr->tareas[inf & arr->mascara], tarea,
+			__ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	__atomic_store_n(&inferior, inf + 1, __ATOMIC_RELAXED);
+}
+
+Tarea* ColaRobo::extraer() {
+	long inf = __atomic_load_n(&inferior, __ATOMIC_RELAXED) - 1;
+	Arreglo *arr = __atomic_load_n(&arreglo, __ATOMIC_RELAXED);
+	__atomic_store_n(&inferior, inf, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	long sup = __atomic_load_n(&superior, __ATOMIC_RELAXED);
+
+	if (sup > inf) {
+		/* Vacia */
+		__atomic_store_n(&inferior, inf + 1, __ATOMIC_RELAXED);
+		return NULL;
+	}
+	Tarea *tarea = __atomic_load_n(&arr->tareas[inf & arr->mascara],
+			__ATOMIC_RELAXED);
+	if (sup == inf) {
+		/* Ultima tarea: compito con los ladrones por ella */
+		if (!__atomic_compare_exchange_n(&superior, &sup, sup + 1, false,
+				__ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+			tarea = NULL;
+		}
+		__atomic_store_n(&inferior, inf + 1, __ATOMIC_RELAXED);
+	}
+	return tarea;
+}
+
+Tarea* ColaRobo::robar() {
+	long sup = __atomic_load_n(&superior, __ATOMIC_ACQUIRE);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	long inf = __atomic_load_n(&inferior, __ATOMIC_ACQUIRE);
+	if (sup >= inf) {
+		return NULL;
+	}
+	Arreglo *arr = __atomic_load_n(&arreglo, __ATOMIC_ACQUIRE);
+	Tarea *tarea = __atomic_load_n(&arr->tareas[sup & arr->mascara],
+			__ATOMIC_RELAXED);
+	if (!__atomic_compare_exchange_n(&superior, &sup, sup + 1, false,
+			__ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+		return NULL;
+	}
+	return tarea;
+}
+
+bool ColaRobo::estaVacia() const {
+	long sup = __atomic_load_n(&superior, __ATOMIC_ACQUIRE);
+	long inf = __atomic_load_n(&inferior, __ATOMIC_ACQUIRE);
+	return (sup >= inf);
+}
+
+ColaRobo::Arreglo* ColaRobo::crearArreglo(size_t capacidad) {
+	Arreglo *nuevo = new Arreglo;
+	nuevo->mascara = capacidad - 1;
+	nuevo->tareas = new Tarea*[capacidad];
+	return nuevo;
+}
+
+void ColaRobo::destruirArreglo(Arreglo *arreglo) {
+	delete[] arreglo->tareas;
+	delete arreglo;
+}
+
+ColaRobo::Arreglo* ColaRobo::agrandar(Arreglo *viejo, long superior,
+		long inferior) {
+	Arreglo *nuevo = crearArreglo(2 * (viejo->mascara + 1));
+	for (long i = superior; i < inferior; ++i) {
+		nuevo->tareas[i & nuevo->mascara] = __atomic_load_n(
+				&viejo->tareas[i & viejo->mascara], __ATOMIC_RELAXED);
+	}
+	arreglosViejos.push_back(viejo);
+	__atomic_store_n(&arreglo, nuevo, __ATOMIC_RELEASE);
+	return nuevo;
+}
+
+ColaRobo::~ColaRobo() {
+	destruirArreglo(arreglo);
+	for (size_t i = 0; i < arreglosViejos.size(); ++i) {
+		destruirArreglo(arreglosViejos[i]);
+	}
+}
+}
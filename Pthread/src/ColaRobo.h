@@ -0,0 +1,90 @@
+#ifndef COLAROBO_H_
+#define COLAROBO_H_
+
+#include <cstddef>
+#include <vector>
+#include "Tarea.h"
+
+namespace POSIX {
+
+/**
+ * @brief Cola doble de tareas de Chase-Lev, utilizada por cada hilo de un
+ * PoolThreads. El hilo dueño inserta y extrae tareas por un extremo (orden
+ * LIFO, que aprovecha la caché), mientras que los demás hilos roban tareas
+ * por el otro extremo (orden FIFO), sin utilizar locks
+ * @details El arreglo interno crece cuando se llena. Los arreglos anteriores
+ * no se liberan hasta destruir la cola, ya que un ladrón puede estar
+ * leyéndolos
+ */
+
+class ColaRobo {
+public:
+
+	/**
+	 * @brief Construye una cola vacía
+	 * @param capacidadInicial Capacidad inicial, debe ser potencia de 2
+	 */
+	explicit ColaRobo(size_t capacidadInicial = 256);
+
+	/**
+	 * @brief Método para insertar una tarea
+	 * @warning Solo puede invocarlo el hilo dueño de la cola
+	 * @param tarea Tarea a insertar
+	 */
+	void insertar(Tarea *tarea);
+
+	/**
+	 * @brief Método para extraer la última tarea insertada
+	 * @warning Solo puede invocarlo el hilo dueño de la cola
+	 * @return La tarea extraída, o <tt>NULL</tt> si la cola está vacía
+	 */
+	Tarea* extraer();
+
+	/**
+	 * @brief Método para robar la tarea más antigua. Puede invocarlo
+	 * cualquier hilo
+	 * @return La tarea robada, o <tt>NULL</tt> si la cola está vacía o
+	 * otro hilo tomó la tarea al mismo tiempo
+	 */
+	Tarea* robar();
+
+	/**
+	 * @brief Método para consultar si la cola está vacía. El resultado es
+	 * aproximado si otros hilos la están modificando
+	 * @return <tt>true</tt> si la cola está vacía
+	 */
+	bool estaVacia() const;
+
+	/**
+	 * @brief Destructor
+	 */
+	~ColaRobo();
+
+private:
+
+	struct Arreglo {
+		size_t mascara;
+		Tarea **tareas;
+	};
+
+	/* Cada indice en su propia linea de cache, para que los robos no
+	 * invaliden la linea del dueño */
+	char relleno0[64];
+	long superior;
+	char relleno1[64 - sizeof(long)];
+	long inferior;
+	char relleno2[64 - sizeof(long)];
+	Arreglo *arreglo;
+
+	std::vector<Arreglo*> arreglosViejos;
+
+	static Arreglo* crearArreglo(size_t capacidad);
+	static void destruirArreglo(Arreglo *arreglo);
+	Arreglo* agrandar(Arreglo *viejo, long superior, long inferior);
+
+	ColaRobo(const ColaRobo&);
+	ColaRobo& operator=(const ColaRobo&);
+};
+}
+
+#endif
@@ -0,0 +1,81 @@
+#include "Condicion.h"
+#include <cerrno>
+
+#define NANOS_POR_SEGUNDO 1000000000L
+#define NANOS_POR_MILI 1000000L
+
+namespace PThread {
+
+Condicion::Condicion() {
+	esperando = 0;
+	pthread_condattr_t atributos;
+	pthread_condattr_init(&atributos);
+	pthread_condattr_setclock(&atributos, CLOCK_MONOTONIC);
+	pthread_cond_init(&condVar, &atributos);
+	pthread_condattr_destroy(&atributos);
+}
+
+void Condicion::esperar(Mutex &mutex) {
+	esperar(mutex, NULL);
+}
+
+bool Condicion::esperarHasta(Mutex &mutex, const timespec &limite) {
+	return esperar(mutex, &limite);
+}
+
+bool Condicion::esperarPor(Mutex &mutex, long milisegundos) {
+	timespec limite = limiteEn(milisegundos);
+	return esperar(mutex, &limite);
+}
+
+void Condicion::notificarUno() {
+	if (__atomic_load_n(&esperando, __ATOMIC_SEQ_CST) > 0) {
+		pthread_cond_signal(&condVar);
+	}
+}
+
+void Condicion::notificarTodos() {
+	if (__atomic_load_n(&esperando, __ATOMIC_SEQ_CST) > 0) {
+		pthread_cond_broadcast(&condVar);
+	}
+}
+
+timespec Condicion::limiteEn(long milisegundos) {
+	timespec limite;
+	clock_gettime(CLOCK_MONOTONIC, &limite);
+	limite.tv_sec += milisegundos / 1000;
+	limite.tv_nsec += (milisegundos % 1000) * NANOS_POR_MILI;
+	if (limite.tv_nsec >= NANOS_POR_SEGUNDO) {
+		limite.tv_sec += 1;
+		limite.tv_nsec -= NANOS_POR_SEGUNDO;
+	}
+	return limite;
+}
+
+Condicion::~Condicion() {
+	pthread_cond_destroy(&condVar);
+}
+
+bool Condicion::esperar(Mutex &mutex, const timespec *limite) {
+	/* El incremento se hace con el mutex tomado: un hilo que cambie el estado
+	 * esperado bajo el mismo mutex y luego notifique ve al hilo en espera */
+	__atomic_add_fetch(&esperando, 1, __ATOMIC_SEQ_CST);
+#ifdef MUTEX_PERFILADO
+	mutex.perfil.registrarLiberacion();
+#endif
+	int resultado;
+	if (limite == NULL) {
+		resultado = pthread_cond_wait(&condVar, &mutex.mutex);
+	}
+	else {
+		resultado = pthread_cond_timedwait(&condVar, &mutex.mutex, limite);
+	}
+#ifdef MUTEX_PERFILADO
+	if (RegistroMutex::estaActivo()) {
+		mutex.perfil.inicioRetencion = PerfilMutex::ahora();
+	}
+#endif
+	__atomic_sub_fetch(&esperando, 1, __ATOMIC_SEQ_CST);
+	return (resultado != ETIMEDOUT);
+}
+}
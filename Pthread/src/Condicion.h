@@ -0,0 +1,99 @@
+#ifndef CONDICION_H_
+#define CONDICION_H_
+
+#include <pthread.h>
+#include <time.h>
+#include "Mutex.h"
+
+namespace PThread {
+
+/**
+ * @brief Variable de condición independiente de Mutex, de modo que un mismo
+ * mutex pueda proteger varias condiciones. Permite notificar a uno o a todos
+ * los hilos en espera y esperar con un tiempo límite
+ * @details Los tiempos límite se miden con el reloj monótono
+ * (<tt>CLOCK_MONOTONIC</tt>), por lo que no se ven afectados por cambios en
+ * la hora del sistema
+ * @details Se lleva la cuenta de los hilos en espera, y las notificaciones
+ * sin hilos esperando no realizan llamadas al sistema. Para que no se pierdan
+ * notificaciones, el estado que se espera debe modificarse con el mutex
+ * tomado (la notificación puede hacerse luego de liberarlo)
+ */
+
+class Condicion {
+public:
+
+	/**
+	 * @brief Instancia una condición sin hilos en espera
+	 */
+	Condicion();
+
+	/**
+	 * @brief Hace esperar al thread en ejecución hasta que se notifique la
+	 * condición. Puede despertarse sin notificación, por lo que debe
+	 * volver a verificarse el estado esperado
+	 * @pre El hilo actual está en posesión del mutex
+	 * @post El hilo actual está en posesión del mutex
+	 * @param mutex Mutex que protege el estado esperado
+	 */
+	void esperar(Mutex &mutex);
+
+	/**
+	 * @brief Hace esperar al thread en ejecución hasta que se notifique la
+	 * condición o se alcance el tiempo límite
+	 * @pre El hilo actual está en posesión del mutex
+	 * @post El hilo actual está en posesión del mutex
+	 * @param mutex Mutex que protege el estado esperado
+	 * @param limite Instante límite, según <tt>CLOCK_MONOTONIC</tt>
+	 * @return <tt>true</tt> si se despertó antes del límite
+	 * @return <tt>false</tt> si se alcanzó el límite
+	 */
+	bool esperarHasta(Mutex &mutex, const timespec &limite);
+
+	/**
+	 * @brief Igual a Condicion::esperarHasta, con un límite relativo al
+	 * instante actual
+	 * @param mutex Mutex que protege el estado esperado
+	 * @param milisegundos Tiempo máximo de espera
+	 * @return <tt>true</tt> si se despertó antes del límite
+	 * @return <tt>false</tt> si se alcanzó el límite
+	 */
+	bool esperarPor(Mutex &mutex, long milisegundos);
+
+	/**
+	 * @brief Método que despierta a uno de los hilos en espera, si hay alguno
+	 */
+	void notificarUno();
+
+	/**
+	 * @brief Método que despierta a todos los hilos en espera
+	 */
+	void notificarTodos();
+
+	/**
+	 * @brief Método para calcular un instante límite a partir del actual
+	 * @param milisegundos Tiempo a sumar al instante actual
+	 * @return El instante límite, según <tt>CLOCK_MONOTONIC</tt>
+	 */
+	static timespec limiteEn(long milisegundos);
+
+	/**
+	 * @brief Libera los recursos
+	 * @pre No hay hilos en espera
+	 */
+	~Condicion();
+
+private:
+
+	pthread_cond_t condVar;
+	/* Hilos en espera. Se modifica con el mutex asociado tomado */
+	int esperando;
+
+	bool esperar(Mutex &mutex, const timespec *limite);
+
+	Condicion(const Condicion&);
+	Condicion& operator=(const Condicion&);
+};
+}
+
+#endif
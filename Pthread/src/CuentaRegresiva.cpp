@@ -0,0 +1,61 @@
+#include "CuentaRegresiva.h"
+#include "Futex.h"
+#include <climits>
+
+/* Iteraciones de espera activa antes de dormir en el futex */
+#define MAX_GIROS 100
+
+namespace PThread {
+
+CuentaRegresiva::CuentaRegresiva(int cuenta) {
+	this->cuenta = (cuenta > 0) ? cuenta : 0;
+	dormidos = 0;
+}
+
+void CuentaRegresiva::descontar(int cantidad) {
+	if (cantidad <= 0) {
+		return;
+	}
+	/* Despierta quien cruza el cero, aunque un descuento grande deje la
+	 * cuenta negativa */
+	int anterior = __atomic_fetch_sub(&cuenta, cantidad, __ATOMIC_SEQ_CST);
+	if (anterior > 0 && anterior - cantidad <= 0
+			&& __atomic_load_n(&dormidos, __ATOMIC_SEQ_CST) > 0) {
+		futexDespertar(&cuenta, INT_MAX);
+	}
+}
+
+void CuentaRegresiva::esperar() {
+	for (int giros = 0; giros < MAX_GIROS; ++giros) {
+		if (intentarEsperar()) {
+			return;
+		}
+		pausaCPU();
+	}
+
+	/* Solo se despierta al llegar a cero: los descuentos intermedios no
+	 * generan llamadas al sistema */
+	__atomic_add_fetch(&dormidos, 1, __ATOMIC_SEQ_CST);
+	int actual;
+	while ((actual = __atomic_load_n(&cuenta, __ATOMIC_ACQUIRE)) > 0) {
+		futexEsperar(&cuenta, actual);
+	}
+	__atomic_sub_fetch(&dormidos, 1, __ATOMIC_RELAXED);
+}
+
+bool CuentaRegresiva::intentarEsperar() const {
+	return (__atomic_load_n(&cuenta, __ATOMIC_ACQUIRE) <= 0);
+}
+
+void CuentaRegresiva::descontarYEsperar() {
+	descontar();
+	esperar();
+}
+
+int CuentaRegresiva::getCuenta() const {
+	return __atomic_load_n(&cuenta, __ATOMIC_RELAXED);
+}
+
+CuentaRegresiva::~CuentaRegresiva() {
+}
+}
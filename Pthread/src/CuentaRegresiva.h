@@ -0,0 +1,73 @@
+#ifndef CUENTAREGRESIVA_H_
+#define CUENTAREGRESIVA_H_
+
+namespace PThread {
+
+/**
+ * @brief Cuenta regresiva de un solo uso, implementada directamente sobre un
+ * futex. Los hilos que esperan se liberan todos juntos cuando la cuenta
+ * llega a cero, y a partir de ahí la espera retorna inmediatamente
+ * @details Útil para esperar el fin de una fase de inicialización, o de un
+ * grupo de tareas lanzadas en paralelo. Para fases que se repiten, ver
+ * Barrera
+ */
+
+class CuentaRegresiva {
+public:
+
+	/**
+	 * @brief Instancia una cuenta regresiva
+	 * @param cuenta Cantidad de descuentos necesarios para liberar a los
+	 * hilos que esperan
+	 */
+	explicit CuentaRegresiva(int cuenta);
+
+	/**
+	 * @brief Método para descontar de la cuenta. Si llega a cero, o la pasa,
+	 * despierta a todos los hilos que esperan
+	 * @param cantidad Cantidad a descontar
+	 */
+	void descontar(int cantidad = 1);
+
+	/**
+	 * @brief Método para esperar a que la cuenta llegue a cero
+	 * @post Si la cuenta no es cero, el hilo espera activamente un tiempo
+	 * acotado y luego se duerme hasta que lo sea
+	 */
+	void esperar();
+
+	/**
+	 * @brief Método para consultar, sin esperar, si la cuenta llegó a cero
+	 * @return <tt>true</tt> si la cuenta es cero
+	 */
+	bool intentarEsperar() const;
+
+	/**
+	 * @brief Método que descuenta uno y espera a que la cuenta llegue a cero
+	 */
+	void descontarYEsperar();
+
+	/**
+	 * @brief Método para obtener la cuenta actual
+	 * @return La cuenta
+	 */
+	int getCuenta() const;
+
+	/**
+	 * @brief Destructor
+	 * @pre No hay hilos esperando
+	 */
+	~CuentaRegresiva();
+
+private:
+
+	/* Palabra del futex */
+	int cuenta;
+	int dormidos;
+
+	CuentaRegresiva(const CuentaRegresiva&);
+	CuentaRegresiva& operator=(const CuentaRegresiva&);
+};
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef EJECUTOR_H_
+#define EJECUTOR_H_
+
+#include "Tarea.h"
+
+namespace POSIX {
+
+/**
+ * @brief Interfaz de los objetos que ejecutan tareas, como PoolThreads. Se
+ * utiliza para indicar dónde deben ejecutarse las continuaciones de un
+ * Futuro
+ */
+
+class Ejecutor {
+public:
+
+	/**
+	 * @brief Método para enviar una tarea a ejecutar
+	 * @param tarea Tarea a ejecutar. Debe seguir viva hasta que termine su
+	 * ejecución
+	 */
+	virtual void enviar(Tarea *tarea) = 0;
+
+	/**
+	 * @brief Destructor
+	 */
+	virtual ~Ejecutor() {
+	}
+};
+
+/**
+ * @brief Ejecutor que ejecuta las tareas en el mismo hilo que las envía, en
+ * el momento del envío. Útil para continuaciones muy cortas
+ */
+
+class EjecutorInmediato: public Ejecutor {
+public:
+
+	/**
+	 * @brief Ejecuta la tarea en el hilo actual
+	 * @param tarea Tarea a ejecutar
+	 */
+	virtual void enviar(Tarea *tarea) {
+		tarea->ejecutar();
+	}
+
+	/**
+	 * @brief Método para obtener una instancia compartida
+	 * @return La instancia
+	 */
+	static EjecutorInmediato& instancia() {
+		static EjecutorInmediato ejecutor;
+		return ejecutor;
+	}
+};
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef FUTEX_H_
+#define FUTEX_H_
+
+#include <cstddef>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace PThread {
+
+/**
+ * @brief Bloquea el hilo en ejecución mientras @a *direccion valga
+ * @a esperado, hasta que otro hilo lo despierte con futexDespertar
+ * @details Puede retornar sin que nadie lo despierte (señales o despertares
+ * espurios), por lo que siempre debe llamarse dentro de un ciclo que vuelva a
+ * verificar la condición
+ * @param direccion Palabra sobre la que se espera
+ * @param esperado Valor que debe tener la palabra para bloquearse
+ * @return 0 si fue despertado, -1 si la palabra no valía @a esperado o la
+ * espera fue interrumpida
+ */
+inline int futexEsperar(int *direccion, int esperado) {
+	return (int) syscall(SYS_futex, direccion, FUTEX_WAIT_PRIVATE, esperado,
+			NULL, NULL, 0);
+}
+
+/**
+ * @brief Despierta hasta @a cantidad hilos bloqueados con futexEsperar sobre
+ * @a direccion
+ * @param direccion Palabra sobre la que esperan los hilos
+ * @param cantidad Cantidad máxima de hilos a despertar
+ * @return La cantidad de hilos despertados
+ */
+inline int futexDespertar(int *direccion, int cantidad) {
+	return (int) syscall(SYS_futex, direccion, FUTEX_WAKE_PRIVATE, cantidad,
+			NULL, NULL, 0);
+}
+
+/**
+ * @brief Le indica al procesador que el hilo está en un ciclo de espera
+ * activa, para reducir el consumo y no penalizar al otro hilo del núcleo
+ */
+inline void pausaCPU() {
+#if defined(__i386__) || defined(__x86_64__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+	__asm__ __volatile__("yield" ::: "memory");
+#else
+	__asm__ __volatile__("" ::: "memory");
+#endif
+}
+}
+
+#endif
@@ -0,0 +1,566 @@
+#ifndef FUTURO_H_
+#define FUTURO_H_
+
+#include <climits>
+#include <string>
+#include <vector>
+#include "Ejecutor.h"
+#include "Futex.h"
+#include "MultiHiloExcepcion.h"
+
+namespace POSIX {
+
+template<typename T> class Futuro;
+template<typename T> class Promesa;
+
+/**
+ * @brief Estado compartido entre una Promesa y sus Futuro. Es de uso interno:
+ * se aloca una única vez y se libera cuando se destruye la última referencia
+ * @details La palabra de estado sirve también de futex para los hilos que
+ * esperan el resultado. Completar el estado sin hilos esperando no realiza
+ * llamadas al sistema
+ * @details Las continuaciones se apilan en una lista con compare-and-swap.
+ * Al completarse, el estado cierra la lista y envía las continuaciones en el
+ * orden en que se registraron; las que se registran después se envían en el
+ * momento
+ */
+
+template<typename T>
+class EstadoFuturo {
+public:
+
+	enum {
+		PENDIENTE = 0, LISTO = 1
+	};
+
+	EstadoFuturo() {
+		referencias = 1;
+		estado = PENDIENTE;
+		esperando = 0;
+		fijado = 0;
+		conError = false;
+		codigo = MultiHiloExcepcion::FUTURO_CON_ERROR;
+		continuaciones = NULL;
+	}
+
+	void adquirir() {
+		__atomic_add_fetch(&referencias, 1, __ATOMIC_RELAXED);
+	}
+
+	void liberar() {
+		if (__atomic_sub_fetch(&referencias, 1, __ATOMIC_ACQ_REL) == 0) {
+			delete this;
+		}
+	}
+
+	bool estaListo() const {
+		return (__atomic_load_n(&estado, __ATOMIC_ACQUIRE) == LISTO);
+	}
+
+	bool estaFijado() const {
+		return (__atomic_load_n(&fijado, __ATOMIC_ACQUIRE) != 0);
+	}
+
+	void esperar() {
+		while (!estaListo()) {
+			__atomic_add_fetch(&esperando, 1, __ATOMIC_SEQ_CST);
+			int actual = __atomic_load_n(&estado, __ATOMIC_SEQ_CST);
+			if (actual != LISTO) {
+				PThread::futexEsperar(&estado, actual);
+			}
+			__atomic_sub_fetch(&esperando, 1, __ATOMIC_SEQ_CST);
+		}
+	}
+
+	bool fijarValor(const T &valor) {
+		if (!reservar()) {
+			return false;
+		}
+		this->valor = valor;
+		completar();
+		return true;
+	}
+
+	bool fijarError(const std::string &motivo,
+			MultiHiloExcepcion::CodigoError codigo) {
+		if (!reservar()) {
+			return false;
+		}
+		conError = true;
+		this->motivo = motivo;
+		this->codigo = codigo;
+		completar();
+		return true;
+	}
+
+	/* Registra la tarea a enviar al ejecutor cuando se complete el estado.
+	 * Si ya estaba completo, la envia en el momento */
+	void alCompletar(Tarea *tarea, Ejecutor &ejecutor) {
+		NodoContinuacion *nodo = new NodoContinuacion;
+		nodo->tarea = tarea;
+		nodo->ejecutor = &ejecutor;
+		nodo->siguiente = __atomic_load_n(&continuaciones, __ATOMIC_ACQUIRE);
+		do {
+			if (nodo->siguiente == cerrada()) {
+				delete nodo;
+				ejecutor.enviar(tarea);
+				return;
+			}
+		} while (!__atomic_compare_exchange_n(&continuaciones,
+				&nodo->siguiente, nodo, true, __ATOMIC_ACQ_REL,
+				__ATOMIC_ACQUIRE));
+	}
+
+	T valor;
+	bool conError;
+	std::string motivo;
+	MultiHiloExcepcion::CodigoError codigo;
+
+private:
+
+	int referencias;
+	int estado;
+	int esperando;
+	int fijado;
+
+	struct NodoContinuacion {
+		Tarea *tarea;
+		Ejecutor *ejecutor;
+		NodoContinuacion *siguiente;
+	};
+
+	/* Pila de continuaciones pendientes, o cerrada() una vez completo */
+	NodoContinuacion *continuaciones;
+
+	static NodoContinuacion* cerrada() {
+		static NodoContinuacion centinela;
+		return &centinela;
+	}
+
+	bool reservar() {
+		int esperado = 0;
+		return __atomic_compare_exchange_n(&fijado, &esperado, 1, false,
+				__ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+	}
+
+	void completar() {
+		__atomic_store_n(&estado, (int) LISTO, __ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&esperando, __ATOMIC_SEQ_CST) > 0) {
+			PThread::futexDespertar(&estado, INT_MAX);
+		}
+		NodoContinuacion *pila = __atomic_exchange_n(&continuaciones,
+				cerrada(), __ATOMIC_ACQ_REL);
+		/* La pila tiene la ultima registrada primero: se invierte para
+		 * enviarlas en orden de registro */
+		NodoContinuacion *lista = NULL;
+		while (pila != NULL) {
+			NodoContinuacion *siguiente = pila->siguiente;
+			pila->siguiente = lista;
+			lista = pila;
+			pila = siguiente;
+		}
+		while (lista != NULL) {
+			NodoContinuacion *siguiente = lista->siguiente;
+			lista->ejecutor->enviar(lista->tarea);
+			delete lista;
+			lista = siguiente;
+		}
+	}
+
+	~EstadoFuturo() {
+	}
+
+	EstadoFuturo(const EstadoFuturo&);
+	EstadoFuturo& operator=(const EstadoFuturo&);
+};
+
+/**
+ * @brief Resultado de una operación asincrónica, que estará disponible en
+ * algún momento. Se obtiene de una Promesa, que es quien fija el resultado
+ * @details Las copias de un Futuro comparten el mismo resultado. Puede
+ * esperarse el resultado bloqueando al hilo con Futuro::obtener, o
+ * encadenar una continuación con Futuro::entonces que se ejecuta en un
+ * Ejecutor sin bloquear a nadie
+ * @details @a T debe poder construirse por defecto y copiarse
+ */
+
+template<typename T>
+class Futuro {
+public:
+
+	typedef T t_valor;
+
+	/**
+	 * @brief Construye un futuro inválido, sin estado asociado
+	 */
+	Futuro() :
+			estado(NULL) {
+	}
+
+	/**
+	 * @brief Construye un futuro que comparte el resultado de otro
+	 * @param otro Futuro a copiar
+	 */
+	Futuro(const Futuro &otro) :
+			estado(otro.estado) {
+		if (estado != NULL) {
+			estado->adquirir();
+		}
+	}
+
+	/**
+	 * @brief Hace que el futuro comparta el resultado de otro
+	 * @param otro Futuro a copiar
+	 * @return Este futuro
+	 */
+	Futuro& operator=(const Futuro &otro) {
+		if (otro.estado != NULL) {
+			otro.estado->adquirir();
+		}
+		if (estado != NULL) {
+			estado->liberar();
+		}
+		estado = otro.estado;
+		return *this;
+	}
+
+	/**
+	 * @brief Método para construir un futuro que ya tiene su valor
+	 * @param valor Valor del futuro
+	 * @return El futuro
+	 */
+	static Futuro conValor(const T &valor) {
+		EstadoFuturo<T> *nuevo = new EstadoFuturo<T>;
+		nuevo->fijarValor(valor);
+		return Futuro(nuevo);
+	}
+
+	/**
+	 * @brief Método para consultar si el futuro tiene un estado asociado
+	 * @return <tt>true</tt> si es válido
+	 */
+	bool esValido() const {
+		return (estado != NULL);
+	}
+
+	/**
+	 * @brief Método para consultar, sin bloquear, si el resultado está
+	 * disponible
+	 * @pre El futuro es válido
+	 * @return <tt>true</tt> si está disponible
+	 */
+	bool estaListo() const {
+		return estado->estaListo();
+	}
+
+	/**
+	 * @brief Bloquea al hilo en ejecución hasta que el resultado esté
+	 * disponible
+	 * @pre El futuro es válido
+	 */
+	void esperar() const {
+		estado->esperar();
+	}
+
+	/**
+	 * @brief Método para obtener el valor, bloqueando al hilo en ejecución
+	 * hasta que esté disponible
+	 * @pre El futuro es válido
+	 * @return El valor
+	 * @throw MultiHiloExcepcion Si la operación falló o la promesa se
+	 * destruyó sin fijar un resultado
+	 */
+	const T& obtener() const /* throw (MultiHiloExcepcion) */{
+		estado->esperar();
+		if (estado->conError) {
+			throw MultiHiloExcepcion(estado->motivo.c_str(), estado->codigo);
+		}
+		return estado->valor;
+	}
+
+	/**
+	 * @brief Método para consultar si la operación falló
+	 * @pre El resultado está disponible
+	 * @return <tt>true</tt> si falló
+	 */
+	bool tieneError() const {
+		return estado->conError;
+	}
+
+	/**
+	 * @brief Método para encadenar una operación a ejecutar cuando el
+	 * resultado esté disponible
+	 * @details @a F es un functor con un typedef <tt>t_resultado</tt> y un
+	 * operador <tt>t_resultado operator()(const T&)</tt>. Si este futuro
+	 * falla, no se invoca el functor y el error se propaga al futuro
+	 * devuelto. Si el functor arroja una excepción, el futuro devuelto
+	 * falla con el código MultiHiloExcepcion::FUTURO_CON_ERROR
+	 * @details Un mismo futuro, o sus copias, admite varias continuaciones:
+	 * se envían en el orden en que se registraron
+	 * @pre El futuro es válido
+	 * @param funcion Functor a invocar con el valor
+	 * @param ejecutor Ejecutor donde se invoca el functor
+	 * @return Un futuro con el resultado del functor
+	 */
+	template<typename F>
+	Futuro<typename F::t_resultado> entonces(F funcion,
+			Ejecutor &ejecutor) const {
+		typedef typename F::t_resultado R;
+		EstadoFuturo<R> *destino = new EstadoFuturo<R>;
+		/* Una referencia para el futuro devuelto y otra para la continuacion */
+		destino->adquirir();
+		estado->alCompletar(new Continuacion<F, R>(*this, funcion, destino),
+				ejecutor);
+		return Futuro<R>(destino);
+	}
+
+	/**
+	 * @brief Método para registrar una tarea a enviar al ejecutor cuando el
+	 * resultado esté disponible. Es la base de Futuro::entonces y de los
+	 * combinadores cuandoTodos y cuandoAlguno
+	 * @pre El futuro es válido
+	 * @param tarea Tarea a ejecutar. Debe seguir viva hasta que se ejecute
+	 * @param ejecutor Ejecutor donde se ejecuta la tarea
+	 */
+	void alCompletar(Tarea *tarea, Ejecutor &ejecutor) const {
+		estado->alCompletar(tarea, ejecutor);
+	}
+
+	/**
+	 * @brief Destructor. Libera el estado si es la última referencia
+	 */
+	~Futuro() {
+		if (estado != NULL) {
+			estado->liberar();
+		}
+	}
+
+private:
+
+	template<typename U> friend class Futuro;
+	friend class Promesa<T>;
+
+	EstadoFuturo<T> *estado;
+
+	/* Toma posesion de una referencia al estado */
+	explicit Futuro(EstadoFuturo<T> *estado) :
+			estado(estado) {
+	}
+
+	template<typename F, typename R>
+	class Continuacion: public Tarea {
+	public:
+		Continuacion(const Futuro &origen, F funcion,
+				EstadoFuturo<R> *destino) :
+				origen(origen), funcion(funcion), destino(destino) {
+		}
+
+		void ejecutar() {
+			if (origen.estado->conError) {
+				destino->fijarError(origen.estado->motivo,
+						origen.estado->codigo);
+			}
+			else {
+				try {
+					destino->fijarValor(funcion(origen.estado->valor));
+				} catch (...) {
+					destino->fijarError("Excepcion en la continuacion",
+							MultiHiloExcepcion::FUTURO_CON_ERROR);
+				}
+			}
+			destino->liberar();
+			delete this;
+		}
+
+	private:
+		Futuro origen;
+		F funcion;
+		EstadoFuturo<R> *destino;
+	};
+};
+
+/**
+ * @brief Extremo de escritura de un Futuro: quien realiza la operación
+ * asincrónica fija su valor o su error, una única vez
+ * @details Si la promesa se destruye sin fijar un resultado, sus futuros
+ * fallan con el código MultiHiloExcepcion::PROMESA_ROTA
+ */
+
+template<typename T>
+class Promesa {
+public:
+
+	/**
+	 * @brief Construye una promesa sin resultado
+	 */
+	Promesa() :
+			estado(new EstadoFuturo<T>) {
+	}
+
+	/**
+	 * @brief Método para obtener un futuro asociado a la promesa
+	 * @return El futuro
+	 */
+	Futuro<T> obtenerFuturo() {
+		estado->adquirir();
+		return Futuro<T>(estado);
+	}
+
+	/**
+	 * @brief Método para fijar el valor. Despierta a los hilos en espera y
+	 * envía la continuación a su ejecutor
+	 * @param valor Valor del futuro
+	 * @return <tt>true</tt> si se fijó
+	 * @return <tt>false</tt> si ya se había fijado un resultado
+	 */
+	bool establecerValor(const T &valor) {
+		return estado->fijarValor(valor);
+	}
+
+	/**
+	 * @brief Método para indicar que la operación falló
+	 * @param motivo Texto descriptivo del error
+	 * @return <tt>true</tt> si se fijó
+	 * @return <tt>false</tt> si ya se había fijado un resultado
+	 */
+	bool establecerError(const std::string &motivo) {
+		return estado->fijarError(motivo, MultiHiloExcepcion::FUTURO_CON_ERROR);
+	}
+
+	/**
+	 * @brief Destructor. Si no se fijó un resultado, los futuros fallan
+	 */
+	~Promesa() {
+		if (!estado->estaFijado()) {
+			estado->fijarError("Promesa destruida sin resultado",
+					MultiHiloExcepcion::PROMESA_ROTA);
+		}
+		estado->liberar();
+	}
+
+private:
+
+	EstadoFuturo<T> *estado;
+
+	Promesa(const Promesa&);
+	Promesa& operator=(const Promesa&);
+};
+
+/**
+ * @brief Combina varios futuros en uno que se completa cuando todos se
+ * completan, con sus valores en el mismo orden. Si alguno falla, el
+ * resultado falla con el código MultiHiloExcepcion::FUTURO_CON_ERROR
+ * @pre Los futuros son válidos. Pueden tener otras continuaciones
+ * registradas y repetirse en la lista
+ * @param futuros Futuros a combinar
+ * @return Un futuro con los valores de todos
+ */
+template<typename T>
+Futuro<std::vector<T> > cuandoTodos(const std::vector<Futuro<T> > &futuros) {
+	if (futuros.empty()) {
+		return Futuro<std::vector<T> >::conValor(std::vector<T>());
+	}
+	Promesa<std::vector<T> > *promesa = new Promesa<std::vector<T> >;
+	Futuro<std::vector<T> > resultado = promesa->obtenerFuturo();
+
+	class Combinador: public Tarea {
+	public:
+		Combinador(const std::vector<Futuro<T> > &futuros,
+				Promesa<std::vector<T> > *promesa) :
+				futuros(futuros), promesa(promesa) {
+			pendientes = (int) futuros.size();
+		}
+
+		/* Cada futuro que se completa invoca ejecutar; el ultimo arma el
+		 * resultado */
+		void ejecutar() {
+			if (__atomic_sub_fetch(&pendientes, 1, __ATOMIC_ACQ_REL) > 0) {
+				return;
+			}
+			std::vector<T> valores;
+			valores.reserve(futuros.size());
+			bool fallo = false;
+			for (size_t i = 0; i < futuros.size() && !fallo; ++i) {
+				if (futuros[i].tieneError()) {
+					fallo = true;
+				}
+				else {
+					valores.push_back(futuros[i].obtener());
+				}
+			}
+			if (fallo) {
+				promesa->establecerError("Fallo uno de los futuros combinados");
+			}
+			else {
+				promesa->establecerValor(valores);
+			}
+			delete promesa;
+			delete this;
+		}
+
+	private:
+		std::vector<Futuro<T> > futuros;
+		Promesa<std::vector<T> > *promesa;
+		int pendientes;
+	};
+
+	Combinador *combinador = new Combinador(futuros, promesa);
+	for (size_t i = 0; i < futuros.size(); ++i) {
+		futuros[i].alCompletar(combinador, EjecutorInmediato::instancia());
+	}
+	return resultado;
+}
+
+/**
+ * @brief Combina varios futuros en uno que se completa cuando se completa
+ * el primero de ellos. Con la lista vacía, el resultado falla con el
+ * código MultiHiloExcepcion::FUTURO_CON_ERROR
+ * @pre Los futuros son válidos. Pueden tener otras continuaciones
+ * registradas y repetirse en la lista
+ * @param futuros Futuros a combinar
+ * @return Un futuro con el índice en la lista del primer futuro completado
+ */
+template<typename T>
+Futuro<size_t> cuandoAlguno(const std::vector<Futuro<T> > &futuros) {
+	if (futuros.empty()) {
+		Promesa<size_t> vacia;
+		vacia.establecerError("No hay futuros para combinar");
+		return vacia.obtenerFuturo();
+	}
+	struct Compartido {
+		Promesa<size_t> promesa;
+		int pendientes;
+	};
+
+	class Aviso: public Tarea {
+	public:
+		Aviso(Compartido *compartido, size_t indice) :
+				compartido(compartido), indice(indice) {
+		}
+
+		void ejecutar() {
+			compartido->promesa.establecerValor(indice);
+			if (__atomic_sub_fetch(&compartido->pendientes, 1,
+					__ATOMIC_ACQ_REL) == 0) {
+				delete compartido;
+			}
+			delete this;
+		}
+
+	private:
+		Compartido *compartido;
+		size_t indice;
+	};
+
+	Compartido *compartido = new Compartido;
+	compartido->pendientes = (int) futuros.size();
+	Futuro<size_t> resultado = compartido->promesa.obtenerFuturo();
+	for (size_t i = 0; i < futuros.size(); ++i) {
+		futuros[i].alCompletar(new Aviso(compartido, i),
+				EjecutorInmediato::instancia());
+	}
+	return resultado;
+}
+}
+
+#endif
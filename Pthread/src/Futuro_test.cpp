@@ -0,0 +1,117 @@
+#include "Futuro.h"
+#include <cassert>
+#include <cstdio>
+#include <vector>
+
+namespace POSIX {
+
+/* Multiplica el valor y anota su identificador al ejecutarse */
+struct Multiplicar {
+	typedef int t_resultado;
+	Multiplicar(int factor, std::vector<int> *orden) :
+			factor(factor), orden(orden) {
+	}
+	int operator()(const int &valor) const {
+		orden->push_back(factor);
+		return valor * factor;
+	}
+	int factor;
+	std::vector<int> *orden;
+};
+
+/* Dos continuaciones sobre el mismo futuro se ejecutan ambas, con el valor
+ * fijado y en el orden en que se registraron */
+void testDosContinuaciones() {
+	std::vector<int> orden;
+	Promesa<int> promesa;
+	Futuro<int> futuro = promesa.obtenerFuturo();
+	Futuro<int> copia = futuro;
+	Futuro<int> doble = futuro.entonces(Multiplicar(2, &orden),
+			EjecutorInmediato::instancia());
+	Futuro<int> triple = copia.entonces(Multiplicar(3, &orden),
+			EjecutorInmediato::instancia());
+	assert(orden.empty());
+	assert(!doble.estaListo() && !triple.estaListo());
+
+	assert(promesa.establecerValor(21));
+	assert(doble.obtener() == 42);
+	assert(triple.obtener() == 63);
+	assert(orden.size() == 2 && orden[0] == 2 && orden[1] == 3);
+}
+
+/* Una continuación registrada sobre un futuro completo se ejecuta en el
+ * momento */
+void testContinuacionSobreFuturoListo() {
+	std::vector<int> orden;
+	Futuro<int> futuro = Futuro<int>::conValor(5);
+	Futuro<int> doble = futuro.entonces(Multiplicar(2, &orden),
+			EjecutorInmediato::instancia());
+	assert(doble.estaListo() && doble.obtener() == 10);
+	Futuro<int> triple = futuro.entonces(Multiplicar(3, &orden),
+			EjecutorInmediato::instancia());
+	assert(triple.obtener() == 15);
+	assert(orden.size() == 2);
+}
+
+/* cuandoTodos sobre un futuro con otra continuación y repetido en la lista */
+void testCuandoTodosConFuturoCompartido() {
+	std::vector<int> orden;
+	Promesa<int> primera;
+	Promesa<int> segunda;
+	Futuro<int> futuro = primera.obtenerFuturo();
+	Futuro<int> doble = futuro.entonces(Multiplicar(2, &orden),
+			EjecutorInmediato::instancia());
+	std::vector<Futuro<int> > futuros;
+	futuros.push_back(futuro);
+	futuros.push_back(segunda.obtenerFuturo());
+	futuros.push_back(futuro);
+	Futuro<std::vector<int> > todos = cuandoTodos(futuros);
+
+	primera.establecerValor(7);
+	assert(doble.obtener() == 14);
+	assert(!todos.estaListo());
+	segunda.establecerValor(8);
+	const std::vector<int> &valores = todos.obtener();
+	assert(valores.size() == 3);
+	assert(valores[0] == 7 && valores[1] == 8 && valores[2] == 7);
+}
+
+/* Una promesa destruida sin resultado propaga el error a todas las
+ * continuaciones */
+void testPromesaRotaConVariasContinuaciones() {
+	std::vector<int> orden;
+	Futuro<int> doble;
+	Futuro<int> triple;
+	{
+		Promesa<int> promesa;
+		Futuro<int> futuro = promesa.obtenerFuturo();
+		doble = futuro.entonces(Multiplicar(2, &orden),
+				EjecutorInmediato::instancia());
+		triple = futuro.entonces(Multiplicar(3, &orden),
+				EjecutorInmediato::instancia());
+	}
+	assert(doble.estaListo() && doble.tieneError());
+	assert(triple.estaListo() && triple.tieneError());
+	assert(orden.empty());
+}
+
+/* cuandoAlguno sin futuros falla en el momento */
+void testCuandoAlgunoVacio() {
+	std::vector<Futuro<int> > futuros;
+	Futuro<size_t> alguno = cuandoAlguno(futuros);
+	assert(alguno.estaListo() && alguno.tieneError());
+}
+
+}
+
+#ifdef FUTURO_TEST
+int main() {
+	POSIX::testDosContinuaciones();
+	POSIX::testContinuacionSobreFuturoListo();
+	POSIX::testCuandoTodosConFuturoCompartido();
+	POSIX::testPromesaRotaConVariasContinuaciones();
+	POSIX::testCuandoAlgunoVacio();
+	printf("Futuro_test: OK\n");
+	return 0;
+}
+#endif
@@ -0,0 +1,120 @@
+#include "LockLecturaEscritura.h"
+#include "Futex.h"
+#include <climits>
+#include <cstdlib>
+#include <new>
+#include <sched.h>
+
+#define SIN_ESCRITOR 0
+#define CON_ESCRITOR 1
+#define CON_LECTORES_DORMIDOS 2
+
+namespace PThread {
+
+LockLecturaEscritura::LockLecturaEscritura() {
+	long procesadores = sysconf(_SC_NPROCESSORS_CONF);
+	size_t cantidad = 1;
+	while ((long) cantidad < procesadores) {
+		cantidad <<= 1;
+	}
+	/* new[] solo garantiza la alineacion de malloc: cada contador debe
+	 * empezar en su propia linea de cache */
+	void *memoria = NULL;
+	if (posix_memalign(&memoria, sizeof(Contador), cantidad * sizeof(Contador))
+			!= 0) {
+		throw std::bad_alloc();
+	}
+	contadores = static_cast<Contador*>(memoria);
+	for (size_t i = 0; i < cantidad; ++i) {
+		new (&contadores[i]) Contador();
+		contadores[i].lectores = 0;
+	}
+	mascara = cantidad - 1;
+	escritor = SIN_ESCRITOR;
+}
+
+size_t LockLecturaEscritura::bloquearLectura() {
+	while (true) {
+		int cpu = sched_getcpu();
+		size_t contador = (cpu < 0) ? 0 : ((size_t) cpu & mascara);
+		__atomic_add_fetch(&contadores[contador].lectores, 1,
+				__ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&escritor, __ATOMIC_SEQ_CST) == SIN_ESCRITOR) {
+			return contador;
+		}
+
+		/* Hay un escritor: me retiro para que pueda avanzar y espero a que
+		 * termine */
+		__atomic_sub_fetch(&contadores[contador].lectores, 1,
+				__ATOMIC_RELEASE);
+		int actual = __atomic_load_n(&escritor, __ATOMIC_ACQUIRE);
+		while (actual != SIN_ESCRITOR) {
+			if (actual == CON_LECTORES_DORMIDOS ||
+					__atomic_compare_exchange_n(&escritor, &actual,
+							CON_LECTORES_DORMIDOS, false, __ATOMIC_ACQUIRE,
+							__ATOMIC_ACQUIRE)) {
+				futexEsperar(&escritor, CON_LECTORES_DORMIDOS);
+			}
+			actual = __atomic_load_n(&escritor, __ATOMIC_ACQUIRE);
+		}
+	}
+}
+
+void LockLecturaEscritura::desbloquearLectura(size_t contador) {
+	__atomic_sub_fetch(&contadores[contador].lectores, 1, __ATOMIC_RELEASE);
+}
+
+void LockLecturaEscritura::bloquearEscritura() {
+	mutexEscritores.bloquear();
+	__atomic_store_n(&escritor, CON_ESCRITOR, __ATOMIC_SEQ_CST);
+
+	/* Espero a que salgan los lectores que entraron antes de marcar al
+	 * escritor. Las lecturas son cortas, asi que alcanza con ceder el
+	 * procesador */
+	for (size_t i = 0; i <= mascara; ++i) {
+		int giros = 0;
+		while (__atomic_load_n(&contadores[i].lectores, __ATOMIC_ACQUIRE)
+				!= 0) {
+			if (++giros < 100) {
+				pausaCPU();
+			}
+			else {
+				sched_yield();
+			}
+		}
+	}
+}
+
+void LockLecturaEscritura::desbloquearEscritura() {
+	if (__atomic_exchange_n(&escritor, SIN_ESCRITOR, __ATOMIC_RELEASE)
+			== CON_LECTORES_DORMIDOS) {
+		futexDespertar(&escritor, INT_MAX);
+	}
+	mutexEscritores.desbloquear();
+}
+
+LockLecturaEscritura::~LockLecturaEscritura() {
+	for (size_t i = 0; i <= mascara; ++i) {
+		contadores[i].~Contador();
+	}
+	free(contadores);
+}
+
+LockLecturaEscritura::Lectura::Lectura(LockLecturaEscritura &lock) :
+		_lock(lock) {
+	_contador = _lock.bloquearLectura();
+}
+
+LockLecturaEscritura::Lectura::~Lectura() {
+	_lock.desbloquearLectura(_contador);
+}
+
+LockLecturaEscritura::Escritura::Escritura(LockLecturaEscritura &lock) :
+		_lock(lock) {
+	_lock.bloquearEscritura();
+}
+
+LockLecturaEscritura::Escritura::~Escritura() {
+	_lock.desbloquearEscritura();
+}
+}
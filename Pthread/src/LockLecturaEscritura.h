@@ -0,0 +1,136 @@
+#ifndef LOCKLECTURAESCRITURA_H_
+#define LOCKLECTURAESCRITURA_H_
+
+#include <cstddef>
+#include "MutexAdaptativo.h"
+
+namespace PThread {
+
+/**
+ * @brief Clase que implementa un lock de lectura/escritura escalable, pensado
+ * para datos que se leen muy seguido y se modifican rara vez (tablas de ruteo,
+ * mapas de sesiones)
+ * @details Cualquier cantidad de hilos puede tener el lock de lectura al mismo
+ * tiempo, mientras que el de escritura es exclusivo. Los lectores se
+ * registran en un contador por procesador, cada uno en su propia línea de
+ * caché, por lo que leer no genera tráfico de coherencia entre núcleos. A
+ * cambio, tomar el lock de escritura debe recorrer todos los contadores
+ * @details Tiene preferencia de escritura: mientras un escritor espera o
+ * escribe, los nuevos lectores esperan
+ */
+
+class LockLecturaEscritura {
+public:
+
+	/**
+	 * @brief Instancia un lock liberado
+	 */
+	LockLecturaEscritura();
+
+	/**
+	 * @brief Método para tomar el lock de lectura
+	 * @post El hilo puede leer los datos protegidos. Si un escritor tiene o
+	 * está esperando el lock, el hilo queda a la espera de que lo libere
+	 * @return El contador donde se registró el lector, que debe pasarse a
+	 * LockLecturaEscritura::desbloquearLectura
+	 */
+	size_t bloquearLectura();
+
+	/**
+	 * @brief Método para liberar el lock de lectura
+	 * @param contador Valor retornado por
+	 * LockLecturaEscritura::bloquearLectura
+	 */
+	void desbloquearLectura(size_t contador);
+
+	/**
+	 * @brief Método para tomar el lock de escritura
+	 * @post El hilo tiene acceso exclusivo a los datos protegidos. Si hay
+	 * otro escritor, o lectores, el hilo queda a la espera de que terminen
+	 */
+	void bloquearEscritura();
+
+	/**
+	 * @brief Método para liberar el lock de escritura
+	 * @pre El hilo actual tiene el lock de escritura
+	 */
+	void desbloquearEscritura();
+
+	/**
+	 * @brief Destructor
+	 * @pre El lock no se encuentra tomado
+	 */
+	~LockLecturaEscritura();
+
+private:
+
+	/* Ocupa una linea de cache completa y se reserva alineado a ella */
+	struct Contador {
+		int lectores;
+		char relleno[64 - sizeof(int)];
+	};
+
+	Contador *contadores;
+	size_t mascara;
+
+	/* 0: sin escritor, 1: con escritor, 2: con escritor y lectores
+	 * dormidos esperandolo */
+	int escritor;
+
+	MutexAdaptativo mutexEscritores;
+
+	LockLecturaEscritura(const LockLecturaEscritura&);
+	LockLecturaEscritura& operator=(const LockLecturaEscritura&);
+
+public:
+
+	/**
+	 * @brief Clase que implementa el patrón RAII para el lock de lectura
+	 */
+
+	class Lectura {
+	public:
+
+		/**
+		 * @brief Construye una Lectura tomando el lock de lectura
+		 * @param lock Lock a tomar
+		 */
+		explicit Lectura(LockLecturaEscritura &lock);
+
+		/**
+		 * @brief Destruye la Lectura liberando el lock de lectura
+		 */
+		~Lectura();
+
+	private:
+
+		LockLecturaEscritura &_lock;
+		size_t _contador;
+	};
+
+	/**
+	 * @brief Clase que implementa el patrón RAII para el lock de escritura
+	 */
+
+	class Escritura {
+	public:
+
+		/**
+		 * @brief Construye una Escritura tomando el lock de escritura
+		 * @param lock Lock a tomar
+		 */
+		explicit Escritura(LockLecturaEscritura &lock);
+
+		/**
+		 * @brief Destruye la Escritura liberando el lock de escritura
+		 */
+		~Escritura();
+
+	private:
+
+		LockLecturaEscritura &_lock;
+	};
+};
+}
+
+#endif
@@ -0,0 +1,163 @@
+#include "LockLecturaEscritura.h"
+#include "SeqLock.h"
+#include "Mutex.h"
+#include "Barrera.h"
+#include "Bench.h"
+#include <cstdio>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+/* Lecturas por segundo de un valor que se lee mucho y se escribe poco,
+ * protegido con LockLecturaEscritura, con SeqLock o con un Mutex, con 1, 8 y
+ * 32 lectores y un escritor */
+
+#define LECTURAS_TOTALES 20000000
+/* Pausa del escritor entre escrituras, en microsegundos */
+#define PAUSA_ESCRITOR 100
+
+namespace PThread {
+
+/* Los cuatro campos valen siempre lo mismo: una lectura con campos distintos
+ * vio una escritura a medias */
+struct Estado {
+	long campos[4];
+};
+
+class ConLockLecturaEscritura {
+public:
+	void leer(Estado &copia) {
+		LockLecturaEscritura::Lectura lectura(lock);
+		copia = estado;
+	}
+	void escribir(long valor) {
+		LockLecturaEscritura::Escritura escritura(lock);
+		for (int i = 0; i < 4; ++i) {
+			estado.campos[i] = valor;
+		}
+	}
+private:
+	LockLecturaEscritura lock;
+	Estado estado;
+};
+
+class ConSeqLock {
+public:
+	void leer(Estado &copia) {
+		copia = lock.leer();
+	}
+	void escribir(long valor) {
+		SeqLock<Estado>::Escritura escritura(lock);
+		for (int i = 0; i < 4; ++i) {
+			escritura.valor().campos[i] = valor;
+		}
+	}
+private:
+	SeqLock<Estado> lock;
+};
+
+class ConMutex {
+public:
+	void leer(Estado &copia) {
+		mutex.bloquear();
+		copia = estado;
+		mutex.desbloquear();
+	}
+	void escribir(long valor) {
+		mutex.bloquear();
+		for (int i = 0; i < 4; ++i) {
+			estado.campos[i] = valor;
+		}
+		mutex.desbloquear();
+	}
+private:
+	Mutex mutex;
+	Estado estado;
+};
+
+template<typename P>
+struct Lecturas {
+	P protegido;
+	Barrera largada;
+	int lecturasPorLector;
+	int lectoresActivos;
+	long escrituras;
+	long inconsistentes;
+	explicit Lecturas(int lectores) :
+			largada(lectores + 2), lecturasPorLector(
+					LECTURAS_TOTALES / lectores), lectoresActivos(lectores),
+			escrituras(0), inconsistentes(0) {
+		protegido.escribir(0);
+	}
+	static void* leer(void *parametro) {
+		Lecturas *lecturas = static_cast<Lecturas*>(parametro);
+		long vistas = 0;
+		lecturas->largada.esperar();
+		for (int i = 0; i < lecturas->lecturasPorLector; ++i) {
+			Estado copia;
+			lecturas->protegido.leer(copia);
+			if (copia.campos[0] != copia.campos[3]) {
+				++vistas;
+			}
+		}
+		__atomic_add_fetch(&lecturas->inconsistentes, vistas,
+				__ATOMIC_RELAXED);
+		__atomic_sub_fetch(&lecturas->lectoresActivos, 1, __ATOMIC_RELEASE);
+		return NULL;
+	}
+	static void* escribir(void *parametro) {
+		Lecturas *lecturas = static_cast<Lecturas*>(parametro);
+		lecturas->largada.esperar();
+		while (__atomic_load_n(&lecturas->lectoresActivos, __ATOMIC_ACQUIRE)
+				> 0) {
+			lecturas->protegido.escribir(++lecturas->escrituras);
+			usleep(PAUSA_ESCRITOR);
+		}
+		return NULL;
+	}
+};
+
+template<typename P>
+static void medir(const char *prueba, int lectores) {
+	Lecturas<P> *lecturas = new Lecturas<P>(lectores);
+	std::vector<pthread_t> hilos(lectores + 1);
+	for (int i = 0; i < lectores; ++i) {
+		pthread_create(&hilos[i], NULL, Lecturas<P>::leer, lecturas);
+	}
+	pthread_create(&hilos[lectores], NULL, Lecturas<P>::escribir, lecturas);
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	lecturas->largada.esperar();
+	for (int i = 0; i < lectores; ++i) {
+		pthread_join(hilos[i], NULL);
+	}
+	double segundos = segundosDesde(inicio);
+	pthread_join(hilos[lectores], NULL);
+	double total = (double) lecturas->lecturasPorLector * lectores;
+	printf("%-24s %2d lectores  %10.0f lecturas/s  %6.1f ns/lectura  "
+			"%6ld escrituras%s\n", prueba, lectores, total / segundos,
+			segundos * 1e9 / total, lecturas->escrituras,
+			(lecturas->inconsistentes > 0) ? "  INCONSISTENTE" : "");
+	delete lecturas;
+}
+
+void benchLecturaMayoritaria() {
+	int lectores[] = { 1, 8, 32 };
+	for (size_t i = 0; i < sizeof(lectores) / sizeof(lectores[0]); ++i) {
+		medir<ConLockLecturaEscritura>("lock lectura/escritura", lectores[i]);
+		medir<ConSeqLock>("seqlock", lectores[i]);
+		medir<ConMutex>("mutex", lectores[i]);
+	}
+}
+
+}
+
+#ifdef LOCKLECTURAESCRITURA_BENCH
+int main() {
+	printf("%d lecturas, una escritura cada %d us\n", LECTURAS_TOTALES,
+			PAUSA_ESCRITOR);
+	PThread::benchLecturaMayoritaria();
+	return 0;
+}
+#endif
@@ -49,6 +49,12 @@ std::string MultiHiloExcepcion::codigoAstring() const {
 		return std::string("CANCEL_SELF_ERROR");
 	case THREAD_ID_INVALIDO:
 		return std::string("THREAD_ID_INVALIDO");
+	case SIN_PERMISOS:
+		return std::string("SIN_PERMISOS");
+	case PROMESA_ROTA:
+		return std::string("PROMESA_ROTA");
+	case FUTURO_CON_ERROR:
+		return std::string("FUTURO_CON_ERROR");
 	}
 	return std::string("CODIGO DESCONOCIDO");
 }
@@ -29,6 +29,10 @@ public:
 		JOIN_SELF_ERROR,        //!< Intento de join consigo mismo
 		CANCEL_SELF_ERROR,      //!< Intento de cancel consigo mismo
 		THREAD_ID_INVALIDO,     //!< No existe un hilo con ese id
+		SIN_PERMISOS,           //!< No se tienen privilegios para los
+								//!< atributos pedidos
+		PROMESA_ROTA,           //!< Se destruyó una Promesa sin resultado
+		FUTURO_CON_ERROR,       //!< La operación de un Futuro falló
 	};
 
 	/**
@@ -2,25 +2,66 @@
 
 namespace PThread {
 
+#ifdef MUTEX_PERFILADO
+Mutex::Mutex() : perfil(NULL) {
+#else
 Mutex::Mutex() {
+#endif
+	pthread_mutex_init(&mutex, NULL);
+	pthread_cond_init(&condVar, 0);
+}
+
+#ifdef MUTEX_PERFILADO
+Mutex::Mutex(const char *nombre) : perfil(nombre) {
+#else
+Mutex::Mutex(const char*) {
+#endif
 	pthread_mutex_init(&mutex, NULL);
 	pthread_cond_init(&condVar, 0);
 }
 
 bool Mutex::bloquear() {
+#ifdef MUTEX_PERFILADO
+	if (RegistroMutex::estaActivo()) {
+		return bloquearPerfilado();
+	}
+#endif
 	return (pthread_mutex_lock(&mutex) == 0);
 }
 
 bool Mutex::intentarBloquear() {
+#ifdef MUTEX_PERFILADO
+	if (pthread_mutex_trylock(&mutex) != 0) {
+		return false;
+	}
+	if (RegistroMutex::estaActivo()) {
+		perfil.registrarAdquisicion(false, 0);
+	}
+	return true;
+#else
 	return (pthread_mutex_trylock(&mutex) == 0);
+#endif
 }
 
 bool Mutex::desbloquear() {
+#ifdef MUTEX_PERFILADO
+	perfil.registrarLiberacion();
+#endif
 	return (pthread_mutex_unlock(&mutex) == 0);
 }
 
 void Mutex::wait() {
+#ifdef MUTEX_PERFILADO
+	/* Durante la espera el mutex no esta tomado, asi que se cierra la
+	 * medicion de retencion y se abre otra al despertar */
+	perfil.registrarLiberacion();
 	pthread_cond_wait(&condVar, &mutex);
+	if (RegistroMutex::estaActivo()) {
+		perfil.inicioRetencion = PerfilMutex::ahora();
+	}
+#else
+	pthread_cond_wait(&condVar, &mutex);
+#endif
 }
 
 void Mutex::signal() {
@@ -32,6 +73,23 @@ Mutex::~Mutex() {
 	pthread_cond_destroy(&condVar);
 }
 
+#ifdef MUTEX_PERFILADO
+bool Mutex::bloquearPerfilado() {
+	/* Primero se intenta sin esperar, para distinguir las adquisiciones
+	 * contendidas sin leer el reloj en el caso comun */
+	if (pthread_mutex_trylock(&mutex) == 0) {
+		perfil.registrarAdquisicion(false, 0);
+		return true;
+	}
+	uint64_t inicio = PerfilMutex::ahora();
+	if (pthread_mutex_lock(&mutex) != 0) {
+		return false;
+	}
+	perfil.registrarAdquisicion(true, PerfilMutex::ahora() - inicio);
+	return true;
+}
+#endif
+
 Mutex::Lock::Lock(Mutex &mutex) : _mutex(mutex) {
 	_mutex.bloquear();
 }
@@ -2,6 +2,14 @@
 #define MUTEX_H_
 
 #include <pthread.h>
+#ifdef MUTEX_PERFILADO
+#include "PerfilMutex.h"
+#endif
+
+/* Arma una etiqueta con el nombre y el lugar de declaracion del mutex */
+#define MUTEX_CADENA_(x) #x
+#define MUTEX_CADENA(x) MUTEX_CADENA_(x)
+#define MUTEX_SITIO(nombre) nombre " (" __FILE__ ":" MUTEX_CADENA(__LINE__) ")"
 
 namespace PThread {
 
@@ -9,6 +17,11 @@ namespace PThread {
  * @brief Clase para manejar los mutex de POSIX threads. Tiene una interfaz muy
  * simple, con los métodos básicos y solo se manejan mutex creados con los
  * atributos por defecto
+ * @details Si se compila con <tt>MUTEX_PERFILADO</tt> definido, cada mutex
+ * registra sus adquisiciones, contención y tiempos de espera y retención en
+ * RegistroMutex. Sin esa definición no se agrega ningún campo ni instrucción.
+ * Todo el programa debe compilarse con la misma definición, ya que cambia el
+ * tamaño de la clase
  */
 
 class Mutex {
@@ -19,6 +32,15 @@ public:
 	 */
 	Mutex();
 
+	/**
+	 * @brief Instancia un mutex con los atributos por defecto y una etiqueta
+	 * para identificarlo en el reporte de contención
+	 * @param nombre Etiqueta del mutex, por ejemplo
+	 * <tt>MUTEX_SITIO("cola global")</tt>. Debe seguir viva mientras exista
+	 * el mutex. Se ignora si no se compila con <tt>MUTEX_PERFILADO</tt>
+	 */
+	explicit Mutex(const char *nombre);
+
 	/**
 	 * @brief Método para bloquear el mutex e impedir a otros threads acceder a
 	 * código salvaguardado por el mismo mutex hasta que sea liberado
@@ -78,9 +100,17 @@ public:
 
 private:
 
+	friend class Condicion;
+
 	pthread_mutex_t mutex;
 	pthread_cond_t condVar;
 
+#ifdef MUTEX_PERFILADO
+	PerfilMutex perfil;
+
+	bool bloquearPerfilado();
+#endif
+
 public:
 
 	/**
@@ -0,0 +1,108 @@
+#include "MutexAdaptativo.h"
+#include "Futex.h"
+
+#define LIBERADO 0
+#define BLOQUEADO 1
+#define CON_ESPERA 2
+
+/* Limites de la espera activa antes de dormir en el futex */
+#define MAX_GIROS 100
+#define MAX_PAUSAS 64
+
+namespace PThread {
+
+MutexAdaptativo::MutexAdaptativo() {
+	estado = LIBERADO;
+	secuencia = 0;
+	promedioGiros = 0;
+}
+
+bool MutexAdaptativo::bloquear() {
+	int esperado = LIBERADO;
+	if (!__atomic_compare_exchange_n(&estado, &esperado, BLOQUEADO, false,
+			__ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+		bloquearConContencion();
+	}
+	return true;
+}
+
+void MutexAdaptativo::bloquearConContencion() {
+	/* Espera activa, como la de PTHREAD_MUTEX_ADAPTIVE_NP: se permite girar
+	 * hasta el doble de lo que se necesito en promedio, y el promedio se
+	 * ajusta con lo que se giro esta vez */
+	int promedio = __atomic_load_n(&promedioGiros, __ATOMIC_RELAXED);
+	int maximo = 2 * promedio + 10;
+	if (maximo > MAX_GIROS) {
+		maximo = MAX_GIROS;
+	}
+	int pausas = 1;
+	for (int giros = 0; giros < maximo; ++giros) {
+		for (int i = 0; i < pausas; ++i) {
+			pausaCPU();
+		}
+		if (pausas < MAX_PAUSAS) {
+			pausas *= 2;
+		}
+		int esperado = LIBERADO;
+		if (__atomic_load_n(&estado, __ATOMIC_RELAXED) == LIBERADO &&
+				__atomic_compare_exchange_n(&estado, &esperado, BLOQUEADO,
+						false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+			__atomic_store_n(&promedioGiros,
+					promedio + (giros - promedio) / 8, __ATOMIC_RELAXED);
+			return;
+		}
+	}
+	__atomic_store_n(&promedioGiros, promedio + (maximo - promedio) / 8,
+			__ATOMIC_RELAXED);
+
+	/* Me duermo marcando que hay hilos esperando, para que quien libere el
+	 * mutex sepa que tiene que despertar a alguno */
+	while (__atomic_exchange_n(&estado, CON_ESPERA, __ATOMIC_ACQUIRE)
+			!= LIBERADO) {
+		futexEsperar(&estado, CON_ESPERA);
+	}
+}
+
+bool MutexAdaptativo::intentarBloquear() {
+	int esperado = LIBERADO;
+	return __atomic_compare_exchange_n(&estado, &esperado, BLOQUEADO, false,
+			__ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+bool MutexAdaptativo::desbloquear() {
+	int previo = __atomic_exchange_n(&estado, LIBERADO, __ATOMIC_RELEASE);
+	if (previo == CON_ESPERA) {
+		futexDespertar(&estado, 1);
+	}
+	return (previo != LIBERADO);
+}
+
+void MutexAdaptativo::wait() {
+	int actual = __atomic_load_n(&secuencia, __ATOMIC_RELAXED);
+	desbloquear();
+	futexEsperar(&secuencia, actual);
+
+	/* Al volver puede haber otros hilos despertados esperando el mutex, por
+	 * lo que se lo toma marcandolo con espera */
+	while (__atomic_exchange_n(&estado, CON_ESPERA, __ATOMIC_ACQUIRE)
+			!= LIBERADO) {
+		futexEsperar(&estado, CON_ESPERA);
+	}
+}
+
+void MutexAdaptativo::signal() {
+	__atomic_add_fetch(&secuencia, 1, __ATOMIC_RELEASE);
+	futexDespertar(&secuencia, 1);
+}
+
+MutexAdaptativo::~MutexAdaptativo() {
+}
+
+MutexAdaptativo::Lock::Lock(MutexAdaptativo &mutex) : _mutex(mutex) {
+	_mutex.bloquear();
+}
+
+MutexAdaptativo::Lock::~Lock() {
+	_mutex.desbloquear();
+}
+}
@@ -0,0 +1,126 @@
+#ifndef MUTEXADAPTATIVO_H_
+#define MUTEXADAPTATIVO_H_
+
+namespace PThread {
+
+/**
+ * @brief Clase alternativa a Mutex, implementada directamente sobre un futex,
+ * pensada para secciones críticas cortas. Tiene la misma interfaz que Mutex,
+ * por lo que pueden intercambiarse
+ * @details Si el mutex está bloqueado, antes de dormir al hilo en el kernel
+ * se espera activamente una cantidad acotada de iteraciones (con pausas que
+ * crecen exponencialmente), ya que es probable que el dueño lo libere en
+ * poco tiempo. La cantidad de iteraciones se adapta según cuánto se tuvo que
+ * esperar en las adquisiciones anteriores
+ * @details Liberar un mutex sin hilos dormidos no realiza llamadas al sistema
+ */
+
+class MutexAdaptativo {
+public:
+
+	/**
+	 * @brief Instancia un mutex liberado
+	 */
+	MutexAdaptativo();
+
+	/**
+	 * @brief Método para bloquear el mutex e impedir a otros threads acceder a
+	 * código salvaguardado por el mismo mutex hasta que sea liberado
+	 * @pre El hilo actual no está en posesión del mutex (no lo bloqueó)
+	 * @post Si el mutex se encuentra liberado, el hilo actual se apropia del
+	 * mismo y lo bloquea. Si ya se encontraba bloqueado, el hilo espera
+	 * activamente un tiempo acotado y luego se duerme hasta que se le pueda
+	 * asignar el mutex
+	 * @return <tt>true</tt> siempre
+	 */
+	bool bloquear();
+
+	/**
+	 * @brief Método para intentar bloquear el mutex, sin esperar
+	 * @post Si el mutex se encuentra liberado, el hilo actual se apropia del
+	 * mismo y lo bloquea. Si ya se encontraba bloqueado, se retorna false y
+	 * el hilo actual sigue su ejecución
+	 * @return <tt>true</tt> si se logra bloquear el mutex
+	 * @return <tt>false</tt> si el mutex se encontraba ya bloqueado
+	 */
+	bool intentarBloquear();
+
+	/**
+	 * @brief Método para liberar el mutex por parte del hilo en ejecución
+	 * @pre El hilo actual debe estar en posesión del mutex
+	 * @post El mutex queda liberado y, si había hilos dormidos esperándolo,
+	 * se despierta a uno
+	 * @return <tt>true</tt> si se libera el mutex
+	 * @return <tt>false</tt> si el mutex ya estaba liberado
+	 */
+	bool desbloquear();
+
+	/**
+	 * @brief Hace esperar al thread en ejecución hasta que reciba la señal
+	 * enviada por MutexAdaptativo::signal
+	 * @pre El hilo actual debe estar en posesión del mutex
+	 * @post El mutex se libera durante la espera y se vuelve a bloquear
+	 * antes de retornar. Puede retornar sin haber recibido una señal, por lo
+	 * que la condición esperada debe volver a verificarse
+	 */
+	void wait();
+
+	/**
+	 * @brief Método que despierta a uno de los threads que están bloqueados
+	 * por el método MutexAdaptativo::wait
+	 */
+	void signal();
+
+	/**
+	 * @brief Destructor
+	 * @pre Mutex no se encuentra bloqueado
+	 */
+	~MutexAdaptativo();
+
+private:
+
+	/* 0: liberado, 1: bloqueado sin hilos dormidos, 2: bloqueado con
+	 * posibles hilos dormidos */
+	int estado;
+
+	/* Contador de señales de wait/signal */
+	int secuencia;
+
+	/* Promedio de iteraciones de espera activa en las ultimas
+	 * adquisiciones con contencion */
+	int promedioGiros;
+
+	void bloquearConContencion();
+
+	MutexAdaptativo(const MutexAdaptativo&);
+	MutexAdaptativo& operator=(const MutexAdaptativo&);
+
+public:
+
+	/**
+	 * @brief Clase que implementa el patrón RAII para la clase
+	 * MutexAdaptativo
+	 */
+
+	class Lock {
+	public:
+
+		/**
+		 * @brief Construye un Lock bloqueando el mutex
+		 * @param mutex Mutex a bloquear
+		 */
+		explicit Lock(MutexAdaptativo &mutex);
+
+		/**
+		 * @brief Destruye el Lock desbloqueando el mutex
+		 */
+		~Lock();
+
+	private:
+
+		MutexAdaptativo &_mutex;
+	};
+};
+}
+
+#endif
@@ -0,0 +1,110 @@
+#include "MutexAdaptativo.h"
+#include "Mutex.h"
+#include "Barrera.h"
+#include "Bench.h"
+#include <cstdio>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <vector>
+
+/* MutexAdaptativo frente a Mutex con 1 a 64 hilos compitiendo por un mismo
+ * lock, con secciones críticas cortas y largas */
+
+/* Adquisiciones totales, repartidas entre los hilos */
+#define ADQUISICIONES_CORTAS 400000
+#define ADQUISICIONES_LARGAS 40000
+/* Trabajo dentro y fuera de la sección crítica, en iteraciones */
+#define RETENCION_CORTA 0
+#define RETENCION_LARGA 1000
+#define TRABAJO_FUERA 50
+#define MAXIMO_HILOS 64
+
+namespace PThread {
+
+static void trabajar(int iteraciones) {
+	for (volatile int i = 0; i < iteraciones; ++i) {
+	}
+}
+
+template<typename M>
+struct Competencia {
+	M mutex;
+	Barrera largada;
+	int adquisiciones;
+	int retencion;
+	long protegido;
+	Competencia(int hilos, int adquisiciones, int retencion) :
+			largada(hilos + 1), adquisiciones(adquisiciones),
+			retencion(retencion), protegido(0) {
+	}
+	static void* competir(void *parametro) {
+		Competencia *competencia = static_cast<Competencia*>(parametro);
+		competencia->largada.esperar();
+		for (int i = 0; i < competencia->adquisiciones; ++i) {
+			competencia->mutex.bloquear();
+			++competencia->protegido;
+			trabajar(competencia->retencion);
+			competencia->mutex.desbloquear();
+			trabajar(TRABAJO_FUERA);
+		}
+		return NULL;
+	}
+};
+
+/* Cambios de contexto, voluntarios e involuntarios, de todo el proceso */
+static long cambiosDeContexto() {
+	struct rusage uso;
+	getrusage(RUSAGE_SELF, &uso);
+	return uso.ru_nvcsw + uso.ru_nivcsw;
+}
+
+template<typename M>
+static void medir(const char *prueba, int hilos, int total, int retencion) {
+	Competencia<M> competencia(hilos, total / hilos, retencion);
+	std::vector<pthread_t> competidores(hilos);
+	for (int i = 0; i < hilos; ++i) {
+		pthread_create(&competidores[i], NULL, Competencia<M>::competir,
+				&competencia);
+	}
+	long cambios = cambiosDeContexto();
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	competencia.largada.esperar();
+	for (int i = 0; i < hilos; ++i) {
+		pthread_join(competidores[i], NULL);
+	}
+	double segundos = segundosDesde(inicio);
+	double operaciones = (double) competencia.adquisiciones * hilos;
+	printf("%-10s %2d hilos  %10.0f ops/s  %8.1f ns/op  %7ld cambios%s\n",
+			prueba, hilos, operaciones / segundos, segundos * 1e9 / operaciones,
+			cambiosDeContexto() - cambios,
+			(competencia.protegido != (long) operaciones) ? "  ERROR" : "");
+}
+
+static void medirRetencion(const char *titulo, int total, int retencion) {
+	printf("%s: %d iteraciones dentro, %d fuera\n", titulo, retencion,
+			TRABAJO_FUERA);
+	for (int hilos = 1; hilos <= MAXIMO_HILOS; hilos *= 2) {
+		medir<MutexAdaptativo>("adaptativo", hilos, total, retencion);
+		medir<Mutex>("pthread", hilos, total, retencion);
+	}
+}
+
+void benchRetencionCorta() {
+	medirRetencion("retencion corta", ADQUISICIONES_CORTAS, RETENCION_CORTA);
+}
+
+void benchRetencionLarga() {
+	medirRetencion("retencion larga", ADQUISICIONES_LARGAS, RETENCION_LARGA);
+}
+
+}
+
+#ifdef MUTEXADAPTATIVO_BENCH
+int main() {
+	PThread::benchRetencionCorta();
+	PThread::benchRetencionLarga();
+	return 0;
+}
+#endif
@@ -0,0 +1,208 @@
+#include "PerfilMutex.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <time.h>
+#include <vector>
+
+#define NANOS_POR_SEGUNDO 1000000000ull
+#define NANOS_POR_MICRO 1000.0
+
+namespace PThread {
+
+bool RegistroMutex::activo = true;
+pthread_mutex_t RegistroMutex::mutex = PTHREAD_MUTEX_INITIALIZER;
+PerfilMutex *RegistroMutex::primero = NULL;
+
+/* Casillero del histograma logaritmico que corresponde a una medicion */
+static size_t casillero(uint64_t nanos) {
+	if (nanos == 0) {
+		return 0;
+	}
+	size_t indice = 63 - (size_t) __builtin_clzll(nanos);
+	return (indice < PerfilMutex::CASILLEROS) ?
+			indice : PerfilMutex::CASILLEROS - 1;
+}
+
+/* Cota superior aproximada del percentil pedido, en nanosegundos */
+static uint64_t percentil(const uint64_t *histograma, uint64_t total,
+		double fraccion) {
+	if (total == 0) {
+		return 0;
+	}
+	uint64_t objetivo = (uint64_t) (fraccion * total);
+	uint64_t acumulado = 0;
+	for (size_t i = 0; i < PerfilMutex::CASILLEROS; ++i) {
+		acumulado += histograma[i];
+		if (acumulado > objetivo) {
+			return 2ull << i;
+		}
+	}
+	return 2ull << (PerfilMutex::CASILLEROS - 1);
+}
+
+PerfilMutex::PerfilMutex(const char *nombre) :
+		nombre(nombre), anterior(NULL), siguiente(NULL) {
+	adquisiciones = 0;
+	contendidas = 0;
+	esperaTotal = 0;
+	retencionTotal = 0;
+	memset(histogramaEspera, 0, sizeof(histogramaEspera));
+	memset(histogramaRetencion, 0, sizeof(histogramaRetencion));
+	inicioRetencion = 0;
+	RegistroMutex::registrar(this);
+}
+
+void PerfilMutex::registrarAdquisicion(bool contendida, uint64_t espera) {
+	/* Se invoca con el mutex tomado, asi que no hace falta sincronizar las
+	 * escrituras entre duenios sucesivos */
+	++adquisiciones;
+	if (contendida) {
+		++contendidas;
+		esperaTotal += espera;
+	}
+	++histogramaEspera[casillero(espera)];
+	inicioRetencion = ahora();
+}
+
+void PerfilMutex::registrarLiberacion() {
+	if (inicioRetencion == 0) {
+		/* Se activo la medicion con el mutex ya tomado */
+		return;
+	}
+	uint64_t retencion = ahora() - inicioRetencion;
+	inicioRetencion = 0;
+	retencionTotal += retencion;
+	++histogramaRetencion[casillero(retencion)];
+}
+
+PerfilMutex::~PerfilMutex() {
+	RegistroMutex::desregistrar(this);
+}
+
+uint64_t PerfilMutex::ahora() {
+	struct timespec tiempo;
+	clock_gettime(CLOCK_MONOTONIC, &tiempo);
+	return (uint64_t) tiempo.tv_sec * NANOS_POR_SEGUNDO + tiempo.tv_nsec;
+}
+
+void RegistroMutex::setActivo(bool activo) {
+	__atomic_store_n(&RegistroMutex::activo, activo, __ATOMIC_RELAXED);
+}
+
+namespace {
+
+/* Copia de las estadisticas de un mutex al momento del reporte */
+struct Muestra {
+	const char *nombre;
+	uint64_t adquisiciones;
+	uint64_t contendidas;
+	uint64_t esperaTotal;
+	uint64_t retencionTotal;
+	uint64_t histogramaEspera[PerfilMutex::CASILLEROS];
+	uint64_t histogramaRetencion[PerfilMutex::CASILLEROS];
+};
+
+bool mayorEspera(const Muestra &a, const Muestra &b) {
+	return (a.esperaTotal > b.esperaTotal);
+}
+}
+
+void RegistroMutex::generarReporte(std::ostream &salida, size_t cantidad) {
+	std::vector<Muestra> muestras;
+	pthread_mutex_lock(&mutex);
+	for (PerfilMutex *perfil = primero; perfil != NULL;
+			perfil = perfil->siguiente) {
+		/* Las estadisticas se leen sin tomar el mutex perfilado, por lo que
+		 * pueden estar levemente desfasadas entre si */
+		Muestra muestra;
+		muestra.nombre = perfil->nombre;
+		muestra.adquisiciones = perfil->adquisiciones;
+		muestra.contendidas = perfil->contendidas;
+		muestra.esperaTotal = perfil->esperaTotal;
+		muestra.retencionTotal = perfil->retencionTotal;
+		memcpy(muestra.histogramaEspera, perfil->histogramaEspera,
+				sizeof(muestra.histogramaEspera));
+		memcpy(muestra.histogramaRetencion, perfil->histogramaRetencion,
+				sizeof(muestra.histogramaRetencion));
+		muestras.push_back(muestra);
+	}
+	pthread_mutex_unlock(&mutex);
+
+	std::sort(muestras.begin(), muestras.end(), mayorEspera);
+	if (cantidad == 0 || cantidad > muestras.size()) {
+		cantidad = muestras.size();
+	}
+
+	salida << "Contencion de mutex (" << muestras.size()
+			<< " registrados, tiempos en us)" << std::endl;
+	salida << std::setw(12) << "adquis." << std::setw(12) << "contend."
+			<< std::setw(8) << "%" << std::setw(14) << "espera tot."
+			<< std::setw(12) << "espera p99" << std::setw(12) << "reten. prom"
+			<< std::setw(12) << "reten. p99" << "  mutex" << std::endl;
+	salida << std::fixed << std::setprecision(1);
+	for (size_t i = 0; i < cantidad; ++i) {
+		const Muestra &m = muestras[i];
+		double porcentaje = (m.adquisiciones > 0) ?
+				100.0 * m.contendidas / m.adquisiciones : 0.0;
+		uint64_t liberaciones = 0;
+		for (size_t j = 0; j < PerfilMutex::CASILLEROS; ++j) {
+			liberaciones += m.histogramaRetencion[j];
+		}
+		double retencionPromedio = (liberaciones > 0) ?
+				(double) m.retencionTotal / liberaciones / NANOS_POR_MICRO :
+				0.0;
+		salida << std::setw(12) << m.adquisiciones << std::setw(12)
+				<< m.contendidas << std::setw(8) << porcentaje
+				<< std::setw(14) << m.esperaTotal / NANOS_POR_MICRO
+				<< std::setw(12)
+				<< percentil(m.histogramaEspera, m.adquisiciones, 0.99)
+						/ NANOS_POR_MICRO << std::setw(12)
+				<< retencionPromedio << std::setw(12)
+				<< percentil(m.histogramaRetencion, liberaciones, 0.99)
+						/ NANOS_POR_MICRO << "  "
+				<< ((m.nombre != NULL) ? m.nombre : "(sin nombre)")
+				<< std::endl;
+	}
+}
+
+void RegistroMutex::reiniciar() {
+	pthread_mutex_lock(&mutex);
+	for (PerfilMutex *perfil = primero; perfil != NULL;
+			perfil = perfil->siguiente) {
+		perfil->adquisiciones = 0;
+		perfil->contendidas = 0;
+		perfil->esperaTotal = 0;
+		perfil->retencionTotal = 0;
+		memset(perfil->histogramaEspera, 0, sizeof(perfil->histogramaEspera));
+		memset(perfil->histogramaRetencion, 0,
+				sizeof(perfil->histogramaRetencion));
+	}
+	pthread_mutex_unlock(&mutex);
+}
+
+void RegistroMutex::registrar(PerfilMutex *perfil) {
+	pthread_mutex_lock(&mutex);
+	perfil->anterior = NULL;
+	perfil->siguiente = primero;
+	if (primero != NULL) {
+		primero->anterior = perfil;
+	}
+	primero = perfil;
+	pthread_mutex_unlock(&mutex);
+}
+
+void RegistroMutex::desregistrar(PerfilMutex *perfil) {
+	pthread_mutex_lock(&mutex);
+	if (perfil->anterior != NULL) {
+		perfil->anterior->siguiente = perfil->siguiente;
+	}
+	else {
+		primero = perfil->siguiente;
+	}
+	if (perfil->siguiente != NULL) {
+		perfil->siguiente->anterior = perfil->anterior;
+	}
+	pthread_mutex_unlock(&mutex);
+}
+}
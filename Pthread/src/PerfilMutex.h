@@ -0,0 +1,132 @@
+#ifndef PERFILMUTEX_H_
+#define PERFILMUTEX_H_
+
+#include <pthread.h>
+#include <stdint.h>
+#include <ostream>
+
+namespace PThread {
+
+/**
+ * @brief Estadísticas de contención de un mutex. Solo se recolectan si se
+ * compila con <tt>MUTEX_PERFILADO</tt> definido
+ * @details Los tiempos se guardan en histogramas de escala logarítmica: el
+ * casillero <tt>i</tt> cuenta las mediciones de entre 2^i y 2^(i+1)
+ * nanosegundos
+ */
+
+struct PerfilMutex {
+
+	enum {
+		CASILLEROS = 40
+	};
+
+	const char *nombre;
+	uint64_t adquisiciones;
+	uint64_t contendidas;
+	uint64_t esperaTotal;
+	uint64_t retencionTotal;
+	uint64_t histogramaEspera[CASILLEROS];
+	uint64_t histogramaRetencion[CASILLEROS];
+
+	/* Momento en que el dueño actual tomo el mutex, 0 si no se mide */
+	uint64_t inicioRetencion;
+
+	/* Lista de perfiles registrados */
+	PerfilMutex *anterior;
+	PerfilMutex *siguiente;
+
+	/**
+	 * @brief Inicializa las estadísticas en cero y las registra en
+	 * RegistroMutex
+	 * @param nombre Etiqueta del mutex, puede ser <tt>NULL</tt>. Debe seguir
+	 * viva mientras exista el mutex (normalmente un literal)
+	 */
+	explicit PerfilMutex(const char *nombre);
+
+	/**
+	 * @brief Registra una adquisición del mutex
+	 * @pre El hilo actual está en posesión del mutex
+	 * @param contendida Si el mutex estaba tomado al intentar adquirirlo
+	 * @param espera Nanosegundos esperados hasta adquirirlo
+	 */
+	void registrarAdquisicion(bool contendida, uint64_t espera);
+
+	/**
+	 * @brief Registra la liberación del mutex y el tiempo que estuvo tomado
+	 * @pre El hilo actual está en posesión del mutex
+	 */
+	void registrarLiberacion();
+
+	/**
+	 * @brief Quita las estadísticas de RegistroMutex
+	 */
+	~PerfilMutex();
+
+	/**
+	 * @brief Método para obtener el tiempo actual del reloj monótono
+	 * @return El tiempo en nanosegundos
+	 */
+	static uint64_t ahora();
+
+private:
+
+	PerfilMutex(const PerfilMutex&);
+	PerfilMutex& operator=(const PerfilMutex&);
+};
+
+/**
+ * @brief Registro global de los mutex perfilados. Permite activar o
+ * desactivar la medición en tiempo de ejecución y generar un reporte de los
+ * mutex ordenados por tiempo total de espera
+ * @details Si no se compila con <tt>MUTEX_PERFILADO</tt>, el registro queda
+ * siempre vacío
+ */
+
+class RegistroMutex {
+public:
+
+	/**
+	 * @brief Método para activar o desactivar la medición. Por defecto está
+	 * activa
+	 * @param activo <tt>true</tt> para medir
+	 */
+	static void setActivo(bool activo);
+
+	/**
+	 * @brief Método para consultar si la medición está activa
+	 * @return <tt>true</tt> si está activa
+	 */
+	static bool estaActivo() {
+		return __atomic_load_n(&activo, __ATOMIC_RELAXED);
+	}
+
+	/**
+	 * @brief Método para escribir el reporte de contención, con los mutex
+	 * ordenados de mayor a menor tiempo total de espera
+	 * @param salida Flujo donde se escribe el reporte
+	 * @param cantidad Cantidad máxima de mutex a listar, 0 para todos
+	 */
+	static void generarReporte(std::ostream &salida, size_t cantidad = 0);
+
+	/**
+	 * @brief Método para poner en cero las estadísticas de todos los mutex
+	 * registrados
+	 */
+	static void reiniciar();
+
+private:
+
+	friend struct PerfilMutex;
+
+	static bool activo;
+	/* Se usa un pthread_mutex_t para no perfilar el propio registro */
+	static pthread_mutex_t mutex;
+	static PerfilMutex *primero;
+
+	static void registrar(PerfilMutex *perfil);
+	static void desregistrar(PerfilMutex *perfil);
+};
+}
+
+#endif
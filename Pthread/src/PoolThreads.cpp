@@ -0,0 +1,191 @@
+#include "PoolThreads.h"
+#include <cstdlib>
+#include <sched.h>
+#include <sstream>
+#include <unistd.h>
+
+/* Cantidad de veces que un hilo sin trabajo vuelve a buscar antes de
+ * dormirse */
+#define BUSQUEDAS_ANTES_DE_DORMIR 64
+
+namespace POSIX {
+
+/* Hilo del pool que se esta ejecutando y su pool, NULL si no es un hilo de
+ * un pool */
+static __thread void *trabajadorActual = NULL;
+static __thread PoolThreads *poolActual = NULL;
+
+PoolThreads::PoolThreads(size_t cantidadHilos) :
+		mutexGlobal(MUTEX_SITIO("PoolThreads::mutexGlobal")),
+		mutexDormidos(MUTEX_SITIO("PoolThreads::mutexDormidos")) {
+	tamanioColaGlobal = 0;
+	dormidos = 0;
+	terminando = false;
+	detenido = false;
+	if (cantidadHilos == 0) {
+		long procesadores = sysconf(_SC_NPROCESSORS_ONLN);
+		cantidadHilos = (procesadores > 0) ? (size_t) procesadores : 1;
+	}
+
+	/* Primero creo todos los hilos, ya que apenas se inicia uno puede
+	 * intentar robarle tareas a cualquiera de los otros */
+	for (size_t i = 0; i < cantidadHilos; ++i) {
+		trabajadores.push_back(new Trabajador(*this, i));
+		std::ostringstream nombre;
+		nombre << "pool-" << i;
+		trabajadores[i]->setNombre(nombre.str());
+	}
+	for (size_t i = 0; i < cantidadHilos; ++i) {
+		trabajadores[i]->iniciar();
+	}
+}
+
+void PoolThreads::enviar(Tarea *tarea) {
+	if (poolActual == this) {
+		((Trabajador*) trabajadorActual)->cola.insertar(tarea);
+	}
+	else {
+		PThread::Mutex::Lock lock(mutexGlobal);
+		colaGlobal.push_back(tarea);
+		__atomic_store_n(&tamanioColaGlobal, colaGlobal.size(),
+				__ATOMIC_RELEASE);
+	}
+	despertar();
+}
+
+void PoolThreads::detener() {
+	if (detenido) {
+		return;
+	}
+	{
+		PThread::Mutex::Lock lock(mutexDormidos);
+		terminando = true;
+		for (size_t i = 0; i < trabajadores.size(); ++i) {
+			mutexDormidos.signal();
+		}
+	}
+	for (size_t i = 0; i < trabajadores.size(); ++i) {
+		void *retorno;
+		Thread::esperarThread(*trabajadores[i], retorno);
+		delete trabajadores[i];
+	}
+	trabajadores.clear();
+	detenido = true;
+}
+
+size_t PoolThreads::getCantidadHilos() const {
+	return trabajadores.size();
+}
+
+PoolThreads::~PoolThreads() {
+	detener();
+}
+
+Tarea* PoolThreads::extraerGlobal() {
+	if (__atomic_load_n(&tamanioColaGlobal, __ATOMIC_ACQUIRE) == 0) {
+		return NULL;
+	}
+	PThread::Mutex::Lock lock(mutexGlobal);
+	if (colaGlobal.empty()) {
+		return NULL;
+	}
+	Tarea *tarea = colaGlobal.front();
+	colaGlobal.pop_front();
+	__atomic_store_n(&tamanioColaGlobal, colaGlobal.size(), __ATOMIC_RELEASE);
+	return tarea;
+}
+
+bool PoolThreads::hayTrabajo() const {
+	if (__atomic_load_n(&tamanioColaGlobal, __ATOMIC_ACQUIRE) > 0) {
+		return true;
+	}
+	for (size_t i = 0; i < trabajadores.size(); ++i) {
+		if (!trabajadores[i]->cola.estaVacia()) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void PoolThreads::despertar() {
+	/* Junto con el incremento de dormidos en dormir(), garantiza que o bien
+	 * el hilo que se va a dormir ve la tarea nueva, o bien aca se ve que hay
+	 * un hilo dormido y se lo despierta */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&dormidos, __ATOMIC_RELAXED) > 0) {
+		PThread::Mutex::Lock lock(mutexDormidos);
+		mutexDormidos.signal();
+	}
+}
+
+bool PoolThreads::dormir() {
+	PThread::Mutex::Lock lock(mutexDormidos);
+	__atomic_add_fetch(&dormidos, 1, __ATOMIC_SEQ_CST);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	bool salir = false;
+	if (!hayTrabajo()) {
+		if (terminando) {
+			salir = true;
+		}
+		else {
+			mutexDormidos.wait();
+		}
+	}
+	__atomic_sub_fetch(&dormidos, 1, __ATOMIC_SEQ_CST);
+	return salir;
+}
+
+PoolThreads::Trabajador::Trabajador(PoolThreads &pool, size_t indice) :
+		pool(pool), indice(indice) {
+	semilla = (unsigned int) indice * 2654435761u + 1;
+}
+
+void* PoolThreads::Trabajador::ejecutar(void*) {
+	trabajadorActual = this;
+	poolActual = &pool;
+	int busquedas = 0;
+	while (true) {
+		Tarea *tarea = buscarTarea();
+		if (tarea != NULL) {
+			tarea->ejecutar();
+			busquedas = 0;
+			continue;
+		}
+		if (++busquedas < BUSQUEDAS_ANTES_DE_DORMIR) {
+			sched_yield();
+			continue;
+		}
+		busquedas = 0;
+		if (pool.dormir()) {
+			break;
+		}
+	}
+	trabajadorActual = NULL;
+	poolActual = NULL;
+	return NULL;
+}
+
+Tarea* PoolThreads::Trabajador::buscarTarea() {
+	Tarea *tarea = cola.extraer();
+	if (tarea != NULL) {
+		return tarea;
+	}
+	tarea = pool.extraerGlobal();
+	if (tarea != NULL) {
+		return tarea;
+	}
+	size_t cantidad = pool.trabajadores.size();
+	for (size_t intento = 0; cantidad > 1 && intento < 2 * cantidad;
+			++intento) {
+		size_t victima = (size_t) rand_r(&semilla) % cantidad;
+		if (victima == indice) {
+			continue;
+		}
+		tarea = pool.trabajadores[victima]->cola.robar();
+		if (tarea != NULL) {
+			return tarea;
+		}
+	}
+	return NULL;
+}
+}
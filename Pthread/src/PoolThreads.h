@@ -0,0 +1,104 @@
+#ifndef POOLTHREADS_H_
+#define POOLTHREADS_H_
+
+#include <deque>
+#include <vector>
+#include "Thread.h"
+#include "Mutex.h"
+#include "Tarea.h"
+#include "ColaRobo.h"
+#include "Ejecutor.h"
+
+namespace POSIX {
+
+/**
+ * @brief Clase que mantiene un conjunto de hilos que ejecutan las tareas que
+ * se le envían, repartiendo el trabajo mediante robo de tareas
+ * @details Cada hilo tiene su propia ColaRobo. Las tareas enviadas desde un
+ * hilo del pool se insertan en la cola de ese hilo; las enviadas desde
+ * cualquier otro hilo se insertan en una cola global. Un hilo sin trabajo
+ * toma primero de su cola, luego de la cola global y por último intenta
+ * robar tareas de otro hilo elegido al azar. Si no encuentra trabajo, se
+ * duerme hasta que se envíe una nueva tarea
+ * @details No se garantiza ningún orden de ejecución entre tareas
+ */
+
+class PoolThreads: public Ejecutor {
+public:
+
+	/**
+	 * @brief Construye el pool e inicia sus hilos
+	 * @param cantidadHilos Cantidad de hilos del pool. Si es 0, se usa la
+	 * cantidad de procesadores en línea
+	 * @throw MultiHiloExcepcion Error generado al iniciar los hilos
+	 */
+	explicit PoolThreads(size_t cantidadHilos = 0)
+			/* throw (MultiHiloExcepcion) */;
+
+	/**
+	 * @brief Método para enviar una tarea a ejecutar
+	 * @pre El pool no fue detenido
+	 * @param tarea Tarea a ejecutar. Debe seguir viva hasta que termine su
+	 * ejecución
+	 */
+	virtual void enviar(Tarea *tarea);
+
+	/**
+	 * @brief Método que detiene el pool. Espera a que se ejecuten todas las
+	 * tareas pendientes y a que finalicen los hilos
+	 * @warning No invocar desde una tarea del mismo pool
+	 */
+	void detener();
+
+	/**
+	 * @brief Método para obtener la cantidad de hilos del pool
+	 * @return La cantidad de hilos
+	 */
+	size_t getCantidadHilos() const;
+
+	/**
+	 * @brief Destructor. Detiene el pool si no fue detenido
+	 */
+	virtual ~PoolThreads();
+
+private:
+
+	class Trabajador: public Thread {
+	public:
+		Trabajador(PoolThreads &pool, size_t indice);
+		ColaRobo cola;
+	protected:
+		void* ejecutar(void *parametro);
+	private:
+		PoolThreads &pool;
+		size_t indice;
+		unsigned int semilla;
+		Tarea* buscarTarea();
+	};
+
+	std::vector<Trabajador*> trabajadores;
+
+	PThread::Mutex mutexGlobal;
+	std::deque<Tarea*> colaGlobal;
+	size_t tamanioColaGlobal;
+
+	/* Protege la espera de los hilos dormidos */
+	PThread::Mutex mutexDormidos;
+	size_t dormidos;
+	bool terminando;
+	bool detenido;
+
+	Tarea* extraerGlobal();
+	bool hayTrabajo() const;
+	void despertar();
+	/* Duerme al hilo invocante hasta que haya trabajo. Devuelve true si
+	 * el pool está terminando y no queda trabajo, es decir, si el hilo
+	 * debe finalizar */
+	bool dormir();
+
+	PoolThreads(const PoolThreads&);
+	PoolThreads& operator=(const PoolThreads&);
+};
+}
+
+#endif
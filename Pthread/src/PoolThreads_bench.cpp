@@ -0,0 +1,189 @@
+#include "PoolThreads.h"
+#include "Condicion.h"
+#include "CuentaRegresiva.h"
+#include "Mutex.h"
+#include "Bench.h"
+#include <cstdio>
+#include <deque>
+#include <pthread.h>
+#include <time.h>
+#include <vector>
+
+/* Tareas por segundo del PoolThreads, con robo de tareas, frente a una única
+ * cola global protegida por un PThread::Mutex. Las tareas se envían desde
+ * afuera del pool, o desde las mismas tareas (fork-join) */
+
+#define HILOS 4
+#define TAREAS 200000
+/* Profundidad del árbol de tareas anidadas: 2^PROFUNDIDAD hojas */
+#define PROFUNDIDAD 17
+/* Trabajo de cada tarea, en iteraciones de un bucle vacío */
+#define TRABAJO_CORTO 0
+#define TRABAJO_LARGO 2000
+
+namespace POSIX {
+
+/* Pool mínimo: los hilos toman las tareas de una sola cola con un mutex */
+class PoolColaUnica: public Ejecutor {
+public:
+	explicit PoolColaUnica(size_t cantidadHilos) :
+			terminando(false), hilos(cantidadHilos) {
+		for (size_t i = 0; i < cantidadHilos; ++i) {
+			pthread_create(&hilos[i], NULL, trabajar, this);
+		}
+	}
+	void enviar(Tarea *tarea) {
+		mutex.bloquear();
+		tareas.push_back(tarea);
+		hayTareas.notificarUno();
+		mutex.desbloquear();
+	}
+	~PoolColaUnica() {
+		mutex.bloquear();
+		terminando = true;
+		hayTareas.notificarTodos();
+		mutex.desbloquear();
+		for (size_t i = 0; i < hilos.size(); ++i) {
+			pthread_join(hilos[i], NULL);
+		}
+	}
+private:
+	PThread::Mutex mutex;
+	PThread::Condicion hayTareas;
+	std::deque<Tarea*> tareas;
+	bool terminando;
+	std::vector<pthread_t> hilos;
+
+	static void* trabajar(void *parametro) {
+		PoolColaUnica *pool = static_cast<PoolColaUnica*>(parametro);
+		while (true) {
+			pool->mutex.bloquear();
+			while (pool->tareas.empty() && !pool->terminando) {
+				pool->hayTareas.esperar(pool->mutex);
+			}
+			if (pool->tareas.empty()) {
+				pool->mutex.desbloquear();
+				return NULL;
+			}
+			Tarea *tarea = pool->tareas.front();
+			pool->tareas.pop_front();
+			pool->mutex.desbloquear();
+			tarea->ejecutar();
+		}
+	}
+};
+
+static void trabajar(int iteraciones) {
+	for (volatile int i = 0; i < iteraciones; ++i) {
+	}
+}
+
+/* Tarea enviada desde afuera del pool: trabaja y descuenta la cuenta */
+class TareaHoja: public Tarea {
+public:
+	TareaHoja() :
+			trabajo(0), fin(NULL) {
+	}
+	void ejecutar() {
+		trabajar(trabajo);
+		fin->descontar();
+	}
+	int trabajo;
+	PThread::CuentaRegresiva *fin;
+};
+
+/* Tarea que se divide en dos hasta la profundidad indicada, enviando las
+ * mitades al mismo ejecutor desde el hilo que la ejecuta */
+class TareaDivisible: public Tarea {
+public:
+	TareaDivisible(Ejecutor &ejecutor, int profundidad, int trabajo,
+			PThread::CuentaRegresiva &fin) :
+			ejecutor(ejecutor), profundidad(profundidad), trabajo(trabajo),
+			fin(fin) {
+	}
+	void ejecutar() {
+		if (profundidad == 0) {
+			trabajar(trabajo);
+			fin.descontar();
+		}
+		else {
+			ejecutor.enviar(new TareaDivisible(ejecutor, profundidad - 1,
+					trabajo, fin));
+			ejecutor.enviar(new TareaDivisible(ejecutor, profundidad - 1,
+					trabajo, fin));
+		}
+		delete this;
+	}
+private:
+	Ejecutor &ejecutor;
+	int profundidad;
+	int trabajo;
+	PThread::CuentaRegresiva &fin;
+};
+
+static void reportar(const char *prueba, int trabajo, double tareas,
+		double segundos) {
+	printf("%-28s trabajo %5d  %10.0f tareas/s\n", prueba, trabajo,
+			tareas / segundos);
+}
+
+static double medirExternas(Ejecutor &ejecutor, int trabajo) {
+	std::vector<TareaHoja> tareas(TAREAS);
+	PThread::CuentaRegresiva fin(TAREAS);
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	for (int i = 0; i < TAREAS; ++i) {
+		tareas[i].trabajo = trabajo;
+		tareas[i].fin = &fin;
+		ejecutor.enviar(&tareas[i]);
+	}
+	fin.esperar();
+	return PThread::segundosDesde(inicio);
+}
+
+static double medirAnidadas(Ejecutor &ejecutor, int trabajo) {
+	PThread::CuentaRegresiva fin(1 << PROFUNDIDAD);
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	ejecutor.enviar(new TareaDivisible(ejecutor, PROFUNDIDAD, trabajo, fin));
+	fin.esperar();
+	return PThread::segundosDesde(inicio);
+}
+
+void benchTareasExternas() {
+	int trabajos[] = { TRABAJO_CORTO, TRABAJO_LARGO };
+	for (size_t i = 0; i < sizeof(trabajos) / sizeof(trabajos[0]); ++i) {
+		PoolThreads robo(HILOS);
+		reportar("externas: robo de tareas", trabajos[i], TAREAS,
+				medirExternas(robo, trabajos[i]));
+		PoolColaUnica unica(HILOS);
+		reportar("externas: cola unica", trabajos[i], TAREAS,
+				medirExternas(unica, trabajos[i]));
+	}
+}
+
+void benchTareasAnidadas() {
+	/* Cada nodo del árbol es una tarea: 2^(PROFUNDIDAD+1) - 1 */
+	double tareas = (double) ((2 << PROFUNDIDAD) - 1);
+	int trabajos[] = { TRABAJO_CORTO, TRABAJO_LARGO };
+	for (size_t i = 0; i < sizeof(trabajos) / sizeof(trabajos[0]); ++i) {
+		PoolThreads robo(HILOS);
+		reportar("anidadas: robo de tareas", trabajos[i], tareas,
+				medirAnidadas(robo, trabajos[i]));
+		PoolColaUnica unica(HILOS);
+		reportar("anidadas: cola unica", trabajos[i], tareas,
+				medirAnidadas(unica, trabajos[i]));
+	}
+}
+
+}
+
+#ifdef POOLTHREADS_BENCH
+int main() {
+	printf("%d hilos, %d tareas externas, arbol de profundidad %d\n", HILOS,
+			TAREAS, PROFUNDIDAD);
+	POSIX::benchTareasExternas();
+	POSIX::benchTareasAnidadas();
+	return 0;
+}
+#endif
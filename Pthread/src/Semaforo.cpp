@@ -0,0 +1,59 @@
+#include "Semaforo.h"
+#include "Futex.h"
+
+/* Iteraciones de espera activa antes de dormir en el futex */
+#define MAX_GIROS 100
+
+namespace PThread {
+
+Semaforo::Semaforo(int inicial) {
+	valor = (inicial > 0) ? inicial : 0;
+	dormidos = 0;
+}
+
+void Semaforo::esperar() {
+	for (int giros = 0; giros < MAX_GIROS; ++giros) {
+		if (intentarEsperar()) {
+			return;
+		}
+		pausaCPU();
+	}
+
+	/* Me anoto antes de volver a verificar: quien libere despues de mi
+	 * verificacion ve que hay dormidos, y si libero antes el futex no me
+	 * deja dormir porque el valor ya no es cero */
+	__atomic_add_fetch(&dormidos, 1, __ATOMIC_SEQ_CST);
+	while (!intentarEsperar()) {
+		futexEsperar(&valor, 0);
+	}
+	__atomic_sub_fetch(&dormidos, 1, __ATOMIC_RELAXED);
+}
+
+bool Semaforo::intentarEsperar() {
+	int actual = __atomic_load_n(&valor, __ATOMIC_RELAXED);
+	while (actual > 0) {
+		if (__atomic_compare_exchange_n(&valor, &actual, actual - 1, true,
+				__ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void Semaforo::liberar(int cantidad) {
+	if (cantidad <= 0) {
+		return;
+	}
+	__atomic_add_fetch(&valor, cantidad, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&dormidos, __ATOMIC_SEQ_CST) > 0) {
+		futexDespertar(&valor, cantidad);
+	}
+}
+
+int Semaforo::getValor() const {
+	return __atomic_load_n(&valor, __ATOMIC_RELAXED);
+}
+
+Semaforo::~Semaforo() {
+}
+}
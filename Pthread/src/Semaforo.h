@@ -0,0 +1,70 @@
+#ifndef SEMAFORO_H_
+#define SEMAFORO_H_
+
+namespace PThread {
+
+/**
+ * @brief Semáforo contador implementado directamente sobre un futex
+ * @details Antes de dormir en el kernel se espera activamente una cantidad
+ * acotada de iteraciones, ya que es probable que otro hilo libere el
+ * semáforo en poco tiempo. Liberar un semáforo sin hilos dormidos no realiza
+ * llamadas al sistema
+ */
+
+class Semaforo {
+public:
+
+	/**
+	 * @brief Instancia un semáforo
+	 * @param inicial Valor inicial, no negativo
+	 */
+	explicit Semaforo(int inicial = 0);
+
+	/**
+	 * @brief Método para tomar una unidad del semáforo
+	 * @post Si el valor es positivo, se decrementa y se retorna. Si no, el
+	 * hilo espera activamente un tiempo acotado y luego se duerme hasta que
+	 * se libere una unidad
+	 */
+	void esperar();
+
+	/**
+	 * @brief Método para intentar tomar una unidad del semáforo, sin esperar
+	 * @return <tt>true</tt> si se tomó una unidad
+	 * @return <tt>false</tt> si el valor era cero
+	 */
+	bool intentarEsperar();
+
+	/**
+	 * @brief Método para devolver unidades al semáforo, despertando a los
+	 * hilos que las estén esperando
+	 * @param cantidad Cantidad de unidades a devolver
+	 */
+	void liberar(int cantidad = 1);
+
+	/**
+	 * @brief Método para obtener el valor actual. Puede cambiar
+	 * inmediatamente después de obtenerlo
+	 * @return El valor
+	 */
+	int getValor() const;
+
+	/**
+	 * @brief Destructor
+	 * @pre No hay hilos esperando
+	 */
+	~Semaforo();
+
+private:
+
+	/* Palabra del futex: unidades disponibles */
+	int valor;
+	/* Hilos dormidos, para no despertar en vano */
+	int dormidos;
+
+	Semaforo(const Semaforo&);
+	Semaforo& operator=(const Semaforo&);
+};
+}
+
+#endif
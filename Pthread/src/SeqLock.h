@@ -0,0 +1,130 @@
+#ifndef SEQLOCK_H_
+#define SEQLOCK_H_
+
+#include <cstring>
+#include "Futex.h"
+
+namespace PThread {
+
+/**
+ * @brief Clase que protege un valor pequeño de tipo POD (por ejemplo, una
+ * instantánea de estadísticas o de configuración) con un contador de
+ * secuencia
+ * @details Los lectores nunca se bloquean ni escriben memoria compartida:
+ * copian el valor y verifican que ningún escritor lo haya modificado mientras
+ * tanto, reintentando en ese caso. Los escritores se excluyen entre sí
+ * @warning @a T debe poder copiarse con memcpy (sin punteros a memoria que
+ * pueda liberarse), ya que un lector puede copiarlo mientras se escribe
+ */
+
+template <typename T> class SeqLock {
+public:
+
+	/**
+	 * @brief Instancia el SeqLock con una copia de @a inicial
+	 * @param inicial Valor inicial
+	 */
+	explicit SeqLock(const T &inicial = T()) : secuencia(0) {
+		memcpy(&valor, &inicial, sizeof(T));
+	}
+
+	/**
+	 * @brief Método para obtener una copia consistente del valor
+	 * @return Una copia del valor
+	 */
+	T leer() const {
+		T copia;
+		int antes, despues;
+		do {
+			antes = __atomic_load_n(&secuencia, __ATOMIC_ACQUIRE);
+			while (antes & 1) {
+				pausaCPU();
+				antes = __atomic_load_n(&secuencia, __ATOMIC_ACQUIRE);
+			}
+			memcpy(&copia, (const void*) &valor, sizeof(T));
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			despues = __atomic_load_n(&secuencia, __ATOMIC_RELAXED);
+		} while (antes != despues);
+		return copia;
+	}
+
+	/**
+	 * @brief Método para reemplazar el valor
+	 * @param nuevo Valor nuevo
+	 */
+	void escribir(const T &nuevo) {
+		Escritura escritura(*this);
+		memcpy(&escritura.valor(), &nuevo, sizeof(T));
+	}
+
+	/**
+	 * @brief Destructor
+	 */
+	~SeqLock() {
+	}
+
+private:
+
+	/* Impar mientras hay un escritor */
+	int secuencia;
+	T valor;
+
+	void bloquearEscritura() {
+		int actual = __atomic_load_n(&secuencia, __ATOMIC_RELAXED);
+		while ((actual & 1) || !__atomic_compare_exchange_n(&secuencia,
+				&actual, actual + 1, false, __ATOMIC_ACQUIRE,
+				__ATOMIC_RELAXED)) {
+			pausaCPU();
+			actual = __atomic_load_n(&secuencia, __ATOMIC_RELAXED);
+		}
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+	}
+
+	void desbloquearEscritura() {
+		__atomic_add_fetch(&secuencia, 1, __ATOMIC_RELEASE);
+	}
+
+	SeqLock(const SeqLock&);
+	SeqLock& operator=(const SeqLock&);
+
+public:
+
+	/**
+	 * @brief Clase que implementa el patrón RAII para modificar el valor de
+	 * un SeqLock en el lugar
+	 */
+
+	class Escritura {
+	public:
+
+		/**
+		 * @brief Construye una Escritura excluyendo a otros escritores
+		 * @param lock SeqLock a modificar
+		 */
+		explicit Escritura(SeqLock &lock) : _lock(lock) {
+			_lock.bloquearEscritura();
+		}
+
+		/**
+		 * @brief Método para acceder al valor a modificar
+		 * @return Referencia al valor protegido
+		 */
+		T& valor() {
+			return _lock.valor;
+		}
+
+		/**
+		 * @brief Destruye la Escritura, publicando el valor modificado
+		 */
+		~Escritura() {
+			_lock.desbloquearEscritura();
+		}
+
+	private:
+
+		SeqLock &_lock;
+	};
+};
+}
+
+#endif
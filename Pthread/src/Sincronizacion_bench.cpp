@@ -0,0 +1,272 @@
+#include "Semaforo.h"
+#include "CuentaRegresiva.h"
+#include "Barrera.h"
+#include "Bench.h"
+#include <cstdio>
+#include <pthread.h>
+#include <time.h>
+#include <vector>
+
+/* Semaforo, CuentaRegresiva y Barrera comparados con sus equivalentes
+ * armados con un mutex y una variable de condición de pthread */
+
+#define TRASPASOS 200000
+#define RONDAS 20000
+#define PARTICIPANTES 4
+
+namespace PThread {
+
+class SemaforoCondicion {
+public:
+	explicit SemaforoCondicion(int inicial = 0) :
+			valor(inicial) {
+		pthread_mutex_init(&mutex, NULL);
+		pthread_cond_init(&condicion, NULL);
+	}
+	void esperar() {
+		pthread_mutex_lock(&mutex);
+		while (valor == 0) {
+			pthread_cond_wait(&condicion, &mutex);
+		}
+		--valor;
+		pthread_mutex_unlock(&mutex);
+	}
+	void liberar() {
+		pthread_mutex_lock(&mutex);
+		++valor;
+		pthread_cond_signal(&condicion);
+		pthread_mutex_unlock(&mutex);
+	}
+	~SemaforoCondicion() {
+		pthread_cond_destroy(&condicion);
+		pthread_mutex_destroy(&mutex);
+	}
+private:
+	pthread_mutex_t mutex;
+	pthread_cond_t condicion;
+	int valor;
+};
+
+class CuentaRegresivaCondicion {
+public:
+	explicit CuentaRegresivaCondicion(int cuenta) :
+			cuenta(cuenta) {
+		pthread_mutex_init(&mutex, NULL);
+		pthread_cond_init(&condicion, NULL);
+	}
+	void descontar() {
+		pthread_mutex_lock(&mutex);
+		if (--cuenta == 0) {
+			pthread_cond_broadcast(&condicion);
+		}
+		pthread_mutex_unlock(&mutex);
+	}
+	void esperar() {
+		pthread_mutex_lock(&mutex);
+		while (cuenta > 0) {
+			pthread_cond_wait(&condicion, &mutex);
+		}
+		pthread_mutex_unlock(&mutex);
+	}
+	~CuentaRegresivaCondicion() {
+		pthread_cond_destroy(&condicion);
+		pthread_mutex_destroy(&mutex);
+	}
+private:
+	pthread_mutex_t mutex;
+	pthread_cond_t condicion;
+	int cuenta;
+};
+
+class BarreraCondicion {
+public:
+	explicit BarreraCondicion(int participantes) :
+			participantes(participantes), restantes(participantes), fase(0) {
+		pthread_mutex_init(&mutex, NULL);
+		pthread_cond_init(&condicion, NULL);
+	}
+	void esperar() {
+		pthread_mutex_lock(&mutex);
+		int actual = fase;
+		if (--restantes == 0) {
+			restantes = participantes;
+			++fase;
+			pthread_cond_broadcast(&condicion);
+		}
+		else {
+			while (fase == actual) {
+				pthread_cond_wait(&condicion, &mutex);
+			}
+		}
+		pthread_mutex_unlock(&mutex);
+	}
+	~BarreraCondicion() {
+		pthread_cond_destroy(&condicion);
+		pthread_mutex_destroy(&mutex);
+	}
+private:
+	pthread_mutex_t mutex;
+	pthread_cond_t condicion;
+	int participantes;
+	int restantes;
+	int fase;
+};
+
+static void reportar(const char *prueba, double operaciones, double segundos) {
+	printf("%-34s %10.0f ops/s  %8.1f ns/op\n", prueba, operaciones / segundos,
+			segundos * 1e9 / operaciones);
+}
+
+static void esperarHilos(std::vector<pthread_t> &hilos) {
+	for (size_t i = 0; i < hilos.size(); ++i) {
+		pthread_join(hilos[i], NULL);
+	}
+}
+
+/* Ping-pong entre dos hilos: cada traspaso despierta al otro hilo */
+template<typename S>
+struct PingPong {
+	S ida;
+	S vuelta;
+	static void* responder(void *parametro) {
+		PingPong *juego = static_cast<PingPong*>(parametro);
+		for (int i = 0; i < TRASPASOS; ++i) {
+			juego->ida.esperar();
+			juego->vuelta.liberar();
+		}
+		return NULL;
+	}
+	double medir() {
+		pthread_t hilo;
+		struct timespec inicio;
+		clock_gettime(CLOCK_MONOTONIC, &inicio);
+		pthread_create(&hilo, NULL, responder, this);
+		for (int i = 0; i < TRASPASOS; ++i) {
+			ida.liberar();
+			vuelta.esperar();
+		}
+		pthread_join(hilo, NULL);
+		return segundosDesde(inicio);
+	}
+};
+
+/* Tomar y devolver sin competencia: el camino rápido */
+template<typename S>
+double medirSinCompetencia() {
+	S semaforo(1);
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	for (int i = 0; i < TRASPASOS; ++i) {
+		semaforo.esperar();
+		semaforo.liberar();
+	}
+	return segundosDesde(inicio);
+}
+
+void benchSemaforo() {
+	PingPong<Semaforo> futex;
+	PingPong<SemaforoCondicion> condicion;
+	reportar("semaforo futex: ping-pong", 2.0 * TRASPASOS, futex.medir());
+	reportar("semaforo mutex+cond: ping-pong", 2.0 * TRASPASOS,
+			condicion.medir());
+	reportar("semaforo futex: sin competencia", TRASPASOS,
+			medirSinCompetencia<Semaforo>());
+	reportar("semaforo mutex+cond: sin competencia", TRASPASOS,
+			medirSinCompetencia<SemaforoCondicion>());
+}
+
+/* Fork-join: el hilo principal habilita cada ronda con una cuenta de 1 y
+ * espera que todos los participantes descuenten la cuenta de fin */
+template<typename C>
+struct Rondas {
+	std::vector<C*> inicio;
+	std::vector<C*> fin;
+	Rondas() {
+		for (int i = 0; i < RONDAS; ++i) {
+			inicio.push_back(new C(1));
+			fin.push_back(new C(PARTICIPANTES));
+		}
+	}
+	~Rondas() {
+		for (int i = 0; i < RONDAS; ++i) {
+			delete inicio[i];
+			delete fin[i];
+		}
+	}
+	static void* participar(void *parametro) {
+		Rondas *rondas = static_cast<Rondas*>(parametro);
+		for (int i = 0; i < RONDAS; ++i) {
+			rondas->inicio[i]->esperar();
+			rondas->fin[i]->descontar();
+		}
+		return NULL;
+	}
+	double medir() {
+		std::vector<pthread_t> hilos(PARTICIPANTES);
+		for (int i = 0; i < PARTICIPANTES; ++i) {
+			pthread_create(&hilos[i], NULL, participar, this);
+		}
+		struct timespec comienzo;
+		clock_gettime(CLOCK_MONOTONIC, &comienzo);
+		for (int i = 0; i < RONDAS; ++i) {
+			inicio[i]->descontar();
+			fin[i]->esperar();
+		}
+		double segundos = segundosDesde(comienzo);
+		esperarHilos(hilos);
+		return segundos;
+	}
+};
+
+void benchCuentaRegresiva() {
+	Rondas<CuentaRegresiva> futex;
+	Rondas<CuentaRegresivaCondicion> condicion;
+	reportar("cuenta regresiva futex: rondas", RONDAS, futex.medir());
+	reportar("cuenta regresiva mutex+cond: rondas", RONDAS,
+			condicion.medir());
+}
+
+template<typename B>
+struct Fases {
+	B barrera;
+	Fases() :
+			barrera(PARTICIPANTES) {
+	}
+	static void* participar(void *parametro) {
+		Fases *fases = static_cast<Fases*>(parametro);
+		for (int i = 0; i < RONDAS; ++i) {
+			fases->barrera.esperar();
+		}
+		return NULL;
+	}
+	double medir() {
+		std::vector<pthread_t> hilos(PARTICIPANTES);
+		struct timespec inicio;
+		clock_gettime(CLOCK_MONOTONIC, &inicio);
+		for (int i = 0; i < PARTICIPANTES; ++i) {
+			pthread_create(&hilos[i], NULL, participar, this);
+		}
+		esperarHilos(hilos);
+		return segundosDesde(inicio);
+	}
+};
+
+void benchBarrera() {
+	Fases<Barrera> futex;
+	Fases<BarreraCondicion> condicion;
+	reportar("barrera futex: fases", RONDAS, futex.medir());
+	reportar("barrera mutex+cond: fases", RONDAS, condicion.medir());
+}
+
+}
+
+#ifdef SINCRONIZACION_BENCH
+int main() {
+	printf("%d traspasos, %d rondas de %d hilos\n", TRASPASOS, RONDAS,
+			PARTICIPANTES);
+	PThread::benchSemaforo();
+	PThread::benchCuentaRegresiva();
+	PThread::benchBarrera();
+	return 0;
+}
+#endif
@@ -0,0 +1,31 @@
+#ifndef TAREA_H_
+#define TAREA_H_
+
+namespace POSIX {
+
+/**
+ * @brief Clase abstracta que representa una unidad de trabajo a ejecutar por
+ * un PoolThreads. Se redefine Tarea::ejecutar con el trabajo deseado
+ * @details El pool no toma posesión de la tarea: quien la envía debe
+ * mantenerla viva hasta que termine de ejecutarse. Una tarea alocada en el
+ * heap puede liberarse a sí misma (delete this) al final de Tarea::ejecutar
+ */
+
+class Tarea {
+public:
+
+	/**
+	 * @brief Método que realiza el trabajo de la tarea. Es invocado por un
+	 * hilo del pool una única vez por cada envío
+	 */
+	virtual void ejecutar() = 0;
+
+	/**
+	 * @brief Destructor
+	 */
+	virtual ~Tarea() {
+	}
+};
+}
+
+#endif
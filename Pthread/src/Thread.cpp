@@ -3,25 +3,106 @@
 #include <cerrno>
 #include <cstring>
 #include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <iomanip>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+/* Politica de memoria de set_mempolicy (numaif.h), para no depender de
+ * libnuma */
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+
+#define NANOS_POR_SEGUNDO 1000000000ull
+#define NANOS_POR_MILI 1000000.0
+/* pthread_setname_np admite 16 bytes, incluyendo el terminador */
+#define LARGO_NOMBRE 15
 
 extern int errno;
 
 namespace POSIX {
 
+pthread_mutex_t RegistroThreads::mutex = PTHREAD_MUTEX_INITIALIZER;
+Thread *RegistroThreads::primero = NULL;
+
+/* Lectura de un reloj, en nanosegundos */
+static uint64_t nanosegundos(clockid_t reloj) {
+	struct timespec tiempo;
+	if (clock_gettime(reloj, &tiempo) != 0) {
+		return 0;
+	}
+	return (uint64_t) tiempo.tv_sec * NANOS_POR_SEGUNDO + tiempo.tv_nsec;
+}
+
+/* Cambios de contexto de un hilo del proceso, leidos de su archivo status */
+static void leerCambiosContexto(pid_t tid, unsigned long &voluntarios,
+		unsigned long &involuntarios) {
+	std::ostringstream ruta;
+	ruta << "/proc/self/task/" << tid << "/status";
+	std::ifstream archivo(ruta.str().c_str());
+	std::string linea;
+	while (std::getline(archivo, linea)) {
+		sscanf(linea.c_str(), "voluntary_ctxt_switches: %lu", &voluntarios);
+		sscanf(linea.c_str(), "nonvoluntary_ctxt_switches: %lu",
+				&involuntarios);
+	}
+}
+
 Thread::Atributos::Atributos() {
 	pthread_attr_init(&atributos);
+	conAfinidad = false;
+	nodoNUMA = -1;
 	setJoinable();
 }
 
 Thread::Atributos::Atributos(const Atributos &aCopiar) {
-	this->atributos = aCopiar.atributos;
+	pthread_attr_init(&atributos);
+	copiar(aCopiar);
 }
 
 Thread::Atributos& Thread::Atributos::operator=(const Atributos &aAsignar) {
-	this->atributos = aAsignar.atributos;
+	if (this != &aAsignar) {
+		pthread_attr_destroy(&atributos);
+		pthread_attr_init(&atributos);
+		copiar(aAsignar);
+	}
 	return *this;
 }
 
+void Thread::Atributos::copiar(const Atributos &aCopiar) {
+	const pthread_attr_t *otros = &aCopiar.atributos;
+	int valor;
+	size_t tamanio;
+	struct sched_param parametros;
+
+	pthread_attr_getdetachstate(otros, &valor);
+	pthread_attr_setdetachstate(&atributos, valor);
+	pthread_attr_getstacksize(otros, &tamanio);
+	pthread_attr_setstacksize(&atributos, tamanio);
+	pthread_attr_getguardsize(otros, &tamanio);
+	pthread_attr_setguardsize(&atributos, tamanio);
+	pthread_attr_getinheritsched(otros, &valor);
+	pthread_attr_setinheritsched(&atributos, valor);
+	pthread_attr_getschedpolicy(otros, &valor);
+	pthread_attr_setschedpolicy(&atributos, valor);
+	pthread_attr_getschedparam(otros, &parametros);
+	pthread_attr_setschedparam(&atributos, &parametros);
+
+	conAfinidad = aCopiar.conAfinidad;
+	if (conAfinidad) {
+		cpu_set_t cpus;
+		pthread_attr_getaffinity_np(otros, sizeof(cpus), &cpus);
+		pthread_attr_setaffinity_np(&atributos, sizeof(cpus), &cpus);
+	}
+	nodoNUMA = aCopiar.nodoNUMA;
+}
+
 void Thread::Atributos::setDetached() {
 	pthread_attr_setdetachstate(&atributos, PTHREAD_CREATE_DETACHED);
 }
@@ -42,6 +123,128 @@ bool Thread::Atributos::isJoinable() const {
 	return (detach_state == PTHREAD_CREATE_JOINABLE);
 }
 
+bool Thread::Atributos::setAfinidadCPU(const std::vector<int> &cpus) {
+	cpu_set_t conjunto;
+	CPU_ZERO(&conjunto);
+	for (size_t i = 0; i < cpus.size(); ++i) {
+		if (cpus[i] < 0 || cpus[i] >= CPU_SETSIZE) {
+			return false;
+		}
+		CPU_SET(cpus[i], &conjunto);
+	}
+	if (cpus.empty() ||
+			pthread_attr_setaffinity_np(&atributos, sizeof(conjunto),
+					&conjunto) != 0) {
+		return false;
+	}
+	conAfinidad = true;
+	return true;
+}
+
+bool Thread::Atributos::setAfinidadCPU(int cpu) {
+	return setAfinidadCPU(std::vector<int>(1, cpu));
+}
+
+std::vector<int> Thread::Atributos::getAfinidadCPU() const {
+	std::vector<int> cpus;
+	cpu_set_t conjunto;
+	if (conAfinidad && pthread_attr_getaffinity_np(&atributos,
+			sizeof(conjunto), &conjunto) == 0) {
+		for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+			if (CPU_ISSET(cpu, &conjunto)) {
+				cpus.push_back(cpu);
+			}
+		}
+	}
+	return cpus;
+}
+
+bool Thread::Atributos::setNodoNUMA(int nodo) {
+	if (nodo < 0 || nodo >= (int) (8 * sizeof(unsigned long))) {
+		return false;
+	}
+
+	/* La lista de procesadores del nodo tiene el formato "0-3,8,10-11" */
+	std::ostringstream ruta;
+	ruta << "/sys/devices/system/node/node" << nodo << "/cpulist";
+	std::ifstream archivo(ruta.str().c_str());
+	std::string lista;
+	if (!std::getline(archivo, lista)) {
+		return false;
+	}
+	std::vector<int> cpus;
+	std::istringstream rangos(lista);
+	std::string rango;
+	while (std::getline(rangos, rango, ',')) {
+		int desde, hasta;
+		int leidos = sscanf(rango.c_str(), "%d-%d", &desde, &hasta);
+		if (leidos == 1) {
+			hasta = desde;
+		}
+		else if (leidos != 2) {
+			continue;
+		}
+		for (int cpu = desde; cpu <= hasta; ++cpu) {
+			cpus.push_back(cpu);
+		}
+	}
+	if (!setAfinidadCPU(cpus)) {
+		return false;
+	}
+	nodoNUMA = nodo;
+	return true;
+}
+
+int Thread::Atributos::getNodoNUMA() const {
+	return nodoNUMA;
+}
+
+bool Thread::Atributos::setTamanioStack(size_t tamanio) {
+	return (pthread_attr_setstacksize(&atributos, tamanio) == 0);
+}
+
+size_t Thread::Atributos::getTamanioStack() const {
+	size_t tamanio;
+	pthread_attr_getstacksize(&atributos, &tamanio);
+	return tamanio;
+}
+
+bool Thread::Atributos::setTamanioGuarda(size_t tamanio) {
+	return (pthread_attr_setguardsize(&atributos, tamanio) == 0);
+}
+
+size_t Thread::Atributos::getTamanioGuarda() const {
+	size_t tamanio;
+	pthread_attr_getguardsize(&atributos, &tamanio);
+	return tamanio;
+}
+
+bool Thread::Atributos::setPlanificacion(int politica, int prioridad) {
+	int minima = sched_get_priority_min(politica);
+	int maxima = sched_get_priority_max(politica);
+	if (minima == -1 || prioridad < minima || prioridad > maxima) {
+		return false;
+	}
+	struct sched_param parametros;
+	parametros.sched_priority = prioridad;
+	return (pthread_attr_setinheritsched(&atributos,
+			PTHREAD_EXPLICIT_SCHED) == 0 &&
+			pthread_attr_setschedpolicy(&atributos, politica) == 0 &&
+			pthread_attr_setschedparam(&atributos, &parametros) == 0);
+}
+
+int Thread::Atributos::getPoliticaPlanificacion() const {
+	int politica;
+	pthread_attr_getschedpolicy(&atributos, &politica);
+	return politica;
+}
+
+int Thread::Atributos::getPrioridad() const {
+	struct sched_param parametros;
+	pthread_attr_getschedparam(&atributos, &parametros);
+	return parametros.sched_priority;
+}
+
 Thread::Atributos::~Atributos() {
 	pthread_attr_destroy(&atributos);
 }
@@ -50,6 +253,7 @@ Thread::Thread() {
 	id = 0;
 	esta_vivo = false;
 	parametro = NULL;
+	inicializarContabilidad();
 }
 
 Thread::Thread(const Atributos &atributos) :
@@ -57,6 +261,22 @@ Thread::Thread(const Atributos &atributos) :
 	id = 0;
 	esta_vivo = false;
 	parametro = NULL;
+	inicializarContabilidad();
+}
+
+void Thread::inicializarContabilidad() {
+	propio = 0;
+	tid = 0;
+	ejecutando = false;
+	inicioEjecucion = 0;
+	finales.tid = 0;
+	finales.ejecutando = false;
+	finales.nanosEjecucion = 0;
+	finales.nanosCPU = 0;
+	finales.cambiosVoluntarios = 0;
+	finales.cambiosInvoluntarios = 0;
+	anterior = NULL;
+	siguiente = NULL;
 }
 
 void Thread::iniciar(void *parametro) {
@@ -65,14 +285,18 @@ void Thread::iniciar(void *parametro) {
 				MultiHiloExcepcion::THREAD_EN_USO);
 	}
 	this->parametro = parametro;
-	switch (pthread_create(&id, &atributos.atributos, lanzador,
-			(void*) this)) {
+	int resultado = pthread_create(&id, &atributos.atributos, lanzador,
+			(void*) this);
+	switch (resultado) {
 	case EAGAIN:
-		throw MultiHiloExcepcion(strerror(errno),
+		throw MultiHiloExcepcion(strerror(resultado),
 				MultiHiloExcepcion::SIN_RECURSOS);
 	case EINVAL:
-		throw MultiHiloExcepcion(strerror(errno),
+		throw MultiHiloExcepcion(strerror(resultado),
 				MultiHiloExcepcion::ATTR_INVALIDOS);
+	case EPERM:
+		throw MultiHiloExcepcion(strerror(resultado),
+				MultiHiloExcepcion::SIN_PERMISOS);
 	}
 	esta_vivo = true;
 }
@@ -158,6 +382,49 @@ void Thread::setJoinable() {
 	atributos.setJoinable();
 }
 
+void Thread::setNombre(const std::string &nombre) {
+	pthread_mutex_lock(&RegistroThreads::mutex);
+	this->nombre = nombre;
+	if (ejecutando) {
+		pthread_setname_np(propio, nombre.substr(0, LARGO_NOMBRE).c_str());
+	}
+	pthread_mutex_unlock(&RegistroThreads::mutex);
+}
+
+std::string Thread::getNombre() const {
+	pthread_mutex_lock(&RegistroThreads::mutex);
+	std::string copia = nombre;
+	pthread_mutex_unlock(&RegistroThreads::mutex);
+	return copia;
+}
+
+Thread::Estadisticas Thread::getEstadisticas() const {
+	pthread_mutex_lock(&RegistroThreads::mutex);
+	Estadisticas estadisticas = ejecutando ? muestrear() : finales;
+	estadisticas.nombre = nombre;
+	pthread_mutex_unlock(&RegistroThreads::mutex);
+	return estadisticas;
+}
+
+Thread::Estadisticas Thread::muestrear() const {
+	/* Se invoca con el mutex del registro tomado y el hilo ejecutandose, por
+	 * lo que su id sigue siendo valido */
+	Estadisticas estadisticas;
+	estadisticas.nombre = nombre;
+	estadisticas.tid = tid;
+	estadisticas.ejecutando = true;
+	estadisticas.nanosEjecucion = nanosegundos(CLOCK_MONOTONIC)
+			- inicioEjecucion;
+	clockid_t reloj;
+	estadisticas.nanosCPU = (pthread_getcpuclockid(propio, &reloj) == 0) ?
+			nanosegundos(reloj) : 0;
+	estadisticas.cambiosVoluntarios = 0;
+	estadisticas.cambiosInvoluntarios = 0;
+	leerCambiosContexto(tid, estadisticas.cambiosVoluntarios,
+			estadisticas.cambiosInvoluntarios);
+	return estadisticas;
+}
+
 bool Thread::operator==(const Thread &aComparar) {
 	return pthread_equal(id, aComparar.id);
 }
@@ -172,7 +439,33 @@ Thread::~Thread() {
 void* Thread::lanzador(void *objetoThread) {
 	Thread *aLanzar = reinterpret_cast<Thread*>(objetoThread);
 	aLanzar->esta_vivo = true;
-	void *retorno = aLanzar->ejecutar(aLanzar->parametro);
+	int nodo = aLanzar->atributos.getNodoNUMA();
+	if (nodo >= 0) {
+		/* La afinidad ya la aplico pthread_create. Falta que la memoria se
+		 * aloque en el nodo (si el nodo se queda sin memoria, se usa otro) */
+		unsigned long mascara = 1UL << nodo;
+		syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mascara,
+				8 * sizeof(mascara) + 1);
+	}
+
+	pthread_mutex_lock(&RegistroThreads::mutex);
+	aLanzar->propio = pthread_self();
+	aLanzar->tid = (pid_t) syscall(SYS_gettid);
+	aLanzar->ejecutando = true;
+	aLanzar->inicioEjecucion = nanosegundos(CLOCK_MONOTONIC);
+	if (!aLanzar->nombre.empty()) {
+		pthread_setname_np(aLanzar->propio,
+				aLanzar->nombre.substr(0, LARGO_NOMBRE).c_str());
+	}
+	RegistroThreads::registrar(aLanzar);
+	pthread_mutex_unlock(&RegistroThreads::mutex);
+
+	/* Si el hilo es cancelado tambien tiene que salir del registro */
+	void *retorno;
+	pthread_cleanup_push(finalizarContabilidad, aLanzar);
+	retorno = aLanzar->ejecutar(aLanzar->parametro);
+	pthread_cleanup_pop(1);
+
 	if (aLanzar->atributos.isDetached()) {
 		/* Si es joinable no puedo cambiarle el id todavia, si lo hago va a
 		 * fallar el esperarThread */
@@ -182,4 +475,93 @@ void* Thread::lanzador(void *objetoThread) {
 	return(retorno);
 }
 
+void Thread::finalizarContabilidad(void *objetoThread) {
+	Thread *thread = reinterpret_cast<Thread*>(objetoThread);
+
+	/* Los valores finales se toman desde el propio hilo, sin leer /proc */
+	uint64_t fin = nanosegundos(CLOCK_MONOTONIC);
+	uint64_t cpu = nanosegundos(CLOCK_THREAD_CPUTIME_ID);
+	struct rusage uso;
+	memset(&uso, 0, sizeof(uso));
+	getrusage(RUSAGE_THREAD, &uso);
+	pthread_mutex_lock(&RegistroThreads::mutex);
+	RegistroThreads::desregistrar(thread);
+	thread->ejecutando = false;
+	Estadisticas &finales = thread->finales;
+	finales.tid = thread->tid;
+	finales.ejecutando = false;
+	finales.nanosEjecucion = fin - thread->inicioEjecucion;
+	finales.nanosCPU = cpu;
+	finales.cambiosVoluntarios = uso.ru_nvcsw;
+	finales.cambiosInvoluntarios = uso.ru_nivcsw;
+	pthread_mutex_unlock(&RegistroThreads::mutex);
+}
+
+/* METODOS DE REGISTROTHREADS */
+
+namespace {
+
+bool mayorCPU(const Thread::Estadisticas &a, const Thread::Estadisticas &b) {
+	return (a.nanosCPU > b.nanosCPU);
+}
+}
+
+std::vector<Thread::Estadisticas> RegistroThreads::listar() {
+	std::vector<Thread::Estadisticas> lista;
+	pthread_mutex_lock(&mutex);
+	for (Thread *thread = primero; thread != NULL;
+			thread = thread->siguiente) {
+		lista.push_back(thread->muestrear());
+	}
+	pthread_mutex_unlock(&mutex);
+	return lista;
+}
+
+void RegistroThreads::generarReporte(std::ostream &salida) {
+	std::vector<Thread::Estadisticas> lista = listar();
+	std::sort(lista.begin(), lista.end(), mayorCPU);
+
+	salida << "Threads en ejecucion (" << lista.size()
+			<< ", tiempos en ms)" << std::endl;
+	salida << std::setw(8) << "tid" << std::setw(12) << "ejecucion"
+			<< std::setw(12) << "cpu" << std::setw(8) << "%cpu"
+			<< std::setw(12) << "voluntar." << std::setw(12) << "desalojos"
+			<< "  thread" << std::endl;
+	salida << std::fixed << std::setprecision(1);
+	for (size_t i = 0; i < lista.size(); ++i) {
+		const Thread::Estadisticas &e = lista[i];
+		double porcentaje = (e.nanosEjecucion > 0) ?
+				100.0 * e.nanosCPU / e.nanosEjecucion : 0.0;
+		salida << std::setw(8) << e.tid << std::setw(12)
+				<< e.nanosEjecucion / NANOS_POR_MILI << std::setw(12)
+				<< e.nanosCPU / NANOS_POR_MILI << std::setw(8) << porcentaje
+				<< std::setw(12) << e.cambiosVoluntarios << std::setw(12)
+				<< e.cambiosInvoluntarios << "  "
+				<< (e.nombre.empty() ? "(sin nombre)" : e.nombre)
+				<< std::endl;
+	}
+}
+
+void RegistroThreads::registrar(Thread *thread) {
+	thread->anterior = NULL;
+	thread->siguiente = primero;
+	if (primero != NULL) {
+		primero->anterior = thread;
+	}
+	primero = thread;
+}
+
+void RegistroThreads::desregistrar(Thread *thread) {
+	if (thread->anterior != NULL) {
+		thread->anterior->siguiente = thread->siguiente;
+	}
+	else {
+		primero = thread->siguiente;
+	}
+	if (thread->siguiente != NULL) {
+		thread->siguiente->anterior = thread->anterior;
+	}
+	thread->anterior = NULL;
+	thread->siguiente = NULL;
+}
 }
@@ -2,6 +2,12 @@
 #define	THREAD_H
 
 #include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <ostream>
+#include <string>
+#include <vector>
 
 namespace POSIX {
 
@@ -34,6 +40,30 @@ public:
 
 	typedef pthread_t thread_id;
 
+	/**
+	 * @brief Contadores de uso de recursos de un hilo
+	 * @details La diferencia entre Estadisticas::nanosEjecucion y
+	 * Estadisticas::nanosCPU es el tiempo que el hilo pasó bloqueado o
+	 * esperando el procesador
+	 */
+	struct Estadisticas {
+		/* Nombre del hilo, vacío si no se le asignó */
+		std::string nombre;
+		/* Id del hilo para el kernel (el que muestran top y ps), 0 si nunca
+		 * se ejecutó */
+		pid_t tid;
+		/* true mientras se ejecuta Thread::ejecutar */
+		bool ejecutando;
+		/* Tiempo transcurrido dentro de Thread::ejecutar */
+		uint64_t nanosEjecucion;
+		/* Tiempo de procesador consumido */
+		uint64_t nanosCPU;
+		/* Cambios de contexto por bloquearse */
+		unsigned long cambiosVoluntarios;
+		/* Cambios de contexto por ser desalojado */
+		unsigned long cambiosInvoluntarios;
+	};
+
 	/**
 	 * @brief Método que inicia el hilo con los atributos actuales que posee
 	 * @pre El Thread debe estar en estado MUERTO
@@ -47,6 +77,8 @@ public:
 	 * @throw THREAD_EN_USO El Thread ya estaba VIVO
 	 * @throw SIN_RECURSOS El sistema no posee recursos para iniciar el Thread
 	 * @throw ATTR_INVALIDOS Los atributos del Thread son inválidos
+	 * @throw SIN_PERMISOS No se tienen privilegios para la política de
+	 * planificación de los atributos
 	 */
 	void iniciar(void *parametro = NULL) /* throw (MultiHiloExcepcion) */;
 
@@ -153,6 +185,31 @@ public:
 	 */
 	void setJoinable() /* throw (MultiHiloExcepcion) */;
 
+	/**
+	 * @brief Método para asignarle un nombre al hilo, visible en top, ps,
+	 * gdb y en el reporte de RegistroThreads
+	 * @details Si el Thread está VIVO el nombre se aplica inmediatamente; si
+	 * no, al iniciarlo. El kernel solo conserva los primeros 15 caracteres
+	 * @param nombre Nombre del hilo
+	 */
+	void setNombre(const std::string &nombre);
+
+	/**
+	 * @brief Método para obtener el nombre del hilo
+	 * @return El nombre, vacío si no se le asignó
+	 */
+	std::string getNombre() const;
+
+	/**
+	 * @brief Método para obtener los contadores de uso de recursos del hilo
+	 * @details Mientras se ejecuta, los contadores se muestrean en el momento
+	 * (reloj de CPU del hilo y /proc/self/task). Al terminar
+	 * Thread::ejecutar se guardan los valores finales, que se conservan
+	 * hasta volver a iniciarlo
+	 * @return Los contadores
+	 */
+	Estadisticas getEstadisticas() const;
+
 	/**
 	 * @brief Operador comparador igual
 	 * @param aComparar Thread a comparar
@@ -222,6 +279,105 @@ public:
 		 */
 		bool isJoinable() const;
 
+		/**
+		 * @brief Restringe la ejecución del hilo a los procesadores de
+		 * @a cpus (por ejemplo, los que atienden las colas de la placa de
+		 * red)
+		 * @param cpus Números de los procesadores permitidos
+		 * @return <tt>true</tt> en caso de éxito
+		 * @return <tt>false</tt> si @a cpus está vacío o algún número es
+		 * inválido
+		 */
+		bool setAfinidadCPU(const std::vector<int> &cpus);
+
+		/**
+		 * @brief Restringe la ejecución del hilo al procesador @a cpu
+		 * @param cpu Número del procesador permitido
+		 * @return <tt>true</tt> en caso de éxito
+		 * @return <tt>false</tt> si @a cpu es inválido
+		 */
+		bool setAfinidadCPU(int cpu);
+
+		/**
+		 * @brief Método para obtener los procesadores a los que está
+		 * restringido el hilo
+		 * @return Los números de los procesadores permitidos. Vacío si no
+		 * hay restricción
+		 */
+		std::vector<int> getAfinidadCPU() const;
+
+		/**
+		 * @brief Asocia el hilo al nodo NUMA @a nodo: restringe su ejecución
+		 * a los procesadores del nodo y hace que su memoria se aloque
+		 * preferentemente en el nodo
+		 * @param nodo Número del nodo NUMA
+		 * @return <tt>true</tt> en caso de éxito
+		 * @return <tt>false</tt> si el nodo no existe
+		 */
+		bool setNodoNUMA(int nodo);
+
+		/**
+		 * @brief Método para obtener el nodo NUMA asociado al hilo
+		 * @return El número de nodo, o -1 si no se asoció a ninguno
+		 */
+		int getNodoNUMA() const;
+
+		/**
+		 * @brief Setea el tamaño del stack del hilo. Reducirlo permite crear
+		 * miles de hilos sin agotar la memoria virtual
+		 * @param tamanio Tamaño del stack, en bytes
+		 * @return <tt>true</tt> en caso de éxito
+		 * @return <tt>false</tt> si @a tamanio es menor a PTHREAD_STACK_MIN
+		 */
+		bool setTamanioStack(size_t tamanio);
+
+		/**
+		 * @brief Método para obtener el tamaño del stack del hilo
+		 * @return El tamaño del stack, en bytes
+		 */
+		size_t getTamanioStack() const;
+
+		/**
+		 * @brief Setea el tamaño de la zona de protección al final del stack,
+		 * que genera SIGSEGV si el hilo desborda su stack
+		 * @param tamanio Tamaño de la zona de protección, en bytes. Con 0 no
+		 * se utiliza zona de protección
+		 * @return <tt>true</tt> en caso de éxito
+		 */
+		bool setTamanioGuarda(size_t tamanio);
+
+		/**
+		 * @brief Método para obtener el tamaño de la zona de protección
+		 * @return El tamaño de la zona de protección, en bytes
+		 */
+		size_t getTamanioGuarda() const;
+
+		/**
+		 * @brief Setea la política de planificación y prioridad del hilo, en
+		 * lugar de heredarlas del hilo que lo inicia
+		 * @note Las políticas de tiempo real (SCHED_FIFO, SCHED_RR) requieren
+		 * privilegios; sin ellos Thread::iniciar falla con SIN_PERMISOS
+		 * @param politica SCHED_OTHER, SCHED_FIFO, SCHED_RR, SCHED_BATCH o
+		 * SCHED_IDLE
+		 * @param prioridad Prioridad estática, dentro del rango de la
+		 * política (0 para las políticas que no son de tiempo real)
+		 * @return <tt>true</tt> en caso de éxito
+		 * @return <tt>false</tt> si la política o prioridad son inválidas
+		 */
+		bool setPlanificacion(int politica, int prioridad = 0);
+
+		/**
+		 * @brief Método para obtener la política de planificación
+		 * @return La política de planificación
+		 */
+		int getPoliticaPlanificacion() const;
+
+		/**
+		 * @brief Método para obtener la prioridad de planificación
+		 * @return La prioridad estática
+		 */
+		int getPrioridad() const;
+
 		/**
 		 * @brief Destructor
 		 */
@@ -230,7 +386,14 @@ public:
 	private:
 
 		pthread_attr_t atributos;
+		bool conAfinidad;
+		int nodoNUMA;
 		friend void Thread::iniciar(void*);
+
+		/* Copia todos los valores de @a aCopiar sobre atributos. Se copian
+		 * uno a uno ya que pthread_attr_t puede tener memoria dinamica
+		 * (la afinidad) y no se debe copiar bit a bit */
+		void copiar(const Atributos &aCopiar);
 	};
 
 protected:
@@ -270,10 +433,64 @@ private:
 	thread_id id;
 	bool esta_vivo;
 
+	/* Contabilidad, protegida por el mutex de RegistroThreads */
+	friend class RegistroThreads;
+	std::string nombre;
+	thread_id propio;
+	pid_t tid;
+	bool ejecutando;
+	uint64_t inicioEjecucion;
+	Estadisticas finales;
+	Thread *anterior;
+	Thread *siguiente;
+
+	void inicializarContabilidad();
+	Estadisticas muestrear() const;
+
 	/* Metodo estatico que sirve para lanzar un thread. Es la conexion
 	 * entre el metodo "iniciar" y "ejecutar", ya que pthread_create
 	 * necesita una funcion de C como argumento */
 	static void* lanzador(void *objetoThread);
+
+	/* Guarda los contadores finales y quita al hilo del registro. Se
+	 * invoca al terminar Thread::ejecutar, aun si el hilo es cancelado */
+	static void finalizarContabilidad(void *objetoThread);
+};
+
+/**
+ * @brief Registro de los Thread que se están ejecutando, para saber cuáles
+ * consumen procesador o pasan el tiempo bloqueados
+ * @details Un Thread se registra al entrar a Thread::ejecutar y se desregistra
+ * al salir
+ */
+
+class RegistroThreads {
+public:
+
+	/**
+	 * @brief Método para obtener los contadores de todos los Thread que se
+	 * están ejecutando
+	 * @return Los contadores, uno por hilo
+	 */
+	static std::vector<Thread::Estadisticas> listar();
+
+	/**
+	 * @brief Método para escribir el reporte de los Thread que se están
+	 * ejecutando, ordenados de mayor a menor tiempo de procesador
+	 * @param salida Flujo donde se escribe el reporte
+	 */
+	static void generarReporte(std::ostream &salida);
+
+private:
+
+	friend class Thread;
+
+	static pthread_mutex_t mutex;
+	static Thread *primero;
+
+	/* Se invocan con el mutex tomado */
+	static void registrar(Thread *thread);
+	static void desregistrar(Thread *thread);
 };
 }
 
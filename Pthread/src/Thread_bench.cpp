@@ -0,0 +1,118 @@
+#include "Thread.h"
+#include "Semaforo.h"
+#include "Bench.h"
+#include <algorithm>
+#include <cstdio>
+#include <sched.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <vector>
+
+/* Ping-pong entre dos Thread, sin afinidad y fijados a procesadores con
+ * Thread::Atributos::setAfinidadCPU: latencia de ida y vuelta (mediana, cola
+ * y máximo como medida del jitter), migraciones entre procesadores y
+ * desalojos */
+
+#define IDAS_Y_VUELTAS 50000
+
+namespace POSIX {
+
+/* Semáforos compartidos por los dos hilos de una prueba */
+struct Mesa {
+	PThread::Semaforo ida;
+	PThread::Semaforo vuelta;
+};
+
+/* Un extremo del ping-pong. El que saca mide cada ida y vuelta */
+class Jugador: public Thread {
+public:
+	Jugador(const Atributos &atributos, Mesa &mesa, bool saca) :
+			Thread(atributos), migraciones(0), desalojos(0), mesa(mesa),
+			saca(saca) {
+	}
+	std::vector<long long> latencias;
+	long migraciones;
+	long desalojos;
+protected:
+	void* ejecutar(void*) {
+		struct rusage uso;
+		getrusage(RUSAGE_THREAD, &uso);
+		long desalojosPrevios = uso.ru_nivcsw;
+		int cpu = sched_getcpu();
+		latencias.reserve(IDAS_Y_VUELTAS);
+		for (int i = 0; i < IDAS_Y_VUELTAS; ++i) {
+			if (saca) {
+				long long inicio = PThread::nanosegundosAhora();
+				mesa.ida.liberar();
+				mesa.vuelta.esperar();
+				latencias.push_back(PThread::nanosegundosAhora() - inicio);
+			}
+			else {
+				mesa.ida.esperar();
+				mesa.vuelta.liberar();
+			}
+			int actual = sched_getcpu();
+			if (actual != cpu) {
+				++migraciones;
+				cpu = actual;
+			}
+		}
+		getrusage(RUSAGE_THREAD, &uso);
+		desalojos = uso.ru_nivcsw - desalojosPrevios;
+		return NULL;
+	}
+private:
+	Mesa &mesa;
+	bool saca;
+};
+
+static void medir(const char *prueba, const Thread::Atributos &saque,
+		const Thread::Atributos &devolucion) {
+	Mesa mesa;
+	Jugador sacador(saque, mesa, true);
+	Jugador devolvedor(devolucion, mesa, false);
+	devolvedor.iniciar();
+	sacador.iniciar();
+	void *retorno;
+	Thread::esperarThread(sacador, retorno);
+	Thread::esperarThread(devolvedor, retorno);
+
+	std::vector<long long> &latencias = sacador.latencias;
+	std::sort(latencias.begin(), latencias.end());
+	printf("%-22s p50 %6.2f us  p99 %7.2f us  max %8.2f us  "
+			"%5ld migraciones  %5ld desalojos\n", prueba,
+			PThread::percentil(latencias, 50) / 1e3,
+			PThread::percentil(latencias, 99) / 1e3, latencias.back() / 1e3,
+			sacador.migraciones + devolvedor.migraciones,
+			sacador.desalojos + devolvedor.desalojos);
+}
+
+void benchAfinidad() {
+	Thread::Atributos libres;
+	medir("sin afinidad", libres, libres);
+
+	/* Con un solo procesador, ambos quedan fijados al 0 */
+	int otro = std::min(1, (int) sysconf(_SC_NPROCESSORS_ONLN) - 1);
+	Thread::Atributos primero;
+	Thread::Atributos segundo;
+	primero.setAfinidadCPU(0);
+	segundo.setAfinidadCPU(otro);
+	char prueba[32];
+	snprintf(prueba, sizeof(prueba), "fijados a 0 y %d", otro);
+	medir(prueba, primero, segundo);
+
+	Thread::Atributos mismo;
+	mismo.setAfinidadCPU(0);
+	medir("fijados ambos a 0", mismo, mismo);
+}
+
+}
+
+#ifdef THREAD_BENCH
+int main() {
+	printf("%d idas y vueltas, %ld procesadores\n", IDAS_Y_VUELTAS,
+			sysconf(_SC_NPROCESSORS_ONLN));
+	POSIX::benchAfinidad();
+	return 0;
+}
+#endif
@@ -0,0 +1,108 @@
+#include "ArchivoMapeado.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define ERROR_ARCHIVO -1
+
+namespace Com {
+
+ArchivoMapeado::ArchivoMapeado(const std::string &ruta, bool precargar) {
+	mapear(ruta, 0, 0, true, precargar);
+}
+
+ArchivoMapeado::ArchivoMapeado(const std::string &ruta, off_t desplazamiento,
+		size_t tamanio, bool precargar) {
+	mapear(ruta, desplazamiento, tamanio, false, precargar);
+}
+
+void ArchivoMapeado::mapear(const std::string &ruta, off_t desplazamiento,
+		size_t tamanio, bool completo, bool precargar) {
+	mapeo = NULL;
+	tamanioMapeo = 0;
+	datos = NULL;
+	this->tamanio = 0;
+
+	int fd = open(ruta.c_str(), O_RDONLY);
+	if (fd == ERROR_ARCHIVO) {
+		throw ArchivoExcepcion(strerror(errno));
+	}
+	struct stat estado;
+	if (fstat(fd, &estado) == ERROR_ARCHIVO) {
+		int error = errno;
+		close(fd);
+		throw ArchivoExcepcion(strerror(error));
+	}
+	if (desplazamiento < 0 || desplazamiento > estado.st_size) {
+		close(fd);
+		throw ArchivoExcepcion("Rango fuera del archivo");
+	}
+	size_t disponible = (size_t) (estado.st_size - desplazamiento);
+	if (completo || tamanio > disponible) {
+		tamanio = disponible;
+	}
+	if (tamanio == 0) {
+		close(fd);
+		return;
+	}
+
+	/* mmap requiere que el desplazamiento este alineado a pagina */
+	off_t tamanioPagina = (off_t) sysconf(_SC_PAGESIZE);
+	off_t alineado = desplazamiento - (desplazamiento % tamanioPagina);
+	size_t corrimiento = (size_t) (desplazamiento - alineado);
+
+	int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+	if (precargar) {
+		flags |= MAP_POPULATE;
+	}
+#endif
+	void *resultado = mmap(NULL, tamanio + corrimiento, PROT_READ, flags, fd,
+			alineado);
+	int error = errno;
+	close(fd);
+	if (resultado == MAP_FAILED) {
+		throw ArchivoExcepcion(strerror(error));
+	}
+	madvise(resultado, tamanio + corrimiento, MADV_SEQUENTIAL);
+
+	mapeo = resultado;
+	tamanioMapeo = tamanio + corrimiento;
+	datos = (const BufferTransmision::t_buffer*) resultado + corrimiento;
+	this->tamanio = tamanio;
+}
+
+const BufferTransmision::t_buffer* ArchivoMapeado::obtenerBuffer() const {
+	return datos;
+}
+
+size_t ArchivoMapeado::obtenerBuffer(std::string &aEscribir) const {
+	aEscribir.assign(datos, tamanio);
+	return tamanio;
+}
+
+bool ArchivoMapeado::obtenerByteBuffer(char &byte, size_t posicion) const {
+	if (posicion >= tamanio) {
+		return false;
+	}
+	byte = datos[posicion];
+	return true;
+}
+
+VistaBuffer ArchivoMapeado::obtenerVista() const {
+	return VistaBuffer(datos, tamanio);
+}
+
+size_t ArchivoMapeado::getTamanioOcupado() const {
+	return tamanio;
+}
+
+ArchivoMapeado::~ArchivoMapeado() {
+	if (mapeo != NULL) {
+		munmap(mapeo, tamanioMapeo);
+	}
+}
+}
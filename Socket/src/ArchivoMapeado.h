@@ -0,0 +1,114 @@
+#ifndef ARCHIVOMAPEADO_H
+#define	ARCHIVOMAPEADO_H
+
+#include <string>
+#include <sys/types.h>
+#include "BufferTransmision.h"
+#include "VistaBuffer.h"
+#include "ArchivoExcepcion.h"
+
+namespace Com {
+
+/**
+ * @brief Clase que mapea en memoria, de solo lectura, un archivo o un rango
+ * de bytes del mismo, para poder enviarlo por un socket sin copiarlo antes a
+ * un BufferTransmision
+ * @details Ofrece los métodos de consulta de BufferTransmision. Para enviarlo
+ * se utiliza su vista con SocketTCP_IP::enviar(const VistaBuffer&) o
+ * SocketTCP_IP::enviarConProtocolo(const VistaBuffer&). Las páginas se leen
+ * del disco a medida que se envían, por lo que el consumo de memoria no crece
+ * con el tamaño del archivo
+ * @warning Si otro proceso trunca el archivo mientras está mapeado, acceder a
+ * los datos genera SIGBUS
+ */
+
+class ArchivoMapeado {
+public:
+
+	/**
+	 * @brief Mapea el archivo completo ubicado en @a ruta
+	 * @param ruta Ruta del archivo a mapear
+	 * @param precargar Indica si se deben leer todas las páginas del archivo
+	 * al mapearlo (MAP_POPULATE), en lugar de hacerlo a medida que se
+	 * accede a ellas
+	 * @throw ArchivoExcepcion Error generado al abrir o mapear el archivo
+	 */
+	explicit ArchivoMapeado(const std::string &ruta, bool precargar = false)
+			/* throw (ArchivoExcepcion) */;
+
+	/**
+	 * @brief Mapea @a tamanio bytes del archivo ubicado en @a ruta, a partir
+	 * del byte @a desplazamiento
+	 * @param ruta Ruta del archivo a mapear
+	 * @param desplazamiento Posición del primer byte a mapear
+	 * @param tamanio Cantidad de bytes a mapear. Si el rango excede el final
+	 * del archivo, se recorta
+	 * @param precargar Indica si se deben leer todas las páginas del rango
+	 * al mapearlo (MAP_POPULATE)
+	 * @throw ArchivoExcepcion Error generado al abrir o mapear el archivo
+	 */
+	ArchivoMapeado(const std::string &ruta, off_t desplazamiento,
+			size_t tamanio, bool precargar = false)
+			/* throw (ArchivoExcepcion) */;
+
+	/**
+	 * @brief Método que obtiene los datos mapeados para consulta
+	 * @return Puntero a los datos mapeados
+	 */
+	const BufferTransmision::t_buffer* obtenerBuffer() const;
+
+	/**
+	 * @brief Método para obtener una copia del contenido mapeado. El
+	 * contenido se guarda en @a aEscribir (cualquier contenido previo
+	 * se descarta)
+	 * @param aEscribir Contenedor string a guardar la copia de los datos
+	 * @return El tamaño total de los datos guardados en el contenedor
+	 */
+	size_t obtenerBuffer(std::string &aEscribir) const;
+
+	/**
+	 * @brief Método que retorna el byte corresponiente a la posición
+	 * @a posicion de los datos mapeados. Las posiciones comienzan en 0
+	 * @param byte Variable donde se guardará el byte solicitado
+	 * @param posicion Posición del byte solicitado
+	 * @return <tt>true</tt> en caso de éxito
+	 * @return <tt>false</tt> si @a posicion es una posición inválida
+	 */
+	bool obtenerByteBuffer(char &byte, size_t posicion) const;
+
+	/**
+	 * @brief Método para obtener una vista de los datos mapeados
+	 * @return La vista de los datos mapeados
+	 */
+	VistaBuffer obtenerVista() const;
+
+	/**
+	 * @brief Método para obtener el tamaño mapeado
+	 * @return El tamaño mapeado, en bytes
+	 */
+	size_t getTamanioOcupado() const;
+
+	/**
+	 * @brief Destructor. Libera el mapeo
+	 */
+	~ArchivoMapeado();
+
+private:
+
+	/* Inicio del mapeo (alineado a pagina) y su longitud */
+	void *mapeo;
+	size_t tamanioMapeo;
+
+	/* Datos pedidos, dentro del mapeo */
+	const BufferTransmision::t_buffer *datos;
+	size_t tamanio;
+
+	void mapear(const std::string &ruta, off_t desplazamiento,
+			size_t tamanio, bool completo, bool precargar);
+
+	ArchivoMapeado(const ArchivoMapeado&);
+	ArchivoMapeado& operator=(const ArchivoMapeado&);
+};
+}
+
+#endif
@@ -0,0 +1,185 @@
+#include "ArchivoMapeado.h"
+#include "SocketCliente.h"
+#include "SocketServidor.h"
+#include "Thread.h"
+#include "Bench.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+/* Envío de un archivo por una conexión local: mapeándolo con ArchivoMapeado
+ * y enviando la vista, frente a leerlo primero en un BufferTransmision.
+ * Cada caso corre en un proceso hijo para medir su pico de memoria residente
+ * (ru_maxrss) por separado */
+
+#define TAMANIO_ARCHIVO (256 * 1024 * 1024)
+/* Tamaño de cada tramo en los casos que procesan el archivo por partes */
+#define VENTANA (8 * 1024 * 1024)
+#define TAMANIO_RECEPCION (64 * 1024)
+#define PUERTO_BENCH 40300
+
+namespace Com {
+
+/* Acepta una conexión y descarta lo recibido hasta que se cierra */
+class Sumidero: public POSIX::Thread {
+public:
+	explicit Sumidero(SocketServidor &servidor) :
+			recibidos(0), servidor(servidor) {
+	}
+	size_t recibidos;
+protected:
+	void* ejecutar(void*) {
+		SocketCliente *conexion = servidor.aceptarClientes();
+		BufferTransmision buffer(TAMANIO_RECEPCION);
+		try {
+			ssize_t bytes;
+			while ((bytes = conexion->recibir(buffer)) > 0) {
+				recibidos += (size_t) bytes;
+			}
+		}
+		catch (RecepcionExcepcion&) {
+		}
+		conexion->cerrar();
+		delete conexion;
+		return NULL;
+	}
+private:
+	SocketServidor &servidor;
+};
+
+static void enviarVista(SocketCliente &cliente, const VistaBuffer &vista) {
+	size_t enviados = 0;
+	while (enviados < vista.getTamanio()) {
+		enviados += (size_t) cliente.enviar(
+				vista.subVista(enviados, vista.getTamanio() - enviados));
+	}
+}
+
+static void enviarBuffer(SocketCliente &cliente, BufferTransmision &buffer) {
+	while (buffer.getTamanioOcupado() > 0) {
+		buffer.descartarDatos((size_t) cliente.enviar(buffer));
+	}
+}
+
+/* Lee hasta @a cantidad bytes de @a fd al final de @a buffer */
+static void leer(int fd, BufferTransmision &buffer, size_t cantidad) {
+	BufferTransmision::t_buffer *destino = buffer.reservarDatos(cantidad);
+	size_t leidos = 0;
+	ssize_t bytes;
+	while (leidos < cantidad
+			&& (bytes = read(fd, destino + leidos, cantidad - leidos)) > 0) {
+		leidos += (size_t) bytes;
+	}
+}
+
+enum Caso {
+	leido_completo, leido_por_ventanas, mapeado, mapeado_precargado,
+	mapeado_por_ventanas
+};
+
+static void enviarArchivo(SocketCliente &cliente, const std::string &ruta,
+		Caso caso) {
+	if (caso == mapeado || caso == mapeado_precargado) {
+		ArchivoMapeado archivo(ruta, caso == mapeado_precargado);
+		enviarVista(cliente, archivo.obtenerVista());
+	}
+	else if (caso == mapeado_por_ventanas) {
+		for (off_t desplazamiento = 0; desplazamiento < TAMANIO_ARCHIVO;
+				desplazamiento += VENTANA) {
+			ArchivoMapeado ventana(ruta, desplazamiento, VENTANA);
+			enviarVista(cliente, ventana.obtenerVista());
+		}
+	}
+	else {
+		size_t tramo = (caso == leido_completo) ? TAMANIO_ARCHIVO : VENTANA;
+		BufferTransmision buffer(tramo);
+		int fd = open(ruta.c_str(), O_RDONLY);
+		for (size_t leidos = 0; leidos < TAMANIO_ARCHIVO; leidos += tramo) {
+			leer(fd, buffer, tramo);
+			enviarBuffer(cliente, buffer);
+		}
+		close(fd);
+	}
+}
+
+static void medir(const char *prueba, SocketServidor &servidor,
+		in_port_t puerto, const std::string &ruta, Caso caso) {
+	fflush(stdout);
+	pid_t hijo = fork();
+	if (hijo != 0) {
+		waitpid(hijo, NULL, 0);
+		return;
+	}
+
+	Sumidero sumidero(servidor);
+	sumidero.iniciar();
+	SocketCliente cliente(puerto, "127.0.0.1");
+	cliente.crear();
+	cliente.conectar();
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	enviarArchivo(cliente, ruta, caso);
+	cliente.cortarComunicacion(Socket::cortar_ambos);
+	void *retorno;
+	POSIX::Thread::esperarThread(sumidero, retorno);
+	double segundos = PThread::segundosDesde(inicio);
+	cliente.cerrar();
+
+	struct rusage uso;
+	getrusage(RUSAGE_SELF, &uso);
+	printf("%-22s %7.1f MB/s  pico RSS %7ld KB%s\n", prueba,
+			TAMANIO_ARCHIVO / segundos / 1e6, uso.ru_maxrss,
+			(sumidero.recibidos != TAMANIO_ARCHIVO) ? "  ERROR" : "");
+	fflush(stdout);
+	_exit(0);
+}
+
+void benchEnvioArchivo(SocketServidor &servidor, in_port_t puerto) {
+	char ruta[] = "/tmp/ArchivoMapeado_benchXXXXXX";
+	int fd = mkstemp(ruta);
+	std::vector<char> bloque(VENTANA);
+	for (size_t i = 0; i < bloque.size(); ++i) {
+		bloque[i] = (char) i;
+	}
+	for (size_t escritos = 0; escritos < TAMANIO_ARCHIVO;
+			escritos += bloque.size()) {
+		if (write(fd, &bloque[0], bloque.size()) != (ssize_t) VENTANA) {
+			break;
+		}
+	}
+	close(fd);
+
+	struct rusage uso;
+	getrusage(RUSAGE_SELF, &uso);
+	printf("archivo de %d MB en la caché de páginas, ventanas de %d MB, "
+			"RSS inicial %ld KB\n", TAMANIO_ARCHIVO >> 20, VENTANA >> 20,
+			uso.ru_maxrss);
+	medir("leido completo", servidor, puerto, ruta, leido_completo);
+	medir("leido por ventanas", servidor, puerto, ruta, leido_por_ventanas);
+	medir("mapeado", servidor, puerto, ruta, mapeado);
+	medir("mapeado precargado", servidor, puerto, ruta, mapeado_precargado);
+	medir("mapeado por ventanas", servidor, puerto, ruta,
+			mapeado_por_ventanas);
+	unlink(ruta);
+}
+
+}
+
+#ifdef ARCHIVOMAPEADO_BENCH
+int main(int argc, char **argv) {
+	in_port_t puerto = (in_port_t) ((argc > 1) ? atoi(argv[1]) : PUERTO_BENCH);
+	Com::SocketServidor servidor(puerto);
+	servidor.crear();
+	servidor.enlazarServidor();
+	servidor.escucharClientes(4);
+	Com::benchEnvioArchivo(servidor, puerto);
+	servidor.cerrar();
+	return 0;
+}
+#endif
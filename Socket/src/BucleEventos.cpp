@@ -0,0 +1,259 @@
+#include "BucleEventos.h"
+#include <cerrno>
+#include <cstring>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include "ExcepcionesSocket.h"
+
+#define ERROR_EPOLL -1
+#define MAX_EVENTOS 64
+
+namespace Com {
+
+BucleEventos::BucleEventos() {
+	detenido = false;
+	epoll = epoll_create1(EPOLL_CLOEXEC);
+	if (epoll == ERROR_EPOLL) {
+		throw CreacionExcepcion(strerror(errno));
+	}
+	despertador = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (despertador == ERROR_EPOLL) {
+		int error = errno;
+		close(epoll);
+		throw CreacionExcepcion(strerror(error));
+	}
+	struct epoll_event evento;
+	evento.events = EPOLLIN;
+	evento.data.fd = despertador;
+	epoll_ctl(epoll, EPOLL_CTL_ADD, despertador, &evento);
+
+	/* Sin timerfd, los plazos se respetan con el tiempo de espera de
+	 * epoll_wait */
+	descriptorRueda = rueda.getDescriptor();
+	if (descriptorRueda != ERROR_EPOLL) {
+		evento.data.fd = descriptorRueda;
+		epoll_ctl(epoll, EPOLL_CTL_ADD, descriptorRueda, &evento);
+	}
+}
+
+bool BucleEventos::esperarLectura(int descriptor,
+		ManejadorDescriptor *manejador) {
+	return registrar(descriptor, manejador, true, NULL, 0);
+}
+
+bool BucleEventos::esperarEscritura(int descriptor,
+		ManejadorDescriptor *manejador) {
+	return registrar(descriptor, manejador, false, NULL, 0);
+}
+
+bool BucleEventos::esperarLectura(int descriptor,
+		ManejadorDescriptor *manejador, Temporizador &limite,
+		uint64_t milisegundos) {
+	return registrar(descriptor, manejador, true, &limite, milisegundos);
+}
+
+bool BucleEventos::esperarEscritura(int descriptor,
+		ManejadorDescriptor *manejador, Temporizador &limite,
+		uint64_t milisegundos) {
+	return registrar(descriptor, manejador, false, &limite, milisegundos);
+}
+
+void BucleEventos::cancelarLectura(int descriptor) {
+	cancelar(descriptor, true);
+}
+
+void BucleEventos::cancelarEscritura(int descriptor) {
+	cancelar(descriptor, false);
+}
+
+void BucleEventos::armarTemporizador(Temporizador &temporizador,
+		uint64_t milisegundos) {
+	PThread::Mutex::Lock lock(mutex);
+	rueda.armar(temporizador, milisegundos);
+}
+
+bool BucleEventos::cancelarTemporizador(Temporizador &temporizador) {
+	PThread::Mutex::Lock lock(mutex);
+	return rueda.cancelar(temporizador);
+}
+
+void BucleEventos::quitar(int descriptor) {
+	PThread::Mutex::Lock lock(mutex);
+	if (registros.erase(descriptor) > 0) {
+		epoll_ctl(epoll, EPOLL_CTL_DEL, descriptor, NULL);
+	}
+}
+
+void BucleEventos::enviar(POSIX::Tarea *tarea) {
+	{
+		PThread::Mutex::Lock lock(mutex);
+		tareas.push_back(tarea);
+	}
+	despertar();
+}
+
+void BucleEventos::ejecutar() {
+	while (!__atomic_load_n(&detenido, __ATOMIC_ACQUIRE)) {
+		ejecutarUnaVez(-1);
+	}
+	__atomic_store_n(&detenido, false, __ATOMIC_RELEASE);
+}
+
+size_t BucleEventos::ejecutarUnaVez(int milisegundos) {
+	if (descriptorRueda == ERROR_EPOLL) {
+		PThread::Mutex::Lock lock(mutex);
+		int proximo = rueda.milisegundosHastaProximo();
+		if (proximo != -1 && (milisegundos == -1 || proximo < milisegundos)) {
+			milisegundos = proximo;
+		}
+	}
+	struct epoll_event eventos[MAX_EVENTOS];
+	int cantidad = epoll_wait(epoll, eventos, MAX_EVENTOS, milisegundos);
+	size_t ejecutados = 0;
+
+	for (int i = 0; i < cantidad; ++i) {
+		int descriptor = eventos[i].data.fd;
+		if (descriptor == despertador) {
+			uint64_t valor;
+			ssize_t leido = read(despertador, &valor, sizeof(valor));
+			(void) leido;
+			continue;
+		}
+		if (descriptor == descriptorRueda) {
+			/* Se procesa luego de los descriptores */
+			continue;
+		}
+
+		/* Los registros son de un solo disparo: tomo los manejadores que
+		 * corresponden al evento y dejo el resto registrado */
+		ManejadorDescriptor *lectura = NULL;
+		ManejadorDescriptor *escritura = NULL;
+		{
+			PThread::Mutex::Lock lock(mutex);
+			std::map<int, Registro>::iterator it = registros.find(descriptor);
+			if (it == registros.end()) {
+				continue;
+			}
+			uint32_t ocurridos = eventos[i].events;
+			bool error = (ocurridos & (EPOLLERR | EPOLLHUP)) != 0;
+			if (error || (ocurridos & (EPOLLIN | EPOLLRDHUP))) {
+				lectura = it->second.lectura;
+				it->second.lectura = NULL;
+			}
+			if (error || (ocurridos & EPOLLOUT)) {
+				escritura = it->second.escritura;
+				it->second.escritura = NULL;
+			}
+			actualizar(descriptor, it->second, false);
+		}
+		if (lectura != NULL) {
+			lectura->descriptorListo();
+			++ejecutados;
+		}
+		if (escritura != NULL) {
+			escritura->descriptorListo();
+			++ejecutados;
+		}
+	}
+
+	/* Los temporizadores se avanzan despues de despachar los descriptores,
+	 * para que una operacion que se completo en esta vuelta ya haya
+	 * cancelado su plazo */
+	std::vector<Temporizador*> vencidos;
+	std::vector<POSIX::Tarea*> pendientes;
+	{
+		PThread::Mutex::Lock lock(mutex);
+		rueda.avanzar(vencidos);
+		pendientes.swap(tareas);
+	}
+	for (size_t i = 0; i < vencidos.size(); ++i) {
+		vencidos[i]->expirar();
+	}
+	ejecutados += vencidos.size();
+	for (size_t i = 0; i < pendientes.size(); ++i) {
+		pendientes[i]->ejecutar();
+	}
+	return ejecutados + pendientes.size();
+}
+
+void BucleEventos::detener() {
+	__atomic_store_n(&detenido, true, __ATOMIC_RELEASE);
+	despertar();
+}
+
+BucleEventos::~BucleEventos() {
+	close(despertador);
+	close(epoll);
+}
+
+bool BucleEventos::registrar(int descriptor, ManejadorDescriptor *manejador,
+		bool lectura, Temporizador *limite, uint64_t milisegundos) {
+	PThread::Mutex::Lock lock(mutex);
+	std::map<int, Registro>::iterator it = registros.find(descriptor);
+	bool nuevo = (it == registros.end());
+	if (nuevo) {
+		Registro vacio;
+		vacio.lectura = NULL;
+		vacio.escritura = NULL;
+		it = registros.insert(std::make_pair(descriptor, vacio)).first;
+	}
+	ManejadorDescriptor *&destino =
+			lectura ? it->second.lectura : it->second.escritura;
+	ManejadorDescriptor *anterior = destino;
+	destino = manejador;
+	if (!actualizar(descriptor, it->second, nuevo)) {
+		destino = anterior;
+		if (nuevo) {
+			registros.erase(it);
+		}
+		return false;
+	}
+	if (limite != NULL) {
+		rueda.armar(*limite, milisegundos);
+	}
+	return true;
+}
+
+void BucleEventos::cancelar(int descriptor, bool lectura) {
+	PThread::Mutex::Lock lock(mutex);
+	std::map<int, Registro>::iterator it = registros.find(descriptor);
+	if (it == registros.end()) {
+		return;
+	}
+	if (lectura) {
+		it->second.lectura = NULL;
+	}
+	else {
+		it->second.escritura = NULL;
+	}
+	actualizar(descriptor, it->second, false);
+}
+
+bool BucleEventos::actualizar(int descriptor, const Registro &registro,
+		bool nuevo) {
+	if (registro.lectura == NULL && registro.escritura == NULL) {
+		registros.erase(descriptor);
+		return (epoll_ctl(epoll, EPOLL_CTL_DEL, descriptor, NULL)
+				!= ERROR_EPOLL);
+	}
+	struct epoll_event evento;
+	evento.events = EPOLLONESHOT;
+	if (registro.lectura != NULL) {
+		evento.events |= EPOLLIN | EPOLLRDHUP;
+	}
+	if (registro.escritura != NULL) {
+		evento.events |= EPOLLOUT;
+	}
+	evento.data.fd = descriptor;
+	int operacion = nuevo ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+	return (epoll_ctl(epoll, operacion, descriptor, &evento) != ERROR_EPOLL);
+}
+
+void BucleEventos::despertar() {
+	uint64_t uno = 1;
+	ssize_t escrito = write(despertador, &uno, sizeof(uno));
+	(void) escrito;
+}
+}
@@ -0,0 +1,214 @@
+#ifndef BUCLEEVENTOS_H
+#define	BUCLEEVENTOS_H
+
+#include <map>
+#include <vector>
+#include "Ejecutor.h"
+#include "Mutex.h"
+#include "RuedaTemporizadores.h"
+
+namespace Com {
+
+/**
+ * @brief Interfaz de los objetos que esperan que un descriptor esté listo
+ * para leer o escribir en un BucleEventos
+ */
+
+class ManejadorDescriptor {
+public:
+
+	/**
+	 * @brief Método invocado desde el hilo del bucle cuando el descriptor
+	 * está listo, o tiene un error pendiente. El manejador puede volver a
+	 * registrarse o destruirse dentro de este método
+	 */
+	virtual void descriptorListo() = 0;
+
+	/**
+	 * @brief Destructor
+	 */
+	virtual ~ManejadorDescriptor() {
+	}
+};
+
+/**
+ * @brief Bucle de eventos sobre epoll. Un hilo ejecuta BucleEventos::ejecutar
+ * y despacha los descriptores que quedan listos a sus manejadores, sin
+ * bloquear un hilo por conexión
+ * @details Cada registro es de un solo disparo: al quedar listo el
+ * descriptor, se invoca al manejador y se quita el registro. Un descriptor
+ * puede tener a la vez un manejador de lectura y otro de escritura
+ * @details Tiene una RuedaTemporizadores propia, manejada con un timerfd, para
+ * los plazos de las operaciones. Los temporizadores vencen en el hilo del
+ * bucle
+ * @details También es un POSIX::Ejecutor: las tareas enviadas se ejecutan en
+ * el hilo del bucle, por lo que puede usarse como ejecutor de las
+ * continuaciones de POSIX::Futuro
+ * @details Todos los métodos pueden invocarse desde cualquier hilo
+ */
+
+class BucleEventos: public POSIX::Ejecutor {
+public:
+
+	/**
+	 * @brief Construye el bucle
+	 * @throw CreacionExcepcion Error al crear el epoll o el eventfd
+	 */
+	BucleEventos() /* throw (CreacionExcepcion) */;
+
+	/**
+	 * @brief Método para esperar a que un descriptor tenga datos para leer
+	 * (o conexiones para aceptar)
+	 * @pre El descriptor no tiene otro manejador de lectura registrado
+	 * @param descriptor Descriptor a esperar
+	 * @param manejador Manejador a invocar. Debe seguir vivo hasta ser
+	 * invocado o hasta quitar el descriptor
+	 * @return <tt>true</tt> si se registró
+	 * @return <tt>false</tt> si epoll rechazó el descriptor
+	 */
+	bool esperarLectura(int descriptor, ManejadorDescriptor *manejador);
+
+	/**
+	 * @brief Método para esperar a que se pueda escribir en un descriptor (o
+	 * a que se complete una conexión)
+	 * @pre El descriptor no tiene otro manejador de escritura registrado
+	 * @param descriptor Descriptor a esperar
+	 * @param manejador Manejador a invocar. Debe seguir vivo hasta ser
+	 * invocado o hasta quitar el descriptor
+	 * @return <tt>true</tt> si se registró
+	 * @return <tt>false</tt> si epoll rechazó el descriptor
+	 */
+	bool esperarEscritura(int descriptor, ManejadorDescriptor *manejador);
+
+	/**
+	 * @brief Igual a BucleEventos::esperarLectura, pero además arma un
+	 * temporizador en la misma operación, de modo que ni el manejador ni el
+	 * temporizador puedan invocarse antes de quedar ambos registrados
+	 * @param descriptor Descriptor a esperar
+	 * @param manejador Manejador a invocar
+	 * @param limite Temporizador a armar
+	 * @param milisegundos Plazo del temporizador
+	 * @return <tt>true</tt> si se registró
+	 * @return <tt>false</tt> si epoll rechazó el descriptor. En ese caso no
+	 * se arma el temporizador
+	 */
+	bool esperarLectura(int descriptor, ManejadorDescriptor *manejador,
+			Temporizador &limite, uint64_t milisegundos);
+
+	/**
+	 * @brief Igual a BucleEventos::esperarEscritura, pero además arma un
+	 * temporizador en la misma operación (ver BucleEventos::esperarLectura)
+	 * @param descriptor Descriptor a esperar
+	 * @param manejador Manejador a invocar
+	 * @param limite Temporizador a armar
+	 * @param milisegundos Plazo del temporizador
+	 * @return <tt>true</tt> si se registró
+	 * @return <tt>false</tt> si epoll rechazó el descriptor. En ese caso no
+	 * se arma el temporizador
+	 */
+	bool esperarEscritura(int descriptor, ManejadorDescriptor *manejador,
+			Temporizador &limite, uint64_t milisegundos);
+
+	/**
+	 * @brief Método para quitar el manejador de lectura de un descriptor,
+	 * sin invocarlo
+	 * @param descriptor Descriptor a quitar
+	 */
+	void cancelarLectura(int descriptor);
+
+	/**
+	 * @brief Método para quitar el manejador de escritura de un descriptor,
+	 * sin invocarlo
+	 * @param descriptor Descriptor a quitar
+	 */
+	void cancelarEscritura(int descriptor);
+
+	/**
+	 * @brief Método para armar un temporizador en la rueda del bucle. Si ya
+	 * estaba armado, se rearma con el nuevo plazo
+	 * @param temporizador Temporizador a armar. Debe seguir vivo mientras
+	 * esté armado
+	 * @param milisegundos Plazo desde el instante actual
+	 */
+	void armarTemporizador(Temporizador &temporizador, uint64_t milisegundos);
+
+	/**
+	 * @brief Método para cancelar un temporizador de la rueda del bucle
+	 * @details Si se invoca desde otro hilo, el temporizador puede estar
+	 * venciendo en ese momento; en ese caso se retorna <tt>false</tt> y
+	 * Temporizador::expirar se invoca igual
+	 * @param temporizador Temporizador a cancelar
+	 * @return <tt>true</tt> si estaba armado
+	 */
+	bool cancelarTemporizador(Temporizador &temporizador);
+
+	/**
+	 * @brief Método para quitar los registros de un descriptor, sin invocar
+	 * a sus manejadores. Debe invocarse antes de cerrar un descriptor con
+	 * esperas pendientes
+	 * @param descriptor Descriptor a quitar
+	 */
+	void quitar(int descriptor);
+
+	/**
+	 * @brief Método para ejecutar una tarea en el hilo del bucle
+	 * @param tarea Tarea a ejecutar. Debe seguir viva hasta que termine su
+	 * ejecución
+	 */
+	virtual void enviar(POSIX::Tarea *tarea);
+
+	/**
+	 * @brief Método que despacha eventos y tareas hasta que se invoque
+	 * BucleEventos::detener
+	 */
+	void ejecutar();
+
+	/**
+	 * @brief Método que espera eventos una sola vez y los despacha
+	 * @param milisegundos Tiempo máximo de espera, -1 para esperar sin límite
+	 * @return La cantidad de manejadores y tareas ejecutados
+	 */
+	size_t ejecutarUnaVez(int milisegundos);
+
+	/**
+	 * @brief Método que hace retornar a BucleEventos::ejecutar, luego de
+	 * despachar los eventos en curso
+	 */
+	void detener();
+
+	/**
+	 * @brief Destructor
+	 * @pre El bucle no se está ejecutando
+	 */
+	virtual ~BucleEventos();
+
+private:
+
+	struct Registro {
+		ManejadorDescriptor *lectura;
+		ManejadorDescriptor *escritura;
+	};
+
+	int epoll;
+	/* eventfd para despertar al bucle */
+	int despertador;
+	bool detenido;
+
+	PThread::Mutex mutex;
+	std::map<int, Registro> registros;
+	std::vector<POSIX::Tarea*> tareas;
+	RuedaTemporizadores rueda;
+	int descriptorRueda;
+
+	bool registrar(int descriptor, ManejadorDescriptor *manejador,
+			bool lectura, Temporizador *limite, uint64_t milisegundos);
+	void cancelar(int descriptor, bool lectura);
+	bool actualizar(int descriptor, const Registro &registro, bool nuevo);
+	void despertar();
+
+	BucleEventos(const BucleEventos&);
+	BucleEventos& operator=(const BucleEventos&);
+};
+}
+
+#endif
@@ -0,0 +1,232 @@
+#include "BucleEventos.h"
+#include "SocketCliente.h"
+#include "SocketServidor.h"
+#include "VistaBuffer.h"
+#include "ExcepcionesSocket.h"
+#include "CuentaRegresiva.h"
+#include "Thread.h"
+#include "Bench.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <time.h>
+#include <vector>
+
+/* Servidor de eco: cada cliente hace ida y vuelta con mensajes chicos, con
+ * el servidor atendiendo todas las conexiones desde un BucleEventos o con
+ * un hilo bloqueante por conexión */
+
+#define CONEXIONES 64
+#define IDAS_Y_VUELTAS 2000
+#define TAMANIO_MENSAJE 64
+#define PUERTO_BENCH 40400
+
+namespace Com {
+
+class ClienteEco: public POSIX::Thread {
+public:
+	explicit ClienteEco(in_port_t puerto) :
+			socket(puerto, "127.0.0.1"), recibido(TAMANIO_MENSAJE) {
+		socket.crear();
+		socket.conectar();
+	}
+	void cerrar() {
+		socket.cerrar();
+	}
+protected:
+	void* ejecutar(void*) {
+		BufferTransmision::t_buffer mensaje[TAMANIO_MENSAJE];
+		memset(mensaje, 'e', sizeof(mensaje));
+		VistaBuffer vista(mensaje, sizeof(mensaje));
+		for (int i = 0; i < IDAS_Y_VUELTAS; ++i) {
+			socket.enviarConProtocolo(vista);
+			socket.recibirConProtocolo(recibido);
+		}
+		return NULL;
+	}
+private:
+	SocketCliente socket;
+	BufferTransmision recibido;
+};
+
+/* Conexión atendida desde el bucle: recibe y devuelve cada mensaje
+ * encadenando las continuaciones de los futuros */
+class ConexionEco: public POSIX::Tarea {
+public:
+	ConexionEco(SocketCliente *socket, BucleEventos &bucle,
+			PThread::CuentaRegresiva &terminadas) :
+			socket(socket), bucle(bucle), terminadas(terminadas),
+			buffer(TAMANIO_MENSAJE), recibiendo(true) {
+	}
+	void iniciar() {
+		operacion = socket->recibirConProtocolo(buffer, bucle);
+		operacion.alCompletar(this, bucle);
+	}
+	void ejecutar() {
+		if (operacion.tieneError()) {
+			terminadas.descontar();
+			return;
+		}
+		recibiendo = !recibiendo;
+		if (recibiendo) {
+			operacion = socket->recibirConProtocolo(buffer, bucle);
+		}
+		else {
+			operacion = socket->enviarConProtocolo(VistaBuffer(buffer), bucle);
+		}
+		operacion.alCompletar(this, bucle);
+	}
+	~ConexionEco() {
+		socket->cerrar();
+		delete socket;
+	}
+private:
+	SocketCliente *socket;
+	BucleEventos &bucle;
+	PThread::CuentaRegresiva &terminadas;
+	BufferTransmision buffer;
+	POSIX::Futuro<size_t> operacion;
+	bool recibiendo;
+};
+
+/* Conexión atendida por su propio hilo con las operaciones bloqueantes */
+class HiloEco: public POSIX::Thread {
+public:
+	explicit HiloEco(SocketCliente *socket) :
+			socket(socket), buffer(TAMANIO_MENSAJE) {
+	}
+	~HiloEco() {
+		socket->cerrar();
+		delete socket;
+	}
+protected:
+	void* ejecutar(void*) {
+		try {
+			while (true) {
+				socket->recibirConProtocolo(buffer);
+				socket->enviarConProtocolo(VistaBuffer(buffer));
+			}
+		}
+		catch (SocketExcepcion&) {
+			/* El cliente cerró la conexión */
+		}
+		return NULL;
+	}
+private:
+	SocketCliente *socket;
+	BufferTransmision buffer;
+};
+
+class HiloBucle: public POSIX::Thread {
+public:
+	explicit HiloBucle(BucleEventos &bucle) :
+			bucle(bucle) {
+	}
+protected:
+	void* ejecutar(void*) {
+		bucle.ejecutar();
+		return NULL;
+	}
+private:
+	BucleEventos &bucle;
+};
+
+static void conectarClientes(in_port_t puerto, SocketServidor &servidor,
+		std::vector<ClienteEco*> &clientes,
+		std::vector<SocketCliente*> &aceptados) {
+	for (int i = 0; i < CONEXIONES; ++i) {
+		clientes.push_back(new ClienteEco(puerto));
+		aceptados.push_back(servidor.aceptarClientes());
+	}
+}
+
+static double medirClientes(std::vector<ClienteEco*> &clientes) {
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	for (size_t i = 0; i < clientes.size(); ++i) {
+		clientes[i]->iniciar();
+	}
+	for (size_t i = 0; i < clientes.size(); ++i) {
+		void *retorno;
+		POSIX::Thread::esperarThread(*clientes[i], retorno);
+	}
+	double segundos = PThread::segundosDesde(inicio);
+	for (size_t i = 0; i < clientes.size(); ++i) {
+		clientes[i]->cerrar();
+		delete clientes[i];
+	}
+	return segundos;
+}
+
+static void reportar(const char *servidor, double segundos) {
+	double idasYVueltas = (double) CONEXIONES * IDAS_Y_VUELTAS;
+	printf("%-22s %8.0f idas y vueltas/s  %7.1f us c/u\n", servidor,
+			idasYVueltas / segundos, segundos * 1e6 / IDAS_Y_VUELTAS);
+}
+
+void benchBucleEventos(in_port_t puerto) {
+	SocketServidor servidor(puerto);
+	servidor.crear();
+	servidor.enlazarServidor();
+	servidor.escucharClientes(CONEXIONES);
+	std::vector<ClienteEco*> clientes;
+	std::vector<SocketCliente*> aceptados;
+	conectarClientes(puerto, servidor, clientes, aceptados);
+
+	BucleEventos bucle;
+	HiloBucle hilo(bucle);
+	hilo.iniciar();
+	PThread::CuentaRegresiva terminadas(CONEXIONES);
+	std::vector<ConexionEco*> conexiones;
+	for (size_t i = 0; i < aceptados.size(); ++i) {
+		conexiones.push_back(new ConexionEco(aceptados[i], bucle, terminadas));
+		conexiones.back()->iniciar();
+	}
+	reportar("bucle de eventos", medirClientes(clientes));
+
+	terminadas.esperar();
+	bucle.detener();
+	void *retorno;
+	POSIX::Thread::esperarThread(hilo, retorno);
+	for (size_t i = 0; i < conexiones.size(); ++i) {
+		delete conexiones[i];
+	}
+	servidor.cerrar();
+}
+
+void benchHiloPorConexion(in_port_t puerto) {
+	SocketServidor servidor(puerto);
+	servidor.crear();
+	servidor.enlazarServidor();
+	servidor.escucharClientes(CONEXIONES);
+	std::vector<ClienteEco*> clientes;
+	std::vector<SocketCliente*> aceptados;
+	conectarClientes(puerto, servidor, clientes, aceptados);
+
+	std::vector<HiloEco*> hilos;
+	for (size_t i = 0; i < aceptados.size(); ++i) {
+		hilos.push_back(new HiloEco(aceptados[i]));
+		hilos.back()->iniciar();
+	}
+	reportar("hilo por conexion", medirClientes(clientes));
+
+	for (size_t i = 0; i < hilos.size(); ++i) {
+		void *retorno;
+		POSIX::Thread::esperarThread(*hilos[i], retorno);
+		delete hilos[i];
+	}
+	servidor.cerrar();
+}
+
+}
+
+#ifdef BUCLEEVENTOS_BENCH
+int main(int argc, char **argv) {
+	in_port_t puerto = (in_port_t) ((argc > 1) ? atoi(argv[1]) : PUERTO_BENCH);
+	printf("%d conexiones, %d idas y vueltas de %d bytes por conexion\n",
+			CONEXIONES, IDAS_Y_VUELTAS, TAMANIO_MENSAJE);
+	Com::benchBucleEventos(puerto);
+	Com::benchHiloPorConexion(puerto + 1);
+	return 0;
+}
+#endif
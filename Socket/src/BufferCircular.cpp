@@ -0,0 +1,205 @@
+#include "BufferCircular.h"
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Com {
+
+/* Redondea a la proxima potencia de 2 */
+static size_t potenciaDeDos(size_t valor) {
+	size_t potencia = 1;
+	while (potencia < valor) {
+		potencia <<= 1;
+	}
+	return potencia;
+}
+
+BufferCircular::BufferCircular(size_t capacidad, bool dobleMapeo) {
+	lectura = 0;
+	escritura = 0;
+	buffer = NULL;
+	this->dobleMapeo = false;
+
+	if (dobleMapeo) {
+		size_t tamanioPagina = (size_t) sysconf(_SC_PAGESIZE);
+		this->capacidad = potenciaDeDos(
+				capacidad > tamanioPagina ? capacidad : tamanioPagina);
+		if (mapearDoble()) {
+			return;
+		}
+	}
+	this->capacidad = potenciaDeDos(capacidad > 0 ? capacidad : 1);
+	buffer = new BufferTransmision::t_buffer[this->capacidad];
+}
+
+bool BufferCircular::mapearDoble() {
+#ifdef SYS_memfd_create
+	int fd = (int) syscall(SYS_memfd_create, "BufferCircular", 0);
+	if (fd == -1) {
+		return false;
+	}
+	if (ftruncate(fd, capacidad) == -1) {
+		close(fd);
+		return false;
+	}
+
+	/* Reservo el doble del espacio virtual y mapeo el archivo en ambas
+	 * mitades, de forma que buffer[i] y buffer[i + capacidad] sean el mismo
+	 * byte fisico */
+	void *reserva = mmap(NULL, 2 * capacidad, PROT_NONE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (reserva == MAP_FAILED) {
+		close(fd);
+		return false;
+	}
+	char *base = (char*) reserva;
+	if (mmap(base, capacidad, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+			fd, 0) == MAP_FAILED ||
+			mmap(base + capacidad, capacidad, PROT_READ | PROT_WRITE,
+					MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+		munmap(reserva, 2 * capacidad);
+		close(fd);
+		return false;
+	}
+	close(fd);
+	buffer = base;
+	dobleMapeo = true;
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool BufferCircular::insertarDatos(const void* dato, size_t tamanioDato) {
+	if (tamanioDato > getCapacidadRestante()) {
+		return false;
+	}
+	struct iovec regiones[2];
+	int cantidad = obtenerRegionesLibres(regiones);
+	const char *origen = (const char*) dato;
+	size_t restante = tamanioDato;
+	for (int i = 0; i < cantidad && restante > 0; ++i) {
+		size_t parcial = regiones[i].iov_len < restante ?
+				regiones[i].iov_len : restante;
+		memcpy(regiones[i].iov_base, origen, parcial);
+		origen += parcial;
+		restante -= parcial;
+	}
+	escritura += tamanioDato;
+	return true;
+}
+
+bool BufferCircular::copiarDatos(void* destino, size_t tamanioDato) const {
+	if (tamanioDato > getTamanioOcupado()) {
+		return false;
+	}
+	struct iovec regiones[2];
+	int cantidad = obtenerRegionesOcupadas(regiones);
+	char *aEscribir = (char*) destino;
+	size_t restante = tamanioDato;
+	for (int i = 0; i < cantidad && restante > 0; ++i) {
+		size_t parcial = regiones[i].iov_len < restante ?
+				regiones[i].iov_len : restante;
+		memcpy(aEscribir, regiones[i].iov_base, parcial);
+		aEscribir += parcial;
+		restante -= parcial;
+	}
+	return true;
+}
+
+void BufferCircular::descartarDatos(size_t cantidad) {
+	if (cantidad >= getTamanioOcupado()) {
+		vaciarBuffer();
+	}
+	else {
+		lectura += cantidad;
+	}
+}
+
+void BufferCircular::vaciarBuffer() {
+	lectura = 0;
+	escritura = 0;
+}
+
+int BufferCircular::obtenerRegionesLibres(struct iovec regiones[2]) {
+	size_t libre = getCapacidadRestante();
+	if (libre == 0) {
+		return 0;
+	}
+	size_t posicion = escritura & (capacidad - 1);
+	size_t hastaElFinal = capacidad - posicion;
+	regiones[0].iov_base = &buffer[posicion];
+	if (dobleMapeo || libre <= hastaElFinal) {
+		regiones[0].iov_len = libre;
+		return 1;
+	}
+	regiones[0].iov_len = hastaElFinal;
+	regiones[1].iov_base = buffer;
+	regiones[1].iov_len = libre - hastaElFinal;
+	return 2;
+}
+
+int BufferCircular::obtenerRegionesOcupadas(struct iovec regiones[2]) const {
+	size_t ocupado = getTamanioOcupado();
+	if (ocupado == 0) {
+		return 0;
+	}
+	size_t posicion = lectura & (capacidad - 1);
+	size_t hastaElFinal = capacidad - posicion;
+	regiones[0].iov_base = &buffer[posicion];
+	if (dobleMapeo || ocupado <= hastaElFinal) {
+		regiones[0].iov_len = ocupado;
+		return 1;
+	}
+	regiones[0].iov_len = hastaElFinal;
+	regiones[1].iov_base = buffer;
+	regiones[1].iov_len = ocupado - hastaElFinal;
+	return 2;
+}
+
+void BufferCircular::confirmarEscritura(size_t cantidad) {
+	if (cantidad > getCapacidadRestante()) {
+		cantidad = getCapacidadRestante();
+	}
+	escritura += cantidad;
+}
+
+VistaBuffer BufferCircular::obtenerVista() const {
+	struct iovec regiones[2];
+	if (obtenerRegionesOcupadas(regiones) == 0) {
+		return VistaBuffer();
+	}
+	return VistaBuffer((const BufferTransmision::t_buffer*) regiones[0].iov_base,
+			regiones[0].iov_len);
+}
+
+bool BufferCircular::estaDobleMapeado() const {
+	return dobleMapeo;
+}
+
+size_t BufferCircular::getTamanioOcupado() const {
+	return (escritura - lectura);
+}
+
+size_t BufferCircular::getCapacidadTotal() const {
+	return capacidad;
+}
+
+size_t BufferCircular::getCapacidadRestante() const {
+	return (capacidad - getTamanioOcupado());
+}
+
+bool BufferCircular::estaLleno() const {
+	return (getTamanioOcupado() == capacidad);
+}
+
+BufferCircular::~BufferCircular() {
+	if (dobleMapeo) {
+		munmap(buffer, 2 * capacidad);
+	}
+	else {
+		delete[] buffer;
+	}
+}
+}
@@ -0,0 +1,162 @@
+#ifndef BUFFERCIRCULAR_H
+#define	BUFFERCIRCULAR_H
+
+#include <sys/uio.h>
+#include "BufferTransmision.h"
+#include "VistaBuffer.h"
+
+namespace Com {
+
+/**
+ * @brief Clase contenedora circular para recibir datos de un socket de forma
+ * continua. Los datos se insertan al final y se consumen desde el principio,
+ * sin necesidad de mover los datos no consumidos
+ * @details La capacidad siempre es una potencia de 2. Opcionalmente, la
+ * memoria se mapea dos veces de forma consecutiva en el espacio virtual, de
+ * manera que los datos ocupados siempre se pueden leer de forma contigua
+ * aunque den la vuelta al final del buffer
+ * @details Para recibir directamente sobre el buffer se utilizan
+ * BufferCircular::obtenerRegionesLibres y BufferCircular::confirmarEscritura
+ * (ver SocketTCP_IP::recibir(BufferCircular&))
+ */
+
+class BufferCircular {
+public:
+
+	/**
+	 * @brief Construye un BufferCircular con capacidad de al menos
+	 * @a capacidad bytes
+	 * @param capacidad Capacidad mínima del buffer, en bytes. Se redondea
+	 * a la próxima potencia de 2 (y, si se usa doble mapeo, al tamaño de
+	 * página)
+	 * @param dobleMapeo Indica si se debe mapear la memoria dos veces. Si el
+	 * sistema no lo permite, se utiliza un buffer simple
+	 */
+	explicit BufferCircular(size_t capacidad, bool dobleMapeo = false);
+
+	/**
+	 * @brief Método para insertar datos al final del buffer, si el buffer
+	 * tiene capacidad libre igual o mayor a @a tamanioDato
+	 * @param dato Puntero a los datos a insertar
+	 * @param tamanioDato Tamaño de los datos a insertar
+	 * @return <tt>true</tt> en caso de éxito
+	 * @return <tt>false</tt> si @a tamanioDato es mayor a la capacidad libre
+	 * del buffer
+	 */
+	bool insertarDatos(const void* dato, size_t tamanioDato);
+
+	/**
+	 * @brief Método para copiar los primeros @a tamanioDato bytes ocupados en
+	 * @a destino, sin consumirlos
+	 * @param destino Donde se copiarán los datos
+	 * @param tamanioDato Cantidad de bytes a copiar
+	 * @return <tt>true</tt> en caso de éxito
+	 * @return <tt>false</tt> si @a tamanioDato es mayor al tamaño ocupado
+	 */
+	bool copiarDatos(void* destino, size_t tamanioDato) const;
+
+	/**
+	 * @brief Método que descarta los primeros @a cantidad bytes ocupados
+	 * (los consume)
+	 * @param cantidad Cantidad de bytes a descartar. Si es mayor o igual al
+	 * tamaño ocupado, el buffer queda vacío
+	 */
+	void descartarDatos(size_t cantidad);
+
+	/**
+	 * @brief Método que vacía los datos del buffer
+	 */
+	void vaciarBuffer();
+
+	/**
+	 * @brief Método para obtener las regiones libres del buffer, en el orden
+	 * en que deben ser escritas. Están pensadas para ser utilizadas con
+	 * readv
+	 * @param regiones Arreglo donde se guardarán las regiones libres
+	 * @return La cantidad de regiones libres (0, 1 o 2)
+	 */
+	int obtenerRegionesLibres(struct iovec regiones[2]);
+
+	/**
+	 * @brief Método para obtener las regiones ocupadas del buffer, en el
+	 * orden en que deben ser leídas. Están pensadas para ser utilizadas con
+	 * writev
+	 * @param regiones Arreglo donde se guardarán las regiones ocupadas
+	 * @return La cantidad de regiones ocupadas (0, 1 o 2)
+	 */
+	int obtenerRegionesOcupadas(struct iovec regiones[2]) const;
+
+	/**
+	 * @brief Método que agrega al tamaño ocupado @a cantidad bytes escritos
+	 * directamente sobre las regiones obtenidas por
+	 * BufferCircular::obtenerRegionesLibres
+	 * @param cantidad Cantidad de bytes escritos. Si es mayor a la capacidad
+	 * restante, el buffer queda lleno
+	 */
+	void confirmarEscritura(size_t cantidad);
+
+	/**
+	 * @brief Método para obtener una vista contigua de los datos ocupados,
+	 * desde el principio
+	 * @note Si el buffer está doblemente mapeado, la vista incluye todos los
+	 * datos ocupados. Si no, la vista termina donde los datos dan la vuelta
+	 * al final del buffer
+	 * @return La vista de los datos ocupados
+	 */
+	VistaBuffer obtenerVista() const;
+
+	/**
+	 * @brief Método para consultar si la memoria está doblemente mapeada
+	 * @return <tt>true</tt> si los datos ocupados siempre son contiguos
+	 */
+	bool estaDobleMapeado() const;
+
+	/**
+	 * @brief Método para obtener el tamaño ocupado
+	 * @return El tamaño ocupado, en bytes
+	 */
+	size_t getTamanioOcupado() const;
+
+	/**
+	 * @brief Método para obtener la capacidad máxima
+	 * @return La capacidad máxima, en bytes
+	 */
+	size_t getCapacidadTotal() const;
+
+	/**
+	 * @brief Método para obtener la capacidad restante
+	 * @return La capacidad restante, en bytes
+	 */
+	size_t getCapacidadRestante() const;
+
+	/**
+	 * @brief Método para consultar si el buffer está lleno
+	 * @return <tt>true</tt> si el buffer está lleno
+	 */
+	bool estaLleno() const;
+
+	/**
+	 * @brief Destructor
+	 */
+	~BufferCircular();
+
+private:
+
+	BufferTransmision::t_buffer *buffer;
+	size_t capacidad;
+
+	/* Posiciones absolutas (crecen indefinidamente). La posicion dentro del
+	 * buffer se obtiene aplicando la mascara capacidad - 1 */
+	size_t lectura, escritura;
+
+	bool dobleMapeo;
+
+	/* Intenta mapear la memoria dos veces. Retorna false si no es posible */
+	bool mapearDoble();
+
+	BufferCircular(const BufferCircular&);
+	BufferCircular& operator=(const BufferCircular&);
+};
+}
+
+#endif
@@ -1,23 +1,28 @@
 #include "BufferTransmision.h"
 #include <cstring>
+#include <new>
+#include <sys/mman.h>
+
+/* Capacidad a partir de la cual la memoria se obtiene con mmap en lugar de
+ * new[], para poder usar paginas enormes y crecer con mremap */
+#define UMBRAL_MAPEO (32 * 1024 * 1024)
+#define TAMANIO_PAGINA_ENORME (2 * 1024 * 1024)
 
 namespace Com {
 
 BufferTransmision::BufferTransmision(size_t capacidad) {
 	tamanio = 0;
+	inicio = 0;
 	this->capacidad = capacidad;
-	buffer = NULL;
-	if (capacidad > 0) {
-		buffer = new t_buffer[capacidad];
-	}
+	buffer = alocar(capacidad, mapeado);
 }
 
 BufferTransmision::BufferTransmision(const t_buffer* buffer, size_t tamanio) {
 	this->tamanio = tamanio;
 	this->capacidad = tamanio;
-	this->buffer = NULL;
+	inicio = 0;
+	this->buffer = alocar(tamanio, mapeado);
 	if (tamanio > 0) {
-		this->buffer = new t_buffer[tamanio];
 		memcpy(this->buffer, buffer, tamanio);
 	}
 }
@@ -25,48 +30,70 @@ BufferTransmision::BufferTransmision(const t_buffer* buffer, size_t tamanio) {
 BufferTransmision::BufferTransmision(const BufferTransmision& aCopiar) {
 	capacidad = aCopiar.capacidad;
 	tamanio = aCopiar.tamanio;
+	inicio = 0;
 	buffer = NULL;
+	mapeado = false;
 	if (aCopiar.buffer != NULL) {
-		buffer = new t_buffer[capacidad];
-		memcpy(buffer, aCopiar.buffer, tamanio);
+		buffer = alocar(capacidad, mapeado);
+		memcpy(buffer, aCopiar.obtenerBuffer(), tamanio);
 	}
 }
 
 void BufferTransmision::asignarBuffer(const t_buffer* buffer, size_t tamanio) {
 	if (tamanio > this->capacidad) {
-		if (this->buffer != NULL) {
-			delete[] this->buffer;
-		}
-		this->buffer = new t_buffer[tamanio];
+		liberar(this->buffer, this->capacidad, mapeado);
+		this->buffer = alocar(tamanio, mapeado);
 		this->capacidad = tamanio;
 	}
 	this->tamanio = tamanio;
+	inicio = 0;
 	if (tamanio > 0) {
 		memcpy(this->buffer, buffer, tamanio);
 	}
 }
 
 void BufferTransmision::redimensionar(size_t nuevaCapacidad) {
+	size_t capacidadPrevia = capacidad;
 	capacidad = nuevaCapacidad;
 	if (capacidad <= 0) {
 		tamanio = 0;
-		if (buffer != NULL) {
-			delete[] buffer;
-		}
+		inicio = 0;
+		liberar(buffer, capacidadPrevia, mapeado);
 		buffer = NULL;
+		mapeado = false;
 	}
 	else {
-		t_buffer *nuevo = new t_buffer[capacidad];
-
 		/* Si la nueva capacidad es menor al tamanio ocupado actual, al
 		 * achicarse el buffer se pierden datos y este queda lleno */
 		if (tamanio > capacidad) {
 			tamanio = capacidad;
 		}
 
-		memcpy(nuevo, buffer, tamanio);
-		delete[] buffer;
+		/* Si ya estaba mapeado y sigue siendo grande, el kernel puede mover
+		 * las paginas sin copiar los datos */
+		if (mapeado && capacidad >= UMBRAL_MAPEO) {
+			if (inicio > 0) {
+				memmove(buffer, &buffer[inicio], tamanio);
+				inicio = 0;
+			}
+			void *remapeado = mremap(buffer, tamanioMapeo(capacidadPrevia),
+					tamanioMapeo(capacidad), MREMAP_MAYMOVE);
+			if (remapeado != MAP_FAILED) {
+				buffer = (t_buffer*) remapeado;
+#ifdef MADV_HUGEPAGE
+				madvise(buffer, tamanioMapeo(capacidad), MADV_HUGEPAGE);
+#endif
+				return;
+			}
+		}
+
+		bool nuevoMapeado;
+		t_buffer *nuevo = alocar(capacidad, nuevoMapeado);
+		memcpy(nuevo, obtenerBuffer(), tamanio);
+		liberar(buffer, capacidadPrevia, mapeado);
 		buffer = nuevo;
+		mapeado = nuevoMapeado;
+		inicio = 0;
 	}
 }
 
@@ -74,21 +101,47 @@ bool BufferTransmision::insertarDatos(const void* dato, size_t tamanioDato) {
 	if ((tamanio + tamanioDato) > capacidad) {
 		return false;
 	}
-	memcpy(&buffer[tamanio], dato, tamanioDato);
+	compactar(tamanioDato);
+	memcpy(&buffer[inicio + tamanio], dato, tamanioDato);
 	tamanio += tamanioDato;
 	return true;
 }
 
+BufferTransmision::t_buffer* BufferTransmision::reservarDatos(
+		size_t tamanioDato) {
+	if ((tamanio + tamanioDato) > capacidad) {
+		return NULL;
+	}
+	compactar(tamanioDato);
+	t_buffer *reservado = &buffer[inicio + tamanio];
+	tamanio += tamanioDato;
+	return reservado;
+}
+
 void BufferTransmision::vaciarBuffer() {
 	tamanio = 0;
+	inicio = 0;
+}
+
+void BufferTransmision::descartarDatos(size_t cantidad) {
+	if (cantidad >= tamanio) {
+		vaciarBuffer();
+	}
+	else {
+		inicio += cantidad;
+		tamanio -= cantidad;
+	}
 }
 
 const BufferTransmision::t_buffer* BufferTransmision::obtenerBuffer() const {
-	return buffer;
+	if (buffer == NULL) {
+		return NULL;
+	}
+	return &buffer[inicio];
 }
 
 size_t BufferTransmision::obtenerBuffer(std::string &aEscribir) const {
-	aEscribir.assign(buffer, tamanio);
+	aEscribir.assign(obtenerBuffer(), tamanio);
 	return tamanio;
 }
 
@@ -96,7 +149,7 @@ bool BufferTransmision::obtenerByteBuffer(char &byte, size_t posicion) const {
 	if (posicion >= tamanio) {
 		return false;
 	}
-	byte = buffer[posicion];
+	byte = buffer[inicio + posicion];
 	return true;
 }
 
@@ -116,9 +169,63 @@ bool BufferTransmision::estaLleno() const {
 	return (capacidad == tamanio);
 }
 
-BufferTransmision::~BufferTransmision() {
-	if (buffer != NULL) {
+void BufferTransmision::compactar(size_t tamanioDato) {
+	if ((inicio + tamanio + tamanioDato) > capacidad) {
+		memmove(buffer, &buffer[inicio], tamanio);
+		inicio = 0;
+	}
+}
+
+size_t BufferTransmision::tamanioMapeo(size_t capacidad) {
+	return ((capacidad + TAMANIO_PAGINA_ENORME - 1) / TAMANIO_PAGINA_ENORME)
+			* TAMANIO_PAGINA_ENORME;
+}
+
+BufferTransmision::t_buffer* BufferTransmision::alocar(size_t capacidad,
+		bool &mapeado) {
+	mapeado = false;
+	if (capacidad == 0) {
+		return NULL;
+	}
+	if (capacidad < UMBRAL_MAPEO) {
+		return new t_buffer[capacidad];
+	}
+
+	void *memoria = MAP_FAILED;
+#if defined(BUFFER_HUGETLB) && defined(MAP_HUGETLB)
+	/* Paginas enormes explicitas: requieren paginas reservadas en
+	 * /proc/sys/vm/nr_hugepages, si no hay se usa el mapeo comun */
+	memoria = mmap(NULL, tamanioMapeo(capacidad), PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+	if (memoria == MAP_FAILED) {
+		memoria = mmap(NULL, tamanioMapeo(capacidad), PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (memoria == MAP_FAILED) {
+			throw std::bad_alloc();
+		}
+#ifdef MADV_HUGEPAGE
+		madvise(memoria, tamanioMapeo(capacidad), MADV_HUGEPAGE);
+#endif
+	}
+	mapeado = true;
+	return (t_buffer*) memoria;
+}
+
+void BufferTransmision::liberar(t_buffer *buffer, size_t capacidad,
+		bool mapeado) {
+	if (buffer == NULL) {
+		return;
+	}
+	if (mapeado) {
+		munmap(buffer, tamanioMapeo(capacidad));
+	}
+	else {
 		delete[] buffer;
 	}
 }
+
+BufferTransmision::~BufferTransmision() {
+	liberar(buffer, capacidad, mapeado);
+}
 }
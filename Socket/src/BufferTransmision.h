@@ -56,6 +56,8 @@ public:
 	 * conservan. En caso de que @a nuevaCapacidad sea menor al tamaño ocupado
 	 * en el buffer, el buffer queda en estado lleno y los datos que quedaron
 	 * afuera de la capacidad se pierden
+	 * @note Los buffers grandes se alojan con mmap y crecen con mremap, sin
+	 * copiar los datos
 	 * @param nuevaCapacidad Tamaño nuevo del buffer
 	 */
 	void redimensionar(size_t nuevaCapacidad);
@@ -72,11 +74,34 @@ public:
 	 */
 	bool insertarDatos(const void* dato, size_t tamanioDato);
 
+	/**
+	 * @brief Método para reservar @a tamanioDato bytes al final del buffer,
+	 * los cuales pasan a formar parte del tamaño ocupado. Permite escribir
+	 * los datos directamente sobre el buffer, sin copias intermedias
+	 * @note El contenido de los bytes reservados queda indefinido hasta que
+	 * el invocante los escriba
+	 * @param tamanioDato Cantidad de bytes a reservar
+	 * @return Puntero al primer byte reservado
+	 * @return <tt>NULL</tt> si @a tamanioDato es mayor a la capacidad libre
+	 * del buffer
+	 */
+	t_buffer* reservarDatos(size_t tamanioDato);
+
 	/**
 	 * @brief Método que vacía los datos del buffer
 	 */
 	void vaciarBuffer();
 
+	/**
+	 * @brief Método que descarta los primeros @a cantidad bytes ocupados del
+	 * buffer, por ejemplo los ya procesados por un CursorLectura. Los datos
+	 * restantes no se mueven: el espacio liberado al principio se recupera
+	 * recién cuando una inserción lo necesita
+	 * @param cantidad Cantidad de bytes a descartar. Si es mayor o igual al
+	 * tamaño ocupado, el buffer queda vacío
+	 */
+	void descartarDatos(size_t cantidad);
+
 	/**
 	 * @brief Método que obtiene el buffer para consulta, no modificación
 	 * @return Puntero a los datos guardados en el buffer
@@ -139,6 +164,25 @@ private:
 
 	t_buffer *buffer;
 	size_t capacidad, tamanio;
+
+	/* Posicion del primer byte ocupado. Los bytes anteriores fueron
+	 * descartados con descartarDatos */
+	size_t inicio;
+
+	/* Mueve los datos ocupados al principio del buffer si no hay lugar al
+	 * final para @a tamanioDato bytes */
+	void compactar(size_t tamanioDato);
+
+	/* Indica si la memoria fue obtenida con mmap (buffers grandes) en lugar
+	 * de new[] */
+	bool mapeado;
+
+	/* Alocan y liberan la memoria del buffer. A partir de cierto umbral se
+	 * utiliza mmap anonimo con paginas enormes, para evitar la cantidad de
+	 * fallos de pagina y de TLB que generan las paginas de 4 KB */
+	static t_buffer* alocar(size_t capacidad, bool &mapeado);
+	static void liberar(t_buffer *buffer, size_t capacidad, bool mapeado);
+	static size_t tamanioMapeo(size_t capacidad);
 };
 }
 
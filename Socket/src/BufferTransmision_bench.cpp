@@ -0,0 +1,118 @@
+#include "BufferTransmision.h"
+#include "Bench.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <sys/resource.h>
+#include <time.h>
+#include <vector>
+
+/* Crecimiento y llenado de un buffer hasta 1 GB, duplicando la capacidad
+ * cada vez que se llena: BufferTransmision, que por encima del umbral de
+ * mapeo usa mmap con MADV_HUGEPAGE y crece con mremap, frente a crecer con
+ * new[], copia y delete[] */
+
+#define CAPACIDAD_INICIAL (1024 * 1024)
+#define CAPACIDAD_FINAL (1024 * 1024 * 1024)
+/* Tamaño de cada inserción */
+#define BLOQUE (64 * 1024)
+
+namespace Com {
+
+/* Buffer que crece como lo hacía BufferTransmision antes del mapeo */
+class BufferNew {
+public:
+	explicit BufferNew(size_t capacidad) :
+			buffer(new char[capacidad]), capacidad(capacidad), tamanio(0) {
+	}
+	~BufferNew() {
+		delete[] buffer;
+	}
+	bool insertarDatos(const void *dato, size_t tamanioDato) {
+		if (tamanio + tamanioDato > capacidad) {
+			return false;
+		}
+		memcpy(&buffer[tamanio], dato, tamanioDato);
+		tamanio += tamanioDato;
+		return true;
+	}
+	void redimensionar(size_t nuevaCapacidad) {
+		char *nuevo = new char[nuevaCapacidad];
+		memcpy(nuevo, buffer, tamanio);
+		delete[] buffer;
+		buffer = nuevo;
+		capacidad = nuevaCapacidad;
+	}
+	size_t getCapacidadTotal() const {
+		return capacidad;
+	}
+	size_t getTamanioOcupado() const {
+		return tamanio;
+	}
+private:
+	char *buffer;
+	size_t capacidad;
+	size_t tamanio;
+};
+
+/* Páginas enormes transparentes del proceso, en KB, según /proc */
+static long paginasEnormesKB() {
+	std::ifstream smaps("/proc/self/smaps_rollup");
+	std::string linea;
+	long kb = -1;
+	while (std::getline(smaps, linea)) {
+		if (sscanf(linea.c_str(), "AnonHugePages: %ld kB", &kb) == 1) {
+			break;
+		}
+	}
+	return kb;
+}
+
+template<typename B>
+static void medir(const char *prueba) {
+	std::vector<char> bloque(BLOQUE, 'x');
+	struct rusage uso;
+	getrusage(RUSAGE_SELF, &uso);
+	long fallosPrevios = uso.ru_minflt;
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+
+	B *buffer = new B(CAPACIDAD_INICIAL);
+	int crecimientos = 0;
+	while (buffer->getTamanioOcupado() < CAPACIDAD_FINAL) {
+		if (!buffer->insertarDatos(&bloque[0], BLOQUE)) {
+			buffer->redimensionar(buffer->getCapacidadTotal() * 2);
+			++crecimientos;
+		}
+	}
+	double segundos = PThread::segundosDesde(inicio);
+	getrusage(RUSAGE_SELF, &uso);
+	long enormes = paginasEnormesKB();
+	delete buffer;
+
+	printf("%-18s %7.3f s  %7.1f MB/s  %2d crecimientos  %8ld fallos de "
+			"página  %8ld KB en páginas enormes\n", prueba, segundos,
+			CAPACIDAD_FINAL / segundos / 1e6, crecimientos,
+			uso.ru_minflt - fallosPrevios, enormes);
+}
+
+void benchCrecimiento() {
+	std::ifstream modo("/sys/kernel/mm/transparent_hugepage/enabled");
+	std::string linea;
+	std::getline(modo, linea);
+	printf("transparent_hugepage: %s\n", linea.c_str());
+	medir<BufferTransmision>("BufferTransmision");
+	medir<BufferNew>("new[] + copia");
+}
+
+}
+
+#ifdef BUFFERTRANSMISION_BENCH
+int main() {
+	printf("de %d a %d bytes, bloques de %d bytes\n", CAPACIDAD_INICIAL,
+			CAPACIDAD_FINAL, BLOQUE);
+	Com::benchCrecimiento();
+	return 0;
+}
+#endif
@@ -0,0 +1,477 @@
+#ifndef CODIFICADORBINARIO_H
+#define	CODIFICADORBINARIO_H
+
+#include <stdint.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "BufferTransmision.h"
+#include "VistaBuffer.h"
+
+namespace Com {
+
+/**
+ * @brief Rasgos de los tipos que se pueden codificar con ancho fijo. Solo se
+ * definen para enteros de ancho fijo y números de punto flotante, por lo que
+ * intentar codificar cualquier otro tipo es un error de compilación
+ * @details @a t_entero es el entero sin signo del mismo tamaño que el tipo,
+ * utilizado para reordenar los bytes
+ */
+template <typename T> struct RasgosBinarios;
+
+#define RASGO_BINARIO(tipo, entero) \
+	template <> struct RasgosBinarios<tipo> { typedef entero t_entero; }
+
+RASGO_BINARIO(int8_t, uint8_t);
+RASGO_BINARIO(uint8_t, uint8_t);
+RASGO_BINARIO(int16_t, uint16_t);
+RASGO_BINARIO(uint16_t, uint16_t);
+RASGO_BINARIO(int32_t, uint32_t);
+RASGO_BINARIO(uint32_t, uint32_t);
+RASGO_BINARIO(int64_t, uint64_t);
+RASGO_BINARIO(uint64_t, uint64_t);
+RASGO_BINARIO(float, uint32_t);
+RASGO_BINARIO(double, uint64_t);
+
+#undef RASGO_BINARIO
+
+/**
+ * @brief Funciones para pasar un entero sin signo entre el orden de bytes del
+ * host y el orden de red (big endian). La operación es su propia inversa
+ */
+inline uint8_t ordenRed(uint8_t valor) {
+	return valor;
+}
+
+inline uint16_t ordenRed(uint16_t valor) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	return __builtin_bswap16(valor);
+#else
+	return valor;
+#endif
+}
+
+inline uint32_t ordenRed(uint32_t valor) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	return __builtin_bswap32(valor);
+#else
+	return valor;
+#endif
+}
+
+inline uint64_t ordenRed(uint64_t valor) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	return __builtin_bswap64(valor);
+#else
+	return valor;
+#endif
+}
+
+/**
+ * @brief Indica si un arreglo de elementos de tipo @a T tiene la misma
+ * representación en memoria que en la red, y puede copiarse de una sola vez
+ */
+template <typename T> inline bool mismoOrdenQueRed() {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	return (sizeof(T) == 1);
+#else
+	return true;
+#endif
+}
+
+/**
+ * @brief Tamaño máximo, en bytes, de un entero de 64 bits codificado como
+ * varint
+ */
+#define MAX_BYTES_VARINT 10
+
+/**
+ * @brief Clase para escribir datos tipados al final de un BufferTransmision,
+ * en un formato binario independiente de la arquitectura
+ * @details Formato utilizado:
+ * @details Enteros y punto flotante: ancho fijo, en orden de red (big endian)
+ * @details Varint: 7 bits por byte, el bit más significativo indica que
+ * continúa (LEB128). Los enteros con signo se codifican en zigzag
+ * @details Cadenas: varint con la longitud, seguido de los bytes
+ * @details Arreglos: varint con la cantidad de elementos, seguido de los
+ * elementos con ancho fijo
+ * @details Cada operación verifica la capacidad del buffer una única vez, aún
+ * las que escriben arreglos enteros. Si la capacidad no alcanza, no se
+ * escribe nada y se retorna <tt>false</tt>
+ */
+
+class CodificadorBinario {
+public:
+
+	/**
+	 * @brief Construye un codificador que escribe al final de @a buffer
+	 * @param buffer Buffer donde se escribirán los datos. Debe vivir más que
+	 * el codificador
+	 */
+	explicit CodificadorBinario(BufferTransmision &buffer) : buffer(buffer) {
+	}
+
+	/**
+	 * @brief Método para escribir un entero o punto flotante de ancho fijo
+	 * @param valor Valor a escribir
+	 * @return <tt>true</tt> en caso de éxito
+	 * @return <tt>false</tt> si no hay capacidad libre en el buffer
+	 */
+	template <typename T> bool escribir(T valor) {
+		BufferTransmision::t_buffer *destino = buffer.reservarDatos(sizeof(T));
+		if (destino == NULL) {
+			return false;
+		}
+		guardar(destino, valor);
+		return true;
+	}
+
+	/**
+	 * @brief Método para escribir un entero sin signo como varint
+	 * @param valor Valor a escribir
+	 * @return <tt>true</tt> en caso de éxito
+	 * @return <tt>false</tt> si no hay capacidad libre en el buffer
+	 */
+	bool escribirVarint(uint64_t valor) {
+		BufferTransmision::t_buffer temp[MAX_BYTES_VARINT];
+		size_t tamanio = codificarVarint(temp, valor);
+		return buffer.insertarDatos(temp, tamanio);
+	}
+
+	/**
+	 * @brief Método para escribir un entero con signo como varint zigzag
+	 * @param valor Valor a escribir
+	 * @return <tt>true</tt> en caso de éxito
+	 * @return <tt>false</tt> si no hay capacidad libre en el buffer
+	 */
+	bool escribirVarintConSigno(int64_t valor) {
+		return escribirVarint(((uint64_t) valor << 1) ^ (uint64_t) (valor >> 63));
+	}
+
+	/**
+	 * @brief Método para escribir una cadena precedida por su longitud
+	 * @param cadena Cadena a escribir
+	 * @return <tt>true</tt> en caso de éxito
+	 * @return <tt>false</tt> si no hay capacidad libre en el buffer
+	 */
+	bool escribirCadena(const std::string &cadena) {
+		return escribirBytes(cadena.data(), cadena.size());
+	}
+
+	/**
+	 * @brief Método para escribir @a tamanio bytes precedidos por su cantidad
+	 * @param datos Bytes a escribir
+	 * @param tamanio Cantidad de bytes
+	 * @return <tt>true</tt> en caso de éxito
+	 * @return <tt>false</tt> si no hay capacidad libre en el buffer
+	 */
+	bool escribirBytes(const void *datos, size_t tamanio) {
+		BufferTransmision::t_buffer temp[MAX_BYTES_VARINT];
+		size_t tamanioLongitud = codificarVarint(temp, tamanio);
+		BufferTransmision::t_buffer *destino = buffer.reservarDatos(
+				tamanioLongitud + tamanio);
+		if (destino == NULL) {
+			return false;
+		}
+		memcpy(destino, temp, tamanioLongitud);
+		memcpy(destino + tamanioLongitud, datos, tamanio);
+		return true;
+	}
+
+	/**
+	 * @brief Método para escribir un arreglo de enteros o punto flotante,
+	 * precedido por su cantidad de elementos
+	 * @param datos Elementos a escribir
+	 * @param cantidad Cantidad de elementos
+	 * @return <tt>true</tt> en caso de éxito
+	 * @return <tt>false</tt> si no hay capacidad libre en el buffer
+	 */
+	template <typename T> bool escribirArreglo(const T *datos, size_t cantidad) {
+		BufferTransmision::t_buffer temp[MAX_BYTES_VARINT];
+		size_t tamanioLongitud = codificarVarint(temp, cantidad);
+		BufferTransmision::t_buffer *destino = buffer.reservarDatos(
+				tamanioLongitud + cantidad * sizeof(T));
+		if (destino == NULL) {
+			return false;
+		}
+		memcpy(destino, temp, tamanioLongitud);
+		destino += tamanioLongitud;
+		if (mismoOrdenQueRed<T>()) {
+			memcpy(destino, datos, cantidad * sizeof(T));
+		}
+		else {
+			for (size_t i = 0; i < cantidad; ++i, destino += sizeof(T)) {
+				guardar(destino, datos[i]);
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Método para escribir un vector de enteros o punto flotante,
+	 * precedido por su cantidad de elementos
+	 * @param vector Vector a escribir
+	 * @return <tt>true</tt> en caso de éxito
+	 * @return <tt>false</tt> si no hay capacidad libre en el buffer
+	 */
+	template <typename T> bool escribirVector(const std::vector<T> &vector) {
+		return escribirArreglo(vector.empty() ? NULL : &vector[0],
+				vector.size());
+	}
+
+	/**
+	 * @brief Destructor
+	 */
+	~CodificadorBinario() {
+	}
+
+	/**
+	 * @brief Método que codifica @a valor como varint en @a destino, el cual
+	 * debe tener al menos MAX_BYTES_VARINT bytes
+	 * @return La cantidad de bytes escritos
+	 */
+	static size_t codificarVarint(BufferTransmision::t_buffer *destino,
+			uint64_t valor) {
+		size_t i = 0;
+		while (valor >= 0x80) {
+			destino[i++] = (BufferTransmision::t_buffer) (valor | 0x80);
+			valor >>= 7;
+		}
+		destino[i++] = (BufferTransmision::t_buffer) valor;
+		return i;
+	}
+
+private:
+
+	BufferTransmision &buffer;
+
+	template <typename T> static void guardar(
+			BufferTransmision::t_buffer *destino, T valor) {
+		typename RasgosBinarios<T>::t_entero entero;
+		memcpy(&entero, &valor, sizeof(T));
+		entero = ordenRed(entero);
+		memcpy(destino, &entero, sizeof(T));
+	}
+
+	CodificadorBinario(const CodificadorBinario&);
+	CodificadorBinario& operator=(const CodificadorBinario&);
+};
+
+/**
+ * @brief Clase para leer los datos escritos por un CodificadorBinario, en el
+ * mismo orden en que fueron escritos
+ * @details Mantiene la posición de lectura. Si una operación falla (no hay
+ * suficientes bytes o el formato es inválido), la posición no avanza y el
+ * valor de salida no se modifica
+ */
+
+class DecodificadorBinario {
+public:
+
+	/**
+	 * @brief Construye un decodificador que lee el contenido de @a buffer
+	 * desde su comienzo
+	 * @param buffer Buffer a leer. No debe modificarse mientras se lo lee
+	 */
+	explicit DecodificadorBinario(const BufferTransmision &buffer) :
+			datos(buffer.obtenerBuffer()), tamanio(buffer.getTamanioOcupado()),
+			posicion(0) {
+	}
+
+	/**
+	 * @brief Construye un decodificador que lee los bytes de @a vista
+	 * @param vista Datos a leer
+	 */
+	explicit DecodificadorBinario(const VistaBuffer &vista) :
+			datos(vista.obtenerDatos()), tamanio(vista.getTamanio()),
+			posicion(0) {
+	}
+
+	/**
+	 * @brief Construye un decodificador que lee los @a tamanio bytes
+	 * apuntados por @a datos
+	 * @param datos Datos a leer
+	 * @param tamanio Cantidad de bytes a leer
+	 */
+	DecodificadorBinario(const BufferTransmision::t_buffer *datos,
+			size_t tamanio) : datos(datos), tamanio(tamanio), posicion(0) {
+	}
+
+	/**
+	 * @brief Método para leer un entero o punto flotante de ancho fijo
+	 * @param valor Variable donde se guardará el valor leído
+	 * @return <tt>true</tt> en caso de éxito
+	 * @return <tt>false</tt> si no quedan suficientes bytes
+	 */
+	template <typename T> bool leer(T &valor) {
+		if (getBytesRestantes() < sizeof(T)) {
+			return false;
+		}
+		valor = cargar<T>(&datos[posicion]);
+		posicion += sizeof(T);
+		return true;
+	}
+
+	/**
+	 * @brief Método para leer un entero sin signo codificado como varint
+	 * @param valor Variable donde se guardará el valor leído
+	 * @return <tt>true</tt> en caso de éxito
+	 * @return <tt>false</tt> si no quedan suficientes bytes o el varint
+	 * excede los 64 bits
+	 */
+	bool leerVarint(uint64_t &valor) {
+		size_t tamanioLongitud = decodificarVarint(valor);
+		if (tamanioLongitud == 0) {
+			return false;
+		}
+		posicion += tamanioLongitud;
+		return true;
+	}
+
+	/**
+	 * @brief Método para leer un entero con signo codificado como varint
+	 * zigzag
+	 * @param valor Variable donde se guardará el valor leído
+	 * @return <tt>true</tt> en caso de éxito
+	 * @return <tt>false</tt> si no quedan suficientes bytes o el varint
+	 * excede los 64 bits
+	 */
+	bool leerVarintConSigno(int64_t &valor) {
+		uint64_t zigzag;
+		if (!leerVarint(zigzag)) {
+			return false;
+		}
+		valor = (int64_t) (zigzag >> 1) ^ -(int64_t) (zigzag & 1);
+		return true;
+	}
+
+	/**
+	 * @brief Método para leer una cadena precedida por su longitud
+	 * @param cadena Cadena donde se guardará la copia de los datos leídos
+	 * @return <tt>true</tt> en caso de éxito
+	 * @return <tt>false</tt> si no quedan suficientes bytes
+	 */
+	bool leerCadena(std::string &cadena) {
+		const BufferTransmision::t_buffer *bytes;
+		size_t cantidad;
+		if (!leerBytes(bytes, cantidad)) {
+			return false;
+		}
+		cadena.assign(bytes, cantidad);
+		return true;
+	}
+
+	/**
+	 * @brief Método para leer bytes precedidos por su cantidad, sin copiarlos
+	 * @param bytes Puntero que apuntará a los bytes leídos, dentro de los
+	 * datos del decodificador
+	 * @param cantidad Variable donde se guardará la cantidad de bytes
+	 * @return <tt>true</tt> en caso de éxito
+	 * @return <tt>false</tt> si no quedan suficientes bytes
+	 */
+	bool leerBytes(const BufferTransmision::t_buffer* &bytes,
+			size_t &cantidad) {
+		uint64_t longitud;
+		size_t tamanioLongitud = decodificarVarint(longitud);
+		if (tamanioLongitud == 0 ||
+				longitud > getBytesRestantes() - tamanioLongitud) {
+			return false;
+		}
+		bytes = &datos[posicion + tamanioLongitud];
+		cantidad = (size_t) longitud;
+		posicion += tamanioLongitud + cantidad;
+		return true;
+	}
+
+	/**
+	 * @brief Método para leer un arreglo de enteros o punto flotante,
+	 * precedido por su cantidad de elementos
+	 * @param vector Vector donde se guardarán los elementos leídos (cualquier
+	 * contenido previo se descarta)
+	 * @return <tt>true</tt> en caso de éxito
+	 * @return <tt>false</tt> si no quedan suficientes bytes
+	 */
+	template <typename T> bool leerVector(std::vector<T> &vector) {
+		uint64_t cantidad;
+		size_t tamanioLongitud = decodificarVarint(cantidad);
+		if (tamanioLongitud == 0 || cantidad >
+				(getBytesRestantes() - tamanioLongitud) / sizeof(T)) {
+			return false;
+		}
+		const BufferTransmision::t_buffer *origen =
+				&datos[posicion + tamanioLongitud];
+		vector.resize((size_t) cantidad);
+		if (cantidad > 0) {
+			if (mismoOrdenQueRed<T>()) {
+				memcpy(&vector[0], origen, (size_t) cantidad * sizeof(T));
+			}
+			else {
+				for (size_t i = 0; i < cantidad; ++i, origen += sizeof(T)) {
+					vector[i] = cargar<T>(origen);
+				}
+			}
+		}
+		posicion += tamanioLongitud + (size_t) cantidad * sizeof(T);
+		return true;
+	}
+
+	/**
+	 * @brief Método para obtener la posición de lectura actual
+	 * @return La cantidad de bytes leídos
+	 */
+	size_t getPosicion() const {
+		return posicion;
+	}
+
+	/**
+	 * @brief Método para obtener la cantidad de bytes sin leer
+	 * @return La cantidad de bytes sin leer
+	 */
+	size_t getBytesRestantes() const {
+		return (tamanio - posicion);
+	}
+
+	/**
+	 * @brief Destructor
+	 */
+	~DecodificadorBinario() {
+	}
+
+private:
+
+	const BufferTransmision::t_buffer *datos;
+	size_t tamanio, posicion;
+
+	template <typename T> static T cargar(
+			const BufferTransmision::t_buffer *origen) {
+		typename RasgosBinarios<T>::t_entero entero;
+		memcpy(&entero, origen, sizeof(T));
+		entero = ordenRed(entero);
+		T valor;
+		memcpy(&valor, &entero, sizeof(T));
+		return valor;
+	}
+
+	/* Decodifica el varint de la posicion actual sin avanzar. Retorna la
+	 * cantidad de bytes que ocupa, o 0 si es invalido o esta incompleto */
+	size_t decodificarVarint(uint64_t &valor) const {
+		uint64_t resultado = 0;
+		size_t restantes = getBytesRestantes();
+		for (size_t i = 0; i < MAX_BYTES_VARINT && i < restantes; ++i) {
+			uint8_t byte = (uint8_t) datos[posicion + i];
+			/* El ultimo byte solo aporta el bit 63 */
+			if (i == MAX_BYTES_VARINT - 1 && (byte & 0x7E) != 0) {
+				return 0;
+			}
+			resultado |= (uint64_t) (byte & 0x7F) << (7 * i);
+			if ((byte & 0x80) == 0) {
+				valor = resultado;
+				return (i + 1);
+			}
+		}
+		return 0;
+	}
+};
+}
+
+#endif
@@ -0,0 +1,192 @@
+#include "CodificadorBinario.h"
+#include "Bench.h"
+#include <arpa/inet.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <time.h>
+
+/* Codificar y decodificar registros con CodificadorBinario y
+ * DecodificadorBinario, frente a armarlos campo por campo con
+ * BufferTransmision::insertarDatos y leerlos byte por byte con
+ * BufferTransmision::obtenerByteBuffer */
+
+#define REGISTROS 10000
+#define RONDAS 200
+
+namespace Com {
+
+struct Registro {
+	uint16_t tipo;
+	uint32_t secuencia;
+	uint64_t marca;
+	double valor;
+	std::string nombre;
+};
+
+static void reportar(const char *prueba, double segundos, size_t bytes) {
+	double registros = (double) REGISTROS * RONDAS;
+	printf("%-34s %10.0f reg/s  %7.1f ns/reg  %7.1f MB/s\n", prueba,
+			registros / segundos, segundos * 1e9 / registros,
+			(double) bytes * RONDAS / segundos / 1e6);
+}
+
+static uint64_t aOrdenRed64(uint64_t valor) {
+	return ((uint64_t) htonl((uint32_t) valor) << 32)
+			| htonl((uint32_t) (valor >> 32));
+}
+
+/* Como se armaban los mensajes antes del codificador */
+static void insertarRegistro(BufferTransmision &buffer,
+		const Registro &registro) {
+	uint16_t tipo = htons(registro.tipo);
+	uint32_t secuencia = htonl(registro.secuencia);
+	uint64_t marca = aOrdenRed64(registro.marca);
+	uint64_t valor;
+	memcpy(&valor, &registro.valor, sizeof(valor));
+	valor = aOrdenRed64(valor);
+	uint32_t longitud = htonl((uint32_t) registro.nombre.size());
+	buffer.insertarDatos(&tipo, sizeof(tipo));
+	buffer.insertarDatos(&secuencia, sizeof(secuencia));
+	buffer.insertarDatos(&marca, sizeof(marca));
+	buffer.insertarDatos(&valor, sizeof(valor));
+	buffer.insertarDatos(&longitud, sizeof(longitud));
+	buffer.insertarDatos(registro.nombre.data(), registro.nombre.size());
+}
+
+/* Lee un entero en orden de red de @a tamanio bytes desde @a posicion */
+static uint64_t obtenerEntero(const BufferTransmision &buffer,
+		size_t &posicion, size_t tamanio) {
+	uint64_t valor = 0;
+	char byte;
+	for (size_t i = 0; i < tamanio; ++i) {
+		buffer.obtenerByteBuffer(byte, posicion++);
+		valor = (valor << 8) | (unsigned char) byte;
+	}
+	return valor;
+}
+
+static void obtenerRegistro(const BufferTransmision &buffer, size_t &posicion,
+		Registro &registro) {
+	registro.tipo = (uint16_t) obtenerEntero(buffer, posicion, 2);
+	registro.secuencia = (uint32_t) obtenerEntero(buffer, posicion, 4);
+	registro.marca = obtenerEntero(buffer, posicion, 8);
+	uint64_t valor = obtenerEntero(buffer, posicion, 8);
+	memcpy(&registro.valor, &valor, sizeof(valor));
+	size_t longitud = (size_t) obtenerEntero(buffer, posicion, 4);
+	registro.nombre.resize(longitud);
+	char byte;
+	for (size_t i = 0; i < longitud; ++i) {
+		buffer.obtenerByteBuffer(byte, posicion++);
+		registro.nombre[i] = byte;
+	}
+}
+
+static void codificarRegistro(CodificadorBinario &codificador,
+		const Registro &registro) {
+	codificador.escribir(registro.tipo);
+	codificador.escribirVarint(registro.secuencia);
+	codificador.escribir(registro.marca);
+	codificador.escribir(registro.valor);
+	codificador.escribirCadena(registro.nombre);
+}
+
+static void decodificarRegistro(DecodificadorBinario &decodificador,
+		Registro &registro) {
+	uint64_t secuencia = 0;
+	decodificador.leer(registro.tipo);
+	decodificador.leerVarint(secuencia);
+	registro.secuencia = (uint32_t) secuencia;
+	decodificador.leer(registro.marca);
+	decodificador.leer(registro.valor);
+	decodificador.leerCadena(registro.nombre);
+}
+
+static Registro ejemplo(uint32_t secuencia) {
+	Registro registro;
+	registro.tipo = 7;
+	registro.secuencia = secuencia;
+	registro.marca = 0x0123456789ABCDEFULL + secuencia;
+	registro.valor = secuencia * 0.5;
+	registro.nombre = "sensor-norte";
+	return registro;
+}
+
+void benchCodificar() {
+	BufferTransmision codificado(REGISTROS * 64);
+	BufferTransmision insertado(REGISTROS * 64);
+	Registro registro = ejemplo(0);
+
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	for (int ronda = 0; ronda < RONDAS; ++ronda) {
+		codificado.vaciarBuffer();
+		CodificadorBinario codificador(codificado);
+		for (uint32_t i = 0; i < REGISTROS; ++i) {
+			registro.secuencia = i;
+			codificarRegistro(codificador, registro);
+		}
+	}
+	reportar("codificar: CodificadorBinario",
+			PThread::segundosDesde(inicio), codificado.getTamanioOcupado());
+
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	for (int ronda = 0; ronda < RONDAS; ++ronda) {
+		insertado.vaciarBuffer();
+		for (uint32_t i = 0; i < REGISTROS; ++i) {
+			registro.secuencia = i;
+			insertarRegistro(insertado, registro);
+		}
+	}
+	reportar("codificar: insertarDatos", PThread::segundosDesde(inicio),
+			insertado.getTamanioOcupado());
+}
+
+void benchDecodificar() {
+	BufferTransmision codificado(REGISTROS * 64);
+	BufferTransmision insertado(REGISTROS * 64);
+	CodificadorBinario codificador(codificado);
+	for (uint32_t i = 0; i < REGISTROS; ++i) {
+		codificarRegistro(codificador, ejemplo(i));
+		insertarRegistro(insertado, ejemplo(i));
+	}
+	Registro registro;
+	uint64_t control = 0;
+
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	for (int ronda = 0; ronda < RONDAS; ++ronda) {
+		DecodificadorBinario decodificador(codificado);
+		for (int i = 0; i < REGISTROS; ++i) {
+			decodificarRegistro(decodificador, registro);
+			control += registro.secuencia;
+		}
+	}
+	reportar("decodificar: DecodificadorBinario",
+			PThread::segundosDesde(inicio), codificado.getTamanioOcupado());
+
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	for (int ronda = 0; ronda < RONDAS; ++ronda) {
+		size_t posicion = 0;
+		for (int i = 0; i < REGISTROS; ++i) {
+			obtenerRegistro(insertado, posicion, registro);
+			control -= registro.secuencia;
+		}
+	}
+	reportar("decodificar: obtenerByteBuffer", PThread::segundosDesde(inicio),
+			insertado.getTamanioOcupado());
+	if (control != 0 || registro.nombre != "sensor-norte") {
+		printf("decodificar: los registros no coinciden\n");
+	}
+}
+
+}
+
+#ifdef CODIFICADORBINARIO_BENCH
+int main() {
+	printf("%d registros, %d rondas\n", REGISTROS, RONDAS);
+	Com::benchCodificar();
+	Com::benchDecodificar();
+	return 0;
+}
+#endif
@@ -0,0 +1,72 @@
+#include "CodificadorBinario.h"
+#include <cassert>
+#include <cstdio>
+
+namespace Com {
+
+static const uint64_t MAXIMO_SIN_SIGNO = ~(uint64_t) 0;
+static const int64_t MAXIMO_CON_SIGNO = (int64_t) (MAXIMO_SIN_SIGNO >> 1);
+static const int64_t MINIMO_CON_SIGNO = -MAXIMO_CON_SIGNO - 1;
+
+static VistaBuffer vista(const unsigned char *bytes, size_t tamanio) {
+	return VistaBuffer((const BufferTransmision::t_buffer*) bytes, tamanio);
+}
+
+/* Los extremos de 64 bits se codifican y decodifican sin perder bits */
+void testVarintExtremos() {
+	BufferTransmision buffer(64);
+	CodificadorBinario codificador(buffer);
+	assert(codificador.escribirVarint(0));
+	assert(codificador.escribirVarint(MAXIMO_SIN_SIGNO));
+	assert(codificador.escribirVarintConSigno(MINIMO_CON_SIGNO));
+	assert(codificador.escribirVarintConSigno(MAXIMO_CON_SIGNO));
+
+	DecodificadorBinario decodificador(buffer);
+	uint64_t valor;
+	int64_t conSigno;
+	assert(decodificador.leerVarint(valor) && valor == 0);
+	assert(decodificador.leerVarint(valor) && valor == MAXIMO_SIN_SIGNO);
+	assert(decodificador.leerVarintConSigno(conSigno) && conSigno == MINIMO_CON_SIGNO);
+	assert(decodificador.leerVarintConSigno(conSigno) && conSigno == MAXIMO_CON_SIGNO);
+	assert(decodificador.getBytesRestantes() == 0);
+}
+
+/* Un décimo byte con bits por encima del 63 excede los 64 bits */
+void testVarintExcedido() {
+	const unsigned char excedido[] = { 0xFF, 0xFF, 0xFF, 0xFF,
+			0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x02 };
+	DecodificadorBinario decodificador(
+			vista(excedido, sizeof(excedido)));
+	uint64_t valor;
+	assert(!decodificador.leerVarint(valor));
+	assert(decodificador.getBytesRestantes() == sizeof(excedido));
+
+	const unsigned char largo[] = { 0x80, 0x80, 0x80, 0x80,
+			0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00 };
+	DecodificadorBinario decodificadorLargo(vista(largo, sizeof(largo)));
+	assert(!decodificadorLargo.leerVarint(valor));
+}
+
+/* Un varint sin su byte final está incompleto y no se consume */
+void testVarintTruncado() {
+	const unsigned char truncado[] = { 0x80, 0x80 };
+	DecodificadorBinario decodificador(
+			vista(truncado, sizeof(truncado)));
+	uint64_t valor;
+	int64_t conSigno;
+	assert(!decodificador.leerVarint(valor));
+	assert(!decodificador.leerVarintConSigno(conSigno));
+	assert(decodificador.getBytesRestantes() == sizeof(truncado));
+}
+
+}
+
+#ifdef CODIFICADORBINARIO_TEST
+int main() {
+	Com::testVarintExtremos();
+	Com::testVarintExcedido();
+	Com::testVarintTruncado();
+	printf("CodificadorBinario_test: OK\n");
+	return 0;
+}
+#endif
@@ -0,0 +1,17 @@
+#include "ArchivoExcepcion.h"
+
+namespace Com {
+
+ArchivoExcepcion::ArchivoExcepcion(const char *motivo) throw () :
+		ComunicacionExcepcion(motivo) {
+	descripcion.assign("ERROR EN EL ARCHIVO! Motivo: ");
+	descripcion.append(motivo);
+}
+
+ArchivoExcepcion::~ArchivoExcepcion() throw () {
+}
+
+const char* ArchivoExcepcion::what() const throw () {
+	return descripcion.c_str();
+}
+}
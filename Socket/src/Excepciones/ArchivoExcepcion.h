@@ -0,0 +1,39 @@
+#ifndef ARCHIVOEXCEPCION_H_
+#define ARCHIVOEXCEPCION_H_
+
+#include "ComunicacionExcepcion.h"
+
+namespace Com {
+
+/**
+ * @brief Clase que define una excepción generada al intentar abrir o mapear
+ * un archivo a enviar
+ */
+
+class ArchivoExcepcion: public ComunicacionExcepcion {
+public:
+
+	/**
+	 * @brief Constructor
+	 * @param motivo Texto descriptivo del error
+	 */
+	explicit ArchivoExcepcion(const char *motivo) throw ();
+
+	/**
+	 * @brief Destructor
+	 */
+	virtual ~ArchivoExcepcion() throw ();
+
+	/**
+	 * @brief Método que obtiene una descripción del error
+	 * @return Una descripción del error
+	 */
+	virtual const char* what() const throw ();
+
+private:
+
+	std::string descripcion;
+};
+}
+
+#endif
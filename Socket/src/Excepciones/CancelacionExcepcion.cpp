@@ -0,0 +1,17 @@
+#include "CancelacionExcepcion.h"
+
+namespace Com {
+
+CancelacionExcepcion::CancelacionExcepcion(const char *motivo) throw () :
+		SocketExcepcion(motivo) {
+}
+
+CancelacionExcepcion::~CancelacionExcepcion() throw () {
+}
+
+const char* CancelacionExcepcion::what() const throw () {
+	std::string error("OPERACION CANCELADA! Motivo: ");
+	error.append(motivo);
+	return error.c_str();
+}
+}
@@ -0,0 +1,36 @@
+#ifndef CANCELACIONEXCEPCION_H_
+#define CANCELACIONEXCEPCION_H_
+
+#include "SocketExcepcion.h"
+
+namespace Com {
+
+/**
+ * @brief Clase que define una excepción generada cuando una operación
+ * bloqueante sobre un socket se interrumpe porque se canceló su
+ * TokenCancelacion
+ */
+
+class CancelacionExcepcion: public SocketExcepcion {
+public:
+
+	/**
+	 * @brief Constructor
+	 * @param motivo Texto descriptivo del error
+	 */
+	explicit CancelacionExcepcion(const char *motivo) throw ();
+
+	/**
+	 * @brief Destructor
+	 */
+	virtual ~CancelacionExcepcion() throw ();
+
+	/**
+	 * @brief Método que obtiene una descripción del error
+	 * @return Una descripción del error
+	 */
+	virtual const char* what() const throw ();
+};
+}
+
+#endif
@@ -7,6 +7,8 @@
 #define EXCEPCIONESSOCKET_H_
 
 #include "Excepciones/AceptacionExcepcion.h"
+#include "Excepciones/ArchivoExcepcion.h"
+#include "Excepciones/CancelacionExcepcion.h"
 #include "Excepciones/CierreExcepcion.h"
 #include "Excepciones/ComunicacionExcepcion.h"
 #include "Excepciones/ConexionExcepcion.h"
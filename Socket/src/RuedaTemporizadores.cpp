@@ -0,0 +1,250 @@
+#include "RuedaTemporizadores.h"
+#include <climits>
+#include <cstring>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#define ERROR_DESCRIPTOR -1
+#define MILIS_POR_SEGUNDO 1000
+#define NANOS_POR_MILI 1000000
+#define SIN_PROGRAMAR ((uint64_t) -1)
+
+namespace Com {
+
+/* Instante actual del reloj monotono, en milisegundos */
+static uint64_t milisegundosMonotonos() {
+	struct timespec tiempo;
+	clock_gettime(CLOCK_MONOTONIC, &tiempo);
+	return (uint64_t) tiempo.tv_sec * MILIS_POR_SEGUNDO
+			+ tiempo.tv_nsec / NANOS_POR_MILI;
+}
+
+/* METODOS DE TEMPORIZADOR */
+
+Temporizador::Temporizador() {
+	anterior = NULL;
+	siguiente = NULL;
+	lista = NULL;
+	vencimiento = 0;
+}
+
+bool Temporizador::estaArmado() const {
+	return (lista != NULL);
+}
+
+Temporizador::~Temporizador() {
+}
+
+/* METODOS DE RUEDATEMPORIZADORES */
+
+RuedaTemporizadores::RuedaTemporizadores(uint64_t resolucion) {
+	memset(ranuras, 0, sizeof(ranuras));
+	this->resolucion = (resolucion > 0) ? resolucion : 1;
+	origen = milisegundosMonotonos();
+	actual = 0;
+	cantidad = 0;
+	descriptor = ERROR_DESCRIPTOR;
+	programado = SIN_PROGRAMAR;
+}
+
+void RuedaTemporizadores::armar(Temporizador &temporizador,
+		uint64_t milisegundos) {
+	/* Si ya estaba armado, se lo quita y se lo descuenta antes de
+	 * rearmarlo */
+	cancelar(temporizador);
+	/* Redondeo hacia arriba para no vencer antes del plazo */
+	uint64_t objetivo = milisegundosMonotonos() - origen + milisegundos;
+	temporizador.vencimiento = (objetivo + resolucion - 1) / resolucion;
+	insertar(temporizador);
+	++cantidad;
+	if (descriptor != ERROR_DESCRIPTOR
+			&& temporizador.vencimiento < programado) {
+		programar();
+	}
+}
+
+bool RuedaTemporizadores::cancelar(Temporizador &temporizador) {
+	if (!temporizador.estaArmado()) {
+		return false;
+	}
+	quitar(temporizador);
+	--cantidad;
+	return true;
+}
+
+size_t RuedaTemporizadores::avanzar() {
+	std::vector<Temporizador*> vencidos;
+	avanzar(vencidos);
+	for (size_t i = 0; i < vencidos.size(); ++i) {
+		vencidos[i]->expirar();
+	}
+	return vencidos.size();
+}
+
+size_t RuedaTemporizadores::avanzar(std::vector<Temporizador*> &vencidos) {
+	if (descriptor != ERROR_DESCRIPTOR) {
+		uint64_t expiraciones;
+		ssize_t leido = read(descriptor, &expiraciones, sizeof(expiraciones));
+		(void) leido;
+	}
+	size_t previos = vencidos.size();
+	uint64_t limite = ahora();
+
+	while (actual <= limite && cantidad > 0) {
+		size_t indice = actual & (RANURAS - 1);
+		if (indice == 0) {
+			/* Termino una vuelta del primer nivel: bajo los temporizadores
+			 * de la ranura que corresponde en cada nivel superior */
+			for (int nivel = 1; nivel < NIVELES; ++nivel) {
+				size_t ranura = (actual >> (BITS_RANURA * nivel))
+						& (RANURAS - 1);
+				Temporizador *temporizador = ranuras[nivel][ranura];
+				ranuras[nivel][ranura] = NULL;
+				while (temporizador != NULL) {
+					Temporizador *siguiente = temporizador->siguiente;
+					insertar(*temporizador);
+					temporizador = siguiente;
+				}
+				if (ranura != 0) {
+					break;
+				}
+			}
+		}
+
+		Temporizador *temporizador = ranuras[0][indice];
+		ranuras[0][indice] = NULL;
+		while (temporizador != NULL) {
+			Temporizador *siguiente = temporizador->siguiente;
+			temporizador->anterior = NULL;
+			temporizador->siguiente = NULL;
+			temporizador->lista = NULL;
+			--cantidad;
+			vencidos.push_back(temporizador);
+			temporizador = siguiente;
+		}
+		++actual;
+	}
+	if (cantidad == 0 && actual <= limite) {
+		/* Sin temporizadores no hace falta recorrer los ticks vacios */
+		actual = limite + 1;
+	}
+
+	if (descriptor != ERROR_DESCRIPTOR) {
+		programar();
+	}
+	return vencidos.size() - previos;
+}
+
+int RuedaTemporizadores::milisegundosHastaProximo() const {
+	if (cantidad == 0) {
+		return -1;
+	}
+	uint64_t objetivo = proximoTick() * resolucion;
+	uint64_t transcurrido = milisegundosMonotonos() - origen;
+	if (objetivo <= transcurrido) {
+		return 0;
+	}
+	uint64_t faltante = objetivo - transcurrido;
+	return (faltante > (uint64_t) INT_MAX) ? INT_MAX : (int) faltante;
+}
+
+size_t RuedaTemporizadores::getCantidad() const {
+	return cantidad;
+}
+
+int RuedaTemporizadores::getDescriptor() {
+	if (descriptor == ERROR_DESCRIPTOR) {
+		descriptor = timerfd_create(CLOCK_MONOTONIC,
+				TFD_NONBLOCK | TFD_CLOEXEC);
+		if (descriptor != ERROR_DESCRIPTOR) {
+			programar();
+		}
+	}
+	return descriptor;
+}
+
+RuedaTemporizadores::~RuedaTemporizadores() {
+	if (descriptor != ERROR_DESCRIPTOR) {
+		close(descriptor);
+	}
+}
+
+uint64_t RuedaTemporizadores::ahora() const {
+	return (milisegundosMonotonos() - origen) / resolucion;
+}
+
+void RuedaTemporizadores::insertar(Temporizador &temporizador) {
+	if (temporizador.vencimiento < actual) {
+		temporizador.vencimiento = actual;
+	}
+	uint64_t diferencia = temporizador.vencimiento - actual;
+	int nivel = 0;
+	while (nivel < NIVELES - 1
+			&& diferencia >= ((uint64_t) 1 << (BITS_RANURA * (nivel + 1)))) {
+		++nivel;
+	}
+	uint64_t maximo = ((uint64_t) 1 << (BITS_RANURA * NIVELES)) - 1;
+	if (diferencia > maximo) {
+		/* Plazo fuera del alcance de la rueda: vence en el ultimo tick que
+		 * puede representar */
+		temporizador.vencimiento = actual + maximo;
+	}
+	size_t ranura = (temporizador.vencimiento >> (BITS_RANURA * nivel))
+			& (RANURAS - 1);
+
+	Temporizador **lista = &ranuras[nivel][ranura];
+	temporizador.lista = lista;
+	temporizador.anterior = NULL;
+	temporizador.siguiente = *lista;
+	if (*lista != NULL) {
+		(*lista)->anterior = &temporizador;
+	}
+	*lista = &temporizador;
+}
+
+void RuedaTemporizadores::quitar(Temporizador &temporizador) {
+	if (temporizador.anterior != NULL) {
+		temporizador.anterior->siguiente = temporizador.siguiente;
+	}
+	else {
+		*temporizador.lista = temporizador.siguiente;
+	}
+	if (temporizador.siguiente != NULL) {
+		temporizador.siguiente->anterior = temporizador.anterior;
+	}
+	temporizador.anterior = NULL;
+	temporizador.siguiente = NULL;
+	temporizador.lista = NULL;
+}
+
+uint64_t RuedaTemporizadores::proximoTick() const {
+	/* Busco en lo que resta de la vuelta del primer nivel. Si no hay nada,
+	 * el proximo instante relevante es el fin de la vuelta, donde bajan los
+	 * temporizadores de los niveles superiores */
+	size_t indice = actual & (RANURAS - 1);
+	for (size_t i = indice; i < RANURAS; ++i) {
+		if (ranuras[0][i] != NULL) {
+			return actual + (i - indice);
+		}
+	}
+	return actual + (RANURAS - indice);
+}
+
+void RuedaTemporizadores::programar() {
+	uint64_t tick = (cantidad > 0) ? proximoTick() : SIN_PROGRAMAR;
+	if (tick == programado) {
+		return;
+	}
+	struct itimerspec plazo;
+	memset(&plazo, 0, sizeof(plazo));
+	if (tick != SIN_PROGRAMAR) {
+		uint64_t absoluto = origen + tick * resolucion;
+		plazo.it_value.tv_sec = absoluto / MILIS_POR_SEGUNDO;
+		plazo.it_value.tv_nsec = (absoluto % MILIS_POR_SEGUNDO)
+				* NANOS_POR_MILI;
+	}
+	timerfd_settime(descriptor, TFD_TIMER_ABSTIME, &plazo, NULL);
+	programado = tick;
+}
+}
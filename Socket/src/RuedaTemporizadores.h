@@ -0,0 +1,173 @@
+#ifndef RUEDATEMPORIZADORES_H
+#define	RUEDATEMPORIZADORES_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace Com {
+
+class RuedaTemporizadores;
+
+/**
+ * @brief Clase abstracta que representa un temporizador de una
+ * RuedaTemporizadores. Se redefine Temporizador::expirar con la acción a
+ * realizar al vencer
+ * @details Los nodos de la rueda están dentro del propio temporizador, por lo
+ * que armarlo y cancelarlo no aloca memoria. El temporizador debe seguir
+ * vivo mientras esté armado
+ */
+
+class Temporizador {
+public:
+
+	/**
+	 * @brief Construye un temporizador desarmado
+	 */
+	Temporizador();
+
+	/**
+	 * @brief Método invocado al vencer el temporizador. Al invocarse, el
+	 * temporizador ya está desarmado, por lo que puede volver a armarse o
+	 * destruirse
+	 */
+	virtual void expirar() = 0;
+
+	/**
+	 * @brief Método para consultar si el temporizador está armado
+	 * @return <tt>true</tt> si está armado
+	 */
+	bool estaArmado() const;
+
+	/**
+	 * @brief Destructor
+	 * @pre El temporizador no está armado
+	 */
+	virtual ~Temporizador();
+
+private:
+
+	friend class RuedaTemporizadores;
+
+	Temporizador *anterior;
+	Temporizador *siguiente;
+	/* Lista en la que esta el temporizador, NULL si esta desarmado */
+	Temporizador **lista;
+	uint64_t vencimiento;
+
+	Temporizador(const Temporizador&);
+	Temporizador& operator=(const Temporizador&);
+};
+
+/**
+ * @brief Rueda jerárquica de temporizadores, para manejar una gran cantidad
+ * de plazos (inactividad, límites de recepción, reintentos) con costo
+ * constante al armarlos y cancelarlos
+ * @details Hay varios niveles de ranuras. El primero tiene una ranura por
+ * tick; cada nivel siguiente cubre 256 veces más tiempo por ranura. Los
+ * temporizadores lejanos se ubican en niveles altos y bajan de nivel a
+ * medida que se acercan a su vencimiento
+ * @details Puede asociarse a un timerfd, que se programa con el próximo
+ * vencimiento, para integrarla a un epoll (ver BucleEventos)
+ * @warning No es segura para uso desde varios hilos
+ */
+
+class RuedaTemporizadores {
+public:
+
+	/**
+	 * @brief Construye una rueda vacía
+	 * @param resolucion Milisegundos por tick. Los vencimientos se redondean
+	 * hacia arriba a la resolución
+	 */
+	explicit RuedaTemporizadores(uint64_t resolucion = 1);
+
+	/**
+	 * @brief Método para armar un temporizador. Si ya estaba armado, se
+	 * rearma con el nuevo plazo
+	 * @param temporizador Temporizador a armar
+	 * @param milisegundos Plazo desde el instante actual
+	 */
+	void armar(Temporizador &temporizador, uint64_t milisegundos);
+
+	/**
+	 * @brief Método para cancelar un temporizador
+	 * @param temporizador Temporizador a cancelar
+	 * @return <tt>true</tt> si estaba armado
+	 * @return <tt>false</tt> si no estaba armado (por ejemplo, porque ya
+	 * venció)
+	 */
+	bool cancelar(Temporizador &temporizador);
+
+	/**
+	 * @brief Método que avanza la rueda hasta el instante actual e invoca
+	 * Temporizador::expirar de los temporizadores vencidos
+	 * @return La cantidad de temporizadores vencidos
+	 */
+	size_t avanzar();
+
+	/**
+	 * @brief Método que avanza la rueda hasta el instante actual y desarma
+	 * los temporizadores vencidos, sin invocarlos
+	 * @param vencidos Lista donde se agregan los temporizadores vencidos,
+	 * para invocarlos luego
+	 * @return La cantidad de temporizadores vencidos
+	 */
+	size_t avanzar(std::vector<Temporizador*> &vencidos);
+
+	/**
+	 * @brief Método para obtener cuánto falta para el próximo instante en
+	 * que debe avanzarse la rueda. Puede ser anterior al próximo vencimiento,
+	 * pero nunca posterior. Útil como plazo de poll o epoll_wait
+	 * @return Los milisegundos, o -1 si no hay temporizadores armados
+	 */
+	int milisegundosHastaProximo() const;
+
+	/**
+	 * @brief Método para obtener la cantidad de temporizadores armados
+	 * @return La cantidad
+	 */
+	size_t getCantidad() const;
+
+	/**
+	 * @brief Método para obtener un timerfd que se programa automáticamente
+	 * con el próximo instante en que debe avanzarse la rueda. Se crea en el
+	 * primer llamado
+	 * @return El descriptor, o -1 si no se pudo crear
+	 */
+	int getDescriptor();
+
+	/**
+	 * @brief Destructor
+	 */
+	~RuedaTemporizadores();
+
+private:
+
+	enum {
+		NIVELES = 4, BITS_RANURA = 8, RANURAS = 1 << BITS_RANURA
+	};
+
+	Temporizador *ranuras[NIVELES][RANURAS];
+	uint64_t resolucion;
+	uint64_t origen;
+	/* Proximo tick a procesar */
+	uint64_t actual;
+	size_t cantidad;
+
+	int descriptor;
+	/* Tick con el que esta programado el timerfd */
+	uint64_t programado;
+
+	uint64_t ahora() const;
+	void insertar(Temporizador &temporizador);
+	void quitar(Temporizador &temporizador);
+	uint64_t proximoTick() const;
+	void programar();
+
+	RuedaTemporizadores(const RuedaTemporizadores&);
+	RuedaTemporizadores& operator=(const RuedaTemporizadores&);
+};
+}
+
+#endif
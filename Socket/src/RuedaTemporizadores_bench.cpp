@@ -0,0 +1,134 @@
+#include "RuedaTemporizadores.h"
+#include "Bench.h"
+#include <cstdio>
+#include <map>
+#include <vector>
+#include <time.h>
+
+/* Costo de armar y cancelar plazos de conexión, comparado con un contenedor
+ * ordenado, y de vencerlos */
+
+#define TEMPORIZADORES 100000
+#define VUELTAS 10
+/* Plazos repartidos en un minuto, como los de inactividad */
+#define PLAZO_MAXIMO 60000
+/* Plazos cortos para medir el vencimiento sin esperar de más */
+#define PLAZO_VENCIMIENTO 200
+
+namespace Com {
+
+class TemporizadorBench: public Temporizador {
+public:
+	TemporizadorBench() :
+			vencimientos(0) {
+	}
+	void expirar() {
+		++vencimientos;
+	}
+	size_t vencimientos;
+};
+
+static uint64_t plazo(size_t i, uint64_t maximo) {
+	/* Reparto determinístico y desordenado */
+	return (uint64_t) ((i * 7919) % maximo);
+}
+
+static void reportar(const char *prueba, double operaciones, double segundos) {
+	printf("%-32s %12.0f ops/s  %6.1f ns/op\n", prueba, operaciones / segundos,
+			segundos * 1e9 / operaciones);
+}
+
+/* Cada operación es un armado seguido de su cancelación */
+void benchArmarYCancelar(TemporizadorBench *temporizadores) {
+	RuedaTemporizadores rueda;
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	for (int vuelta = 0; vuelta < VUELTAS; ++vuelta) {
+		for (size_t i = 0; i < TEMPORIZADORES; ++i) {
+			rueda.armar(temporizadores[i], plazo(i, PLAZO_MAXIMO));
+		}
+		for (size_t i = 0; i < TEMPORIZADORES; ++i) {
+			rueda.cancelar(temporizadores[i]);
+		}
+	}
+	reportar("rueda: armar y cancelar", (double) TEMPORIZADORES * VUELTAS,
+			PThread::segundosDesde(inicio));
+}
+
+/* Cada actividad de una conexión posterga su plazo de inactividad */
+void benchRearmar(TemporizadorBench *temporizadores) {
+	RuedaTemporizadores rueda;
+	for (size_t i = 0; i < TEMPORIZADORES; ++i) {
+		rueda.armar(temporizadores[i], plazo(i, PLAZO_MAXIMO));
+	}
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	for (int vuelta = 0; vuelta < VUELTAS; ++vuelta) {
+		for (size_t i = 0; i < TEMPORIZADORES; ++i) {
+			rueda.armar(temporizadores[i], plazo(i + vuelta, PLAZO_MAXIMO));
+		}
+	}
+	reportar("rueda: rearmar armado", (double) TEMPORIZADORES * VUELTAS,
+			PThread::segundosDesde(inicio));
+	for (size_t i = 0; i < TEMPORIZADORES; ++i) {
+		rueda.cancelar(temporizadores[i]);
+	}
+}
+
+/* La misma carga que benchArmarYCancelar sobre un árbol ordenado */
+void benchContenedorOrdenado(TemporizadorBench *temporizadores) {
+	typedef std::multimap<uint64_t, Temporizador*> t_plazos;
+	t_plazos plazos;
+	std::vector<t_plazos::iterator> posiciones(TEMPORIZADORES);
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	for (int vuelta = 0; vuelta < VUELTAS; ++vuelta) {
+		for (size_t i = 0; i < TEMPORIZADORES; ++i) {
+			posiciones[i] = plazos.insert(
+					std::make_pair(plazo(i, PLAZO_MAXIMO), &temporizadores[i]));
+		}
+		for (size_t i = 0; i < TEMPORIZADORES; ++i) {
+			plazos.erase(posiciones[i]);
+		}
+	}
+	reportar("multimap: insertar y borrar", (double) TEMPORIZADORES * VUELTAS,
+			PThread::segundosDesde(inicio));
+}
+
+/* Solo se cuenta el tiempo de avanzar la rueda, no el de esperar */
+void benchVencer(TemporizadorBench *temporizadores) {
+	RuedaTemporizadores rueda;
+	for (size_t i = 0; i < TEMPORIZADORES; ++i) {
+		rueda.armar(temporizadores[i], plazo(i, PLAZO_VENCIMIENTO));
+	}
+	double segundos = 0;
+	while (rueda.getCantidad() > 0) {
+		int espera = rueda.milisegundosHastaProximo();
+		if (espera > 0) {
+			struct timespec pausa = { 0, espera * 1000000L };
+			nanosleep(&pausa, NULL);
+		}
+		struct timespec inicio;
+		clock_gettime(CLOCK_MONOTONIC, &inicio);
+		rueda.avanzar();
+		segundos += PThread::segundosDesde(inicio);
+	}
+	reportar("rueda: vencer", (double) TEMPORIZADORES, segundos);
+}
+
+}
+
+#ifdef RUEDATEMPORIZADORES_BENCH
+int main() {
+	printf("%d temporizadores, plazos de hasta %d ms\n", TEMPORIZADORES,
+			PLAZO_MAXIMO);
+	Com::TemporizadorBench *temporizadores =
+			new Com::TemporizadorBench[TEMPORIZADORES];
+	Com::benchArmarYCancelar(temporizadores);
+	Com::benchRearmar(temporizadores);
+	Com::benchContenedorOrdenado(temporizadores);
+	Com::benchVencer(temporizadores);
+	delete[] temporizadores;
+	return 0;
+}
+#endif
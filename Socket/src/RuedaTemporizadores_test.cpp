@@ -0,0 +1,67 @@
+#include "RuedaTemporizadores.h"
+#include <cassert>
+#include <cstdio>
+#include <unistd.h>
+
+namespace Com {
+
+class TemporizadorContador: public Temporizador {
+public:
+	TemporizadorContador() :
+			expiraciones(0) {
+	}
+	void expirar() {
+		++expiraciones;
+	}
+	int expiraciones;
+};
+
+/* Rearmar un temporizador armado no lo cuenta dos veces */
+void testRearmarYCancelar() {
+	RuedaTemporizadores rueda;
+	TemporizadorContador temporizador;
+	rueda.armar(temporizador, 100);
+	rueda.armar(temporizador, 50);
+	assert(rueda.getCantidad() == 1);
+	assert(rueda.milisegundosHastaProximo() >= 0);
+
+	assert(rueda.cancelar(temporizador));
+	assert(!temporizador.estaArmado());
+	assert(rueda.getCantidad() == 0);
+	assert(rueda.milisegundosHastaProximo() == -1);
+	assert(!rueda.cancelar(temporizador));
+	assert(rueda.getCantidad() == 0);
+}
+
+/* Un temporizador rearmado vence una sola vez, con el último plazo */
+void testRearmarYVencer() {
+	RuedaTemporizadores rueda;
+	TemporizadorContador temporizador;
+	TemporizadorContador otro;
+	rueda.armar(temporizador, 10000);
+	rueda.armar(otro, 10000);
+	rueda.armar(temporizador, 5);
+	assert(rueda.getCantidad() == 2);
+
+	usleep(20000);
+	assert(rueda.avanzar() == 1);
+	assert(temporizador.expiraciones == 1);
+	assert(!temporizador.estaArmado());
+	assert(rueda.getCantidad() == 1);
+
+	assert(rueda.cancelar(otro));
+	assert(otro.expiraciones == 0);
+	assert(rueda.getCantidad() == 0);
+	assert(rueda.milisegundosHastaProximo() == -1);
+}
+
+}
+
+#ifdef RUEDATEMPORIZADORES_TEST
+int main() {
+	Com::testRearmarYCancelar();
+	Com::testRearmarYVencer();
+	printf("RuedaTemporizadores_test: OK\n");
+	return 0;
+}
+#endif
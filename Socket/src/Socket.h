@@ -1,8 +1,8 @@
 #ifndef SOCKET_H
 #define	SOCKET_H
 
-/* todo: Hacer una clase protocolo abstracta para facilitar la definicion
- * de un protocolo */
+/* Los protocolos de encuadre de mensajes se definen con FWK_CS::Protocolo
+ * (Common/src/Protocolo.h) */
 
 namespace Com {
 
@@ -1,9 +1,69 @@
 #include "SocketCliente.h"
+#include "BucleEventos.h"
+#include <fcntl.h>
+#include <poll.h>
 
 #define ERROR_CONEXION -1
+#define SIN_LIMITE -1
 
 namespace Com {
 
+namespace {
+
+/* Conexion asincronica. Se destruye al completar su promesa */
+class ConexionAsincronica: public ManejadorDescriptor, public Temporizador {
+public:
+	ConexionAsincronica(Socket::t_socket sockfd, int flags,
+			BucleEventos &bucle) :
+			sockfd(sockfd), flags(flags), bucle(bucle) {
+	}
+
+	POSIX::Futuro<bool> obtenerFuturo() {
+		return promesa.obtenerFuturo();
+	}
+
+	/* Se invoca cuando el socket queda listo para escribir, es decir, cuando
+	 * termino el intento de conexion */
+	void descriptorListo() {
+		int error = 0;
+		socklen_t tamanio = sizeof(error);
+		if (getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &error, &tamanio)
+				== ERROR_CONEXION) {
+			error = errno;
+		}
+		completar(error);
+	}
+
+	/* Se invoca desde el hilo del bucle si vence el plazo */
+	void expirar() {
+		bucle.cancelarEscritura(sockfd);
+		completar(ETIMEDOUT);
+	}
+
+	void completar(int error) {
+		if (estaArmado()) {
+			bucle.cancelarTemporizador(*this);
+		}
+		if (flags != ERROR_CONEXION) {
+			fcntl(sockfd, F_SETFL, flags);
+		}
+		if (error == 0) {
+			promesa.establecerValor(true);
+		}
+		else {
+			promesa.establecerError(strerror(error));
+		}
+		delete this;
+	}
+
+private:
+	Socket::t_socket sockfd;
+	int flags;
+	BucleEventos &bucle;
+	POSIX::Promesa<bool> promesa;
+};
+}
+
 SocketCliente::SocketCliente(in_port_t puertoDestino, in_addr_t dirIPdestino,
 		int protocolo) throw () : SocketTCP_IP(protocolo) {
 	direccion.setPuerto(puertoDestino);
@@ -34,12 +94,83 @@ SocketCliente::SocketCliente(const SocketCliente &cliente) throw () :
 	sockfd = cliente.sockfd;
 }
 
-void SocketCliente::conectar() throw (ConexionExcepcion) {
+void SocketCliente::conectar()
+		throw (ConexionExcepcion, CancelacionExcepcion) {
+	if (token == NULL) {
+		int resultadoConectar = connect(sockfd, direccion.getDireccion(),
+				sizeof(struct sockaddr));
+		if (resultadoConectar == ERROR_CONEXION) {
+			throw ConexionExcepcion(strerror(errno));
+		}
+		return;
+	}
+
+	/* Con token, la conexion se inicia sin bloquear y se espera con poll
+	 * para poder cancelarla */
+	int flags = fcntl(sockfd, F_GETFL, 0);
+	if (flags == ERROR_CONEXION
+			|| fcntl(sockfd, F_SETFL, flags | O_NONBLOCK) == ERROR_CONEXION) {
+		throw ConexionExcepcion(strerror(errno));
+	}
+	int error = 0;
+	if (connect(sockfd, direccion.getDireccion(), sizeof(struct sockaddr))
+			== ERROR_CONEXION) {
+		error = errno;
+	}
+	if (error == EINPROGRESS) {
+		try {
+			if (esperarListo(POLLOUT)) {
+				socklen_t tamanio = sizeof(error);
+				if (getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &error, &tamanio)
+						== ERROR_CONEXION) {
+					error = errno;
+				}
+			}
+			else {
+				error = ETIMEDOUT;
+			}
+		}
+		catch (CancelacionExcepcion&) {
+			fcntl(sockfd, F_SETFL, flags);
+			throw;
+		}
+	}
+	fcntl(sockfd, F_SETFL, flags);
+	if (error != 0) {
+		throw ConexionExcepcion(strerror(error));
+	}
+}
+
+POSIX::Futuro<bool> SocketCliente::conectar(BucleEventos &bucle,
+		int milisegundosLimite) {
+	int flags = fcntl(sockfd, F_GETFL, 0);
+	ConexionAsincronica *conexion = new ConexionAsincronica(sockfd, flags,
+			bucle);
+	POSIX::Futuro<bool> futuro = conexion->obtenerFuturo();
+	if (flags == ERROR_CONEXION
+			|| fcntl(sockfd, F_SETFL, flags | O_NONBLOCK) == ERROR_CONEXION) {
+		conexion->completar(errno);
+		return futuro;
+	}
+
 	int resultadoConectar = connect(sockfd, direccion.getDireccion(),
 			sizeof(struct sockaddr));
-	if (resultadoConectar == ERROR_CONEXION) {
-		throw ConexionExcepcion(strerror(errno));
+	if (resultadoConectar != ERROR_CONEXION) {
+		conexion->completar(0);
+	}
+	else if (errno != EINPROGRESS) {
+		conexion->completar(errno);
+	}
+	else if (milisegundosLimite == SIN_LIMITE) {
+		if (!bucle.esperarEscritura(sockfd, conexion)) {
+			conexion->completar(errno);
+		}
+	}
+	else if (!bucle.esperarEscritura(sockfd, conexion, *conexion,
+			milisegundosLimite)) {
+		conexion->completar(errno);
 	}
+	return futuro;
 }
 
 SocketCliente::~SocketCliente() {
@@ -61,8 +61,24 @@ public:
 	 * @pre El servidor destino debe estar enlazado al puerto seteado mediante
 	 * el método SocketServidor::enlazarServidor
 	 * @throw ConexionExcepcion Error generado al intentar conectarse
+	 * @throw CancelacionExcepcion Se canceló el token del socket
 	 */
-	void conectar() throw (ConexionExcepcion);
+	void conectar() throw (ConexionExcepcion, CancelacionExcepcion);
+
+	/**
+	 * @brief Versión asincrónica de SocketCliente::conectar. Inicia la
+	 * conexión sin bloquear y la completa cuando el bucle de eventos indique
+	 * que se estableció
+	 * @details El socket vuelve a modo bloqueante al completarse la conexión
+	 * @pre Socket creado mediante Socket::crear
+	 * @param bucle Bucle de eventos que completa la conexión
+	 * @param milisegundosLimite Plazo para establecer la conexión, -1 para
+	 * esperar sin límite
+	 * @return Un futuro con <tt>true</tt> al conectarse. Si la conexión
+	 * falla o vence el plazo, el futuro falla con el motivo
+	 */
+	POSIX::Futuro<bool> conectar(BucleEventos &bucle,
+			int milisegundosLimite = -1);
 
 	/**
 	 * @brief Destructor
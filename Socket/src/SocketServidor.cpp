@@ -1,5 +1,8 @@
 #include "SocketServidor.h"
 #include "SocketCliente.h"
+#include "BucleEventos.h"
+#include <fcntl.h>
+#include <poll.h>
 
 #define ERROR_ENLACE -1
 #define ERROR_ESCUCHA -1
@@ -7,6 +10,54 @@
 
 namespace Com {
 
+namespace {
+
+/* Aceptacion asincronica de una conexion. Se destruye al completar su
+ * promesa */
+class AceptacionAsincronica: public ManejadorDescriptor {
+public:
+	AceptacionAsincronica(Socket::t_socket sockfd, int protocolo,
+			BucleEventos &bucle) :
+			sockfd(sockfd), protocolo(protocolo), bucle(bucle) {
+	}
+
+	POSIX::Futuro<SocketCliente*> iniciar() {
+		POSIX::Futuro<SocketCliente*> futuro = promesa.obtenerFuturo();
+		descriptorListo();
+		return futuro;
+	}
+
+	void descriptorListo() {
+		struct sockaddr address;
+		socklen_t tamanio = sizeof(struct sockaddr);
+		Socket::t_socket nuevoSocket;
+		do {
+			nuevoSocket = accept(sockfd, &address, &tamanio);
+		} while (nuevoSocket == ERROR_ACEPTACION && errno == EINTR);
+
+		if (nuevoSocket == ERROR_ACEPTACION) {
+			if ((errno == EAGAIN || errno == EWOULDBLOCK
+					|| errno == ECONNABORTED)
+					&& bucle.esperarLectura(sockfd, this)) {
+				return;
+			}
+			promesa.establecerError(strerror(errno));
+		}
+		else {
+			promesa.establecerValor(
+					new SocketCliente(nuevoSocket, address, protocolo));
+		}
+		delete this;
+	}
+
+private:
+	Socket::t_socket sockfd;
+	int protocolo;
+	BucleEventos &bucle;
+	POSIX::Promesa<SocketCliente*> promesa;
+};
+}
+
 SocketServidor::SocketServidor(in_port_t puerto, int protocolo) throw () :
 		SocketTCP_IP(protocolo) {
 	direccion.setPuerto(puerto);
@@ -37,19 +88,47 @@ void SocketServidor::escucharClientes(int colaMaxima) throw (EscuchaExcepcion) {
 	}
 }
 
-SocketCliente* SocketServidor::aceptarClientes() throw (AceptacionExcepcion) {
+SocketCliente* SocketServidor::aceptarClientes()
+		throw (AceptacionExcepcion, CancelacionExcepcion) {
 	struct sockaddr address;
 	socklen_t tamanio = sizeof(struct sockaddr);
-	t_socket nuevoSocket = accept(sockfd, &address, &tamanio);
+	t_socket nuevoSocket;
+	if (token == NULL) {
+		nuevoSocket = accept(sockfd, &address, &tamanio);
+	}
+	else {
+		/* Si el socket es no bloqueante (por haber aceptado con un bucle de
+		 * eventos), otro hilo puede llevarse la conexion entre el poll y el
+		 * accept */
+		do {
+			if (!esperarListo(POLLIN)) {
+				throw AceptacionExcepcion(strerror(EAGAIN));
+			}
+			tamanio = sizeof(struct sockaddr);
+			nuevoSocket = accept(sockfd, &address, &tamanio);
+		} while (nuevoSocket == ERROR_ACEPTACION
+				&& (errno == EAGAIN || errno == EWOULDBLOCK
+						|| errno == ECONNABORTED));
+	}
 
 	if (nuevoSocket == ERROR_ACEPTACION) {
 		throw AceptacionExcepcion(strerror(errno));
 	}
 	SocketCliente *nuevoCliente = new SocketCliente(nuevoSocket, address,
 			protocolo);
+	nuevoCliente->setTokenCancelacion(token);
 	return nuevoCliente;
 }
 
+POSIX::Futuro<SocketCliente*> SocketServidor::aceptarClientes(
+		BucleEventos &bucle) {
+	int flags = fcntl(sockfd, F_GETFL, 0);
+	if (flags != -1 && !(flags & O_NONBLOCK)) {
+		fcntl(sockfd, F_SETFL, flags | O_NONBLOCK);
+	}
+	return (new AceptacionAsincronica(sockfd, protocolo, bucle))->iniciar();
+}
+
 SocketServidor::~SocketServidor() {
 }
 }
@@ -62,8 +62,24 @@ public:
 	 * @return Puntero al socket que se utilizará para comunicarse con el
 	 * usuario de la conexión aceptada
 	 * @throw AceptacionExcepcion Error generado al aceptar una conexión
+	 * @throw CancelacionExcepcion Se canceló el token del socket
 	 */
-	SocketCliente* aceptarClientes() throw (AceptacionExcepcion);
+	SocketCliente* aceptarClientes()
+			throw (AceptacionExcepcion, CancelacionExcepcion);
+
+	/**
+	 * @brief Versión asincrónica de SocketServidor::aceptarClientes. Si no hay
+	 * conexiones en la cola, se acepta la próxima cuando el bucle de eventos
+	 * indique que llegó, sin bloquear al hilo invocante
+	 * @details Pone al socket servidor en modo no bloqueante
+	 * @pre Tener al socket escuchando clientes mediante
+	 * SocketServidor::escucharClientes
+	 * @param bucle Bucle de eventos que reanuda la aceptación
+	 * @return Un futuro con el socket aceptado, que debe cerrarse y liberarse
+	 * igual que el de SocketServidor::aceptarClientes. Si la aceptación
+	 * falla, el futuro falla con el motivo
+	 */
+	POSIX::Futuro<SocketCliente*> aceptarClientes(BucleEventos &bucle);
 
 	/**
 	 * @brief Destructor
@@ -1,26 +1,253 @@
 #include "SocketTCP_IP.h"
+#include "BucleEventos.h"
+#include "BufferCircular.h"
+#include "TokenCancelacion.h"
+#include "VistaBuffer.h"
+#include <poll.h>
+#include <sys/uio.h>
 
 #define FLAGS 0
 #define ERROR_ENVIO -1
 #define ERROR_RECEPCION -1
 #define USUARIO_DESCONECTADO 0
 #define TEMP_BUFFER_SIZE 512
+#define FLAGS_ASINCRONICO (MSG_DONTWAIT | MSG_NOSIGNAL)
+#define ERROR_OPCION -1
+#define SIN_LIMITE -1
+#define MILIS_POR_SEGUNDO 1000
+#define MICROS_POR_MILI 1000
+#define MENSAJE_TIEMPO_AGOTADO "Tiempo limite agotado"
+#define MENSAJE_CANCELADO "Token de cancelacion cancelado"
+#define ERROR_POLL -1
+#define MAX_REGIONES 64
 
 namespace Com {
 
+namespace {
+
+/* Base de las operaciones asincronicas sobre un socket. El plazo, si lo hay,
+ * se arma recien cuando la operacion tiene que esperar al bucle; el
+ * manejador y el plazo se invocan siempre desde el hilo del bucle */
+class OperacionAsincronica: public ManejadorDescriptor, public Temporizador {
+protected:
+	OperacionAsincronica(int sockfd, BucleEventos &bucle,
+			int milisegundosLimite, bool lectura) :
+			sockfd(sockfd), bucle(bucle),
+			milisegundosLimite(milisegundosLimite), lectura(lectura) {
+	}
+
+	bool esperar() {
+		if (milisegundosLimite == SIN_LIMITE || estaArmado()) {
+			return lectura ? bucle.esperarLectura(sockfd, this) :
+					bucle.esperarEscritura(sockfd, this);
+		}
+		return lectura ?
+				bucle.esperarLectura(sockfd, this, *this, milisegundosLimite) :
+				bucle.esperarEscritura(sockfd, this, *this,
+						milisegundosLimite);
+	}
+
+	/* Se invoca antes de destruirse al completar */
+	void desarmar() {
+		if (estaArmado()) {
+			bucle.cancelarTemporizador(*this);
+		}
+	}
+
+	/* Al vencer el plazo se deja de esperar al descriptor */
+	void cancelarEspera() {
+		if (lectura) {
+			bucle.cancelarLectura(sockfd);
+		}
+		else {
+			bucle.cancelarEscritura(sockfd);
+		}
+	}
+
+	int sockfd;
+	BucleEventos &bucle;
+
+private:
+	int milisegundosLimite;
+	bool lectura;
+};
+
+/* Envio asincronico con el protocolo por defecto. Se destruye al completar
+ * su promesa */
+class EnvioAsincronico: public OperacionAsincronica {
+public:
+	EnvioAsincronico(int sockfd, const VistaBuffer &vista,
+			BucleEventos &bucle, int milisegundosLimite) :
+			OperacionAsincronica(sockfd, bucle, milisegundosLimite, false),
+			datos(vista.obtenerDatos()) {
+		cabecera = vista.getTamanio();
+		enviados = 0;
+	}
+
+	POSIX::Futuro<size_t> iniciar() {
+		POSIX::Futuro<size_t> futuro = promesa.obtenerFuturo();
+		descriptorListo();
+		return futuro;
+	}
+
+	void descriptorListo() {
+		size_t total = sizeof(cabecera) + cabecera;
+		while (enviados < total) {
+			/* Cabecera y datos en un solo llamado */
+			struct iovec regiones[2];
+			int cantidad = 0;
+			if (enviados < sizeof(cabecera)) {
+				regiones[0].iov_base = (char*) &cabecera + enviados;
+				regiones[0].iov_len = sizeof(cabecera) - enviados;
+				regiones[1].iov_base = (void*) datos;
+				regiones[1].iov_len = cabecera;
+				cantidad = 2;
+			}
+			else {
+				regiones[0].iov_base = (void*) (datos + enviados
+						- sizeof(cabecera));
+				regiones[0].iov_len = total - enviados;
+				cantidad = 1;
+			}
+			struct msghdr mensaje;
+			memset(&mensaje, 0, sizeof(mensaje));
+			mensaje.msg_iov = regiones;
+			mensaje.msg_iovlen = cantidad;
+			ssize_t resultado = sendmsg(sockfd, &mensaje, FLAGS_ASINCRONICO);
+			if (resultado == ERROR_ENVIO) {
+				if (errno == EINTR) {
+					continue;
+				}
+				if ((errno == EAGAIN || errno == EWOULDBLOCK) && esperar()) {
+					return;
+				}
+				desarmar();
+				promesa.establecerError(strerror(errno));
+				delete this;
+				return;
+			}
+			enviados += resultado;
+		}
+		desarmar();
+		promesa.establecerValor(total);
+		delete this;
+	}
+
+	void expirar() {
+		cancelarEspera();
+		promesa.establecerError(MENSAJE_TIEMPO_AGOTADO);
+		delete this;
+	}
+
+private:
+	const BufferTransmision::t_buffer *datos;
+	size_t cabecera;
+	size_t enviados;
+	POSIX::Promesa<size_t> promesa;
+};
+
+/* Recepcion asincronica con el protocolo por defecto. Se destruye al
+ * completar su promesa */
+class RecepcionAsincronica: public OperacionAsincronica {
+public:
+	RecepcionAsincronica(int sockfd, BufferTransmision &buffer,
+			BucleEventos &bucle, int milisegundosLimite) :
+			OperacionAsincronica(sockfd, bucle, milisegundosLimite, true),
+			buffer(buffer) {
+		cabecera = 0;
+		recibidos = 0;
+		destino = NULL;
+	}
+
+	POSIX::Futuro<size_t> iniciar() {
+		POSIX::Futuro<size_t> futuro = promesa.obtenerFuturo();
+		descriptorListo();
+		return futuro;
+	}
+
+	void descriptorListo() {
+		while (recibidos < sizeof(cabecera) + cabecera) {
+			void *posicion;
+			size_t restante;
+			if (recibidos < sizeof(cabecera)) {
+				posicion = (char*) &cabecera + recibidos;
+				restante = sizeof(cabecera) - recibidos;
+			}
+			else {
+				size_t recibidosDatos = recibidos - sizeof(cabecera);
+				posicion = destino + recibidosDatos;
+				restante = cabecera - recibidosDatos;
+			}
+			ssize_t resultado = recv(sockfd, posicion, restante,
+					FLAGS_ASINCRONICO);
+			if (resultado == ERROR_RECEPCION) {
+				if (errno == EINTR) {
+					continue;
+				}
+				if ((errno == EAGAIN || errno == EWOULDBLOCK) && esperar()) {
+					return;
+				}
+				desarmar();
+				promesa.establecerError(strerror(errno));
+				delete this;
+				return;
+			}
+			if (resultado == USUARIO_DESCONECTADO) {
+				desarmar();
+				promesa.establecerError("Usuario desconectado");
+				delete this;
+				return;
+			}
+			recibidos += resultado;
+			if (recibidos == sizeof(cabecera)) {
+				/* Con la cabecera completa reservo el espacio para recibir
+				 * los datos directamente en el buffer */
+				buffer.vaciarBuffer();
+				if (cabecera > buffer.getCapacidadTotal()) {
+					buffer.redimensionar(cabecera);
+				}
+				destino = buffer.reservarDatos(cabecera);
+			}
+		}
+		desarmar();
+		promesa.establecerValor(recibidos);
+		delete this;
+	}
+
+	void expirar() {
+		cancelarEspera();
+		promesa.establecerError(MENSAJE_TIEMPO_AGOTADO);
+		delete this;
+	}
+
+private:
+	BufferTransmision &buffer;
+	size_t cabecera;
+	size_t recibidos;
+	BufferTransmision::t_buffer *destino;
+	POSIX::Promesa<size_t> promesa;
+};
+}
+
 SocketTCP_IP::SocketTCP_IP(int protocolo) throw () :
 		Socket(AF_INET, SOCK_STREAM, protocolo) {
 	direccion.setFamilia(AF_INET);
+	token = NULL;
+	milisegundosLimite = SIN_LIMITE;
 }
 
 SocketTCP_IP::SocketTCP_IP(const struct sockaddr &dir, int protocolo) throw () :
 		Socket(AF_INET, SOCK_STREAM, protocolo, dir) {
+	token = NULL;
+	milisegundosLimite = SIN_LIMITE;
 }
 
 SocketTCP_IP::SocketTCP_IP(const SocketTCP_IP &socket) throw () :
 		Socket(socket.tipo, socket.tipo, socket.protocolo) {
 	direccion = socket.direccion;
 	sockfd = socket.sockfd;
+	token = socket.token;
+	milisegundosLimite = socket.milisegundosLimite;
 }
 
 in_port_t SocketTCP_IP::getPuerto() const throw () {
@@ -34,10 +261,13 @@ std::string SocketTCP_IP::getDireccionIP() const throw () {
 }
 
 ssize_t SocketTCP_IP::enviar(const BufferTransmision &buffer)
-		throw (EnvioExcepcion) {
+		throw (EnvioExcepcion, CancelacionExcepcion) {
+	return enviar(VistaBuffer(buffer));
+}
+
+ssize_t SocketTCP_IP::enviar(const VistaBuffer &vista) throw (EnvioExcepcion, CancelacionExcepcion) {
 	ssize_t bytesEnviados;
-	bytesEnviados = send(sockfd, buffer.obtenerBuffer(),
-			buffer.getTamanioOcupado(), FLAGS);
+	bytesEnviados = enviarParcial(vista.obtenerDatos(), vista.getTamanio());
 
 	if (bytesEnviados == ERROR_ENVIO) {
 		throw EnvioExcepcion(strerror(errno));
@@ -45,13 +275,68 @@ ssize_t SocketTCP_IP::enviar(const BufferTransmision &buffer)
 	return bytesEnviados;
 }
 
+size_t SocketTCP_IP::enviarVectorizado(const VistaBuffer *vistas,
+		size_t cantidad) throw (EnvioExcepcion, CancelacionExcepcion) {
+	struct iovec regiones[MAX_REGIONES];
+	size_t totalEnviado = 0;
+	/* Vista en curso y bytes ya enviados de ella */
+	size_t actual = 0;
+	size_t desplazamiento = 0;
+
+	for (;;) {
+		while (actual < cantidad
+				&& vistas[actual].getTamanio() == desplazamiento) {
+			++actual;
+			desplazamiento = 0;
+		}
+		if (actual == cantidad) {
+			return totalEnviado;
+		}
+
+		size_t usadas = 0;
+		for (size_t i = actual; i < cantidad && usadas < MAX_REGIONES; ++i) {
+			size_t inicio = (i == actual) ? desplazamiento : 0;
+			if (vistas[i].getTamanio() > inicio) {
+				regiones[usadas].iov_base =
+						(void*) (vistas[i].obtenerDatos() + inicio);
+				regiones[usadas++].iov_len = vistas[i].getTamanio() - inicio;
+			}
+		}
+
+		ssize_t bytesEnviados = enviarRegionesParcial(regiones, usadas);
+		if (bytesEnviados == ERROR_ENVIO) {
+			throw EnvioExcepcion(strerror(errno));
+		}
+		totalEnviado += bytesEnviados;
+
+		/* Avanzo sobre las vistas enviadas, completas o en parte */
+		size_t restante = bytesEnviados;
+		while (restante > 0) {
+			size_t pendiente = vistas[actual].getTamanio() - desplazamiento;
+			if (restante < pendiente) {
+				desplazamiento += restante;
+				break;
+			}
+			restante -= pendiente;
+			++actual;
+			desplazamiento = 0;
+		}
+	}
+}
+
 ssize_t SocketTCP_IP::recibir(BufferTransmision &buffer)
-		throw (RecepcionExcepcion) {
+		throw (RecepcionExcepcion, CancelacionExcepcion) {
 	ssize_t bytesRecibidos;
 	BufferTransmision::t_buffer *tempBuffer =
 			new BufferTransmision::t_buffer[buffer.getCapacidadTotal()];
-	bytesRecibidos = recv(sockfd, tempBuffer, buffer.getCapacidadTotal(),
-			FLAGS);
+	try {
+		bytesRecibidos = recibirParcial(tempBuffer,
+				buffer.getCapacidadTotal());
+	}
+	catch (CancelacionExcepcion&) {
+		delete[] tempBuffer;
+		throw;
+	}
 
 	if (bytesRecibidos > 0) {
 		buffer.asignarBuffer(tempBuffer, bytesRecibidos);
@@ -69,46 +354,66 @@ ssize_t SocketTCP_IP::recibir(BufferTransmision &buffer)
 	return bytesRecibidos;
 }
 
-size_t SocketTCP_IP::enviarConProtocolo(const BufferTransmision &buffer)
-		throw (EnvioExcepcion) {
-	size_t bytesAenviar;
-	ssize_t resultadoEnvio;
-	size_t bytesTotalesEnviados = 0;
-	const BufferTransmision::t_buffer* tempBuffer;
-
-	/* Primero envio el tamanio del buffer que voy a enviar */
-	size_t tamanioBuffer = buffer.getTamanioOcupado();
-	bytesAenviar = sizeof(tamanioBuffer);
-	tempBuffer = (BufferTransmision::t_buffer*) &tamanioBuffer;
-
-	while (bytesAenviar != 0) {
-		resultadoEnvio = send(sockfd, tempBuffer, bytesAenviar, FLAGS);
-		if (resultadoEnvio == ERROR_ENVIO) {
-			throw EnvioExcepcion(strerror(errno));
-		}
-		bytesAenviar -= resultadoEnvio;
-		tempBuffer += resultadoEnvio;
-		bytesTotalesEnviados += resultadoEnvio;
+ssize_t SocketTCP_IP::recibir(BufferCircular &buffer)
+		throw (RecepcionExcepcion, CancelacionExcepcion) {
+	struct iovec regiones[2];
+	int cantidadRegiones = buffer.obtenerRegionesLibres(regiones);
+	if (cantidadRegiones == 0) {
+		return 0;
 	}
 
-	/* Envio el contenido del buffer */
-	bytesAenviar = buffer.getTamanioOcupado();
-	tempBuffer = buffer.obtenerBuffer();
-
-	while (bytesAenviar != 0) {
-		resultadoEnvio = send(sockfd, tempBuffer, bytesAenviar, FLAGS);
-		if (resultadoEnvio == ERROR_ENVIO) {
-			throw EnvioExcepcion(strerror(errno));
+	ssize_t bytesRecibidos;
+	if (token == NULL) {
+		bytesRecibidos = readv(sockfd, regiones, cantidadRegiones);
+	}
+	else {
+		if (token->estaCancelado()) {
+			throw CancelacionExcepcion(MENSAJE_CANCELADO);
+		}
+		struct msghdr mensaje;
+		memset(&mensaje, 0, sizeof(mensaje));
+		mensaje.msg_iov = regiones;
+		mensaje.msg_iovlen = cantidadRegiones;
+		while ((bytesRecibidos = recvmsg(sockfd, &mensaje, MSG_DONTWAIT))
+				== ERROR_RECEPCION && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			if (!esperarListo(POLLIN)) {
+				errno = EAGAIN;
+				break;
+			}
 		}
-		tempBuffer += resultadoEnvio;
-		bytesAenviar -= resultadoEnvio;
-		bytesTotalesEnviados += resultadoEnvio;
 	}
-	return bytesTotalesEnviados;
+
+	if (bytesRecibidos == ERROR_RECEPCION) {
+		throw RecepcionExcepcion(strerror(errno),
+				RecepcionExcepcion::error_recepcion);
+	}
+	if (bytesRecibidos == USUARIO_DESCONECTADO) {
+		throw RecepcionExcepcion(strerror(errno),
+				RecepcionExcepcion::usuario_desconectado);
+	}
+	buffer.confirmarEscritura(bytesRecibidos);
+	return bytesRecibidos;
+}
+
+size_t SocketTCP_IP::enviarConProtocolo(const BufferTransmision &buffer)
+		throw (EnvioExcepcion, CancelacionExcepcion) {
+	return enviarConProtocolo(VistaBuffer(buffer));
+}
+
+size_t SocketTCP_IP::enviarConProtocolo(const VistaBuffer &vista)
+		throw (EnvioExcepcion, CancelacionExcepcion) {
+	/* El tamanio y el contenido salen en la misma llamada: en dos envios
+	 * separados, Nagle retiene el contenido hasta el ACK del tamanio */
+	size_t tamanioBuffer = vista.getTamanio();
+	VistaBuffer partes[2];
+	partes[0] = VistaBuffer((BufferTransmision::t_buffer*) &tamanioBuffer,
+			sizeof(tamanioBuffer));
+	partes[1] = vista;
+	return enviarVectorizado(partes, 2);
 }
 
 size_t SocketTCP_IP::recibirConProtocolo(BufferTransmision &buffer)
-		throw (RecepcionExcepcion) {
+		throw (RecepcionExcepcion, CancelacionExcepcion) {
 	size_t bytesArecibir;
 	size_t tamanioBuffer;
 	ssize_t resultadoRecepcion;
@@ -122,8 +427,8 @@ size_t SocketTCP_IP::recibirConProtocolo(BufferTransmision &buffer)
 	bytesArecibir = sizeof(tamanioBuffer);
 
 	while (bytesArecibir != 0) {
-		resultadoRecepcion = recv(sockfd, &tempBuffer[bytesTotalesRecibidos],
-				bytesArecibir, FLAGS);
+		resultadoRecepcion = recibirParcial(
+				&tempBuffer[bytesTotalesRecibidos], bytesArecibir);
 
 		if (resultadoRecepcion == ERROR_RECEPCION) {
 			throw RecepcionExcepcion(strerror(errno),
@@ -148,7 +453,10 @@ size_t SocketTCP_IP::recibirConProtocolo(BufferTransmision &buffer)
 	}
 
 	while (bytesArecibir != 0) {
-		resultadoRecepcion = recv(sockfd, tempBuffer, TEMP_BUFFER_SIZE, FLAGS);
+		/* No se lee mas alla del mensaje, para no consumir el siguiente */
+		resultadoRecepcion = recibirParcial(tempBuffer,
+				(bytesArecibir < TEMP_BUFFER_SIZE) ?
+						bytesArecibir : TEMP_BUFFER_SIZE);
 
 		if (resultadoRecepcion == ERROR_RECEPCION) {
 			throw RecepcionExcepcion(strerror(errno),
@@ -167,6 +475,135 @@ size_t SocketTCP_IP::recibirConProtocolo(BufferTransmision &buffer)
 	return bytesTotalesRecibidos;
 }
 
+POSIX::Futuro<size_t> SocketTCP_IP::enviarConProtocolo(
+		const VistaBuffer &vista, BucleEventos &bucle,
+		int milisegundosLimite) {
+	return (new EnvioAsincronico(sockfd, vista, bucle, milisegundosLimite))
+			->iniciar();
+}
+
+POSIX::Futuro<size_t> SocketTCP_IP::recibirConProtocolo(
+		BufferTransmision &buffer, BucleEventos &bucle,
+		int milisegundosLimite) {
+	return (new RecepcionAsincronica(sockfd, buffer, bucle,
+			milisegundosLimite))->iniciar();
+}
+
+bool SocketTCP_IP::setTiempoLimite(int milisegundos) {
+	struct timeval limite;
+	milisegundosLimite = (milisegundos < 0) ? SIN_LIMITE : milisegundos;
+	if (milisegundos == SIN_LIMITE) {
+		milisegundos = 0;
+	}
+	limite.tv_sec = milisegundos / MILIS_POR_SEGUNDO;
+	limite.tv_usec = (milisegundos % MILIS_POR_SEGUNDO) * MICROS_POR_MILI;
+	return (setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &limite,
+			sizeof(limite)) != ERROR_OPCION
+			&& setsockopt(sockfd, SOL_SOCKET, SO_SNDTIMEO, &limite,
+					sizeof(limite)) != ERROR_OPCION);
+}
+
+void SocketTCP_IP::setTokenCancelacion(TokenCancelacion *token) {
+	this->token = token;
+}
+
+TokenCancelacion* SocketTCP_IP::getTokenCancelacion() const {
+	return token;
+}
+
+bool SocketTCP_IP::esperarListo(short eventos) throw (CancelacionExcepcion) {
+	struct pollfd descriptores[2];
+	descriptores[0].fd = sockfd;
+	descriptores[0].events = eventos;
+	descriptores[1].fd = token->getDescriptor();
+	descriptores[1].events = POLLIN;
+	for (;;) {
+		if (token->estaCancelado()) {
+			throw CancelacionExcepcion(MENSAJE_CANCELADO);
+		}
+		descriptores[0].revents = 0;
+		descriptores[1].revents = 0;
+		int listos = poll(descriptores, 2, milisegundosLimite);
+		if (listos == ERROR_POLL && errno == EINTR) {
+			continue;
+		}
+		if (descriptores[1].revents != 0) {
+			throw CancelacionExcepcion(MENSAJE_CANCELADO);
+		}
+		/* Con un error de poll se deja que la operacion lo reporte */
+		return (listos != 0);
+	}
+}
+
+ssize_t SocketTCP_IP::enviarParcial(const void *datos, size_t tamanio)
+		throw (CancelacionExcepcion) {
+	if (token == NULL) {
+		return send(sockfd, datos, tamanio, FLAGS);
+	}
+	/* Se intenta primero sin esperar, para no agregar un poll cuando el
+	 * socket ya esta listo */
+	for (;;) {
+		if (token->estaCancelado()) {
+			throw CancelacionExcepcion(MENSAJE_CANCELADO);
+		}
+		ssize_t resultado = send(sockfd, datos, tamanio, FLAGS | MSG_DONTWAIT);
+		if (resultado != ERROR_ENVIO
+				|| (errno != EAGAIN && errno != EWOULDBLOCK)) {
+			return resultado;
+		}
+		if (!esperarListo(POLLOUT)) {
+			errno = EAGAIN;
+			return ERROR_ENVIO;
+		}
+	}
+}
+
+ssize_t SocketTCP_IP::enviarRegionesParcial(struct iovec *regiones,
+		size_t cantidad) throw (CancelacionExcepcion) {
+	struct msghdr mensaje;
+	memset(&mensaje, 0, sizeof(mensaje));
+	mensaje.msg_iov = regiones;
+	mensaje.msg_iovlen = cantidad;
+	if (token == NULL) {
+		return sendmsg(sockfd, &mensaje, FLAGS);
+	}
+	for (;;) {
+		if (token->estaCancelado()) {
+			throw CancelacionExcepcion(MENSAJE_CANCELADO);
+		}
+		ssize_t resultado = sendmsg(sockfd, &mensaje, FLAGS | MSG_DONTWAIT);
+		if (resultado != ERROR_ENVIO
+				|| (errno != EAGAIN && errno != EWOULDBLOCK)) {
+			return resultado;
+		}
+		if (!esperarListo(POLLOUT)) {
+			errno = EAGAIN;
+			return ERROR_ENVIO;
+		}
+	}
+}
+
+ssize_t SocketTCP_IP::recibirParcial(void *datos, size_t tamanio)
+		throw (CancelacionExcepcion) {
+	if (token == NULL) {
+		return recv(sockfd, datos, tamanio, FLAGS);
+	}
+	for (;;) {
+		if (token->estaCancelado()) {
+			throw CancelacionExcepcion(MENSAJE_CANCELADO);
+		}
+		ssize_t resultado = recv(sockfd, datos, tamanio, FLAGS | MSG_DONTWAIT);
+		if (resultado != ERROR_RECEPCION
+				|| (errno != EAGAIN && errno != EWOULDBLOCK)) {
+			return resultado;
+		}
+		if (!esperarListo(POLLIN)) {
+			errno = EAGAIN;
+			return ERROR_RECEPCION;
+		}
+	}
+}
+
 SocketTCP_IP::~SocketTCP_IP() {
 }
 }
@@ -2,9 +2,16 @@
 #define	SOCKETTCPIP_H
 
 #include "Socket.h"
+#include "Futuro.h"
+#include "CancelacionExcepcion.h"
 
 namespace Com {
 
+class BucleEventos;
+class BufferCircular;
+class TokenCancelacion;
+class VistaBuffer;
+
 /**
  * @brief Clase que define el comportamiento en común de un socket TCP_IP, sea
  * cliente o servidor
@@ -35,9 +42,40 @@ public:
 	 * @param buffer Contenedor con los datos a enviar
 	 * @return La cantidad de bytes enviados
 	 * @throw EnvioExcepcion Error generado al enviar datos
+	 * @throw CancelacionExcepcion Se canceló el token del socket
 	 */
 	virtual ssize_t enviar(const BufferTransmision &buffer)
-			throw (EnvioExcepcion);
+			throw (EnvioExcepcion, CancelacionExcepcion);
+
+	/**
+	 * @brief Método para enviar a través del socket los bytes de una vista,
+	 * sin copiarlos (por ejemplo, los de un ArchivoMapeado). Puede no enviar
+	 * la vista completa en un solo llamado
+	 * @pre Conexión establecida mediante SocketCliente::conectar (por parte
+	 * del cliente) y SocketServidor::aceptar (por parte del servidor)
+	 * @param vista Vista de los datos a enviar
+	 * @return La cantidad de bytes enviados
+	 * @throw EnvioExcepcion Error generado al enviar datos
+	 * @throw CancelacionExcepcion Se canceló el token del socket
+	 */
+	ssize_t enviar(const VistaBuffer &vista) throw (EnvioExcepcion, CancelacionExcepcion);
+
+	/**
+	 * @brief Método para enviar varias vistas seguidas, sin copiarlas, con la
+	 * menor cantidad de llamadas al sistema: cada llamado a sendmsg lleva
+	 * todas las regiones pendientes (hasta un máximo por llamado). No retorna
+	 * hasta enviarlas completas
+	 * @pre Conexión establecida mediante SocketCliente::conectar (por parte
+	 * del cliente) y SocketServidor::aceptar (por parte del servidor)
+	 * @param vistas Arreglo de vistas a enviar, en orden
+	 * @param cantidad Cantidad de vistas
+	 * @return La cantidad de bytes enviados
+	 * @throw EnvioExcepcion Error generado al enviar datos. Parte de los
+	 * datos pudo haberse enviado
+	 * @throw CancelacionExcepcion Se canceló el token del socket
+	 */
+	size_t enviarVectorizado(const VistaBuffer *vistas, size_t cantidad)
+			throw (EnvioExcepcion, CancelacionExcepcion);
 
 	/**
 	 * @brief Método para recibir datos a través del socket. Puede no recibir
@@ -50,9 +88,27 @@ public:
 	 * contenido previo es descartado
 	 * @return La cantidad de bytes recibidos
 	 * @throw RecepcionExcepcion Error generado al recibir datos
+	 * @throw CancelacionExcepcion Se canceló el token del socket
 	 */
 	virtual ssize_t recibir(BufferTransmision &buffer)
-			throw (RecepcionExcepcion);
+			throw (RecepcionExcepcion, CancelacionExcepcion);
+
+	/**
+	 * @brief Método para recibir datos a través del socket directamente sobre
+	 * el espacio libre de un BufferCircular, con un único llamado a readv.
+	 * Los datos recibidos se agregan a continuación de los datos previos,
+	 * que se conservan. Si no hay datos para recibir, se bloquea la ejecución
+	 * hasta recibir datos o se corte la comunicación con
+	 * Socket::cortarComunicacion
+	 * @pre Conexión establecida mediante SocketCliente::conectar (por parte
+	 * del cliente) y SocketServidor::aceptar (por parte del servidor)
+	 * @param buffer Contenedor donde se agregarán los datos recibidos
+	 * @return La cantidad de bytes recibidos. Si el buffer está lleno, no se
+	 * recibe nada y se retorna 0
+	 * @throw RecepcionExcepcion Error generado al recibir datos
+	 * @throw CancelacionExcepcion Se canceló el token del socket
+	 */
+	ssize_t recibir(BufferCircular &buffer) throw (RecepcionExcepcion, CancelacionExcepcion);
 
 	/**
 	 * @brief Método para enviar datos. Utiliza un protocolo por defecto,
@@ -66,10 +122,27 @@ public:
 	 * de control con el tamaño del buffer a enviar)
 	 * @return La cantidad de bytes enviados, incluyendo dato de control con
 	 * el tamaño del buffer a enviar
+	 * @throw EnvioExcepcion Error generado al enviar datos
+	 * @throw CancelacionExcepcion Se canceló el token del socket
 	 * @note No testeado
 	 */
 	virtual size_t enviarConProtocolo(const BufferTransmision &buffer)
-			throw (EnvioExcepcion);
+			throw (EnvioExcepcion, CancelacionExcepcion);
+
+	/**
+	 * @brief Método para enviar los bytes de una vista con el protocolo por
+	 * defecto (ver SocketTCP_IP::enviarConProtocolo), sin copiarlos. Permite
+	 * enviar un ArchivoMapeado sin leerlo antes a un BufferTransmision
+	 * @pre Conexión establecida mediante SocketCliente::conectar (por parte
+	 * del cliente) y SocketServidor::aceptar (por parte del servidor)
+	 * @param vista Vista de los datos a enviar
+	 * @return La cantidad de bytes enviados, incluyendo dato de control con
+	 * el tamaño de los datos a enviar
+	 * @throw EnvioExcepcion Error generado al enviar datos
+	 * @throw CancelacionExcepcion Se canceló el token del socket
+	 */
+	size_t enviarConProtocolo(const VistaBuffer &vista)
+			throw (EnvioExcepcion, CancelacionExcepcion);
 
 	/**
 	 * @brief Método para recibir datos. Utiliza un protocolo por defecto,
@@ -83,10 +156,77 @@ public:
 	 * contenido previo es descartado
 	 * @return La cantidad de bytes recibidos, incluyendo dato de control con
 	 * el tamaño del buffer a recibir
+	 * @throw RecepcionExcepcion Error generado al recibir datos
+	 * @throw CancelacionExcepcion Se canceló el token del socket
 	 * @note No testeado
 	 */
 	virtual size_t recibirConProtocolo(BufferTransmision &buffer)
-			throw (RecepcionExcepcion);
+			throw (RecepcionExcepcion, CancelacionExcepcion);
+
+	/**
+	 * @brief Versión asincrónica de SocketTCP_IP::enviarConProtocolo. Envía
+	 * lo que se pueda sin bloquear y, si el socket no admite más datos,
+	 * continúa cuando el bucle de eventos indique que se puede escribir
+	 * @pre Conexión establecida
+	 * @pre Los datos de la vista siguen vivos hasta que se complete el futuro
+	 * @pre No hay otro envío asincrónico en curso sobre el socket
+	 * @param vista Vista de los datos a enviar
+	 * @param bucle Bucle de eventos que reanuda el envío
+	 * @param milisegundosLimite Plazo para completar el envío una vez que hay
+	 * que esperar al bucle, -1 para esperar sin límite
+	 * @return Un futuro con la cantidad de bytes enviados, incluyendo el dato
+	 * de control. Si el envío falla o vence el plazo, el futuro falla con el
+	 * motivo. Si vence el plazo, el mensaje puede haberse enviado en parte
+	 */
+	POSIX::Futuro<size_t> enviarConProtocolo(const VistaBuffer &vista,
+			BucleEventos &bucle, int milisegundosLimite = -1);
+
+	/**
+	 * @brief Versión asincrónica de SocketTCP_IP::recibirConProtocolo. Recibe
+	 * lo que haya disponible sin bloquear y continúa cuando el bucle de
+	 * eventos indique que llegaron más datos. El mensaje se recibe
+	 * directamente sobre el buffer, sin copias intermedias
+	 * @pre Conexión establecida
+	 * @pre El buffer sigue vivo, y no se usa, hasta que se complete el futuro
+	 * @pre No hay otra recepción asincrónica en curso sobre el socket
+	 * @param buffer Contenedor donde se guardarán los datos recibidos. El
+	 * contenido previo es descartado
+	 * @param bucle Bucle de eventos que reanuda la recepción
+	 * @param milisegundosLimite Plazo para completar la recepción una vez que
+	 * hay que esperar al bucle, -1 para esperar sin límite
+	 * @return Un futuro con la cantidad de bytes recibidos, incluyendo el
+	 * dato de control. Si la recepción falla, vence el plazo o el otro
+	 * extremo se desconecta, el futuro falla con el motivo
+	 */
+	POSIX::Futuro<size_t> recibirConProtocolo(BufferTransmision &buffer,
+			BucleEventos &bucle, int milisegundosLimite = -1);
+
+	/**
+	 * @brief Método para fijar el tiempo límite de los envíos y recepciones
+	 * bloqueantes. Al vencer, la operación falla con su excepción
+	 * @pre Socket creado mediante Socket::crear
+	 * @param milisegundos Tiempo límite, -1 para esperar sin límite
+	 * @return <tt>true</tt> si se pudo fijar
+	 */
+	bool setTiempoLimite(int milisegundos);
+
+	/**
+	 * @brief Método para asociar un token de cancelación a las operaciones
+	 * bloqueantes del socket. Con un token, cada operación espera con poll
+	 * sobre el socket y el token, y al cancelarlo arroja
+	 * CancelacionExcepcion. Sin token, las operaciones son las llamadas
+	 * bloqueantes directas
+	 * @details Los clientes aceptados por un SocketServidor heredan su token
+	 * @param token Token a asociar, NULL para quitarlo. Debe seguir vivo
+	 * mientras esté asociado
+	 */
+	void setTokenCancelacion(TokenCancelacion *token);
+
+	/**
+	 * @brief Método para obtener el token de cancelación asociado
+	 * @return El token, NULL si no tiene
+	 */
+	TokenCancelacion* getTokenCancelacion() const;
 
 	/**
 	 * @brief Destructor
@@ -113,6 +253,35 @@ protected:
 	 * @param socket SocketTCP_IP a copiar
 	 */
 	SocketTCP_IP(const SocketTCP_IP &socket) throw ();
+
+	/**
+	 * @brief Método que espera a que el socket esté listo, o a que se cancele
+	 * su token
+	 * @pre El socket tiene un token de cancelación
+	 * @param eventos POLLIN para esperar datos (o conexiones), POLLOUT para
+	 * esperar espacio de envío (o el fin de una conexión)
+	 * @return <tt>true</tt> si el socket está listo o tiene un error pendiente
+	 * @return <tt>false</tt> si venció el tiempo límite
+	 * (ver SocketTCP_IP::setTiempoLimite)
+	 * @throw CancelacionExcepcion Se canceló el token
+	 */
+	bool esperarListo(short eventos) throw (CancelacionExcepcion);
+
+	TokenCancelacion *token;
+
+private:
+
+	/* Tiempo limite de las operaciones bloqueantes, -1 sin limite */
+	int milisegundosLimite;
+
+	/* Un send o recv que, si hay token, espera con esperarListo en lugar de
+	 * bloquearse. Retornan como send y recv */
+	ssize_t enviarParcial(const void *datos, size_t tamanio)
+			throw (CancelacionExcepcion);
+	ssize_t recibirParcial(void *datos, size_t tamanio)
+			throw (CancelacionExcepcion);
+	ssize_t enviarRegionesParcial(struct iovec *regiones, size_t cantidad)
+			throw (CancelacionExcepcion);
 };
 }
 
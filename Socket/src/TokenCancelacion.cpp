@@ -0,0 +1,43 @@
+#include "TokenCancelacion.h"
+#include <cerrno>
+#include <cstring>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include "ExcepcionesSocket.h"
+
+#define ERROR_EVENTFD -1
+
+namespace Com {
+
+TokenCancelacion::TokenCancelacion() {
+	cancelado = false;
+	descriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (descriptor == ERROR_EVENTFD) {
+		throw CreacionExcepcion(strerror(errno));
+	}
+}
+
+void TokenCancelacion::cancelar() {
+	if (__atomic_exchange_n(&cancelado, true, __ATOMIC_ACQ_REL)) {
+		return;
+	}
+	/* El contador nunca se lee, asi que el descriptor queda legible para
+	 * siempre */
+	uint64_t uno = 1;
+	ssize_t escrito = write(descriptor, &uno, sizeof(uno));
+	(void) escrito;
+}
+
+bool TokenCancelacion::estaCancelado() const {
+	return __atomic_load_n(&cancelado, __ATOMIC_ACQUIRE);
+}
+
+int TokenCancelacion::getDescriptor() const {
+	return descriptor;
+}
+
+TokenCancelacion::~TokenCancelacion() {
+	close(descriptor);
+}
+}
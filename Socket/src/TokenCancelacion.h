@@ -0,0 +1,63 @@
+#ifndef TOKENCANCELACION_H
+#define	TOKENCANCELACION_H
+
+namespace Com {
+
+/**
+ * @brief Señal de cancelación compartida por varios sockets e hilos. Al
+ * cancelarla, toda operación bloqueante de un socket asociado (ver
+ * SocketTCP_IP::setTokenCancelacion) retorna con CancelacionExcepcion, sin
+ * dejar recursos a medio liberar como pthread_cancel
+ * @details Internamente es un eventfd que queda legible al cancelar. Las
+ * operaciones bloqueantes esperan con poll sobre el socket y el eventfd a la
+ * vez, por lo que un solo llamado a TokenCancelacion::cancelar despierta a
+ * todos los hilos bloqueados. El descriptor puede agregarse a cualquier otra
+ * espera (poll, epoll) para el mismo fin
+ * @details La cancelación es definitiva: el token no puede reutilizarse
+ */
+
+class TokenCancelacion {
+public:
+
+	/**
+	 * @brief Construye un token sin cancelar
+	 * @throw CreacionExcepcion Error al crear el eventfd
+	 */
+	TokenCancelacion() /* throw (CreacionExcepcion) */;
+
+	/**
+	 * @brief Método para cancelar el token y despertar a los hilos que lo
+	 * esperan. Llamarlo más de una vez no tiene efecto
+	 */
+	void cancelar();
+
+	/**
+	 * @brief Método para consultar si el token fue cancelado. No realiza
+	 * llamadas al sistema
+	 * @return <tt>true</tt> si fue cancelado
+	 */
+	bool estaCancelado() const;
+
+	/**
+	 * @brief Método para obtener el descriptor que queda legible al cancelar
+	 * @return El descriptor
+	 */
+	int getDescriptor() const;
+
+	/**
+	 * @brief Destructor
+	 * @pre Ningún socket está usando el token
+	 */
+	~TokenCancelacion();
+
+private:
+
+	int descriptor;
+	bool cancelado;
+
+	TokenCancelacion(const TokenCancelacion&);
+	TokenCancelacion& operator=(const TokenCancelacion&);
+};
+}
+
+#endif
@@ -0,0 +1,162 @@
+#include "TokenCancelacion.h"
+#include "SocketCliente.h"
+#include "SocketServidor.h"
+#include "ExcepcionesSocket.h"
+#include "CuentaRegresiva.h"
+#include "Thread.h"
+#include "Bench.h"
+#include <cstdio>
+#include <cstdlib>
+#include <sys/resource.h>
+#include <time.h>
+#include <vector>
+
+/* Tiempo de apagado de un servidor con un hilo bloqueado en recibir por
+ * conexión: cancelando un único token, o cortando cada socket desde el hilo
+ * que apaga el servidor */
+
+#define CONEXIONES 10000
+#define PUERTO_BENCH 40440
+/* Los hilos solo esperan en recibir, alcanza con un stack chico */
+#define TAMANIO_STACK (64 * 1024)
+
+namespace Com {
+
+class HiloConexion: public POSIX::Thread {
+public:
+	HiloConexion(SocketCliente *socket, PThread::CuentaRegresiva &listos) :
+			socket(socket), listos(listos) {
+	}
+	SocketCliente& getSocket() {
+		return *socket;
+	}
+	~HiloConexion() {
+		delete socket;
+	}
+protected:
+	void* ejecutar(void*) {
+		BufferTransmision buffer(64);
+		listos.descontar();
+		try {
+			while (true) {
+				socket->recibirConProtocolo(buffer);
+			}
+		}
+		catch (CancelacionExcepcion&) {
+			/* Apagado por el token */
+		}
+		catch (SocketExcepcion&) {
+			/* Apagado cortando el socket */
+		}
+		socket->cerrar();
+		return NULL;
+	}
+private:
+	SocketCliente *socket;
+	PThread::CuentaRegresiva &listos;
+};
+
+/* Conecta los clientes y deja un hilo del servidor bloqueado en cada
+ * conexión */
+static void levantar(SocketServidor &servidor, in_port_t puerto,
+		size_t conexiones, std::vector<SocketCliente*> &clientes,
+		std::vector<HiloConexion*> &hilos) {
+	servidor.crear();
+	servidor.enlazarServidor();
+	servidor.escucharClientes(128);
+	PThread::CuentaRegresiva listos((int) conexiones);
+	POSIX::Thread::Atributos atributos;
+	atributos.setTamanioStack(TAMANIO_STACK);
+	for (size_t i = 0; i < conexiones; ++i) {
+		SocketCliente *cliente = new SocketCliente(puerto, "127.0.0.1");
+		cliente->crear();
+		cliente->conectar();
+		clientes.push_back(cliente);
+		hilos.push_back(new HiloConexion(servidor.aceptarClientes(), listos));
+		hilos.back()->setAtributos(atributos);
+		hilos.back()->iniciar();
+	}
+	listos.esperar();
+	/* Margen para que el último hilo llegue a bloquearse en recibir */
+	struct timespec pausa = { 0, 100 * 1000000L };
+	nanosleep(&pausa, NULL);
+}
+
+static double esperarHilos(std::vector<HiloConexion*> &hilos,
+		const struct timespec &inicio) {
+	for (size_t i = 0; i < hilos.size(); ++i) {
+		void *retorno;
+		POSIX::Thread::esperarThread(*hilos[i], retorno);
+	}
+	double milisegundos = PThread::milisegundosDesde(inicio);
+	for (size_t i = 0; i < hilos.size(); ++i) {
+		delete hilos[i];
+	}
+	return milisegundos;
+}
+
+static void cerrarClientes(std::vector<SocketCliente*> &clientes) {
+	for (size_t i = 0; i < clientes.size(); ++i) {
+		clientes[i]->cerrar();
+		delete clientes[i];
+	}
+}
+
+void benchApagadoConToken(in_port_t puerto, size_t conexiones) {
+	TokenCancelacion token;
+	SocketServidor servidor(puerto);
+	servidor.setTokenCancelacion(&token);
+	std::vector<SocketCliente*> clientes;
+	std::vector<HiloConexion*> hilos;
+	levantar(servidor, puerto, conexiones, clientes, hilos);
+
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	token.cancelar();
+	printf("%-28s %10.1f ms\n", "cancelando el token",
+			esperarHilos(hilos, inicio));
+	cerrarClientes(clientes);
+	servidor.cerrar();
+}
+
+void benchApagadoCortando(in_port_t puerto, size_t conexiones) {
+	SocketServidor servidor(puerto);
+	std::vector<SocketCliente*> clientes;
+	std::vector<HiloConexion*> hilos;
+	levantar(servidor, puerto, conexiones, clientes, hilos);
+
+	struct timespec inicio;
+	clock_gettime(CLOCK_MONOTONIC, &inicio);
+	for (size_t i = 0; i < hilos.size(); ++i) {
+		hilos[i]->getSocket().cortarComunicacion(Socket::cortar_ambos);
+	}
+	printf("%-28s %10.1f ms\n", "cortando cada socket",
+			esperarHilos(hilos, inicio));
+	cerrarClientes(clientes);
+	servidor.cerrar();
+}
+
+}
+
+#ifdef TOKENCANCELACION_BENCH
+int main(int argc, char **argv) {
+	size_t conexiones = (argc > 1) ? (size_t) atol(argv[1]) : CONEXIONES;
+	in_port_t puerto = (in_port_t) ((argc > 2) ? atoi(argv[2]) : PUERTO_BENCH);
+	/* Cada conexión usa dos descriptores: el del cliente y el aceptado */
+	struct rlimit limite;
+	getrlimit(RLIMIT_NOFILE, &limite);
+	limite.rlim_cur = limite.rlim_max;
+	setrlimit(RLIMIT_NOFILE, &limite);
+	if (2 * conexiones + 16 > limite.rlim_cur) {
+		fprintf(stderr, "Se necesitan %lu descriptores, el limite es %lu\n",
+				(unsigned long) (2 * conexiones + 16),
+				(unsigned long) limite.rlim_cur);
+		return 1;
+	}
+	printf("Apagado de %lu conexiones con un hilo bloqueado en cada una\n",
+			(unsigned long) conexiones);
+	Com::benchApagadoConToken(puerto, conexiones);
+	Com::benchApagadoCortando(puerto + 1, conexiones);
+	return 0;
+}
+#endif
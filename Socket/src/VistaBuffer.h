@@ -0,0 +1,250 @@
+#ifndef VISTABUFFER_H
+#define	VISTABUFFER_H
+
+#include <cstddef>
+#include <cstring>
+#include "BufferTransmision.h"
+
+namespace Com {
+
+/**
+ * @brief Clase que representa una vista de solo lectura sobre un rango de
+ * bytes contiguos que pertenecen a otro objeto (por ejemplo, los datos
+ * ocupados de un BufferTransmision). No copia ni libera los datos
+ * @warning La vista deja de ser válida si el dueño de los datos los modifica,
+ * los descarta o se destruye
+ */
+
+class VistaBuffer {
+public:
+
+	/**
+	 * @brief Valor retornado por VistaBuffer::buscar cuando no se encuentra
+	 * el byte buscado
+	 */
+	static const size_t NO_ENCONTRADO = (size_t) -1;
+
+	/**
+	 * @brief Construye una vista vacía
+	 */
+	VistaBuffer() : datos(NULL), tamanio(0) {
+	}
+
+	/**
+	 * @brief Construye una vista sobre los @a tamanio bytes apuntados por
+	 * @a datos
+	 * @param datos Puntero al primer byte de la vista
+	 * @param tamanio Cantidad de bytes de la vista
+	 */
+	VistaBuffer(const BufferTransmision::t_buffer *datos, size_t tamanio) :
+			datos(datos), tamanio(tamanio) {
+	}
+
+	/**
+	 * @brief Construye una vista sobre los datos ocupados de @a buffer
+	 * @param buffer Buffer a observar
+	 */
+	explicit VistaBuffer(const BufferTransmision &buffer) :
+			datos(buffer.obtenerBuffer()),
+			tamanio(buffer.getTamanioOcupado()) {
+	}
+
+	/**
+	 * @brief Método para obtener los datos de la vista
+	 * @return Puntero al primer byte de la vista
+	 */
+	const BufferTransmision::t_buffer* obtenerDatos() const {
+		return datos;
+	}
+
+	/**
+	 * @brief Método para obtener el tamaño de la vista
+	 * @return El tamaño de la vista, en bytes
+	 */
+	size_t getTamanio() const {
+		return tamanio;
+	}
+
+	/**
+	 * @brief Método para consultar si la vista está vacía
+	 * @return <tt>true</tt> si la vista no tiene bytes
+	 */
+	bool estaVacia() const {
+		return (tamanio == 0);
+	}
+
+	/**
+	 * @brief Operador de acceso a un byte, sin verificación de rango
+	 * @param posicion Posición del byte, comenzando en 0
+	 * @return El byte solicitado
+	 */
+	BufferTransmision::t_buffer operator[](size_t posicion) const {
+		return datos[posicion];
+	}
+
+	/**
+	 * @brief Método para obtener una vista de una parte de esta vista. Si el
+	 * rango excede el final, se recorta
+	 * @param inicio Posición del primer byte de la subvista
+	 * @param cantidad Cantidad de bytes de la subvista
+	 * @return La subvista
+	 */
+	VistaBuffer subVista(size_t inicio, size_t cantidad) const {
+		if (inicio > tamanio) {
+			inicio = tamanio;
+		}
+		if (cantidad > tamanio - inicio) {
+			cantidad = tamanio - inicio;
+		}
+		return VistaBuffer(datos + inicio, cantidad);
+	}
+
+	/**
+	 * @brief Método para buscar la primera aparición de @a byte a partir de
+	 * la posición @a desde
+	 * @param byte Byte a buscar
+	 * @param desde Posición desde donde comenzar la búsqueda
+	 * @return La posición del byte encontrado
+	 * @return VistaBuffer::NO_ENCONTRADO si el byte no aparece
+	 */
+	size_t buscar(BufferTransmision::t_buffer byte, size_t desde = 0) const {
+		if (desde >= tamanio) {
+			return NO_ENCONTRADO;
+		}
+		const void *encontrado = memchr(datos + desde, byte, tamanio - desde);
+		if (encontrado == NULL) {
+			return NO_ENCONTRADO;
+		}
+		return (size_t) ((const BufferTransmision::t_buffer*) encontrado - datos);
+	}
+
+private:
+
+	const BufferTransmision::t_buffer *datos;
+	size_t tamanio;
+};
+
+/**
+ * @brief Clase para recorrer secuencialmente una VistaBuffer sin copiar los
+ * datos, consumiendo bytes desde el principio
+ * @details Para descartar de un BufferTransmision los bytes ya procesados,
+ * sin mover los datos restantes, se utiliza
+ * BufferTransmision::descartarDatos con CursorLectura::getPosicion
+ */
+
+class CursorLectura {
+public:
+
+	/**
+	 * @brief Construye un cursor al principio de @a vista
+	 * @param vista Datos a recorrer
+	 */
+	explicit CursorLectura(const VistaBuffer &vista) :
+			vista(vista), posicion(0) {
+	}
+
+	/**
+	 * @brief Construye un cursor al principio de los datos ocupados de
+	 * @a buffer
+	 * @param buffer Buffer a recorrer. No debe modificarse mientras se lo
+	 * recorre
+	 */
+	explicit CursorLectura(const BufferTransmision &buffer) :
+			vista(buffer), posicion(0) {
+	}
+
+	/**
+	 * @brief Método para copiar los próximos @a cantidad bytes en
+	 * @a destino, sin avanzar el cursor
+	 * @param destino Donde se copiarán los bytes
+	 * @param cantidad Cantidad de bytes a copiar
+	 * @return <tt>true</tt> en caso de éxito
+	 * @return <tt>false</tt> si no quedan suficientes bytes
+	 */
+	bool espiar(void *destino, size_t cantidad) const {
+		if (cantidad > getBytesRestantes()) {
+			return false;
+		}
+		memcpy(destino, vista.obtenerDatos() + posicion, cantidad);
+		return true;
+	}
+
+	/**
+	 * @brief Método para copiar los próximos @a cantidad bytes en
+	 * @a destino, avanzando el cursor
+	 * @param destino Donde se copiarán los bytes
+	 * @param cantidad Cantidad de bytes a copiar
+	 * @return <tt>true</tt> en caso de éxito
+	 * @return <tt>false</tt> si no quedan suficientes bytes
+	 */
+	bool consumir(void *destino, size_t cantidad) {
+		if (!espiar(destino, cantidad)) {
+			return false;
+		}
+		posicion += cantidad;
+		return true;
+	}
+
+	/**
+	 * @brief Método para obtener una vista de los próximos @a cantidad bytes,
+	 * avanzando el cursor pero sin copiar los datos
+	 * @param consumida Vista donde se guardarán los bytes consumidos
+	 * @param cantidad Cantidad de bytes a consumir
+	 * @return <tt>true</tt> en caso de éxito
+	 * @return <tt>false</tt> si no quedan suficientes bytes
+	 */
+	bool consumir(VistaBuffer &consumida, size_t cantidad) {
+		if (cantidad > getBytesRestantes()) {
+			return false;
+		}
+		consumida = vista.subVista(posicion, cantidad);
+		posicion += cantidad;
+		return true;
+	}
+
+	/**
+	 * @brief Método para avanzar el cursor @a cantidad bytes
+	 * @param cantidad Cantidad de bytes a saltear
+	 * @return <tt>true</tt> en caso de éxito
+	 * @return <tt>false</tt> si no quedan suficientes bytes
+	 */
+	bool saltear(size_t cantidad) {
+		if (cantidad > getBytesRestantes()) {
+			return false;
+		}
+		posicion += cantidad;
+		return true;
+	}
+
+	/**
+	 * @brief Método para obtener una vista de los bytes sin consumir
+	 * @return La vista de los bytes sin consumir
+	 */
+	VistaBuffer obtenerRestante() const {
+		return vista.subVista(posicion, getBytesRestantes());
+	}
+
+	/**
+	 * @brief Método para obtener la posición del cursor
+	 * @return La cantidad de bytes consumidos
+	 */
+	size_t getPosicion() const {
+		return posicion;
+	}
+
+	/**
+	 * @brief Método para obtener la cantidad de bytes sin consumir
+	 * @return La cantidad de bytes sin consumir
+	 */
+	size_t getBytesRestantes() const {
+		return (vista.getTamanio() - posicion);
+	}
+
+private:
+
+	VistaBuffer vista;
+	size_t posicion;
+};
+}
+
+#endif
@@ -0,0 +1,157 @@
+#include "VistaBuffer.h"
+#include "Bench.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+#include <string>
+#include <time.h>
+#include <vector>
+
+/* Parser de tramas con prefijo de longitud sobre 1 MB recibido de a
+ * fragmentos en un BufferTransmision: recorriéndolo en el lugar con
+ * CursorLectura y descartando lo procesado con descartarDatos, frente a
+ * copiarlo con obtenerBuffer(std::string&) y volver a insertar el resto */
+
+#define BYTES_TRAMAS (1024 * 1024)
+/* Tamaño de cada fragmento recibido, como el de un recv */
+#define FRAGMENTO 4096
+#define CARGA_MINIMA 16
+#define CARGA_MAXIMA 512
+#define RONDAS 200
+
+namespace Com {
+
+/* Tramas de longitud pseudoaleatoria entre CARGA_MINIMA y CARGA_MAXIMA.
+ * @a suma es la suma de los bytes de las cargas, sin las cabeceras */
+static std::vector<char> armarTramas(size_t &cantidad, uint32_t &suma) {
+	std::vector<char> tramas;
+	uint32_t semilla = 12345;
+	cantidad = 0;
+	suma = 0;
+	while (tramas.size() < BYTES_TRAMAS) {
+		semilla = semilla * 1103515245 + 12345;
+		uint32_t carga = CARGA_MINIMA
+				+ (semilla >> 16) % (CARGA_MAXIMA - CARGA_MINIMA + 1);
+		uint32_t longitud = htonl(carga);
+		const char *cabecera = reinterpret_cast<const char*>(&longitud);
+		tramas.insert(tramas.end(), cabecera, cabecera + sizeof(longitud));
+		for (uint32_t i = 0; i < carga; ++i) {
+			tramas.push_back((char) (cantidad + i));
+			suma += (unsigned char) tramas.back();
+		}
+		++cantidad;
+	}
+	return tramas;
+}
+
+/* Trabajo del manejador de cada trama: sumar sus bytes o, si no recorre la
+ * carga, solo contar su tamaño */
+static uint32_t procesar(const char *carga, size_t tamanio, bool recorrer) {
+	if (!recorrer) {
+		return (uint32_t) tamanio;
+	}
+	uint32_t suma = 0;
+	for (size_t i = 0; i < tamanio; ++i) {
+		suma += (unsigned char) carga[i];
+	}
+	return suma;
+}
+
+/* Procesa las tramas completas y deja en @a buffer solo lo que falta */
+static size_t parsearConCursor(BufferTransmision &buffer, bool recorrer,
+		uint32_t &suma) {
+	CursorLectura cursor(buffer);
+	size_t tramas = 0;
+	uint32_t longitud;
+	VistaBuffer carga;
+	while (cursor.espiar(&longitud, sizeof(longitud))
+			&& cursor.getBytesRestantes()
+					>= sizeof(longitud) + ntohl(longitud)) {
+		cursor.saltear(sizeof(longitud));
+		cursor.consumir(carga, ntohl(longitud));
+		suma += procesar(carga.obtenerDatos(), carga.getTamanio(), recorrer);
+		++tramas;
+	}
+	buffer.descartarDatos(cursor.getPosicion());
+	return tramas;
+}
+
+/* Como se parseaba antes del cursor: se copia todo el contenido y se
+ * reconstruye el buffer con lo que falta procesar */
+static size_t parsearConCopia(BufferTransmision &buffer, std::string &copia,
+		bool recorrer, uint32_t &suma) {
+	buffer.obtenerBuffer(copia);
+	size_t posicion = 0;
+	size_t tramas = 0;
+	uint32_t longitud;
+	while (copia.size() - posicion >= sizeof(longitud)) {
+		memcpy(&longitud, copia.data() + posicion, sizeof(longitud));
+		longitud = ntohl(longitud);
+		if (copia.size() - posicion - sizeof(longitud) < longitud) {
+			break;
+		}
+		posicion += sizeof(longitud);
+		suma += procesar(copia.data() + posicion, longitud, recorrer);
+		posicion += longitud;
+		++tramas;
+	}
+	buffer.vaciarBuffer();
+	buffer.insertarDatos(copia.data() + posicion, copia.size() - posicion);
+	return tramas;
+}
+
+static void reportar(const char *prueba, bool recorrer, double segundos,
+		size_t tramas, size_t esperadas, uint32_t suma, uint32_t esperada) {
+	printf("%-24s %-16s %8.1f MB/s  %10.0f tramas/s%s\n", prueba,
+			recorrer ? "recorriendo" : "sin recorrer",
+			(double) BYTES_TRAMAS * RONDAS / segundos / 1e6,
+			tramas / segundos,
+			(tramas != esperadas || suma != esperada) ? "  ERROR" : "");
+}
+
+void benchParser() {
+	size_t cantidad;
+	uint32_t sumaCargas;
+	std::vector<char> tramas = armarTramas(cantidad, sumaCargas);
+	uint32_t bytesCargas = tramas.size() - cantidad * sizeof(uint32_t);
+	BufferTransmision buffer(FRAGMENTO + sizeof(uint32_t) + CARGA_MAXIMA);
+	std::string copia;
+	printf("%lu tramas en %lu bytes, fragmentos de %d bytes\n",
+			(unsigned long) cantidad, (unsigned long) tramas.size(),
+			FRAGMENTO);
+
+	for (int prueba = 0; prueba < 4; ++prueba) {
+		bool conCursor = (prueba % 2 == 0);
+		bool recorrer = (prueba < 2);
+		uint32_t esperada = recorrer ? sumaCargas : bytesCargas;
+		size_t procesadas = 0;
+		uint32_t suma = 0;
+		struct timespec inicio;
+		clock_gettime(CLOCK_MONOTONIC, &inicio);
+		for (int ronda = 0; ronda < RONDAS; ++ronda) {
+			buffer.vaciarBuffer();
+			for (size_t i = 0; i < tramas.size(); i += FRAGMENTO) {
+				size_t tamanio = std::min((size_t) FRAGMENTO,
+						tramas.size() - i);
+				buffer.insertarDatos(&tramas[i], tamanio);
+				procesadas += conCursor ?
+						parsearConCursor(buffer, recorrer, suma) :
+						parsearConCopia(buffer, copia, recorrer, suma);
+			}
+		}
+		reportar(conCursor ? "CursorLectura" : "obtenerBuffer(string&)",
+				recorrer, PThread::segundosDesde(inicio), procesadas,
+				cantidad * RONDAS, suma, esperada * RONDAS);
+	}
+}
+
+}
+
+#ifdef VISTABUFFER_BENCH
+int main() {
+	Com::benchParser();
+	return 0;
+}
+#endif